@@ -2,22 +2,184 @@
 from __future__ import annotations
 
 import asyncio
+import json
 import logging
+import struct
 from datetime import timedelta
 
 import aiohttp
 from homeassistant.config_entries import ConfigEntry
 from homeassistant.const import CONF_HOST, Platform
-from homeassistant.core import HomeAssistant
+from homeassistant.core import HomeAssistant, callback
+from homeassistant.exceptions import HomeAssistantError
 from homeassistant.helpers.aiohttp_client import async_get_clientsession
 from homeassistant.helpers.update_coordinator import DataUpdateCoordinator, UpdateFailed
 
-from .const import DOMAIN, SCAN_INTERVAL
+from .const import (
+    DOMAIN,
+    JSON_REFRESH_POLLS,
+    MQTT_SCAN_INTERVAL,
+    MQTT_TOPIC_PREFIX,
+    SCAN_INTERVAL,
+)
 
 _LOGGER = logging.getLogger(__name__)
 
 PLATFORMS = [Platform.SENSOR, Platform.BINARY_SENSOR]
 
+# Binary status packet (see src/SensorStatusPacket.h in the firmware)
+STATUS_PACKET_VERSION = 1
+STATUS_PACKET = struct.Struct("<2sBBBBBB6s2xHHH2xII10f")
+STATUS_FLAGS = (
+    ("stopped", None),
+    ("filamentRunout", None),
+    ("isWebsocketConnected", "elegoo"),
+    ("isPrinting", "elegoo"),
+    ("graceActive", "elegoo"),
+    ("telemetryAvailable", "elegoo"),
+    ("runoutPausePending", "elegoo"),
+    ("runoutPauseCommanded", "elegoo"),
+)
+STATUS_FLOATS = (
+    "expectedFilament",
+    "actualFilament",
+    "currentDeficitMm",
+    "deficitRatio",
+    "passRatio",
+    "hardJamPercent",
+    "softJamPercent",
+    "expectedRateMmPerSec",
+    "actualRateMmPerSec",
+    "currentZ",
+)
+
+
+def decode_status_packet(payload: bytes) -> dict | None:
+    """Decode a binary status packet into the /sensor_status JSON shape."""
+    if len(payload) < STATUS_PACKET.size:
+        return None
+    fields = STATUS_PACKET.unpack_from(payload)
+    magic, version, _length, flags, print_status, grace_state, progress, mac = fields[:8]
+    if magic != b"OF" or version != STATUS_PACKET_VERSION:
+        return None
+    current_layer, total_layer, print_speed, uptime, pulses = fields[8:13]
+
+    elegoo = {
+        "printStatus": print_status,
+        "graceState": grace_state,
+        "progress": progress,
+        "currentLayer": current_layer,
+        "totalLayer": total_layer,
+        "PrintSpeedPct": print_speed,
+        "movementPulses": pulses,
+    }
+    elegoo.update(zip(STATUS_FLOATS, fields[13:]))
+    data = {
+        "mac": ":".join(f"{b:02X}" for b in mac),
+        "uptimeSec": uptime,
+        "elegoo": elegoo,
+    }
+    for bit, (key, section) in enumerate(STATUS_FLAGS):
+        target = elegoo if section else data
+        target[key] = bool(flags & (1 << bit))
+    return data
+
+
+# Flow history export (see src/FlowHistory.h in the firmware)
+FLOW_HISTORY_VERSION = 1
+FLOW_HISTORY_HEADER = struct.Struct("<2sBBIIHHHH")
+FLOW_HISTORY_FIELDS = (
+    ("expectedRate", 100),
+    ("actualRate", 100),
+    ("passRatio", 100),
+    ("hardJamPercent", 2),
+    ("softJamPercent", 2),
+)
+
+
+def decode_flow_history(payload: bytes) -> dict | None:
+    """Decode /api/flow_history.bin into fine and coarse sample lists."""
+    if len(payload) < FLOW_HISTORY_HEADER.size:
+        return None
+    (magic, version, header_len, end_sec, age_ms, fine_interval, fine_count,
+     coarse_interval, coarse_count) = FLOW_HISTORY_HEADER.unpack_from(payload)
+    if magic != b"FH" or version != FLOW_HISTORY_VERSION:
+        return None
+    offset = header_len
+
+    def read_varint() -> int:
+        nonlocal offset
+        value = shift = 0
+        while True:
+            byte = payload[offset]
+            offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return (value >> 1) ^ -(value & 1)
+
+    def read_series(count: int) -> list[dict]:
+        nonlocal offset
+        values = [0] * len(FLOW_HISTORY_FIELDS)
+        flags = 0
+        samples = []
+        for _ in range(count):
+            mask = payload[offset]
+            offset += 1
+            for i in range(len(values)):
+                if mask & (1 << i):
+                    values[i] += read_varint()
+            if mask & 0x20:
+                flags = payload[offset]
+                offset += 1
+            sample = {
+                key: value / scale
+                for (key, scale), value in zip(FLOW_HISTORY_FIELDS, values)
+            }
+            sample["hasData"] = bool(flags & 1)
+            sample["jammed"] = bool(flags & 2)
+            sample["graceActive"] = bool(flags & 4)
+            samples.append(sample)
+        return samples
+
+    try:
+        fine = read_series(fine_count)
+        coarse = read_series(coarse_count)
+    except IndexError:
+        return None
+    return {
+        "elapsedSec": end_sec,
+        "ageMs": age_ms,
+        "fineIntervalSec": fine_interval,
+        "coarseIntervalSec": coarse_interval,
+        "fine": fine,
+        "coarse": coarse,
+    }
+
+
+def summarize_flow_history(history: dict) -> dict:
+    """Figures for the flow sensors: the fine window and the whole print."""
+    recent = [s for s in history["fine"] if s["hasData"]]
+    whole = [s for s in history["coarse"] if s["hasData"]] or recent
+    summary = {"elapsedSec": history["elapsedSec"]}
+    if recent:
+        summary["recentMinPassRatio"] = min(s["passRatio"] for s in recent)
+        summary["recentPeakHardJam"] = max(s["hardJamPercent"] for s in recent)
+        summary["recentPeakSoftJam"] = max(s["softJamPercent"] for s in recent)
+    if whole:
+        summary["printAvgPassRatio"] = round(
+            sum(s["passRatio"] for s in whole) / len(whole), 2
+        )
+    return summary
+
+
+def merge_status(base: dict, update: dict) -> dict:
+    """Overlay a partial status (binary packet or MQTT message) on a full one."""
+    merged = dict(base)
+    merged.update({k: v for k, v in update.items() if k != "elegoo"})
+    merged["elegoo"] = {**base.get("elegoo", {}), **update.get("elegoo", {})}
+    return merged
+
 
 async def async_setup_entry(hass: HomeAssistant, entry: ConfigEntry) -> bool:
     """Set up Open Filament Sensor from a config entry."""
@@ -25,6 +187,8 @@ async def async_setup_entry(hass: HomeAssistant, entry: ConfigEntry) -> bool:
 
     coordinator = OFSDataUpdateCoordinator(hass, host)
     await coordinator.async_config_entry_first_refresh()
+    await coordinator.async_start_push()
+    entry.async_on_unload(coordinator.async_stop_push)
 
     hass.data.setdefault(DOMAIN, {})
     hass.data[DOMAIN][entry.entry_id] = coordinator
@@ -57,16 +221,146 @@ class OFSDataUpdateCoordinator(DataUpdateCoordinator):
         self.host = host
         self.session = async_get_clientsession(hass)
         self._url = f"http://{host}/sensor_status"
+        self._bin_url = f"http://{host}/api/sensor_status.bin"
+        self._memory_url = f"http://{host}/api/perf/memory"
+        self._memory_supported = True
+        self._flow_history_url = f"http://{host}/api/flow_history.bin"
+        self._flow_history_supported = True
+        # Fields only the JSON carries (e.g. mainboardID); refreshed every
+        # JSON_REFRESH_POLLS polls while the binary endpoint is in use
+        self._json_fields: dict = {}
+        self._polls_since_json = 0
+        self._binary_supported = True
+        self._unsubscribers: list = []
+
+    async def async_start_push(self) -> None:
+        """Subscribe to the device's MQTT topics when HA has MQTT set up.
+
+        Jam and runout transitions then arrive as soon as the device sees
+        them; HTTP polling drops to MQTT_SCAN_INTERVAL as a fallback.
+        """
+        if "mqtt" not in self.hass.config.components or not self.data:
+            return
+        mac = self.data.get("mac")
+        if not mac:
+            return
+
+        from homeassistant.components import mqtt
+
+        prefix = f"{MQTT_TOPIC_PREFIX}/{mac.replace(':', '').lower()}"
+        try:
+            self._unsubscribers = [
+                await mqtt.async_subscribe(self.hass, f"{prefix}/status", self._handle_status),
+                await mqtt.async_subscribe(self.hass, f"{prefix}/jam", self._handle_jam),
+                await mqtt.async_subscribe(self.hass, f"{prefix}/runout", self._handle_runout),
+            ]
+        except HomeAssistantError as err:
+            _LOGGER.debug("MQTT subscribe failed, staying on HTTP polling: %s", err)
+            self.async_stop_push()
+            return
+        self.update_interval = timedelta(seconds=MQTT_SCAN_INTERVAL)
+        _LOGGER.debug("Receiving %s updates over MQTT (%s/#)", self.host, prefix)
+
+    @callback
+    def async_stop_push(self) -> None:
+        """Drop MQTT subscriptions."""
+        for unsubscribe in self._unsubscribers:
+            unsubscribe()
+        self._unsubscribers = []
+        self.update_interval = timedelta(seconds=SCAN_INTERVAL)
+
+    def _push_update(self, update: dict) -> None:
+        if self.data is None:
+            return
+        self.async_set_updated_data(merge_status(self.data, update))
+
+    @callback
+    def _handle_status(self, msg) -> None:
+        try:
+            update = json.loads(msg.payload)
+        except ValueError:
+            return
+        if isinstance(update, dict):
+            self._push_update(update)
+
+    @callback
+    def _handle_jam(self, msg) -> None:
+        self._push_update({"stopped": msg.payload == "ON"})
+
+    @callback
+    def _handle_runout(self, msg) -> None:
+        self._push_update({"filamentRunout": msg.payload == "ON"})
+
+    async def _fetch_json(self) -> dict:
+        async with self.session.get(self._url) as response:
+            if response.status != 200:
+                raise UpdateFailed(f"HTTP error {response.status}")
+            return await response.json()
+
+    async def _fetch_binary(self) -> dict | None:
+        async with self.session.get(self._bin_url) as response:
+            if response.status == 404:
+                # Older firmware without the packet endpoint
+                self._binary_supported = False
+                return None
+            if response.status != 200:
+                return None  # Packet not built yet; the JSON path reports errors
+            return decode_status_packet(await response.read())
+
+    async def _fetch_memory(self) -> dict | None:
+        """Heap and stack marks, summarised for the memory sensors."""
+        async with self.session.get(self._memory_url) as response:
+            if response.status == 404:
+                # Older firmware without memory instrumentation
+                self._memory_supported = False
+                return None
+            if response.status != 200:
+                return None
+            memory = await response.json()
+        tasks = memory.get("tasks") or []
+        if tasks:
+            tightest = min(tasks, key=lambda task: task.get("stackFreeMin", 0))
+            memory["minStackFree"] = tightest.get("stackFreeMin")
+            memory["minStackTask"] = tightest.get("name")
+        return memory
+
+    async def _fetch_flow_history(self) -> dict | None:
+        """Summary of the device's per-print flow history."""
+        async with self.session.get(self._flow_history_url) as response:
+            if response.status == 404:
+                # Older firmware without the flow history
+                self._flow_history_supported = False
+                return None
+            if response.status != 200:
+                return None
+            history = decode_flow_history(await response.read())
+        return summarize_flow_history(history) if history else None
 
     async def _async_update_data(self) -> dict:
         """Fetch data from OFS device."""
         try:
             async with asyncio.timeout(10):
-                async with self.session.get(self._url) as response:
-                    if response.status != 200:
-                        raise UpdateFailed(f"HTTP error {response.status}")
-                    data = await response.json()
+                data = None
+                need_json = not self._json_fields or self._polls_since_json >= JSON_REFRESH_POLLS
+                if self._binary_supported and not need_json:
+                    data = await self._fetch_binary()
+                if data is None:
+                    data = await self._fetch_json()
+                    # Slow-moving, so refreshed with the JSON rather than every poll
+                    if self._memory_supported:
+                        memory = await self._fetch_memory()
+                        if memory is not None:
+                            data["memory"] = memory
+                    if self._flow_history_supported:
+                        flow = await self._fetch_flow_history()
+                        if flow is not None:
+                            data["flowHistory"] = flow
+                    self._json_fields = data
+                    self._polls_since_json = 0
                     return data
+
+                self._polls_since_json += 1
+                return merge_status(self._json_fields, data)
         except aiohttp.ClientError as err:
             raise UpdateFailed(f"Error communicating with OFS: {err}") from err
         except asyncio.TimeoutError as err:
@@ -2,12 +2,20 @@
 from homeassistant.components.sensor import SensorDeviceClass, SensorStateClass
 from homeassistant.const import (
     PERCENTAGE,
+    UnitOfInformation,
     UnitOfLength,
     UnitOfTime,
 )
 
 DOMAIN = "open_filament_sensor"
 SCAN_INTERVAL = 5  # seconds
+# Polls use the compact binary status; the full JSON (for fields the packet
+# doesn't carry, like mainboardID) is refetched every this many polls
+JSON_REFRESH_POLLS = 60
+# When the device publishes over MQTT (firmware ENABLE_MQTT), updates are
+# pushed and HTTP polling only backs them up
+MQTT_TOPIC_PREFIX = "ofs"
+MQTT_SCAN_INTERVAL = 60  # seconds
 
 # Sensor definitions: (key, name, unit, device_class, state_class, icon, json_path)
 # json_path is dot-notation: "elegoo.hardJamPercent" means data["elegoo"]["hardJamPercent"]
@@ -40,6 +48,21 @@ SENSORS = [
     # Device Info
     ("uptime", "Uptime", UnitOfTime.SECONDS, SensorDeviceClass.DURATION, SensorStateClass.TOTAL_INCREASING, "mdi:timer-outline", "uptimeSec"),
     ("mainboard_id", "Mainboard ID", None, None, None, "mdi:identifier", "elegoo.mainboardID"),
+
+    # Flow history (from /api/flow_history.bin, refreshed with the full JSON)
+    ("recent_min_pass_ratio", "Lowest Pass Ratio (10 min)", None, None, SensorStateClass.MEASUREMENT, "mdi:check-circle-outline", "flowHistory.recentMinPassRatio"),
+    ("recent_peak_hard_jam", "Peak Hard Jam (10 min)", PERCENTAGE, None, SensorStateClass.MEASUREMENT, "mdi:alert-circle-outline", "flowHistory.recentPeakHardJam"),
+    ("recent_peak_soft_jam", "Peak Soft Jam (10 min)", PERCENTAGE, None, SensorStateClass.MEASUREMENT, "mdi:alert-outline", "flowHistory.recentPeakSoftJam"),
+    ("print_avg_pass_ratio", "Print Average Pass Ratio", None, None, SensorStateClass.MEASUREMENT, "mdi:chart-line", "flowHistory.printAvgPassRatio"),
+
+    # Memory (from /api/perf/memory, refreshed with the full JSON)
+    ("free_heap", "Free Heap", UnitOfInformation.BYTES, SensorDeviceClass.DATA_SIZE, SensorStateClass.MEASUREMENT, "mdi:memory", "memory.heap.free"),
+    ("min_free_heap", "Min Free Heap", UnitOfInformation.BYTES, SensorDeviceClass.DATA_SIZE, SensorStateClass.MEASUREMENT, "mdi:memory", "memory.heap.minFree"),
+    ("largest_free_block", "Largest Free Block", UnitOfInformation.BYTES, SensorDeviceClass.DATA_SIZE, SensorStateClass.MEASUREMENT, "mdi:memory", "memory.heap.maxAlloc"),
+    ("heap_fragmentation", "Heap Fragmentation", PERCENTAGE, None, SensorStateClass.MEASUREMENT, "mdi:puzzle-outline", "memory.heap.fragmentationPct"),
+    ("top_heap_retainer", "Top Heap Retainer", None, None, None, "mdi:memory-arrow-down", "memory.topRetainer"),
+    ("min_stack_free", "Min Stack Headroom", UnitOfInformation.BYTES, SensorDeviceClass.DATA_SIZE, SensorStateClass.MEASUREMENT, "mdi:layers-outline", "memory.minStackFree"),
+    ("min_stack_task", "Tightest Stack Task", None, None, None, "mdi:layers-outline", "memory.minStackTask"),
 ]
 
 # Binary sensor definitions: (key, name, icon_on, icon_off, device_class, json_path)
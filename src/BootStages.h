@@ -0,0 +1,97 @@
+#ifndef BOOT_STAGES_H
+#define BOOT_STAGES_H
+
+#include <Arduino.h>
+
+/**
+ * BootStages - when each startup stage first completed (ms since boot)
+ *
+ * Startup is staged by dependency rather than run in sequence: setup() arms
+ * the sensors, SystemServices connects WiFi in the background, and the main
+ * loop starts SDCP the pass WiFi associates, ahead of the web server and
+ * NTP. Each stage calls mark() once it is done; only the first call counts,
+ * so reconnects do not overwrite boot timings. Values are written once and
+ * read as whole words, so /version reads them from the async_tcp task
+ * without locking.
+ */
+enum BootStage : uint8_t
+{
+    BOOT_STAGE_SENSORS = 0,  // Pulse counting, runout pins and detection task armed
+    BOOT_STAGE_WIFI,         // Station associated and addressed
+    BOOT_STAGE_SDCP,         // First printer WebSocket connected (pause commands possible)
+    BOOT_STAGE_WEB,          // HTTP/OTA server listening
+    BOOT_STAGE_NTP,          // Wall clock set
+    BOOT_STAGE_COUNT
+};
+
+class BootStages
+{
+  public:
+    static BootStages &getInstance()
+    {
+        static BootStages instance;
+        return instance;
+    }
+
+    void mark(BootStage stage)
+    {
+        if (stage < BOOT_STAGE_COUNT && reachedMs[stage] == 0)
+        {
+            uint32_t now     = millis();
+            reachedMs[stage] = now != 0 ? now : 1;  // 0 means "not yet"
+        }
+    }
+
+    // 0 until the stage completed
+    uint32_t reachedAtMs(BootStage stage) const
+    {
+        return stage < BOOT_STAGE_COUNT ? reachedMs[stage] : 0;
+    }
+
+    // Jam protection needs the sensors armed and a printer to pause
+    uint32_t protectedAtMs() const
+    {
+        uint32_t sensors = reachedMs[BOOT_STAGE_SENSORS];
+        uint32_t sdcp    = reachedMs[BOOT_STAGE_SDCP];
+        return (sensors == 0 || sdcp == 0) ? 0 : (sensors > sdcp ? sensors : sdcp);
+    }
+
+    // {"sensors_ms":12,...,"protected_ms":null}; returns the length written
+    size_t toJson(char *buffer, size_t size) const
+    {
+        static const char *const kNames[BOOT_STAGE_COUNT] = {"sensors", "wifi", "sdcp", "web",
+                                                             "ntp"};
+        size_t length = 0;
+        for (uint8_t stage = 0; stage <= BOOT_STAGE_COUNT && length < size; stage++)
+        {
+            const char *name  = stage < BOOT_STAGE_COUNT ? kNames[stage] : "protected";
+            uint32_t    value = stage < BOOT_STAGE_COUNT ? reachedMs[stage] : protectedAtMs();
+            int written = value != 0
+                              ? snprintf(buffer + length, size - length, "%s\"%s_ms\":%lu",
+                                         stage == 0 ? "{" : ",", name, (unsigned long) value)
+                              : snprintf(buffer + length, size - length, "%s\"%s_ms\":null",
+                                         stage == 0 ? "{" : ",", name);
+            if (written < 0)
+            {
+                return 0;
+            }
+            length += written;
+        }
+        if (length + 1 >= size)
+        {
+            return 0;
+        }
+        buffer[length++] = '}';
+        buffer[length]   = '\0';
+        return length;
+    }
+
+  private:
+    BootStages() = default;
+
+    volatile uint32_t reachedMs[BOOT_STAGE_COUNT] = {0};
+};
+
+#define bootStages BootStages::getInstance()
+
+#endif  // BOOT_STAGES_H
@@ -0,0 +1,308 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * DeferredLog - pack printf arguments now, format them when read
+ *
+ * Hot-path log lines are stored as the format string's address followed by
+ * the raw argument values, each tagged with its type. Text is produced only
+ * when a reader asks for it (log download, serial sink), so logging from the
+ * detection loop costs a few stores instead of a vsnprintf.
+ *
+ * Restrictions, since only the pointer to the format is kept:
+ *   - the format must be a string literal (or otherwise never freed/changed)
+ *   - arguments must be numbers; %s, %p, %n and '*' widths are not supported
+ *
+ * Length modifiers in the format are ignored: each argument is rendered with
+ * the width it was packed with, so "%lu" with a 64-bit value is still right.
+ */
+namespace DeferredLog
+{
+enum ArgType : uint8_t
+{
+    ARG_I32 = 'i',
+    ARG_U32 = 'u',
+    ARG_I64 = 'q',
+    ARG_U64 = 'Q',
+    ARG_F64 = 'd',
+};
+
+// Format pointer plus up to ~12 numeric arguments
+static const size_t MAX_PAYLOAD = 128;
+
+class Packer
+{
+  public:
+    Packer(uint8_t *buffer, size_t size) : buf(buffer), cap(size), len(0), overflow(false) {}
+
+    size_t length() const { return overflow ? 0 : len; }
+
+    void putFormat(const char *format)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(format);
+        putRaw(&address, sizeof(address));
+    }
+
+    void put(bool v) { putI32(v ? 1 : 0); }
+    void put(char v) { putI32(v); }
+    void put(signed char v) { putI32(v); }
+    void put(unsigned char v) { putU32(v); }
+    void put(short v) { putI32(v); }
+    void put(unsigned short v) { putU32(v); }
+    void put(int v) { putI32(v); }
+    void put(unsigned int v) { putU32(v); }
+    void put(long v) { putInteger(static_cast<long long>(v), sizeof(long) > 4); }
+    void put(unsigned long v) { putUnsigned(static_cast<unsigned long long>(v), sizeof(long) > 4); }
+    void put(long long v) { putInteger(v, true); }
+    void put(unsigned long long v) { putUnsigned(v, true); }
+    void put(float v) { putF64(v); }
+    void put(double v) { putF64(v); }
+
+    void putAll() {}
+
+    template <typename T, typename... Rest>
+    void putAll(T first, Rest... rest)
+    {
+        put(first);
+        putAll(rest...);
+    }
+
+  private:
+    uint8_t *buf;
+    size_t   cap;
+    size_t   len;
+    bool     overflow;
+
+    void putRaw(const void *data, size_t size)
+    {
+        if (overflow || len + size > cap)
+        {
+            overflow = true;
+            return;
+        }
+        memcpy(buf + len, data, size);
+        len += size;
+    }
+
+    void putTagged(ArgType type, const void *data, size_t size)
+    {
+        uint8_t tag = type;
+        putRaw(&tag, 1);
+        putRaw(data, size);
+    }
+
+    void putI32(int32_t v) { putTagged(ARG_I32, &v, sizeof(v)); }
+    void putU32(uint32_t v) { putTagged(ARG_U32, &v, sizeof(v)); }
+    void putF64(double v) { putTagged(ARG_F64, &v, sizeof(v)); }
+
+    void putInteger(long long v, bool wide)
+    {
+        if (wide)
+        {
+            int64_t value = v;
+            putTagged(ARG_I64, &value, sizeof(value));
+        }
+        else
+        {
+            putI32(static_cast<int32_t>(v));
+        }
+    }
+
+    void putUnsigned(unsigned long long v, bool wide)
+    {
+        if (wide)
+        {
+            uint64_t value = v;
+            putTagged(ARG_U64, &value, sizeof(value));
+        }
+        else
+        {
+            putU32(static_cast<uint32_t>(v));
+        }
+    }
+};
+
+/**
+ * Pack format + arguments into `buffer`. Returns the payload length, or 0 if
+ * it does not fit (the caller then falls back to immediate formatting).
+ */
+template <typename... Args>
+size_t pack(uint8_t *buffer, size_t size, const char *format, Args... args)
+{
+    Packer packer(buffer, size);
+    packer.putFormat(format);
+    packer.putAll(args...);
+    return packer.length();
+}
+
+/**
+ * Render a packed payload as text into `out` (always NUL-terminated).
+ * Returns the number of characters written.
+ */
+inline size_t render(const uint8_t *payload, size_t length, char *out, size_t outSize)
+{
+    if (outSize == 0)
+    {
+        return 0;
+    }
+    out[0] = '\0';
+
+    uintptr_t address = 0;
+    if (length < sizeof(address))
+    {
+        return 0;
+    }
+    memcpy(&address, payload, sizeof(address));
+    const char *format = reinterpret_cast<const char *>(address);
+    size_t      argPos = sizeof(address);
+    size_t      pos    = 0;
+
+    while (*format != '\0' && pos + 1 < outSize)
+    {
+        if (*format != '%')
+        {
+            out[pos++] = *format++;
+            continue;
+        }
+        if (format[1] == '%')
+        {
+            out[pos++] = '%';
+            format += 2;
+            continue;
+        }
+
+        // Copy flags, width and precision; drop length modifiers
+        char   spec[16];
+        size_t specLen  = 0;
+        spec[specLen++] = *format++;
+        while (*format != '\0' && strchr("-+ #0123456789.", *format) != nullptr && specLen < 10)
+        {
+            spec[specLen++] = *format++;
+        }
+        while (*format != '\0' && strchr("hlLqjzt", *format) != nullptr)
+        {
+            format++;
+        }
+        char conversion = *format;
+        if (conversion == '\0')
+        {
+            break;
+        }
+        format++;
+
+        // Next packed argument (missing ones render as "?")
+        if (argPos >= length)
+        {
+            out[pos++] = '?';
+            continue;
+        }
+        uint8_t tag = payload[argPos++];
+        int64_t  asSigned   = 0;
+        uint64_t asUnsigned = 0;
+        double   asDouble   = 0.0;
+        size_t   valueSize  = (tag == ARG_I32 || tag == ARG_U32) ? 4 : 8;
+        if (argPos + valueSize > length)
+        {
+            break;
+        }
+        if (tag == ARG_I32)
+        {
+            int32_t v;
+            memcpy(&v, payload + argPos, 4);
+            asSigned = v;
+            asUnsigned = static_cast<uint32_t>(v);
+            asDouble = v;
+        }
+        else if (tag == ARG_U32)
+        {
+            uint32_t v;
+            memcpy(&v, payload + argPos, 4);
+            asSigned = v;
+            asUnsigned = v;
+            asDouble = v;
+        }
+        else if (tag == ARG_I64)
+        {
+            memcpy(&asSigned, payload + argPos, 8);
+            asUnsigned = static_cast<uint64_t>(asSigned);
+            asDouble = static_cast<double>(asSigned);
+        }
+        else if (tag == ARG_U64)
+        {
+            memcpy(&asUnsigned, payload + argPos, 8);
+            asSigned = static_cast<int64_t>(asUnsigned);
+            asDouble = static_cast<double>(asUnsigned);
+        }
+        else if (tag == ARG_F64)
+        {
+            memcpy(&asDouble, payload + argPos, 8);
+            asSigned = static_cast<int64_t>(asDouble);
+            asUnsigned = static_cast<uint64_t>(asSigned);
+        }
+        else
+        {
+            break;  // Corrupt payload
+        }
+        argPos += valueSize;
+
+        int written = 0;
+        if (strchr("fFeEgGaA", conversion) != nullptr)
+        {
+            spec[specLen++] = conversion;
+            spec[specLen]   = '\0';
+            written = snprintf(out + pos, outSize - pos, spec, asDouble);
+        }
+        else if (strchr("di", conversion) != nullptr)
+        {
+            spec[specLen++] = 'l';
+            spec[specLen++] = 'l';
+            spec[specLen++] = conversion;
+            spec[specLen]   = '\0';
+            written = snprintf(out + pos, outSize - pos, spec, static_cast<long long>(asSigned));
+        }
+        else if (strchr("uxXoc", conversion) != nullptr)
+        {
+            if (conversion == 'c')
+            {
+                spec[specLen++] = 'c';
+                spec[specLen]   = '\0';
+                written = snprintf(out + pos, outSize - pos, spec, static_cast<int>(asSigned));
+            }
+            else
+            {
+                // Negative 32-bit values render as printf would at their packed width
+                spec[specLen++] = 'l';
+                spec[specLen++] = 'l';
+                spec[specLen++] = conversion;
+                spec[specLen]   = '\0';
+                written = snprintf(out + pos, outSize - pos, spec,
+                                   static_cast<unsigned long long>(asUnsigned));
+            }
+        }
+        else
+        {
+            out[pos++] = '?';  // Unsupported conversion (%s, %p, ...)
+            continue;
+        }
+
+        if (written > 0)
+        {
+            pos += static_cast<size_t>(written);
+            if (pos >= outSize)
+            {
+                pos = outSize - 1;
+            }
+        }
+    }
+
+    out[pos] = '\0';
+    return pos;
+}
+}  // namespace DeferredLog
+
+#endif  // DEFERRED_LOG_H
@@ -3,16 +3,21 @@
 #include <ArduinoJson.h>
 #include <WiFi.h>
 #include <WiFiUdp.h>
+#include <lwip/sockets.h>
+#include <new>
 
+#include "BootStages.h"
 #include "FilamentMotionSensor.h"
+#include "FlowProfile.h"
+#include "LockProfiler.h"
 #include "Logger.h"
+#include "MemoryMonitor.h"
+#include "PerfMonitor.h"
+#include "PulseCounter.h"
 #include "SDCPProtocol.h"
 #include "SettingsManager.h"
+#include "TaskWake.h"
 
-#include <vector>
-
-// Define and initialize the static pulse counter
-volatile unsigned long ElegooCC::isrPulseCounter = 0;
 
 #define ACK_TIMEOUT_MS SDCPTiming::ACK_TIMEOUT_MS
 constexpr float        DEFAULT_FILAMENT_DEFICIT_THRESHOLD_MM = SDCPDefaults::FILAMENT_DEFICIT_THRESHOLD_MM;
@@ -24,37 +29,92 @@ static const char*     TOTAL_EXTRUSION_HEX_KEY       = SDCPKeys::TOTAL_EXTRUSION
 static const char*     CURRENT_EXTRUSION_HEX_KEY     = SDCPKeys::CURRENT_EXTRUSION_HEX;
 static const uint16_t  SDCP_DISCOVERY_PORT = 3000;
 
+static_assert(PRINTER_SESSIONS >= 1 && PRINTER_SESSIONS <= 4, "PRINTER_SESSIONS must be 1-4");
+static_assert(PRINTER_SESSIONS * MOTION_SENSOR_CHANNELS <= PULSE_COUNTER_MAX_CHANNELS,
+              "More motion channels than pulse counter channels");
+static const int kMovementSensorPins[] = {MOVEMENT_SENSOR_PIN, MOVEMENT_SENSOR_PIN_1,
+                                          MOVEMENT_SENSOR_PIN_2, MOVEMENT_SENSOR_PIN_3};
+static const int kRunoutPins[] = {FILAMENT_RUNOUT_PIN, FILAMENT_RUNOUT_PIN_1,
+                                  FILAMENT_RUNOUT_PIN_2, FILAMENT_RUNOUT_PIN_3};
+
+bool SdcpWebSocketClient::enableTcpKeepalive(int idleSeconds, int intervalSeconds, int probeCount)
+{
+    if (_client.tcp == nullptr)
+    {
+        return false;
+    }
+    int fd = _client.tcp->fd();
+    if (fd < 0)
+    {
+        return false;
+    }
+    int enable = 1;
+    return setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable)) == 0 &&
+           setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idleSeconds, sizeof(idleSeconds)) == 0 &&
+           setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &intervalSeconds, sizeof(intervalSeconds)) == 0 &&
+           setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &probeCount, sizeof(probeCount)) == 0;
+}
+
+StaticJsonDocument<1200>  ElegooCC::messageDoc;
+int8_t                    ElegooCC::connectingSession   = -1;
+TaskHandle_t              ElegooCC::detectionTaskHandle = nullptr;
+ElegooCC::DiscoveryState  ElegooCC::discoveryState;
+
 namespace
 {
-JamConfig buildJamConfigFromSettings()
+const char          DISCOVERY_PROBE[]              = "M99999";
+const size_t        DISCOVERY_PROBE_LENGTH         = sizeof(DISCOVERY_PROBE) - 1;
+const unsigned long DISCOVERY_PROBE_INTERVAL_MS    = 400;   // Re-broadcast cadence while scanning
+const unsigned long DISCOVERY_REOPEN_MS            = 5000;  // Retry a socket that failed to open
+const uint8_t       DISCOVERY_MAX_PACKETS_PER_PASS = 4;
+const int           DISCOVERY_LOST_AFTER_FAILURES  = 2;     // Timed-out connects before probing
+
+// Empty or the "1.1.1.1" placeholder means no printer is configured
+bool isUsableAddress(const char *ip)
+{
+    return ip[0] != '\0' && strcmp(ip, "1.1.1.1") != 0;
+}
+
+// Directed broadcast address of the station's subnet
+IPAddress subnetBroadcast()
+{
+    IPAddress localIp = WiFi.localIP();
+    IPAddress subnet  = WiFi.subnetMask();
+    return IPAddress((localIp[0] & subnet[0]) | ~subnet[0], (localIp[1] & subnet[1]) | ~subnet[1],
+                     (localIp[2] & subnet[2]) | ~subnet[2], (localIp[3] & subnet[3]) | ~subnet[3]);
+}
+
+JamConfig buildJamConfigFromSettings(const settings_snapshot_t &settings)
 {
     JamConfig config;
-    config.ratioThreshold = settingsManager.getDetectionRatioThreshold();
+    config.ratioThreshold = settings.detectionRatioThreshold;
     if (config.ratioThreshold <= 0.0f || config.ratioThreshold > 1.0f)
     {
         config.ratioThreshold = 0.70f;
     }
 
-    config.hardJamMm = settingsManager.getDetectionHardJamMm();
+    config.hardJamMm = settings.detectionHardJamMm;
     if (config.hardJamMm <= 0.0f)
     {
         config.hardJamMm = 5.0f;
     }
 
-    config.softJamTimeMs = settingsManager.getDetectionSoftJamTimeMs();
+    config.softJamTimeMs = settings.detectionSoftJamTimeMs;
     if (config.softJamTimeMs <= 0)
     {
         config.softJamTimeMs = 3000;
     }
 
-    config.hardJamTimeMs = settingsManager.getDetectionHardJamTimeMs();
+    config.hardJamTimeMs = settings.detectionHardJamTimeMs;
     if (config.hardJamTimeMs <= 0)
     {
         config.hardJamTimeMs = 2000;
     }
 
-    config.graceTimeMs    = settingsManager.getDetectionGracePeriodMs();
-    config.detectionMode   = static_cast<DetectionMode>(settingsManager.getDetectionMode());
+    config.graceTimeMs     = settings.detectionGracePeriodMs;
+    config.detectionMode   = static_cast<DetectionMode>(settings.detectionMode);
+    config.adaptiveSoftJam = settings.adaptiveSoftJam;
+    config.verboseLogging  = settings.logLevel >= 1;
     return config;
 }
 }  // namespace
@@ -62,27 +122,79 @@ JamConfig buildJamConfigFromSettings()
 // External function to get current time (from main.cpp)
 extern unsigned long getTime();
 
-// Get current printer information
+// Get current printer information (lock-free copy of the last published state)
 printer_info_t ElegooCC::getCurrentInformation()
 {
+    if (infoSnapshot.generation() == 0)
+    {
+        // loop() hasn't run yet (printer not configured): build on demand
+        printer_info_t info;
+        buildCurrentInformation(info);
+        return info;
+    }
+    return infoSnapshot.read();
+}
+
+void ElegooCC::markInfoChanged()
+{
+    __atomic_add_fetch(&infoRevision, 1, __ATOMIC_RELAXED);
+}
+
+void ElegooCC::publishCurrentInformation()
+{
+    // Nothing to do unless a mutator marked the state or the detection task
+    // published since the last pass: most loop() passes stop here
+    uint32_t revision            = __atomic_load_n(&infoRevision, __ATOMIC_RELAXED);
+    uint32_t detectionGeneration = detectionSnapshot.generation();
+    if (revision == publishedInfoRevision && detectionGeneration == publishedDetectionGeneration)
+    {
+        return;
+    }
+    publishedInfoRevision        = revision;
+    publishedDetectionGeneration = detectionGeneration;
+
     printer_info_t info;
-    JamState jamState = jamDetector.getState();
-    bool motionMonitoringEnabled = settingsManager.getEnabled();
+    buildCurrentInformation(info);
+
+    // Republish only on change so readers (and WebServer's dirty tracking)
+    // see a new generation only when there is something new to show
+    if (memcmp(&info, &lastPublishedInfo, sizeof(info)) == 0)
+    {
+        return;
+    }
+    lastPublishedInfo = info;
+
+    // Only the publish itself runs with interrupts off, so no reader on this
+    // core can preempt the writer mid-copy and spin
+    portENTER_CRITICAL(&infoPublishLock);
+    infoSnapshot.publish(info);
+    portEXIT_CRITICAL(&infoPublishLock);
+}
+
+void ElegooCC::buildCurrentInformation(printer_info_t &info)
+{
+    // Called from loop(), which owns every field read here apart from the
+    // detection snapshot, so no critical section is needed (the on-demand
+    // build in getCurrentInformation() only runs before loop() starts)
+    // Zero padding and string tails so unchanged state compares equal
+    memset(&info, 0, sizeof(info));
+    detection_snapshot_t detection = detectionSnapshot.read();
+    JamState jamState = detection.jamState;
+    bool motionMonitoringEnabled = settingsView.enabled;
     if (!motionMonitoringEnabled)
     {
         jamState = JamState{};
     }
 
-    portENTER_CRITICAL(&_stateMutex);
-    info.filamentStopped      = motionMonitoringEnabled ? filamentStopped : false;
+    info.filamentStopped      = motionMonitoringEnabled ? detection.filamentStopped : false;
     info.filamentRunout       = filamentRunout;
-    info.runoutPausePending   = filamentRunout && runoutPausePending && settingsManager.getPauseOnRunout();
+    info.runoutPausePending   = filamentRunout && runoutPausePending && settingsView.pauseOnRunout;
     info.runoutPauseCommanded = runoutPauseCommanded;
     info.runoutPauseRemainingMm = runoutPauseRemainingMm;
     info.runoutPauseDelayMm   = runoutPauseDelayMm;
-    strlcpy(info.mainboardID, mainboardID.c_str(), sizeof(info.mainboardID));
-    strlcpy(info.taskId, taskId.c_str(), sizeof(info.taskId));
-    strlcpy(info.filename, filename.c_str(), sizeof(info.filename));
+    memcpy(info.mainboardID, mainboardID, sizeof(info.mainboardID));
+    memcpy(info.taskId, taskId, sizeof(info.taskId));
+    memcpy(info.filename, filename, sizeof(info.filename));
     info.printStatus          = printStatus;
     info.isPrinting           = (printStatus == SDCP_PRINT_STATUS_PRINTING && (machineStatusMask & (1 << SDCP_MACHINE_STATUS_PRINTING)) != 0);
     info.currentLayer         = currentLayer;
@@ -95,46 +207,95 @@ printer_info_t ElegooCC::getCurrentInformation()
     info.currentZ             = currentZ;
     info.waitingForAck        = transport.waitingForAck;
     info.expectedFilamentMM   = expectedFilamentMM;
-    info.actualFilamentMM     = actualFilamentMM;
+    info.actualFilamentMM     = detection.actualFilamentMM;
     info.lastExpectedDeltaMM  = lastExpectedDeltaMM;
     info.telemetryAvailable   = telemetryAvailableLastStatus;
+    info.flowProfileActive    = flowProfileActive;
 
-    // Expose deficit metrics for UI from jam detector (read inside critical section
-    // to avoid race with checkFilamentMovement() updates)
+    // Expose deficit metrics for UI from the detection snapshot (published
+    // by the detection task, consistent with jamState)
     info.currentDeficitMm     = jamState.deficit;
     info.deficitThresholdMm   = 0.0f;
-    float expectedDist        = motionSensor.getExpectedDistance();
+    float expectedDist        = detection.expectedDistanceMm;
     info.deficitRatio         = jamState.deficit / (expectedDist > 0.1f ? expectedDist : 1.0f);
     info.passRatio            = jamState.passRatio;
+    info.softJamThreshold     = jamState.softJamThreshold;
     info.hardJamPercent       = jamState.hardJamPercent;
     info.softJamPercent       = jamState.softJamPercent;
     info.graceActive          = jamState.graceActive;
     info.graceState           = static_cast<uint8_t>(jamState.graceState);
     info.expectedRateMmPerSec = jamState.expectedRateMmPerSec;
     info.actualRateMmPerSec   = jamState.actualRateMmPerSec;
-    info.movementPulseCount   = movementPulseCount;
-    portEXIT_CRITICAL(&_stateMutex);
-
-    return info;
+    info.movementPulseCount   = detection.movementPulseCount;
+    info.activeChannel        = detection.activeChannel;
+    memcpy(info.channels, detection.channels, sizeof(info.channels));
+    info.jamLatency           = jamLatency;
+    info.link                 = transport.link;
 }
 
 ElegooCC &ElegooCC::getInstance()
 {
-    static ElegooCC instance;
-    return instance;
+    return getSession(0);
+}
+
+ElegooCC &ElegooCC::getSession(uint8_t index)
+{
+    // Constructed on first use, like the single instance before
+    switch (index)
+    {
+#if PRINTER_SESSIONS > 1
+        case 1:
+        {
+            static ElegooCC session(1);
+            return session;
+        }
+#endif
+#if PRINTER_SESSIONS > 2
+        case 2:
+        {
+            static ElegooCC session(2);
+            return session;
+        }
+#endif
+#if PRINTER_SESSIONS > 3
+        case 3:
+        {
+            static ElegooCC session(3);
+            return session;
+        }
+#endif
+        default:
+        {
+            static ElegooCC session(0);
+            return session;
+        }
+    }
 }
 
-ElegooCC::ElegooCC()
+ElegooCC::ElegooCC(uint8_t session)
 {
+    sessionIndex     = session;
+    pulseChannelBase = session * MOTION_SENSOR_CHANNELS;
+    runoutPin        = kRunoutPins[session];
+    if (PRINTER_SESSIONS > 1)
+    {
+        snprintf(logPrefix, sizeof(logPrefix), "[P%u] ", session);
+    }
+    else
+    {
+        logPrefix[0] = '\0';
+    }
     startedAt = 0;  // Initialize to prevent invalid grace periods
     // Interrupt-driven pulse counter initialization
-    lastIsrPulseCount = 0;
+    memset(lastIsrPulseCount, 0, sizeof(lastIsrPulseCount));
+    lastPulseDrainMs  = 0;
+    pulseReductionAccumulator = 0;
     // Legacy pin tracking (used only when tracking is frozen after jam pause)
     lastMovementValue = -1;  // Initialize to invalid value
     lastChangeTime    = 0;
-    mainboardID       = "";
-    taskId            = "";
-    filename          = "";
+    mainboardID[0]    = '\0';
+    taskId[0]         = '\0';
+    filename[0]       = '\0';
     printStatus       = SDCP_PRINT_STATUS_IDLE;
     machineStatusMask = 0;
     currentLayer      = 0;
@@ -153,7 +314,7 @@ ElegooCC::ElegooCC()
     transport.lastPing            = 0;
     transport.waitingForAck       = false;
     transport.pendingAckCommand   = -1;
-    transport.pendingAckRequestId = "";
+    transport.pendingAckRequestId[0] = '\0';
     transport.ackWaitStartTime    = 0;
     transport.lastStatusRequestMs = 0;
     expectedFilamentMM            = 0;
@@ -165,6 +326,10 @@ ElegooCC::ElegooCC()
     lastStatusReceiveMs           = 0;
     telemetryAvailableLastStatus  = false;
     movementPulseCount            = 0;
+    memset(channelPulseCount, 0, sizeof(channelPulseCount));
+    activeChannel                 = 0;
+    estimatorExpectedMm           = 0;
+    estimatorPulseCount           = 0;
     lastFlowLogMs                 = 0;
     lastSummaryLogMs              = 0;
     lastPinDebugLogMs             = 0;
@@ -176,81 +341,197 @@ ElegooCC::ElegooCC()
     lastLoggedTotalLayer          = -1;
     newPrintDetected              = false;
     trackingFrozen                = false;
+    flowProfileActive             = false;
     hasBeenPaused                 = false;
-    motionSensor.reset();
+    motionSensor->reset();
     pauseTriggeredByRunout        = false;
     lastPauseRequestMs = 0;
     lastPrintEndMs     = 0;
+    memset(&jamLatency, 0, sizeof(jamLatency));
+    latencyOnsetMs     = 0;
+    latencyDetectMs    = 0;
+    latencySendMs      = 0;
     lastJamDetectorUpdateMs = 0;
     cacheLock   = portMUX_INITIALIZER_UNLOCKED;
     _stateMutex = portMUX_INITIALIZER_UNLOCKED;
+    LOCK_PROFILE_NAME(&cacheLock, "ElegooCC::cacheLock");
+    LOCK_PROFILE_NAME(&_stateMutex, "ElegooCC::_stateMutex");
+    memset(&settingsView, 0, sizeof(settingsView));
+    settingsViewVersion = 0;
+    detectionLock       = xSemaphoreCreateMutexStatic(&detectionLockBuffer);
+    cachedJamState      = jamDetector.getState();
+    publishDetectionSnapshot();
+    infoPublishLock     = portMUX_INITIALIZER_UNLOCKED;
+    LOCK_PROFILE_NAME(&infoPublishLock, "ElegooCC::infoPublishLock");
+    memset(&lastPublishedInfo, 0, sizeof(lastPublishedInfo));
+    infoRevision                 = 1;  // First loop() pass publishes
+    publishedInfoRevision        = 0;
+    publishedDetectionGeneration = 0;
 
     // event handler
     transport.webSocket.onEvent([this](WStype_t type, uint8_t *payload, size_t length)
                                 { this->webSocketEvent(type, payload, length); });
 }
 
+void ElegooCC::setupSessions()
+{
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        getSession(session).setup();
+    }
+    startDetectionTask();
+
+    // Whoever drains the pulse queues sleeps between drains; pulses wake it
+    pulseCounter.setNotifyTask(detectionTaskHandle != nullptr ? detectionTaskHandle
+                                                              : mainLoopWake.task());
+    bootStages.mark(BOOT_STAGE_SENSORS);
+}
+
+void ElegooCC::connectSessions()
+{
+    if (settingsManager.isAPMode())
+    {
+        return;
+    }
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        getSession(session).connect();
+    }
+}
+
+bool ElegooCC::needsFastLoop()
+{
+    if (isDiscoveryActive() || connectingSession >= 0)
+    {
+        return true;
+    }
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        ElegooCC &printer = getSession(session);
+        if (printer.isPrintJobActive() || printer.transport.waitingForAck)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ElegooCC::setup()
 {
     // Initialize settings and config caches
     refreshCaches();
 
-    // Set up GPIO interrupt for pulse detection on MOVEMENT_SENSOR_PIN
-    // Rising edge trigger: counts each time sensor goes LOW→HIGH
-    // IRAM_ATTR requirement handled by Arduino framework for static method
-    pinMode(MOVEMENT_SENSOR_PIN, INPUT);
-    attachInterrupt(digitalPinToInterrupt(MOVEMENT_SENSOR_PIN),
-                    ElegooCC::pulseCounterISR,
-                    RISING);
-    logger.logf("Pulse detection via GPIO%d interrupt enabled", MOVEMENT_SENSOR_PIN);
+    // Set up pulse counting on MOVEMENT_SENSOR_PIN[_N] (PCNT when available, GPIO ISR otherwise)
+    for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+    {
+        uint8_t pulseChannel = pulseChannelBase + channel;
+        if (kMovementSensorPins[pulseChannel] < 0)
+        {
+            logger.logf("%sMotion channel %u has no MOVEMENT_SENSOR_PIN_%u", logPrefix, channel,
+                        pulseChannel);
+            continue;
+        }
+        pulseCounter.begin(pulseChannel, kMovementSensorPins[pulseChannel]);
+        lastIsrPulseCount[channel] = pulseCounter.read(pulseChannel);
+    }
 
     // Initialize filament runout state from actual pin reading at startup
     // This ensures jam detection is correctly disarmed if device boots with no filament
     // Configure pin with pullup to prevent floating state that causes crashes during idle
-    pinMode(FILAMENT_RUNOUT_PIN, INPUT_PULLUP);
-    int pinValue = digitalRead(FILAMENT_RUNOUT_PIN);
+    if (runoutPin >= 0)
+    {
+        pinMode(runoutPin, INPUT_PULLUP);
+        int pinValue = digitalRead(runoutPin);
 #ifdef INVERT_RUNOUT_PIN
-    pinValue = !pinValue;
+        pinValue = !pinValue;
 #endif
-    filamentRunout = (pinValue == LOW);
-    if (filamentRunout)
-    {
-        logger.log("Startup: No filament detected");
-    }
-
-    bool shouldConect = !settingsManager.isAPMode();
-    if (shouldConect)
-    {
-        connect();
+        filamentRunout = (pinValue == LOW);
+        if (filamentRunout)
+        {
+            logger.logf("%sStartup: No filament detected", logPrefix);
+        }
     }
 }
 
 void ElegooCC::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
 {
+    // Connection state, link counters and everything parsed from SDCP
+    markInfoChanged();
     switch (type)
     {
         case WStype_DISCONNECTED:
-            logger.logf("Disconnected from Centauri Carbon (prior failures: %d)",
+            logger.logf("%sDisconnected from Centauri Carbon (prior failures: %d)", logPrefix,
                         transport.consecutiveFailures);
+            if (transport.linkUp)
+            {
+                // The printer was reachable moments ago: retry at once, no backoff
+                transport.linkUp           = false;
+                transport.disconnectedAtMs = millis();
+                transport.fastReconnect    = true;
+                transport.link.drops++;
+            }
             // Reset acknowledgment state on disconnect
             transport.waitingForAck       = false;
             transport.pendingAckCommand   = -1;
-            transport.pendingAckRequestId = "";
+            transport.pendingAckRequestId[0] = '\0';
             transport.ackWaitStartTime    = 0;
             break;
         case WStype_CONNECTED:
-            logger.log("Connected to Carbon Centauri");
+        {
+            unsigned long now = millis();
+            logger.logf("%sConnected to Carbon Centauri", logPrefix);
+            bootStages.mark(BOOT_STAGE_SDCP);
+            transport.linkUp   = true;
+            transport.pongSeen = false;
+            transport.lastRxMs = now;
+            if (transport.disconnectedAtMs != 0)
+            {
+                uint32_t outageMs = now - transport.disconnectedAtMs;
+                transport.disconnectedAtMs = 0;
+                transport.link.reconnects++;
+                transport.link.lastOutageMs = outageMs;
+                transport.link.totalOutageMs += outageMs;
+                if (outageMs > transport.link.maxOutageMs)
+                {
+                    transport.link.maxOutageMs = outageMs;
+                }
+                logger.logf("%sSDCP link restored after %lums (reconnect #%u)", logPrefix,
+                            (unsigned long) outageMs, (unsigned) transport.link.reconnects);
+            }
+            if (!transport.webSocket.enableTcpKeepalive(SDCPTiming::TCP_KEEPALIVE_IDLE_S,
+                                                        SDCPTiming::TCP_KEEPALIVE_INTERVAL_S,
+                                                        SDCPTiming::TCP_KEEPALIVE_COUNT))
+            {
+                logger.logf("%sTCP keepalive not available on SDCP socket", logPrefix);
+            }
             sendCommand(SDCP_COMMAND_STATUS);
-
+            break;
+        }
+        case WStype_PING:
+            transport.lastRxMs = millis();  // The library answers it
+            break;
+        case WStype_PONG:
+            transport.pongSeen = true;
+            transport.lastRxMs = millis();
             break;
         case WStype_TEXT:
         {
+            MemScope memScope(MEM_SDCP_PARSE);
+            transport.lastRxMs = millis();
             messageDoc.clear();
-            DeserializationError error = deserializeJson(messageDoc, payload, length);
+            // Filtered parse: only the fields handleStatus/handleCommandResponse
+            // read are kept, so large status pushes don't fill the document
+            DeserializationError error;
+            {
+                PerfScope perfScope(PERF_SDCP_JSON_PARSE);
+                error = deserializeJson(messageDoc, payload, length,
+                                        DeserializationOption::Filter(SDCPProtocol::messageFilter()));
+            }
 
             if (error)
             {
-                logger.logf("JSON parsing failed: %s (payload size: %zu)", error.c_str(), length);
+                logger.logf("%sJSON parsing failed: %s (payload size: %zu)", logPrefix,
+                            error.c_str(), length);
                 return;
             }
 
@@ -283,40 +564,35 @@ void ElegooCC::webSocketEvent(WStype_t type, uint8_t *payload, size_t length)
 
 void ElegooCC::handleCommandResponse(JsonDocument &doc)
 {
-    String     id   = doc["Id"];
     JsonObject data = doc["Data"];
 
     if (data.containsKey("Cmd") && data.containsKey("RequestID"))
     {
         int    cmd         = data["Cmd"];
         int    ack         = data["Data"]["Ack"];
-        String requestId   = data["RequestID"];
-        String mainboardId = data["MainboardID"];
+        const char *requestId = data["RequestID"] | "";
 
         // Only log acknowledgments for commands that can ack
         if (transport.waitingForAck && cmd == transport.pendingAckCommand &&
-            requestId == transport.pendingAckRequestId)
+            strcmp(requestId, transport.pendingAckRequestId) == 0)
         {
             logger.logf("Received acknowledgment for command %d (Ack: %d)", cmd, ack);
+            if (cmd == SDCP_COMMAND_PAUSE_PRINT)
+            {
+                recordJamPauseAck();
+            }
             transport.waitingForAck       = false;
             transport.pendingAckCommand   = -1;
-            transport.pendingAckRequestId = "";
+            transport.pendingAckRequestId[0] = '\0';
             transport.ackWaitStartTime    = 0;
         }
 
-        // Store mainboard ID if we don't have it yet
-        //if (mainboardID.isEmpty() && !mainboardId.isEmpty())
-        //{
-        //    mainboardID = mainboardId;
-        //    logger.logf("Stored MainboardID: %s", mainboardID.c_str());
-        //}
     }
 }
 
 void ElegooCC::handleStatus(JsonDocument &doc)
 {
     JsonObject status      = doc["Status"];
-    String     mainboardId = doc["MainboardID"];
     unsigned long statusTimestamp = millis();
     bool wasPrinting = isPrinting();
     lastStatusReceiveMs          = statusTimestamp;
@@ -338,18 +614,12 @@ void ElegooCC::handleStatus(JsonDocument &doc)
     }
 
     // Parse CurrentCoords to extract Z coordinate
-    if (status.containsKey("CurrenCoord"))
+    float coordZ = 0.0f;
+    if (SDCPProtocol::parseCoordinateZ(status["CurrenCoord"].as<const char *>(), coordZ))
     {
-        String coordsStr   = status["CurrenCoord"].as<String>();
-        int    firstComma  = coordsStr.indexOf(',');
-        int    secondComma = coordsStr.indexOf(',', firstComma + 1);
-        if (firstComma != -1 && secondComma != -1)
-        {
-            String zStr = coordsStr.substring(secondComma + 1);
-            portENTER_CRITICAL(&_stateMutex);
-            currentZ    = zStr.toFloat();
-            portEXIT_CRITICAL(&_stateMutex);
-        }
+        portENTER_CRITICAL(&_stateMutex);
+        currentZ = coordZ;
+        portEXIT_CRITICAL(&_stateMutex);
     }
 
     // Parse print info
@@ -390,12 +660,15 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                 if (jamDetector.isPauseRequested() || hasBeenPaused)
                 {
                     logger.log("Print status changed to printing (resume)");
+                    lockDetection();
                     trackingFrozen = false;
                     // On resume, reset the motion sensor so jam detection starts fresh
-                    motionSensor.reset();
+                    motionSensor->reset();
                     jamDetector.onResume(statusTimestamp, movementPulseCount, actualFilamentMM);
                     filamentStopped = false;
-                    if (settingsManager.getVerboseLogging())
+                    publishDetectionSnapshot();
+                    unlockDetection();
+                    if (cachedSettings.verboseLogging)
                     {
                         logger.log("Motion sensor reset (resume after pause)");
                         logger.log("Post-resume grace active until movement detected");
@@ -407,16 +680,19 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                     logger.log("Print status changed to printing");
                     startedAt = statusTimestamp;
                     resetFilamentTracking();
+                    lockDetection();
+                    flowHistory.begin(millis());
+                    unlockDetection();
 
                     // Log active settings for this print (excluding network config)
                     logger.logf(
                         "Print settings: pulse=%.2fmm grace=%dms ratio_thr=%.2f hard_jam=%.1fmm soft_time=%dms hard_time=%dms",
-                        settingsManager.getMovementMmPerPulse(),
-                        settingsManager.getDetectionGracePeriodMs(),
-                        settingsManager.getDetectionRatioThreshold(),
-                        settingsManager.getDetectionHardJamMm(),
-                        settingsManager.getDetectionSoftJamTimeMs(),
-                        settingsManager.getDetectionHardJamTimeMs());
+                        settingsView.movementMmPerPulse,
+                        settingsView.detectionGracePeriodMs,
+                        settingsView.detectionRatioThreshold,
+                        settingsView.detectionHardJamMm,
+                        settingsView.detectionSoftJamTimeMs,
+                        settingsView.detectionHardJamTimeMs);
 
                     newPrintDetected = false;
                 }
@@ -425,6 +701,9 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                     // Ensure grace period starts even if TaskId arrives late.
                     logger.log("Print status changed to printing (no TaskId yet)");
                     startedAt = statusTimestamp;
+                    lockDetection();
+                    flowHistory.begin(millis());
+                    unlockDetection();
                 }
             }
             else if (wasPrinting)
@@ -439,7 +718,9 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                     logger.log("Print status changed to paused");
                     if (jamDetector.isPauseRequested())
                     {
+                        lockDetection();
                         trackingFrozen = true;
+                        unlockDetection();
                         logger.log("Freezing filament tracking while paused after jam");
                     }
                 }
@@ -451,66 +732,41 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                     if (finalDeficit < 0.0f) finalDeficit = 0.0f;
 
                     logger.logf(
-                        "Print summary: status=%d progress=%d layer=%d/%d ticks=%d/%d "
+                        "%sPrint summary: status=%d progress=%d layer=%d/%d ticks=%d/%d "
                         "expected=%.2fmm actual=%.2fmm deficit=%.2fmm pulses=%lu",
-                        (int) newStatus, progress, currentLayer, totalLayer, currentTicks,
+                        logPrefix, (int) newStatus, progress, currentLayer, totalLayer, currentTicks,
                         totalTicks, expectedFilamentMM, actualFilamentMM, finalDeficit,
                         movementPulseCount);
 
-                    // Auto-calibration logic...
-                    if (settingsManager.getAutoCalibrateSensor() && movementPulseCount > 0 &&
-                        expectedFilamentMM > 50.0f)
+                    // Auto-calibration: persist the streaming estimate once it converged.
+                    // movement_mm_per_pulse is a single setting, written back from session 0 only.
+                    if (sessionIndex == 0 && settingsView.autoCalibrateSensor)
                     {
-                        // Minimum thresholds: 50+ pulses and 50+mm expected for reliable calibration
-                        if (movementPulseCount >= 50)
+                        float oldValue  = settingsView.movementMmPerPulse;
+                        float estimate  = mmPerPulseEstimator.estimate();
+                        float errorPct  = mmPerPulseEstimator.standardErrorPercent();
+                        unsigned long segments = mmPerPulseEstimator.segmentCount();
+                        if (!mmPerPulseEstimator.isConverged())
+                        {
+                            logger.logf(
+                                "Auto-calibration: Not converged (%lu segments, +-%.2f%%), keeping "
+                                "mm_per_pulse %.3f",
+                                segments, errorPct, oldValue);
+                        }
+                        else if (mmPerPulseEstimator.seedValue() != oldValue)
                         {
-                            // Health check: only calibrate if flow quality was good (>90%)
-                            float flowQuality = actualFilamentMM / expectedFilamentMM;
-
-                            if (flowQuality >= 0.90f)
-                            {
-                                float calculatedMmPerPulse = expectedFilamentMM / (float) movementPulseCount;
-
-                                // Sanity check: should be between 2.5-3.5mm (reasonable range for SFS 2.0)
-                                if (calculatedMmPerPulse >= 2.5f && calculatedMmPerPulse <= 3.5f)
-                                {
-                                    float oldValue = settingsManager.getMovementMmPerPulse();
-                                    settingsManager.setMovementMmPerPulse(calculatedMmPerPulse);
-
-                                    // Disable auto-calibration after successful calibration
-                                    settingsManager.setAutoCalibrateSensor(false);
-                                    settingsManager.save();
-                                    refreshCaches();
-
-                                    logger.logf(
-                                        "Auto-calibration: Updated mm_per_pulse from %.3f to %.3f "
-                                        "(based on %.2fmm expected / %lu pulses, flow quality %.1f%%)",
-                                        oldValue, calculatedMmPerPulse, expectedFilamentMM,
-                                        movementPulseCount, flowQuality * 100.0f);
-                                    logger.log("Auto-calibration: Disabled after successful calibration");
-                                }
-                                else
-                                {
-                                    logger.logf(
-                                        "Auto-calibration: Calculated value %.3f is outside valid range "
-                                        "(2.5-3.5mm), keeping current setting",
-                                        calculatedMmPerPulse);
-                                }
-                            }
-                            else
-                            {
-                                logger.logf(
-                                    "Auto-calibration: Skipped - flow quality %.1f%% < 90%% threshold "
-                                    "(print may have had jams/under-extrusion)",
-                                    flowQuality * 100.0f);
-                            }
+                            logger.log("Auto-calibration: Setting changed during the print, estimate discarded");
                         }
-                        else
+                        else if (fabsf(estimate - oldValue) >= 0.001f)
                         {
+                            settingsManager.setMovementMmPerPulse(estimate);
+                            settingsManager.commit();
+                            refreshCaches();
+
                             logger.logf(
-                                "Auto-calibration: Not enough pulses (%lu, need 50+) for reliable "
-                                "calibration",
-                                movementPulseCount);
+                                "Auto-calibration: Updated mm_per_pulse from %.3f to %.3f "
+                                "(%lu segments, +-%.2f%%)",
+                                oldValue, estimate, segments, errorPct);
                         }
                     }
 
@@ -548,16 +804,13 @@ void ElegooCC::handleStatus(JsonDocument &doc)
         totalTicks   = printInfo["TotalTicks"];
         PrintSpeedPct = printInfo["PrintSpeedPct"];
 
-        // Extract TaskId - any change indicates a new print job
-        String newTaskId = "";
-        if (printInfo.containsKey("TaskId") && !printInfo["TaskId"].isNull())
-        {
-            newTaskId = printInfo["TaskId"].as<String>();
-        }
+        // Extract TaskId - any change indicates a new print job. Strings are
+        // read in place from messageDoc; only a change is copied.
+        const char *newTaskId = printInfo["TaskId"] | "";
 
-        if (newTaskId != taskId)
+        if (strncmp(newTaskId, taskId, sizeof(taskId) - 1) != 0)
         {
-            if (!newTaskId.isEmpty())
+            if (newTaskId[0] != '\0')
             {
                 newPrintDetected = true;
                 if (printStatus == SDCP_PRINT_STATUS_PRINTING && startedAt == 0)
@@ -565,28 +818,25 @@ void ElegooCC::handleStatus(JsonDocument &doc)
                     // TaskId arrived after PRINTING transition; arm grace period.
                     startedAt = statusTimestamp;
                 }
-                if (settingsManager.getVerboseLogging())
+                if (cachedSettings.verboseLogging)
                 {
-                    logger.logf("New Print detected via TaskId: %s", newTaskId.c_str());
+                    logger.logf("%sNew Print detected via TaskId: %s", logPrefix, newTaskId);
                 }
             }
-            taskId = newTaskId;
+            strlcpy(taskId, newTaskId, sizeof(taskId));
         }
 
-        if (printInfo.containsKey("Filename") && !printInfo["Filename"].isNull())
+        const char *newFilename = printInfo["Filename"] | "";
+        if (newFilename[0] != '\0')
         {
-            String newFilename = printInfo["Filename"].as<String>();
-            if (!newFilename.isEmpty())
-            {
-                filename = newFilename;
-            }
+            strlcpy(filename, newFilename, sizeof(filename));
         }
 
         // Update extrusion tracking (expected/actual/deficit) based on any
         // TotalExtrusion / CurrentExtrusion fields present in this payload.
         processFilamentTelemetry(printInfo, statusTimestamp);
         
-        if (settingsManager.getVerboseLogging())
+        if (cachedSettings.verboseLogging)
         {
             // Only log if meaningful status values have changed
             if ((int)printStatus != lastLoggedPrintStatus ||
@@ -604,19 +854,13 @@ void ElegooCC::handleStatus(JsonDocument &doc)
             }
         }
     }
-
-    // Store mainboard ID if we don't have it yet
-    //if (mainboardID.isEmpty() && !mainboardId.isEmpty())
-    //{
-    //    mainboardID = mainboardId;
-    //   logger.logf("Stored MainboardID: %s", mainboardID.c_str());
-    //}
 }
 
 void ElegooCC::resetFilamentTracking(bool resetGrace)
 {
     unsigned long currentTime = millis();
 
+    lockDetection();
     lastMovementValue          = -1;
     lastChangeTime             = currentTime;
     actualFilamentMM           = 0;
@@ -627,15 +871,36 @@ void ElegooCC::resetFilamentTracking(bool resetGrace)
     filamentStopped            = false;
     lastTelemetryReceiveMs     = 0;
     movementPulseCount         = 0;
+    memset(channelPulseCount, 0, sizeof(channelPulseCount));
+    activeChannel              = 0;
+    estimatorExpectedMm        = 0;
+    estimatorPulseCount        = 0;
+    mmPerPulseEstimator.reset(settingsView.movementMmPerPulse);
+    portENTER_CRITICAL(&cacheLock);
+    cacheMmPerPulse(mmPerPulseEstimator.seedValue());
+    portEXIT_CRITICAL(&cacheLock);
     lastFlowLogMs              = 0;
     trackingFrozen             = false;
+    flowProfileActive          = false;
     resetRunoutPauseState();
+    memset(&jamLatency, 0, sizeof(jamLatency));
+    latencySendMs              = 0;
 
-    // Reset the motion sensor and jam detector
-    motionSensor.reset();
+    // Reset the motion sensor and jam detector. A changed window geometry is
+    // only applied here so it never swaps under a running print.
+    if (motionSensor.select(cachedSettings.motionWindowProfile))
+    {
+        logger.logf("Motion window: %lums buckets, %lums window",
+                    motionSensor->getBucketSizeMs(), motionSensor->getWindowSizeMs());
+    }
+    motionSensor->reset();
+    motionSensor->setPredictive(cachedSettings.predictiveExpected);
     jamDetector.reset(currentTime);
+    cachedJamState = jamDetector.getState();
+    publishDetectionSnapshot();
+    unlockDetection();
 
-    if (settingsManager.getVerboseLogging())
+    if (cachedSettings.verboseLogging)
     {
         logger.log("Filament tracking reset - Mode: Windowed");
     }
@@ -669,25 +934,63 @@ bool ElegooCC::processFilamentTelemetry(JsonObject &printInfo, unsigned long cur
     {
         expectedFilamentMM = totalValue < 0 ? 0 : totalValue;
 
-        // Update the motion sensor with the new expected position
-        motionSensor.updateExpectedPosition(expectedFilamentMM);
+        // An uploaded profile for this print knows the flow of the next
+        // second; looked up before taking the lock since it may read flash
+        bool  profileEngaged = false;
+        bool  hasProfileRate = false;
+        float profileRate    = 0;
+        if (flowProfile.matches(filename))
+        {
+            profileEngaged = !flowProfileActive;
+            hasProfileRate = currentTicks >= 0 &&
+                             flowProfile.rateAt(static_cast<uint32_t>(currentTicks),
+                                                MOTION_PREDICT_HORIZON_MS, profileRate);
+        }
 
+        // Update the motion sensor with the new expected position
+        lockDetection();
+        if (profileEngaged)
+        {
+            // Until the next print reset, regardless of predictive_expected
+            flowProfileActive = true;
+            motionSensor->setPredictive(true);
+        }
+        motionSensor->updateExpectedPosition(expectedFilamentMM);
+        if (hasProfileRate)
+        {
+            motionSensor->setPredictedRate(profileRate);
+        }
+        float windowedExpected = motionSensor->getExpectedDistance();
+        float windowedSensor   = motionSensor->getSensorDistance();
+        float currentDeficit   = motionSensor->getDeficit();
+        unsigned long pulseCount = movementPulseCount;
+        bool  flowHealthy = !cachedJamState.jammed && !cachedJamState.graceActive && !trackingFrozen;
         // Mark telemetry as available and fresh
         expectedTelemetryAvailable = true;
-        lastTelemetryReceiveMs     = currentTime;
+        unlockDetection();
+
+        if (cachedSettings.autoCalibrateSensor)
+        {
+            updateMmPerPulseEstimate(pulseCount, flowHealthy && isPrinting());
+        }
+
+        if (profileEngaged)
+        {
+            logger.logf("Flow profile: expected flow for %s taken from uploaded profile",
+                        filename);
+        }
+
+        lastTelemetryReceiveMs = currentTime;
 
-        if (settingsManager.getVerboseLogging())
+        if (cachedSettings.verboseLogging)
         {
-            float windowedExpected = motionSensor.getExpectedDistance();
-            float windowedSensor = motionSensor.getSensorDistance();
-            float currentDeficit = motionSensor.getDeficit();
 
             // Only log if values have changed
             if (windowedExpected != lastLoggedExpected ||
                 windowedSensor != lastLoggedActual ||
                 currentDeficit != lastLoggedDeficit)
             {
-                JamState jamState = jamDetector.getState();
+                JamState jamState = detectionSnapshot.read().jamState;
                 // Consolidated telemetry log with jam state info
                 logger.logf("Debug: sdcp_exp=%.2fmm cumul_sns=%.2fmm pulses=%lu | win_exp=%.2f win_sns=%.2f deficit=%.2f | jam=%d hard=%.2f soft=%.2f pass=%.2f grace=%d heap=%lu",
                             expectedFilamentMM, actualFilamentMM, movementPulseCount,
@@ -707,12 +1010,43 @@ bool ElegooCC::processFilamentTelemetry(JsonObject &printInfo, unsigned long cur
     return false;
 }
 
+void ElegooCC::updateMmPerPulseEstimate(unsigned long pulseCount, bool healthy)
+{
+    float         expectedDelta = expectedFilamentMM - estimatorExpectedMm;
+    unsigned long pulseDelta    = pulseCount - estimatorPulseCount;
+    estimatorExpectedMm         = expectedFilamentMM;
+    estimatorPulseCount         = pulseCount;
+
+    if (!mmPerPulseEstimator.addSample(expectedDelta, pulseDelta, healthy))
+    {
+        return;
+    }
+
+    // Detection uses the estimate right away; it is persisted at print end
+    float estimate = mmPerPulseEstimator.estimate();
+    portENTER_CRITICAL(&cacheLock);
+    cacheMmPerPulse(estimate);
+    portEXIT_CRITICAL(&cacheLock);
+
+    if (cachedSettings.verboseLogging)
+    {
+        logger.logf("Auto-calibration: segment %lu, mm_per_pulse=%.4f (+-%.2f%%%s)",
+                    mmPerPulseEstimator.segmentCount(), estimate,
+                    mmPerPulseEstimator.standardErrorPercent(),
+                    mmPerPulseEstimator.isConverged() ? ", converged" : "");
+    }
+}
+
 void ElegooCC::pausePrint()
 {
+    lockDetection();
     jamDetector.setPauseRequested();
+    unsigned long onsetMs  = jamDetector.getTripOnsetMs();
+    unsigned long detectMs = jamDetector.getJamDetectedMs();
+    unlockDetection();
     lastPauseRequestMs = millis();
 
-    if (settingsManager.getSuppressPauseCommands())
+    if (settingsView.suppressPauseCommands)
     {
         logger.logf("Pause command suppressed (suppress_pause_commands enabled)");
         return;
@@ -726,10 +1060,62 @@ void ElegooCC::pausePrint()
     if (pauseTriggeredByRunout)
     {
         runoutPauseCommanded = true;
+        markInfoChanged();
     }
 
-    logger.logf("Pause command sent to printer");
+    logger.logf("%sPause command sent to printer", logPrefix);
     sendCommand(SDCP_COMMAND_PAUSE_PRINT, true);
+    if (!pauseTriggeredByRunout && detectMs != 0)
+    {
+        recordJamPauseSent(onsetMs, detectMs);
+    }
+}
+
+void ElegooCC::recordJamPauseSent(unsigned long onsetMs, unsigned long detectMs)
+{
+    unsigned long now = millis();
+    latencyOnsetMs    = onsetMs != 0 ? onsetMs : detectMs;
+    latencyDetectMs   = detectMs;
+    latencySendMs     = now != 0 ? now : 1;
+
+    portENTER_CRITICAL(&_stateMutex);
+    jamLatency.pauseCount++;
+    jamLatency.onsetToDetectMs = detectMs - latencyOnsetMs;
+    jamLatency.detectToSendMs  = now - detectMs;
+    jamLatency.sendToAckMs     = 0;
+    jamLatency.totalMs         = 0;
+    portEXIT_CRITICAL(&_stateMutex);
+    markInfoChanged();
+
+    logger.logf("Jam latency: onset->detect %lums, detect->pause sent %lums",
+                (unsigned long) jamLatency.onsetToDetectMs,
+                (unsigned long) jamLatency.detectToSendMs);
+}
+
+void ElegooCC::recordJamPauseAck()
+{
+    if (latencySendMs == 0)
+    {
+        return;
+    }
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&_stateMutex);
+    jamLatency.ackCount++;
+    jamLatency.sendToAckMs = now - latencySendMs;
+    jamLatency.totalMs     = now - latencyOnsetMs;
+    jamLatency.sumTotalMs += jamLatency.totalMs;
+    if (jamLatency.totalMs > jamLatency.maxTotalMs)
+    {
+        jamLatency.maxTotalMs = jamLatency.totalMs;
+    }
+    portEXIT_CRITICAL(&_stateMutex);
+    latencySendMs = 0;
+    markInfoChanged();
+
+    logger.logf("Jam latency: pause sent->ack %lums, onset->ack %lums (max %lums over %u jams)",
+                (unsigned long) jamLatency.sendToAckMs, (unsigned long) jamLatency.totalMs,
+                (unsigned long) jamLatency.maxTotalMs, (unsigned) jamLatency.ackCount);
 }
 
 void ElegooCC::continuePrint()
@@ -753,42 +1139,41 @@ void ElegooCC::sendCommand(int command, bool waitForAck)
         return;
     }
 
-    uuid.generate();
-    String uuidStr = String(uuid.toCharArray());
-    uuidStr.replace("-", "");  // RequestID doesn't want dashes
+    char requestId[SDCPProtocol::REQUEST_ID_BUFFER_SIZE];
+    SDCPProtocol::generateRequestId(requestId);
 
     // Get current timestamp
     unsigned long timestamp = getTime();
 
-    // Reuse shared message document for outbound SDCP commands
-    messageDoc.clear();
-    if (!SDCPProtocol::buildCommandMessage(messageDoc,
-                                           command,
-                                           uuidStr,
-                                           mainboardID,
-                                           timestamp,
-                                           static_cast<int>(printStatus),
-                                           machineStatusMask))
-    {
-        logger.logf("Failed to build SDCP command %d: JSON document too small", command);
+    // Encode straight into a stack buffer: no JsonDocument, no heap
+    char   payload[SDCPProtocol::COMMAND_BUFFER_SIZE];
+    size_t payloadLength = SDCPProtocol::encodeCommandMessage(payload,
+                                                              sizeof(payload),
+                                                              command,
+                                                              requestId,
+                                                              mainboardID,
+                                                              timestamp,
+                                                              static_cast<int>(printStatus),
+                                                              machineStatusMask);
+    if (payloadLength == 0)
+    {
+        logger.logf("Failed to build SDCP command %d: payload too large", command);
         return;
     }
 
-    String jsonPayload;
-    serializeJson(messageDoc, jsonPayload);
-
     // If this command requires an ack, set the tracking state
     if (waitForAck)
     {
         transport.waitingForAck       = true;
+        markInfoChanged();
         transport.pendingAckCommand   = command;
-        transport.pendingAckRequestId = uuidStr;
+        memcpy(transport.pendingAckRequestId, requestId, sizeof(transport.pendingAckRequestId));
         transport.ackWaitStartTime    = millis();
         logger.logf("Waiting for acknowledgment for command %d with request ID %s", command,
-                    uuidStr.c_str());
+                    requestId);
     }
 
-    transport.webSocket.sendTXT(jsonPayload);
+    transport.webSocket.sendTXT(payload, payloadLength);
     if (command == SDCP_COMMAND_STATUS)
     {
         transport.lastStatusRequestMs = millis();
@@ -797,27 +1182,65 @@ void ElegooCC::sendCommand(int command, bool waitForAck)
 
 void ElegooCC::refreshCaches()
 {
+    // Copy the snapshot first: it has a lock of its own, not to be nested in cacheLock
+    settingsManager.refreshSnapshot(settingsView, settingsViewVersion);
+
     // Use a short critical section so cache refreshes invoked from other tasks stay consistent
     portENTER_CRITICAL(&cacheLock);
     refreshSettingsCache();
     refreshJamConfig();
     portEXIT_CRITICAL(&cacheLock);
+    markInfoChanged();  // Monitoring and runout settings shape the published state
+}
+
+void ElegooCC::refreshAllCaches()
+{
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        getSession(session).refreshCaches();
+    }
 }
 
 void ElegooCC::refreshSettingsCache()
 {
-    cachedSettings.testRecordingMode = settingsManager.getTestRecordingMode();
-    cachedSettings.verboseLogging = settingsManager.getVerboseLogging();
-    cachedSettings.flowSummaryLogging = settingsManager.getFlowSummaryLogging();
-    cachedSettings.pinDebugLogging = settingsManager.getPinDebugLogging();
-    cachedSettings.motionMonitoringEnabled = settingsManager.getEnabled();
-    cachedSettings.pulseReductionPercent = settingsManager.getPulseReductionPercent();
-    cachedSettings.movementMmPerPulse = settingsManager.getMovementMmPerPulse();
+    cachedSettings.testRecordingMode = settingsView.testRecordingMode;
+    cachedSettings.verboseLogging = settingsView.logLevel >= 1;
+    cachedSettings.flowSummaryLogging = settingsView.logLevel >= 1;
+    cachedSettings.pinDebugLogging = settingsView.logLevel >= 2;
+    cachedSettings.motionMonitoringEnabled = settingsView.enabled;
+    // Integer hundredths so the per-pulse filter needs no float math
+    float reductionPercent = settingsView.pulseReductionPercent;
+    cachedSettings.pulseReductionCentiPct =
+        reductionPercent >= 100.0f ? 10000
+        : reductionPercent <= 0.0f ? 0
+                                   : static_cast<uint16_t>(reductionPercent * 100.0f + 0.5f);
+    cachedSettings.autoCalibrateSensor = settingsView.autoCalibrateSensor;
+    // Keep the live estimate unless the setting was changed since it was seeded
+    float mmPerPulse = settingsView.movementMmPerPulse;
+    if (cachedSettings.autoCalibrateSensor && mmPerPulseEstimator.seedValue() == mmPerPulse)
+    {
+        mmPerPulse = mmPerPulseEstimator.estimate();
+    }
+    cacheMmPerPulse(mmPerPulse);
+    cachedSettings.motionWindowProfile =
+        static_cast<MotionWindowProfile>(settingsView.motionWindowProfile);
+    cachedSettings.predictiveExpected = settingsView.predictiveExpected;
+    cachedSettings.statusPollMode =
+        static_cast<StatusPollMode>(settingsView.statusPollMode);
+}
+
+void ElegooCC::cacheMmPerPulse(float mmPerPulse)
+{
+    if (mmPerPulse <= 0.0f)
+    {
+        mmPerPulse = 2.88f;  // Default sensor spec
+    }
+    cachedSettings.movementMmPerPulse = flowFromMm(mmPerPulse);
 }
 
 void ElegooCC::refreshJamConfig()
 {
-    cachedJamConfig = buildJamConfigFromSettings();
+    cachedJamConfig = buildJamConfigFromSettings(settingsView);
 }
 
 void ElegooCC::reconnect()
@@ -828,8 +1251,8 @@ void ElegooCC::reconnect()
     transport.reconnectBackoffMs  = 0;
     transport.consecutiveFailures = 0;
 
-    String configuredIp = settingsManager.getElegooIP();
-    if (configuredIp.length() > 0)
+    char configuredIp[TransportState::ADDRESS_BUFFER_SIZE];
+    if (settingsManager.copyPrinterIP(sessionIndex, configuredIp, sizeof(configuredIp)) > 0)
     {
         connect();
     }
@@ -857,9 +1280,11 @@ void ElegooCC::maybeRequestStatus(unsigned long currentTime)
         }
     }
 
+    StatusPollMode pollMode = cachedSettings.statusPollMode;
     if (jobActive || inPostPrintGrace)
     {
-        interval = STATUS_ACTIVE_INTERVAL_MS;
+        interval = (pollMode == StatusPollMode::FIXED) ? STATUS_ACTIVE_INTERVAL_MS
+                                                       : adaptiveStatusIntervalMs();
         if (jobActive)
         {
             lastPrintEndMs = 0;
@@ -870,24 +1295,88 @@ void ElegooCC::maybeRequestStatus(unsigned long currentTime)
         interval = STATUS_IDLE_INTERVAL_MS;
     }
 
-    if (transport.lastStatusRequestMs == 0 ||
-        currentTime - transport.lastStatusRequestMs >= interval)
+    if (transport.lastStatusRequestMs == 0)
+    {
+        sendCommand(SDCP_COMMAND_STATUS);
+        return;
+    }
+
+    if (pollMode == StatusPollMode::PUSH && (jobActive || inPostPrintGrace))
+    {
+        // Printer pushes status on its own while a job runs; only ask when
+        // nothing (telemetry while printing, any status otherwise) has
+        // arrived for an adaptive interval, and never faster than the fixed rate.
+        unsigned long lastReceiveMs =
+            (printStatus == SDCP_PRINT_STATUS_PRINTING) ? lastTelemetryReceiveMs : lastStatusReceiveMs;
+        bool stale = (lastReceiveMs == 0) || (currentTime - lastReceiveMs >= interval);
+        if (stale && currentTime - transport.lastStatusRequestMs >= STATUS_ACTIVE_INTERVAL_MS)
+        {
+            sendCommand(SDCP_COMMAND_STATUS);
+        }
+        return;
+    }
+
+    if (currentTime - transport.lastStatusRequestMs >= interval)
     {
         sendCommand(SDCP_COMMAND_STATUS);
     }
 }
 
+unsigned long ElegooCC::adaptiveStatusIntervalMs()
+{
+    // Aim for roughly STATUS_ADAPTIVE_MM_PER_POLL of expected extrusion per
+    // status: fast perimeters keep the 250ms rate, travel/low-flow sections
+    // back off. Capped well inside the telemetry-loss timeout so a slow
+    // poll can never look like a lost connection.
+    unsigned long maxInterval = STATUS_ADAPTIVE_MAX_INTERVAL_MS;
+    int           staleMs     = settingsView.flowTelemetryStaleMs;
+    if (staleMs > 0 && (unsigned long) staleMs / 2 < maxInterval)
+    {
+        maxInterval = (unsigned long) staleMs / 2;
+    }
+    if (maxInterval < STATUS_ACTIVE_INTERVAL_MS)
+    {
+        return STATUS_ACTIVE_INTERVAL_MS;
+    }
+
+    float windowSec = motionSensor->getWindowSizeMs() / 1000.0f;
+    float rateMmPerSec =
+        (windowSec > 0.0f) ? detectionSnapshot.read().expectedDistanceMm / windowSec : 0.0f;
+    if (rateMmPerSec <= 0.0f)
+    {
+        return maxInterval;
+    }
+
+    float intervalMs = STATUS_ADAPTIVE_MM_PER_POLL / rateMmPerSec * 1000.0f;
+    if (intervalMs <= (float) STATUS_ACTIVE_INTERVAL_MS)
+    {
+        return STATUS_ACTIVE_INTERVAL_MS;
+    }
+    if (intervalMs >= (float) maxInterval)
+    {
+        return maxInterval;
+    }
+    return (unsigned long) intervalMs;
+}
+
 void ElegooCC::connect()
 {
-    transport.ipAddress = settingsManager.getElegooIP();
+    settingsManager.copyPrinterIP(sessionIndex, transport.ipAddress, sizeof(transport.ipAddress));
 
     // Don't attempt connection if IP is empty or default placeholder
-    if (transport.ipAddress.length() == 0 || transport.ipAddress == "1.1.1.1")
+    if (!isUsableAddress(transport.ipAddress))
     {
         transport.connectionStartMs = 0;
         return;
     }
 
+    // Another session is mid-handshake; updateTransport() retries once it is done
+    if (connectingSession >= 0 && connectingSession != sessionIndex)
+    {
+        return;
+    }
+    connectingSession = sessionIndex;
+
     if (transport.webSocket.isConnected())
     {
         transport.webSocket.disconnect();
@@ -895,25 +1384,32 @@ void ElegooCC::connect()
 
     // Track this connection attempt for reconnection logic
     transport.lastReconnectAttemptMs = millis();
-    transport.lastAttemptedIp        = transport.ipAddress;
+    memcpy(transport.lastAttemptedIp, transport.ipAddress, sizeof(transport.lastAttemptedIp));
+
+    // First retry after a drop gets a short handshake deadline; failures back off
+    transport.connectTimeoutMs = transport.fastReconnect ? SDCPTiming::FAST_RECONNECT_TIMEOUT_MS
+                                                         : SDCPTiming::CONNECT_TIMEOUT_MS;
+    transport.fastReconnect    = false;
 
     transport.webSocket.setReconnectInterval(3000);
-    logger.logf("Attempting connection to Elegoo CC @ %s", transport.ipAddress.c_str());
+    // Pong timeouts are judged here (HEARTBEAT_DEADLINE_MS), not by the library:
+    // a printer that never answers pings must not be dropped every few seconds
+    transport.webSocket.enableHeartbeat(SDCPTiming::HEARTBEAT_INTERVAL_MS,
+                                        SDCPTiming::HEARTBEAT_PONG_TIMEOUT_MS, 0);
+    logger.logf("%sAttempting connection to Elegoo CC @ %s", logPrefix, transport.ipAddress);
     transport.connectionStartMs = millis();
     transport.webSocket.begin(transport.ipAddress, CARBON_CENTAURI_PORT, "/websocket");
 }
 
 void ElegooCC::updateTransport(unsigned long currentTime)
 {
-    // Suspend WebSocket during discovery to prevent stalling the loop
-    if (transport.blocked || discoveryState.active)
-    {
-        return;
-    }
-
     // Skip WebSocket operations if no IP is configured or using default placeholder
-    if (transport.ipAddress.length() == 0 || transport.ipAddress == "1.1.1.1")
+    if (!isUsableAddress(transport.ipAddress))
     {
+        if (connectingSession == sessionIndex)
+        {
+            connectingSession = -1;
+        }
         return;
     }
 
@@ -921,22 +1417,40 @@ void ElegooCC::updateTransport(unsigned long currentTime)
     {
         // CONNECTED: Clear connection tracking and reset backoff on successful reconnection
         transport.connectionStartMs = 0;
+        if (connectingSession == sessionIndex)
+        {
+            connectingSession = -1;
+        }
         if (transport.consecutiveFailures > 0)
         {
-            logger.logf("Reconnected after %d failed attempts", transport.consecutiveFailures);
+            logger.logf("%sReconnected after %d failed attempts", logPrefix,
+                        transport.consecutiveFailures);
             transport.consecutiveFailures = 0;
             transport.reconnectBackoffMs  = 5000;  // Reset backoff to initial value
         }
 
+        // Half-open socket or hung printer: stop waiting for SDCP loss detection
+        if (transport.pongSeen &&
+            (millis() - transport.lastRxMs) >= SDCPTiming::HEARTBEAT_DEADLINE_MS)
+        {
+            logger.logf("%sNo data or pong from printer for %lums, dropping link", logPrefix,
+                        millis() - transport.lastRxMs);
+            transport.link.deadLinks++;
+            markInfoChanged();
+            transport.webSocket.disconnect();
+            return;
+        }
+
         if (transport.waitingForAck &&
             (currentTime - transport.ackWaitStartTime) >= ACK_TIMEOUT_MS)
         {
-            logger.logf("Acknowledgment timeout for command %d, resetting ack state",
+            logger.logf("%sAcknowledgment timeout for command %d, resetting ack state", logPrefix,
                         transport.pendingAckCommand);
             transport.waitingForAck       = false;
             transport.pendingAckCommand   = -1;
-            transport.pendingAckRequestId = "";
+            transport.pendingAckRequestId[0] = '\0';
             transport.ackWaitStartTime    = 0;
+            markInfoChanged();
         }
         else if (currentTime - transport.lastPing > 29900)
         {
@@ -951,20 +1465,28 @@ void ElegooCC::updateTransport(unsigned long currentTime)
     {
         // DISCONNECTED: Active reconnection with exponential backoff
 
+        // Connect attempts block the loop in the TCP connect; a scan would
+        // miss responses meanwhile, so they wait until it ends
+        if (isDiscoveryActive())
+        {
+            return;
+        }
+
         // Check if IP has changed (settings update) - trigger immediate reconnection
-        String currentIp = settingsManager.getElegooIP();
-        if (currentIp != transport.lastAttemptedIp && currentIp.length() > 0 &&
-            currentIp != "1.1.1.1")
+        char currentIp[TransportState::ADDRESS_BUFFER_SIZE];
+        settingsManager.copyPrinterIP(sessionIndex, currentIp, sizeof(currentIp));
+        if (strcmp(currentIp, transport.lastAttemptedIp) != 0 && isUsableAddress(currentIp))
         {
-            logger.logf("Printer IP changed from %s to %s, reconnecting immediately",
-                        transport.lastAttemptedIp.c_str(), currentIp.c_str());
+            logger.logf("%sPrinter IP changed from %s to %s, reconnecting immediately", logPrefix,
+                        transport.lastAttemptedIp, currentIp);
             transport.reconnectBackoffMs  = 0;  // Allow immediate retry
             transport.consecutiveFailures = 0;
         }
 
-        // Check if a connection attempt is in progress (first 10 seconds after connect())
-        bool connectionInProgress = (transport.connectionStartMs != 0) &&
-                                    ((currentTime - transport.connectionStartMs) < 10000);
+        // Check if a connection attempt is in progress (handshake deadline after connect())
+        bool connectionInProgress =
+            (transport.connectionStartMs != 0) &&
+            ((currentTime - transport.connectionStartMs) < transport.connectTimeoutMs);
 
         if (connectionInProgress)
         {
@@ -979,22 +1501,35 @@ void ElegooCC::updateTransport(unsigned long currentTime)
                 // Previous connection attempt timed out
                 transport.connectionStartMs = 0;
                 transport.consecutiveFailures++;
+                if (connectingSession == sessionIndex)
+                {
+                    connectingSession = -1;
+                }
 
                 // Exponential backoff: 5s, 10s, 20s, 40s, 60s max
                 unsigned long backoff =
                     5000UL * (1UL << min(transport.consecutiveFailures - 1, 4));
                 transport.reconnectBackoffMs = min(backoff, 60000UL);
 
-                logger.logf("Connection attempt timed out (failure #%d), next retry in %lus",
-                            transport.consecutiveFailures, transport.reconnectBackoffMs / 1000);
+                logger.logf("%sConnection attempt timed out (failure #%d), next retry in %lus",
+                            logPrefix, transport.consecutiveFailures, transport.reconnectBackoffMs / 1000);
             }
 
             // Check if backoff has expired - time for a new connection attempt
-            if ((currentTime - transport.lastReconnectAttemptMs) >= transport.reconnectBackoffMs)
+            // (waits while another session holds the connect slot)
+            bool slotFree = connectingSession < 0 || connectingSession == sessionIndex;
+            if (slotFree &&
+                (transport.fastReconnect ||
+                 (currentTime - transport.lastReconnectAttemptMs) >= transport.reconnectBackoffMs))
             {
-                if (transport.consecutiveFailures > 0)
+                if (transport.fastReconnect)
+                {
+                    logger.logf("%sSDCP link lost, reconnecting to %s immediately", logPrefix,
+                                transport.lastAttemptedIp);
+                }
+                else if (transport.consecutiveFailures > 0)
                 {
-                    logger.logf("Initiating reconnection attempt #%d",
+                    logger.logf("%sInitiating reconnection attempt #%d", logPrefix,
                                 transport.consecutiveFailures + 1);
                 }
                 connect();  // This sets connectionStartMs and calls webSocket.begin()
@@ -1004,24 +1539,67 @@ void ElegooCC::updateTransport(unsigned long currentTime)
     }
 }
 
-void ElegooCC::loop()
+void ElegooCC::loopSessions()
 {
     unsigned long currentTime = millis();
 
-    updateTransport(currentTime);
-    currentTime = millis();
+    // ============================================================================
+    // LOOP TIMING DIAGNOSTIC
+    // Monitor main loop performance - log warning if loop stalls exceed 50ms.
+    // This helps detect WiFi/WebSocket/JSON processing that delays SDCP handling.
+    // ============================================================================
+    static unsigned long lastLoopTime = 0;
 
-    if (transport.blocked || discoveryState.active)
+    if (lastLoopTime > 0)
     {
-        updateDiscovery(currentTime);
-        return;
+        unsigned long loopDelta = currentTime - lastLoopTime;
+        if (loopDelta > 50 && getSession(0).cachedSettings.verboseLogging)
+        {
+            static unsigned long lastLoopWarningMs = 0;
+            if ((currentTime - lastLoopWarningMs) >= 5000)  // Log max once per 5 seconds
+            {
+                lastLoopWarningMs = currentTime;
+                logger.logf("LOOP_STALL: Main loop took %lums", loopDelta);
+            }
+        }
+    }
+    lastLoopTime = currentTime;
+
+    static uint8_t nextSession = 0;
+    for (uint8_t served = 0; served < PRINTER_SESSIONS; served++)
+    {
+        getSession(nextSession).loop();
+        nextSession = (nextSession + 1) % PRINTER_SESSIONS;
+        if (millis() - currentTime >= SESSION_PASS_BUDGET_MS)
+        {
+            break;
+        }
+    }
+
+    updateDiscovery(millis());
+}
+
+void ElegooCC::loop()
+{
+    // Pick up a settings commit (one version check while nothing changed)
+    if (settingsManager.getRevision() != settingsViewVersion)
+    {
+        refreshCaches();
     }
 
+    unsigned long currentTime = millis();
+
+    updateTransport(currentTime);
+    currentTime = millis();
+
     // Check filament sensors before determining if we should pause
-    // NOTE: checkFilamentRunout must run FIRST to update filamentRunout flag
-    // before checkFilamentMovement uses it to decide whether to run jam detection
+    // NOTE: checkFilamentRunout runs before checkFilamentMovement (or the
+    // detection task's next cycle) so the filamentRunout flag is current
+    // when it decides whether to run jam detection
     checkFilamentRunout(currentTime);
+#if !ENABLE_DETECTION_TASK
     checkFilamentMovement(currentTime);
+#endif
 
     // Check if we should pause the print
     if (shouldPausePrint(currentTime))
@@ -1031,33 +1609,143 @@ void ElegooCC::loop()
     }
 
     maybeRequestStatus(currentTime);
-    updateDiscovery(currentTime);
+    publishCurrentInformation();
 }
 
-bool ElegooCC::shouldApplyPulseReduction(float reductionPercent)
+unsigned long ElegooCC::applyPulseReduction(unsigned long pulses)
 {
-    static float accumulator = 0.0f;
+    uint16_t reductionCentiPct = cachedSettings.pulseReductionCentiPct;
 
     // 100% or higher: count all pulses (normal operation)
-    if (reductionPercent >= 100.0f) {
-        accumulator = 0.0f;  // Reset accumulator for consistency
-        return true;
+    if (reductionCentiPct >= 10000) {
+        pulseReductionAccumulator = 0;  // Reset accumulator for consistency
+        return pulses;
     }
 
     // 0% or lower: count no pulses (simulate complete blockage)
-    if (reductionPercent <= 0.0f) {
-        accumulator = 0.0f;  // Reset accumulator for consistency
-        return false;
+    if (reductionCentiPct == 0) {
+        pulseReductionAccumulator = 0;  // Reset accumulator for consistency
+        return 0;
+    }
+
+    // Fractional counting in closed form: stepping the accumulator by
+    // reductionCentiPct once per pulse and counting each wrap past 10000
+    // keeps the same pulses as this single division
+    uint64_t total = pulseReductionAccumulator + (uint64_t) pulses * reductionCentiPct;
+    pulseReductionAccumulator = (uint16_t) (total % 10000);
+    return (unsigned long) (total / 10000);
+}
+
+unsigned long ElegooCC::addPulseRun(uint8_t channel, unsigned long pulses, flow_mm_t movementMm,
+                                    unsigned long pulseMs)
+{
+    // Caller holds the detection lock
+    if (pulses == 0)
+    {
+        return 0;
     }
 
-    // Accumulator-based logic for fractional pulse counting
-    accumulator += reductionPercent;
-    if (accumulator >= 100.0f) {
-        accumulator -= 100.0f;
-        return true;  // Count this pulse
+    // Apply pulse reduction filter for testing
+    unsigned long kept = applyPulseReduction(pulses);
+    if (kept == 0)
+    {
+        return 0;
+    }
+
+    // Add pulses to motion sensor (Klipper-style)
+    motionSensor->addChannelPulses(channel, kept, movementMm, pulseMs);
+    actualFilamentMM += flowToMm(movementMm * (flow_mm_t) kept);
+    movementPulseCount += kept;
+    channelPulseCount[channel] += kept;
+    return kept;
+}
+
+unsigned long ElegooCC::drainChannelPulses(uint8_t channel, unsigned long newPulses, flow_mm_t movementMm,
+                                           unsigned long currentTime)
+{
+    // Caller holds the detection lock.
+    // Pulses are binned by arrival time so a loop stall does not smear
+    // them into the current bucket. Pulses without an ISR timestamp (PCNT,
+    // or timestamp ring overflow) are spread evenly between the last known
+    // pulse time and now. Consecutive pulses landing in the same bucket go
+    // to the sensor as one batch, so a drain costs O(buckets touched).
+    unsigned long anchorMs = lastPulseDrainMs;
+    if (anchorMs == 0 || anchorMs > currentTime)
+    {
+        anchorMs = currentTime;
+    }
+    unsigned long bucketMs      = motionSensor->getBucketSizeMs();
+    unsigned long runCount      = 0;
+    unsigned long runMs         = 0;
+    unsigned long stamped       = 0;
+    unsigned long countedPulses = 0;
+
+    // Timestamped pulses first (ISR ring), coalesced per bucket
+    unsigned long pulseMs;
+    while (stamped < newPulses && pulseCounter.popPulseTime(pulseMs, pulseChannelBase + channel))
+    {
+        if (runCount > 0 && pulseMs / bucketMs != runMs / bucketMs)
+        {
+            countedPulses += addPulseRun(channel, runCount, movementMm, runMs);
+            runCount = 0;
+        }
+        runMs    = pulseMs;
+        anchorMs = pulseMs;
+        runCount++;
+        stamped++;
+    }
+    countedPulses += addPulseRun(channel, runCount, movementMm, runMs);
+    if (anchorMs > currentTime)
+    {
+        anchorMs = currentTime;
     }
 
-    return false; // Skip this pulse
+    // The rest land at anchor + span * k / unstamped (k = 1..unstamped);
+    // each bucket's share is found in closed form
+    unsigned long unstamped = newPulses - stamped;
+    unsigned long span      = currentTime - anchorMs;
+    unsigned long done      = 0;
+    while (done < unstamped)
+    {
+        unsigned long nextMs = anchorMs + (span * (done + 1)) / unstamped;
+        unsigned long last   = unstamped;
+        if (span > 0)
+        {
+            // Last k whose time is still before the next bucket starts
+            unsigned long untilBucketEnd = (nextMs / bucketMs + 1) * bucketMs - anchorMs;
+            last = (untilBucketEnd * unstamped - 1) / span;
+            if (last > unstamped)
+            {
+                last = unstamped;
+            }
+        }
+        countedPulses += addPulseRun(channel, last - done, movementMm,
+                                     anchorMs + (span * last) / unstamped);
+        done = last;
+    }
+    return countedPulses;
+}
+
+void ElegooCC::selectActiveChannel(const MotionWindowTotals &totals)
+{
+    // Caller holds the detection lock. The active channel stays put while
+    // nothing moves (a jam on it must stay visible); another path takes
+    // over once its window leads by MOTION_CHANNEL_SWITCH_MM, as on a
+    // filament change.
+    uint8_t leader = activeChannel;
+    for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+    {
+        if (totals.actualMm[channel] > totals.actualMm[leader])
+        {
+            leader = channel;
+        }
+    }
+    if (leader != activeChannel &&
+        totals.actualMm[leader] >= totals.actualMm[activeChannel] + MOTION_CHANNEL_SWITCH_MM)
+    {
+        logger.logDeferred(LOG_NORMAL, "Motion channel %u -> %u", activeChannel, leader);
+        activeChannel = leader;
+    }
 }
 
 void ElegooCC::resetRunoutPauseState()
@@ -1077,7 +1765,7 @@ void ElegooCC::updateRunoutPauseCountdown()
         return;
     }
 
-    if (!settingsManager.getPauseOnRunout())
+    if (!settingsView.pauseOnRunout)
     {
         runoutPausePending     = false;
         runoutPauseRemainingMm = 0.0f;
@@ -1111,7 +1799,7 @@ void ElegooCC::updateRunoutPauseCountdown()
 
 bool ElegooCC::isRunoutPauseReady() const
 {
-    return filamentRunout && settingsManager.getPauseOnRunout() && runoutPausePending &&
+    return filamentRunout && settingsView.pauseOnRunout && runoutPausePending &&
            runoutPauseRemainingMm <= 0.0f;
 }
 
@@ -1119,7 +1807,11 @@ void ElegooCC::checkFilamentRunout(unsigned long currentTime)
 {
     // The signal output of the switch sensor is at low level when no filament is detected
     // Some boards/sensors may need inverted logic
-    int pinValue = digitalRead(FILAMENT_RUNOUT_PIN);
+    if (runoutPin < 0)
+    {
+        return;  // No runout switch on this printer
+    }
+    int pinValue = digitalRead(runoutPin);
 #ifdef INVERT_RUNOUT_PIN
     pinValue = !pinValue;  // Invert the logic if flag is set
 #endif
@@ -1127,49 +1819,33 @@ void ElegooCC::checkFilamentRunout(unsigned long currentTime)
 
     if (newFilamentRunout != filamentRunout)
     {
-        logger.log(newFilamentRunout ? "Filament has run out" : "Filament has been detected");
+        logger.logf("%s%s", logPrefix,
+                    newFilamentRunout ? "Filament has run out" : "Filament has been detected");
         if (!newFilamentRunout)
         {
             resetRunoutPauseState();
         }
+        // Read by the detection task to disarm jam detection
+        lockDetection();
+        filamentRunout = newFilamentRunout;
+        unlockDetection();
+        markInfoChanged();
     }
-    filamentRunout = newFilamentRunout;
     updateRunoutPauseCountdown();
 }
 
 void ElegooCC::checkFilamentMovement(unsigned long currentTime)
 {
-    // ============================================================================
-    // LOOP TIMING DIAGNOSTIC
-    // Monitor main loop performance - log warning if loop stalls exceed 50ms
-    // This helps detect WiFi/WebSocket/JSON processing that could miss pulses.
-    // ============================================================================
-    static unsigned long lastLoopTime = 0;
-    static bool wasInDiscovery = false;
-
-    // Reset lastLoopTime after discovery to avoid false stall warnings
-    // (discovery blocks the main loop for 7-14 seconds which is expected)
-    if (wasInDiscovery)
-    {
-        lastLoopTime = currentTime;
-        wasInDiscovery = false;
-    }
-    wasInDiscovery = discoveryState.active;
+    // Runs in the detection task. Print status is written by loop() under
+    // _stateMutex; trackingFrozen, filamentRunout, expectedTelemetryAvailable
+    // and the movement/stopped fields below are shared with loop() under the
+    // detection lock, which is held from here until the snapshot is published.
+    portENTER_CRITICAL(&_stateMutex);
+    bool currentlyPrinting = isPrinting();
+    bool shouldCountPulses = isPrintJobActive();
+    portEXIT_CRITICAL(&_stateMutex);
 
-    if (lastLoopTime > 0)
-    {
-        unsigned long loopDelta = currentTime - lastLoopTime;
-        if (loopDelta > 50 && cachedSettings.verboseLogging)
-        {
-            static unsigned long lastLoopWarningMs = 0;
-            if ((currentTime - lastLoopWarningMs) >= 5000)  // Log max once per 5 seconds
-            {
-                lastLoopWarningMs = currentTime;
-                logger.logf("LOOP_STALL: Main loop took %lums (>50ms may miss pulses)", loopDelta);
-            }
-        }
-    }
-    lastLoopTime = currentTime;
+    lockDetection();
 
     // ============================================================================
     // TRACKING FROZEN STATE
@@ -1178,28 +1854,37 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
     // ============================================================================
     if (trackingFrozen)
     {
-        // Sync ISR counter to discard pulses accumulated while frozen
-        lastIsrPulseCount = ElegooCC::isrPulseCounter;
+        // Sync pulse counters to discard pulses accumulated while frozen
+        for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+        {
+            lastIsrPulseCount[channel] = pulseCounter.read(pulseChannelBase + channel);
+            pulseCounter.discardPulseTimes(pulseChannelBase + channel);
+        }
+        lastPulseDrainMs = currentTime;
 
         // When tracking is frozen (printer paused after a jam), just track pin changes
-        int currentMovementValue = digitalRead(MOVEMENT_SENSOR_PIN);
+        int movementPin = kMovementSensorPins[pulseChannelBase];
+        if (movementPin >= 0)
+        {
+            int currentMovementValue = digitalRead(movementPin);
 #ifdef INVERT_MOVEMENT_PIN
-        currentMovementValue = !currentMovementValue;  // Invert the logic if flag is set
+            currentMovementValue = !currentMovementValue;  // Invert the logic if flag is set
 #endif
-        if (currentMovementValue != lastMovementValue)
-        {
-            lastMovementValue = currentMovementValue;
-            lastChangeTime    = currentTime;
+            if (currentMovementValue != lastMovementValue)
+            {
+                lastMovementValue = currentMovementValue;
+                lastChangeTime    = currentTime;
+            }
         }
+        unlockDetection();
         return;
     }
 
     // Test recording mode enables verbose flow logging for CSV extraction
-    // Use cached settings to avoid repeated getter calls in hot path (~1000 Hz)
+    // Use cached settings to avoid repeated getter calls in hot path
     bool testRecordingMode = cachedSettings.testRecordingMode;
     bool debugFlow         = cachedSettings.verboseLogging || testRecordingMode;
     bool summaryFlow       = cachedSettings.flowSummaryLogging;
-    bool currentlyPrinting = isPrinting();
 
     // ============================================================================
     // PULSE COUNTING POLICY (with INTERRUPT-DRIVEN DETECTION)
@@ -1212,67 +1897,47 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
     //
     // The trackingFrozen gate (handled above) stops counting during jam-paused state.
     // ============================================================================
-    bool shouldCountPulses = isPrintJobActive();
 
     // ============================================================================
-    // READ ACCUMULATED PULSES FROM ISR COUNTER
+    // READ ACCUMULATED PULSES FROM PULSE COUNTER (PCNT or ISR), EVERY CHANNEL
     // ============================================================================
-    unsigned long currentPulseCount = ElegooCC::isrPulseCounter;
-    unsigned long newPulses = currentPulseCount - lastIsrPulseCount;
-    lastIsrPulseCount = currentPulseCount;
+    unsigned long newPulses[MOTION_SENSOR_CHANNELS];
+    bool          anyNewPulses = false;
+    for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+    {
+        unsigned long currentPulseCount = pulseCounter.read(pulseChannelBase + channel);
+        newPulses[channel]              = currentPulseCount - lastIsrPulseCount[channel];
+        lastIsrPulseCount[channel]      = currentPulseCount;
+        anyNewPulses                    = anyNewPulses || newPulses[channel] > 0;
+    }
+    unsigned long countedPulses = 0;
 
     // Process accumulated pulses
-    if (newPulses > 0 && shouldCountPulses)
+    if (anyNewPulses && shouldCountPulses)
     {
-        float movementMm = cachedSettings.movementMmPerPulse;
-        if (movementMm <= 0.0f)
-        {
-            movementMm = 2.88f;  // Default sensor spec
-        }
+        flow_mm_t movementMm = cachedSettings.movementMmPerPulse;
 
-        // Process each pulse through reduction filter (for test recording mode)
-        for (unsigned long i = 0; i < newPulses; i++)
+        for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
         {
-            // Apply pulse reduction filter for testing
-            // Use cached settings to avoid repeated getter calls in hot path
-            float reductionPercent = cachedSettings.pulseReductionPercent;
-            if (!shouldApplyPulseReduction(reductionPercent))
-            {
-                // Skip this pulse due to reduction setting (test feature)
-                continue;
-            }
-
-            // Add pulse to motion sensor (Klipper-style)
-            motionSensor.addSensorPulse(movementMm);
-            actualFilamentMM += movementMm;
-            movementPulseCount++;
-
-            // Pin debug logging for pulse detection
-            if (settingsManager.getPinDebugLogging())
+            if (newPulses[channel] > 0)
             {
-                logger.log("pulse");
+                countedPulses += drainChannelPulses(channel, newPulses[channel], movementMm, currentTime);
             }
         }
 
         lastChangeTime = currentTime;
     }
-
-    // Pin debug logging (once per second) - BEFORE early return so it always runs
-    // Shows RAW pin values (before any inversion)
-    // Use cached settings to avoid repeated getter calls
-    //bool pinDebug = cachedSettings.pinDebugLogging;
-    //if (pinDebug && (currentTime - lastPinDebugLogMs) >= 1000)
-    //{
-    //    lastPinDebugLogMs = currentTime;
-    //    int runoutPinValue = digitalRead(FILAMENT_RUNOUT_PIN);
-    //    int movementPinValue = digitalRead(MOVEMENT_SENSOR_PIN);
-    //    logger.logf("PIN: R%d=%d M%d=%d p=%lu",
-    //                FILAMENT_RUNOUT_PIN, runoutPinValue,
-    //                MOVEMENT_SENSOR_PIN, movementPinValue,
-    //                movementPulseCount);
-    //}
+    else if (anyNewPulses)
+    {
+        for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+        {
+            pulseCounter.discardPulseTimes(pulseChannelBase + channel);
+        }
+    }
+    lastPulseDrainMs = currentTime;
 
     // Only run jam detection when actively printing with valid telemetry
+    bool detectionArmed = true;
     if (!shouldCountPulses || !expectedTelemetryAvailable)
     {
         // Reset jam state when not printing to clear any stale detection
@@ -1280,39 +1945,54 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
         {
             filamentStopped = false;
         }
-        return;
+        detectionArmed = false;
     }
-
-    if (!cachedSettings.motionMonitoringEnabled)
+    else if (!cachedSettings.motionMonitoringEnabled)
     {
         filamentStopped = false;
-        return;
+        detectionArmed  = false;
     }
-
     // Disarm jam detection when filament has run out.
     // If we are in a runout state, we expect no flow.
     // Even if 'pause_on_runout' is disabled (meaning the user wants to ignore the runout sensor),
     // we must also suppress jam detection, otherwise the lack of flow will trigger a "Jam" pause,
     // which defeats the user's intent to not pause.
-    if (filamentRunout)
+    else if (filamentRunout)
     {
         filamentStopped = false;
+        detectionArmed  = false;
+    }
+
+    if (!detectionArmed)
+    {
+        if (countedPulses > 0)
+        {
+            publishDetectionSnapshot();
+        }
+        unlockDetection();
+        logPinDebugPulses(countedPulses);
         return;
     }
 
     // Use cached jam config instead of rebuilding
     const JamConfig& jamConfig = cachedJamConfig;
 
-    // Get windowed distances from motion sensor
-    float expectedDistance = motionSensor.getExpectedDistance();
-    float actualDistance = motionSensor.getSensorDistance();
-    float windowedExpectedRate = 0.0f;
-    float windowedActualRate = 0.0f;
-    motionSensor.getWindowedRates(windowedExpectedRate, windowedActualRate);
+    // Windowed distances and rates for every channel in one window update;
+    // detection follows the channel that is feeding
+    MotionWindowTotals totals;
+    motionSensor->getWindowTotals(totals);
+    selectActiveChannel(totals);
+    float expectedDistance     = totals.expectedMm;
+    float actualDistance       = totals.actualMm[activeChannel];
+    float windowedExpectedRate = totals.expectedRate;
+    float windowedActualRate   = totals.actualRate[activeChannel];
 
     // Update jam detector and get current state
-    // Throttle jamDetector.update() to 4Hz
-    if ((currentTime - lastJamDetectorUpdateMs) >= JAM_DETECTOR_UPDATE_INTERVAL_MS)
+    // Throttle jamDetector.update() to 4Hz (10Hz when the expected side is
+    // extrapolated, so it moves between telemetry samples)
+    unsigned long jamIntervalMs = motionSensor->isPredictive() ? JAM_DETECTOR_PREDICTIVE_INTERVAL_MS
+                                                               : JAM_DETECTOR_UPDATE_INTERVAL_MS;
+    if ((currentTime - lastJamDetectorUpdateMs) >= jamIntervalMs)
     {
         lastJamDetectorUpdateMs = currentTime;
         
@@ -1323,16 +2003,33 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
             currentTime, startedAt, jamConfig,
             windowedExpectedRate, windowedActualRate
         );
-        
+        if (currentlyPrinting)
+        {
+            flowHistory.record(currentTime, cachedJamState.expectedRateMmPerSec,
+                               cachedJamState.actualRateMmPerSec, cachedJamState.passRatio,
+                               cachedJamState.hardJamPercent, cachedJamState.softJamPercent,
+                               cachedJamState.jammed, cachedJamState.graceActive);
+        }
+
         // Update filament stopped state (unless latched by pause/tracking freeze)
         if (!jamDetector.isPauseRequested() && !trackingFrozen)
         {
+            // A new jam should reach shouldPausePrint() now, not on the next poll
+            if (cachedJamState.jammed && !filamentStopped)
+            {
+                mainLoopWake.notify();
+            }
             filamentStopped = cachedJamState.jammed;
         }
     }
-    
+
     // Use cached state for logging
-    JamState jamState = cachedJamState;
+    JamState      jamState          = cachedJamState;
+    unsigned long pulseCountForLog  = movementPulseCount;
+    float         actualMmForLog    = actualFilamentMM;
+    publishDetectionSnapshot();
+    unlockDetection();
+    logPinDebugPulses(countedPulses);
 
     // Periodic consolidated logging with all telemetry data + memory monitoring
     if (debugFlow && currentlyPrinting && (currentTime - lastFlowLogMs) >= EXPECTED_FILAMENT_SAMPLE_MS)
@@ -1340,9 +2037,10 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
         lastFlowLogMs = currentTime;
         uint32_t freeHeap = ESP.getFreeHeap();
 
-        logger.logf(
+        logger.logDeferred(
+            LOG_NORMAL,
             "Debug: sdcp_exp=%.2fmm cumul_sns=%.2fmm pulses=%lu | win_exp=%.2f win_sns=%.2f deficit=%.2f | jam=%d hard=%.2f soft=%.2f pass=%.2f grace=%d heap=%lu",
-            expectedFilamentMM, actualFilamentMM, movementPulseCount,
+            expectedFilamentMM, actualMmForLog, pulseCountForLog,
             expectedDistance, actualDistance, jamState.deficit,
             jamState.jammed ? 1 : 0,
             jamState.hardJamPercent, jamState.softJamPercent, jamState.passRatio,
@@ -1352,29 +2050,168 @@ void ElegooCC::checkFilamentMovement(unsigned long currentTime)
     if (summaryFlow && currentlyPrinting && !debugFlow && (currentTime - lastSummaryLogMs) >= 1000)
     {
         lastSummaryLogMs = currentTime;
-        logger.logf("Debug summary: expected=%.2fmm sensor=%.2fmm deficit=%.2fmm "
-                    "ratio=%.2f hard=%.2f%% soft=%.2f%% pass=%.2f pulses=%lu",
-                    expectedDistance, actualDistance, jamState.deficit,
-                    jamState.deficit / (expectedDistance > 0.1f ? expectedDistance : 1.0f),
-                    jamState.hardJamPercent, jamState.softJamPercent, jamState.passRatio,
-                    movementPulseCount);
+        logger.logDeferred(LOG_NORMAL,
+                           "Debug summary: expected=%.2fmm sensor=%.2fmm deficit=%.2fmm "
+                           "ratio=%.2f hard=%.2f%% soft=%.2f%% pass=%.2f pulses=%lu",
+                           expectedDistance, actualDistance, jamState.deficit,
+                           jamState.deficit / (expectedDistance > 0.1f ? expectedDistance : 1.0f),
+                           jamState.hardJamPercent, jamState.softJamPercent, jamState.passRatio,
+                           pulseCountForLog);
+    }
+}
+
+void ElegooCC::logPinDebugPulses(unsigned long countedPulses)
+{
+    // Pin debug logging for pulse detection (outside the detection lock)
+    if (cachedSettings.pinDebugLogging)
+    {
+        for (unsigned long i = 0; i < countedPulses; i++)
+        {
+            logger.log("pulse");
+        }
     }
 }
 
+// ============================================================================
+// DETECTION TASK
+// Drains pulses and runs jam detection at a fixed cadence, independent of
+// SDCP/web/display work in loop(). Pinned to the application core on dual-core
+// chips so WiFi interrupt load on the protocol core cannot delay it.
+// ============================================================================
+void ElegooCC::lockDetection()
+{
+    xSemaphoreTake(detectionLock, portMAX_DELAY);
+}
+
+void ElegooCC::unlockDetection()
+{
+    xSemaphoreGive(detectionLock);
+}
+
+void ElegooCC::writeFlowHistory(Print &out)
+{
+    // Encode from a copy: writing to the response grows its buffer on the
+    // heap, which the detection task must not wait behind. Copying the sample
+    // tiers under the lock is a plain memcpy of a few KB.
+    FlowHistory *copy = new (std::nothrow) FlowHistory();
+    if (copy == nullptr)
+    {
+        logger.log("Flow history copy allocation failed");
+        return;
+    }
+
+    lockDetection();
+    *copy                = flowHistory;
+    unsigned long copyMs = millis();
+    unlockDetection();
+
+    copy->encode(out, copyMs);
+    delete copy;
+}
+
+void ElegooCC::publishDetectionSnapshot()
+{
+    MotionWindowTotals totals;
+    motionSensor->getWindowTotals(totals);
+
+    detection_snapshot_t snapshot;
+    snapshot.jamState           = cachedJamState;
+    snapshot.expectedDistanceMm = totals.expectedMm;
+    snapshot.actualDistanceMm   = totals.actualMm[activeChannel];
+    snapshot.actualFilamentMM   = actualFilamentMM;
+    snapshot.movementPulseCount = movementPulseCount;
+    snapshot.filamentStopped    = filamentStopped;
+    snapshot.activeChannel      = activeChannel;
+    for (uint8_t channel = 0; channel < MOTION_SENSOR_CHANNELS; channel++)
+    {
+        snapshot.channels[channel].pulseCount   = channelPulseCount[channel];
+        snapshot.channels[channel].windowMm     = totals.actualMm[channel];
+        snapshot.channels[channel].rateMmPerSec = totals.actualRate[channel];
+    }
+    detectionSnapshot.publish(snapshot);
+}
+
+void ElegooCC::detectionTaskEntry(void *param)
+{
+    (void) param;
+    for (;;)
+    {
+        TickType_t cycleStart = xTaskGetTickCount();
+        bool       jobActive  = false;
+        {
+            PerfScope     perfScope(PERF_DETECTION_CYCLE);
+            unsigned long now = millis();
+            for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+            {
+                ElegooCC &printer = getSession(session);
+                printer.checkFilamentMovement(now);
+                jobActive = jobActive || printer.isPrintJobActive();
+            }
+        }
+
+        // Fixed cadence during a job (pulse notifications are just cleared);
+        // idle, sleep longer and let the first pulse start the next cycle
+        TickType_t period  = pdMS_TO_TICKS(jobActive ? DETECTION_TASK_PERIOD_MS
+                                                     : DETECTION_TASK_IDLE_PERIOD_MS);
+        TickType_t elapsed = xTaskGetTickCount() - cycleStart;
+        TickType_t wait    = elapsed < period ? period - elapsed : 0;
+        if (jobActive)
+        {
+            ulTaskNotifyTake(pdTRUE, 0);
+            vTaskDelay(wait);
+        }
+        else
+        {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+    }
+}
+
+void ElegooCC::startDetectionTask()
+{
+#if ENABLE_DETECTION_TASK
+    if (detectionTaskHandle != nullptr)
+    {
+        return;
+    }
+
+#if portNUM_PROCESSORS > 1
+    // WiFi/lwIP run on PRO_CPU (core 0); keep detection on APP_CPU
+    const BaseType_t core = 1;
+#else
+    const BaseType_t core = 0;
+#endif
+    BaseType_t created = xTaskCreatePinnedToCore(detectionTaskEntry, "detect",
+                                                 DETECTION_TASK_STACK_SIZE, nullptr,
+                                                 DETECTION_TASK_PRIORITY, &detectionTaskHandle,
+                                                 core);
+    if (created != pdPASS)
+    {
+        detectionTaskHandle = nullptr;
+        logger.log("Failed to start detection task");
+        return;
+    }
+    logger.logf("Detection task started on core %d (%lums cadence, %lums idle, %d printers)",
+                (int) core, DETECTION_TASK_PERIOD_MS, DETECTION_TASK_IDLE_PERIOD_MS,
+                PRINTER_SESSIONS);
+#endif
+}
+
 bool ElegooCC::shouldPausePrint(unsigned long currentTime)
 {
     pauseTriggeredByRunout = false;
-    bool motionMonitoringEnabled = settingsManager.getEnabled();
+    bool motionMonitoringEnabled = settingsView.enabled;
 
     updateRunoutPauseCountdown();
     bool runoutPauseReady    = isRunoutPauseReady();
     bool pauseConditionRunout = runoutPauseReady;
-    bool pauseConditionFlow  = motionMonitoringEnabled && filamentStopped;
+    // filamentStopped belongs to the detection task; read its published copy
+    bool pauseConditionFlow  = motionMonitoringEnabled && detectionSnapshot.read().filamentStopped;
     bool pauseCondition      = pauseConditionRunout || pauseConditionFlow;
 
     bool           sdcpLoss      = false;
     unsigned long  lastSuccessMs = lastSuccessfulTelemetryMs;
-    int            lossBehavior  = settingsManager.getSdcpLossBehavior();
+    int            lossBehavior  = settingsView.sdcpLossBehavior;
     if (transport.webSocket.isConnected() && isPrinting() && lastSuccessMs > 0 &&
         (currentTime - lastSuccessMs) > SDCP_LOSS_TIMEOUT_MS)
     {
@@ -1393,7 +2230,7 @@ bool ElegooCC::shouldPausePrint(unsigned long currentTime)
         }
     }
 
-    if (currentTime - startedAt < settingsManager.getDetectionGracePeriodMs() ||
+    if (currentTime - startedAt < settingsView.detectionGracePeriodMs ||
         !transport.webSocket.isConnected() || transport.waitingForAck || !isPrinting() ||
         !pauseCondition ||
         (lastPauseRequestMs != 0 && (currentTime - lastPauseRequestMs) < PAUSE_REARM_DELAY_MS))
@@ -1414,15 +2251,15 @@ bool ElegooCC::shouldPausePrint(unsigned long currentTime)
                 pauseCondition, pauseConditionRunout ? 1 : 0, pauseConditionFlow ? 1 : 0,
                 sdcpLoss ? 1 : 0);
     logger.logf("Filament runout: %d", filamentRunout);
-    logger.logf("Filament runout pause enabled: %d", settingsManager.getPauseOnRunout());
+    logger.logf("Filament runout pause enabled: %d", settingsView.pauseOnRunout);
     logger.logf("Runout pause remaining: %.2f / %.2f", runoutPauseRemainingMm, runoutPauseDelayMm);
     logger.logf("Filament stopped: %d", filamentStopped);
     logger.logf("Time since print start %d", currentTime - startedAt);
     logger.logf("Is Machine status printing?: %d", hasMachineStatus(SDCP_MACHINE_STATUS_PRINTING));
     logger.logf("Print status: %d", printStatus);
-    if (settingsManager.getVerboseLogging())
+    if (cachedSettings.verboseLogging)
     {
-        JamState jamState = jamDetector.getState();
+        JamState jamState = detectionSnapshot.read().jamState;
         logger.logf("Flow state: expected=%.2fmm actual=%.2fmm deficit=%.2fmm "
                     "pass_ratio=%.2f pulses=%lu",
                     expectedFilamentMM, actualFilamentMM, jamState.deficit,
@@ -1467,187 +2304,306 @@ void ElegooCC::setMachineStatuses(const int *statusArray, int arraySize)
 
 bool ElegooCC::startDiscoveryAsync(unsigned long timeoutMs, DiscoveryCallback callback)
 {
-    if (discoveryState.active)
+    if (isDiscoveryActive())
     {
         logger.log("Discovery already in progress");
         return false;
     }
 
-    if (!discoveryState.udp.begin(SDCP_DISCOVERY_PORT))
+    unsigned long currentTime = millis();
+    if (discoveryState.phase == DISCOVERY_CLOSED && !openDiscoverySocket(currentTime))
     {
         logger.log("Failed to open UDP socket for discovery");
         return false;
     }
 
-    // Small delay after binding to ensure socket is ready
-    delay(10);
-
-    // Broadcast discovery packet
-    IPAddress localIp   = WiFi.localIP();
-    IPAddress subnet    = WiFi.subnetMask();
-    IPAddress broadcastIp((localIp[0] & subnet[0]) | ~subnet[0],
-                          (localIp[1] & subnet[1]) | ~subnet[1],
-                          (localIp[2] & subnet[2]) | ~subnet[2],
-                          (localIp[3] & subnet[3]) | ~subnet[3]);
-
-    logger.logf("Starting async discovery probe to %s (timeout: %lums)", 
-                broadcastIp.toString().c_str(), timeoutMs);
+    logger.logf("Starting async discovery probe to %s (timeout: %lums)",
+                subnetBroadcast().toString().c_str(), timeoutMs);
 
-    discoveryState.udp.beginPacket(broadcastIp, SDCP_DISCOVERY_PORT);
-    discoveryState.udp.write(reinterpret_cast<const uint8_t *>("M99999"), 6);
-    discoveryState.udp.endPacket();
-
-    discoveryState.active    = true;
-    discoveryState.startTime = millis();
-    discoveryState.lastProbeTime = discoveryState.startTime;
+    discoveryState.phase     = DISCOVERY_SCANNING;
+    discoveryState.startTime = currentTime;
     discoveryState.timeoutMs = timeoutMs;
     discoveryState.callback  = callback;
-    discoveryState.seenIps.clear();
-    discoveryState.results.clear();
+    // First probe goes out from the next updateDiscovery() pass
+    discoveryState.lastProbeTime = currentTime - DISCOVERY_PROBE_INTERVAL_MS;
+    return true;
+}
 
-    // Block transport/WebSocket operations while discovery runs
-    if (transport.webSocket.isConnected())
+void ElegooCC::cancelDiscovery()
+{
+    if (isDiscoveryActive())
     {
-        transport.webSocket.disconnect();
+        discoveryState.phase = DISCOVERY_LISTENING;
+        if (!DISCOVERY_PASSIVE)
+        {
+            closeDiscoverySocket();
+        }
+        logger.log("Discovery cancelled");
     }
-    transport.blocked = true;
+}
 
+bool ElegooCC::openDiscoverySocket(unsigned long currentTime)
+{
+    discoveryState.lastOpenAttemptMs = currentTime;
+    if (!discoveryState.udp.begin(SDCP_DISCOVERY_PORT))
+    {
+        return false;
+    }
+    // Passive mode probes right away so the cache fills soon after WiFi is up
+    discoveryState.phase         = DISCOVERY_LISTENING;
+    discoveryState.lastProbeTime = currentTime - DISCOVERY_REFRESH_MS;
     return true;
 }
 
-void ElegooCC::cancelDiscovery()
+void ElegooCC::closeDiscoverySocket()
 {
-    if (discoveryState.active)
+    discoveryState.udp.stop();
+    discoveryState.phase = DISCOVERY_CLOSED;
+}
+
+void ElegooCC::sendDiscoveryProbe(unsigned long currentTime)
+{
+    discoveryState.udp.beginPacket(subnetBroadcast(), SDCP_DISCOVERY_PORT);
+    discoveryState.udp.write(reinterpret_cast<const uint8_t *>(DISCOVERY_PROBE), DISCOVERY_PROBE_LENGTH);
+    discoveryState.udp.endPacket();
+    discoveryState.lastProbeTime = currentTime;
+}
+
+bool ElegooCC::passiveProbeDue(unsigned long currentTime)
+{
+    unsigned long sinceProbe = currentTime - discoveryState.lastProbeTime;
+    if (sinceProbe >= DISCOVERY_REFRESH_MS)
     {
-        discoveryState.udp.stop();
-        discoveryState.active = false;
-        transport.blocked     = false;
-        logger.log("Discovery cancelled");
+        return true;
     }
+    if (sinceProbe < DISCOVERY_LOST_PROBE_MS)
+    {
+        return false;
+    }
+    // A printer this board talked to stopped answering: it may have a new lease
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        ElegooCC &printer = getSession(session);
+        if (printer.mainboardID[0] != '\0' && !printer.transport.webSocket.isConnected() &&
+            printer.transport.consecutiveFailures >= DISCOVERY_LOST_AFTER_FAILURES)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 void ElegooCC::updateDiscovery(unsigned long currentTime)
 {
-    if (!discoveryState.active)
+    if (!WiFi.isConnected())
     {
-        if (transport.blocked)
+        if (discoveryState.phase != DISCOVERY_CLOSED)
         {
-            transport.blocked = false;
+            if (isDiscoveryActive())
+            {
+                logger.log("Discovery stopped: WiFi disconnected");
+            }
+            closeDiscoverySocket();
         }
         return;
     }
 
-    // Check for timeout
-    if ((currentTime - discoveryState.startTime) >= discoveryState.timeoutMs)
+    if (discoveryState.phase == DISCOVERY_CLOSED)
     {
-        logger.logf("Async discovery complete. Found %d printers.", discoveryState.results.size());
-        
-        // Stop UDP first
-        discoveryState.udp.stop();
-        discoveryState.active = false;
-        transport.blocked     = false;
-
-        // Invoke callback with results
-        if (discoveryState.callback)
+        if (!DISCOVERY_PASSIVE ||
+            (currentTime - discoveryState.lastOpenAttemptMs) < DISCOVERY_REOPEN_MS ||
+            !openDiscoverySocket(currentTime))
         {
-            discoveryState.callback(discoveryState.results);
+            return;
         }
-        return;
     }
 
-    // Re-broadcast every 400ms to give devices staggered response opportunities
-    // The ESP32 UDP buffer may only catch one response per broadcast, so multiple
-    // probes with different timing help catch all devices
-    if ((currentTime - discoveryState.lastProbeTime) >= 400)
+    if ((currentTime - discoveryState.lastExpiryCheckMs) >= 1000)
     {
-        IPAddress localIp   = WiFi.localIP();
-        IPAddress subnet    = WiFi.subnetMask();
-        IPAddress broadcastIp((localIp[0] & subnet[0]) | ~subnet[0],
-                              (localIp[1] & subnet[1]) | ~subnet[1],
-                              (localIp[2] & subnet[2]) | ~subnet[2],
-                              (localIp[3] & subnet[3]) | ~subnet[3]);
+        discoveryState.lastExpiryCheckMs = currentTime;
+        expireDiscoveryResults(currentTime);
+    }
 
-        discoveryState.udp.beginPacket(broadcastIp, SDCP_DISCOVERY_PORT);
-        discoveryState.udp.write(reinterpret_cast<const uint8_t *>("M99999"), 6);
-        discoveryState.udp.endPacket();
+    if (isDiscoveryActive())
+    {
+        if ((currentTime - discoveryState.startTime) >= discoveryState.timeoutMs)
+        {
+            logger.logf("Async discovery complete. Found %u printers.",
+                        (unsigned) discoveryState.count);
+            discoveryState.phase = DISCOVERY_LISTENING;
+            if (!DISCOVERY_PASSIVE)
+            {
+                closeDiscoverySocket();
+            }
+            if (discoveryState.callback)
+            {
+                discoveryState.callback(discoveryState.results, discoveryState.count);
+            }
+            return;
+        }
 
-        discoveryState.lastProbeTime = currentTime;
+        // Re-broadcast every 400ms to give devices staggered response opportunities
+        // The ESP32 UDP buffer may only catch one response per broadcast, so multiple
+        // probes with different timing help catch all devices
+        if ((currentTime - discoveryState.lastProbeTime) >= DISCOVERY_PROBE_INTERVAL_MS)
+        {
+            sendDiscoveryProbe(currentTime);
+        }
+    }
+    else if (passiveProbeDue(currentTime))
+    {
+        sendDiscoveryProbe(currentTime);
     }
 
-    // Process all available packets
+    receiveDiscoveryResponses(currentTime);
+}
+
+void ElegooCC::receiveDiscoveryResponses(unsigned long currentTime)
+{
     // Filter out our own IP (we might receive our own broadcast)
     IPAddress myIp = WiFi.localIP();
 
-    int packetSize;
-    while ((packetSize = discoveryState.udp.parsePacket()) > 0)
+    // A few packets per pass: the rest wait in the socket for the next pass
+    for (uint8_t handled = 0; handled < DISCOVERY_MAX_PACKETS_PER_PASS; handled++)
     {
-        IPAddress remoteIp = discoveryState.udp.remoteIP();
+        if (discoveryState.udp.parsePacket() <= 0)
+        {
+            return;
+        }
 
-        if (remoteIp == myIp)
+        IPAddress remoteIp = discoveryState.udp.remoteIP();
+        char      buffer[sizeof(DiscoveryResult::payload)];
+        int       len = discoveryState.udp.read(buffer, sizeof(buffer) - 1);
+        // CRITICAL: Always drain the packet, even ones we ignore
+        discoveryState.udp.flush();
+        buffer[len > 0 ? len : 0] = '\0';
+
+        // Our own probe, or another host's probe seen on the broadcast port
+        if (remoteIp == myIp || !remoteIp || strcmp(buffer, DISCOVERY_PROBE) == 0)
         {
-            discoveryState.udp.flush();
             continue;
         }
 
-        if (remoteIp)
+        cacheDiscoveryResponse(remoteIp, buffer, currentTime);
+
+        // REQUIRED: Close and reopen the socket after each response
+        // The ESP32 WiFiUDP seems to get "stuck" after receiving a response,
+        // preventing subsequent responses from being received. Recycling the
+        // socket forces it to work properly.
+        discoveryState.udp.stop();
+        if (!discoveryState.udp.begin(SDCP_DISCOVERY_PORT))
         {
-            String ipStr = remoteIp.toString();
+            logger.log("Failed to reopen UDP socket during discovery");
+            closeDiscoverySocket();
+            return;
+        }
+    }
+}
 
-            // Check for duplicate
-            bool duplicate = false;
-            for (const auto& seen : discoveryState.seenIps) {
-                if (seen == ipStr) {
-                    duplicate = true;
-                    break;
-                }
-            }
+void ElegooCC::cacheDiscoveryResponse(const IPAddress &remoteIp, const char *payload,
+                                      unsigned long currentTime)
+{
+    char ip[sizeof(DiscoveryResult::ip)];
+    snprintf(ip, sizeof(ip), "%u.%u.%u.%u", remoteIp[0], remoteIp[1], remoteIp[2], remoteIp[3]);
 
-            if (!duplicate) {
-                discoveryState.seenIps.push_back(ipStr);
+    // {"Id":..,"Data":{"MainboardID":"..",..}} identifies the printer across DHCP leases
+    char mainboard[sizeof(DiscoveryResult::mainboardID)] = "";
+    StaticJsonDocument<64>  filter;
+    filter["Data"]["MainboardID"] = true;
+    StaticJsonDocument<192> doc;
+    if (deserializeJson(doc, payload, DeserializationOption::Filter(filter)) ==
+        DeserializationError::Ok)
+    {
+        strlcpy(mainboard, doc["Data"]["MainboardID"] | "", sizeof(mainboard));
+    }
 
-                String payload = "";
-                char buffer[256];
-                int  len = discoveryState.udp.read(buffer, sizeof(buffer) - 1);
-                if (len > 0)
+    // Same printer (or, without an ID, same address) refreshes its entry;
+    // a new one takes a free slot or the stalest entry
+    size_t slot = discoveryState.count;
+    for (size_t i = 0; i < discoveryState.count; i++)
+    {
+        const DiscoveryResult &entry = discoveryState.results[i];
+        if (mainboard[0] != '\0' ? strcmp(entry.mainboardID, mainboard) == 0
+                                 : strcmp(entry.ip, ip) == 0)
+        {
+            slot = i;
+            break;
+        }
+    }
+    bool known = slot < discoveryState.count;
+    if (!known)
+    {
+        if (discoveryState.count < DISCOVERY_MAX_PRINTERS)
+        {
+            discoveryState.count++;
+        }
+        else
+        {
+            slot = 0;
+            for (size_t i = 1; i < discoveryState.count; i++)
+            {
+                if (discoveryState.results[i].lastSeenMs < discoveryState.results[slot].lastSeenMs)
                 {
-                    buffer[len] = '\0';
-                    payload = String(buffer);
+                    slot = i;
                 }
+            }
+        }
+    }
 
-                logger.logf("Discovered printer at %s", ipStr.c_str());
-                discoveryState.results.push_back({ipStr, payload});
+    DiscoveryResult &result = discoveryState.results[slot];
+    bool moved = known && strcmp(result.ip, ip) != 0;
+    if (!known || moved)
+    {
+        logger.logf("Discovered printer at %s%s", ip, moved ? " (address changed)" : "");
+    }
+    strlcpy(result.ip, ip, sizeof(result.ip));
+    strlcpy(result.mainboardID, mainboard, sizeof(result.mainboardID));
+    strlcpy(result.payload, payload, sizeof(result.payload));
+    result.lastSeenMs = currentTime;
+    discoveryState.generation++;
 
-                // REQUIRED: Close and reopen the socket after each response
-                // The ESP32 WiFiUDP seems to get "stuck" after receiving a response,
-                // preventing subsequent responses from being received. Recycling the
-                // socket forces it to work properly.
-                discoveryState.udp.stop();
-                if (!discoveryState.udp.begin(SDCP_DISCOVERY_PORT))
-                {
-                    logger.log("Failed to reopen UDP socket during discovery");
-                }
-            } else {
-                // CRITICAL: Always drain the packet even if duplicate!
-                discoveryState.udp.flush();
+    if (result.mainboardID[0] != '\0')
+    {
+        followMovedPrinter(result);
+    }
+}
+
+void ElegooCC::expireDiscoveryResults(unsigned long currentTime)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < discoveryState.count; i++)
+    {
+        if ((currentTime - discoveryState.results[i].lastSeenMs) < DISCOVERY_CACHE_TTL_MS)
+        {
+            if (kept != i)
+            {
+                discoveryState.results[kept] = discoveryState.results[i];
             }
+            kept++;
         }
-        yield();
+    }
+    if (kept != discoveryState.count)
+    {
+        discoveryState.count = kept;
+        discoveryState.generation++;
     }
 }
 
-// ============================================================================
-// INTERRUPT SERVICE ROUTINE FOR PULSE COUNTING
-// ============================================================================
-// Static interrupt handler that increments the pulse counter on rising edge.
-// This replaces polling-based edge detection and guarantees no pulses are dropped,
-// even during loop stalls or high-speed extrusion.
-//
-// Called by GPIO interrupt on MOVEMENT_SENSOR_PIN rising edge.
-// Execution time: ~2-3 microseconds (very fast, safe for ISR).
-// ============================================================================
-void IRAM_ATTR ElegooCC::pulseCounterISR()
+void ElegooCC::followMovedPrinter(const DiscoveryResult &result)
 {
-    // Directly increment the static counter. This is safe to do from an ISR
-    // as it involves no flash-based code.
-    ElegooCC::isrPulseCounter++;
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        ElegooCC &printer = getSession(session);
+        if (strcmp(printer.mainboardID, result.mainboardID) != 0 ||
+            printer.transport.webSocket.isConnected() ||
+            strcmp(printer.transport.ipAddress, result.ip) == 0)
+        {
+            continue;
+        }
+        // The disconnected transport sees the IP change and reconnects at once
+        logger.logf("%sPrinter %s moved from %s to %s, following it", printer.logPrefix,
+                    result.mainboardID, printer.transport.ipAddress, result.ip);
+        settingsManager.setPrinterIP(session, result.ip);
+        settingsManager.commit(true);
+    }
 }
@@ -8,10 +8,13 @@
 #include <functional>
 
 #include "FilamentMotionSensor.h"
+#include "FlowHistory.h"
 #include "JamDetector.h"
+#include "MmPerPulseEstimator.h"
+#include "SeqLock.h"
 //#include "JamDetector_iface.h"
-#include "UUID.h"
-#include <vector>
+#include "SDCPProtocol.h"
+#include "SettingsManager.h"
 
 #define CARBON_CENTAURI_PORT 3030
 
@@ -20,10 +23,65 @@
 #define FILAMENT_RUNOUT_PIN 12
 #endif
 
+// Printers monitored by this board, one ElegooCC session each. Session N
+// connects to settingsManager.getPrinterIP(N), counts pulses on pulse counter
+// channels N * MOTION_SENSOR_CHANNELS onwards and reads FILAMENT_RUNOUT_PIN_N
+// (-1 = no runout switch).
+#ifndef PRINTER_SESSIONS
+#define PRINTER_SESSIONS 1
+#endif
+#ifndef FILAMENT_RUNOUT_PIN_1
+#define FILAMENT_RUNOUT_PIN_1 -1
+#endif
+#ifndef FILAMENT_RUNOUT_PIN_2
+#define FILAMENT_RUNOUT_PIN_2 -1
+#endif
+#ifndef FILAMENT_RUNOUT_PIN_3
+#define FILAMENT_RUNOUT_PIN_3 -1
+#endif
+
 #ifndef MOVEMENT_SENSOR_PIN
 #define MOVEMENT_SENSOR_PIN 13
 #endif
 
+// Extra movement sensors, pulse counter channel N on MOVEMENT_SENSOR_PIN_N: further
+// filament paths (MOTION_SENSOR_CHANNELS > 1) or printers (PRINTER_SESSIONS > 1)
+#ifndef MOVEMENT_SENSOR_PIN_1
+#define MOVEMENT_SENSOR_PIN_1 -1
+#endif
+#ifndef MOVEMENT_SENSOR_PIN_2
+#define MOVEMENT_SENSOR_PIN_2 -1
+#endif
+#ifndef MOVEMENT_SENSOR_PIN_3
+#define MOVEMENT_SENSOR_PIN_3 -1
+#endif
+
+// Run pulse draining and jam detection in a dedicated FreeRTOS task so network
+// and web work in loop() cannot delay it. Set to 0 to run it from loop() instead.
+#ifndef ENABLE_DETECTION_TASK
+#define ENABLE_DETECTION_TASK 1
+#endif
+
+// Printer discovery (SDCP probe M99999 on UDP 3000). Between scans the
+// socket stays open and printers answering any probe are cached for
+// DISCOVERY_CACHE_TTL_MS; set DISCOVERY_PASSIVE to 0 to close it instead.
+#ifndef DISCOVERY_PASSIVE
+#define DISCOVERY_PASSIVE 1
+#endif
+#ifndef DISCOVERY_MAX_PRINTERS
+#define DISCOVERY_MAX_PRINTERS 8
+#endif
+#ifndef DISCOVERY_CACHE_TTL_MS
+#define DISCOVERY_CACHE_TTL_MS 900000UL
+#endif
+// Passive probe cadence: cache refresh, and while a known printer is unreachable
+#ifndef DISCOVERY_REFRESH_MS
+#define DISCOVERY_REFRESH_MS 300000UL
+#endif
+#ifndef DISCOVERY_LOST_PROBE_MS
+#define DISCOVERY_LOST_PROBE_MS 15000UL
+#endif
+
 // Status codes
 typedef enum
 {
@@ -78,6 +136,39 @@ typedef enum
     SDCP_COMMAND_STOP_FEEDING_MATERIAL = 132,
 } sdcp_command_t;
 
+// Jam-to-pause latency for the current print. Stage times are for the most
+// recent jam pause; 0 = stage not reached. Reset at print start.
+typedef struct
+{
+    uint16_t pauseCount;       // Jam pauses sent this print
+    uint16_t ackCount;         // ...of which the printer acknowledged
+    uint32_t onsetToDetectMs;  // First accumulating evaluation -> jam threshold crossed
+    uint32_t detectToSendMs;   // Threshold crossed -> pause command sent
+    uint32_t sendToAckMs;      // Pause command sent -> printer ack
+    uint32_t totalMs;          // Onset -> ack
+    uint32_t maxTotalMs;       // Worst onset -> ack this print
+    uint32_t sumTotalMs;       // For the average over ackCount
+} jam_latency_t;
+
+// SDCP link health since boot: established connections lost and restored
+typedef struct
+{
+    uint16_t drops;          // Established connections lost
+    uint16_t reconnects;     // ...and re-established
+    uint16_t deadLinks;      // Drops forced by the heartbeat deadline
+    uint32_t lastOutageMs;   // Drop -> connected again, most recent outage
+    uint32_t maxOutageMs;
+    uint32_t totalOutageMs;
+} sdcp_link_t;
+
+// One movement sensor channel (filament path)
+typedef struct
+{
+    unsigned long pulseCount;    // Pulses this print
+    float         windowMm;      // Windowed sensor distance
+    float         rateMmPerSec;  // Windowed sensor rate
+} motion_channel_info_t;
+
 // Struct to hold current printer information (uses fixed-size buffers to avoid heap allocations)
 typedef struct
 {
@@ -105,10 +196,12 @@ typedef struct
     float               actualFilamentMM;
     float               lastExpectedDeltaMM;
     bool                telemetryAvailable;
+    bool                flowProfileActive;  // Expected rate comes from an uploaded FlowProfile
     float               currentDeficitMm;
     float               deficitThresholdMm;
     float               deficitRatio;
     float               passRatio;
+    float               softJamThreshold;  // Effective soft jam pass ratio (adaptive or setting)
     float               hardJamPercent;
     float               softJamPercent;
     bool                graceActive;
@@ -116,46 +209,101 @@ typedef struct
     float               expectedRateMmPerSec;
     float               actualRateMmPerSec;
     unsigned long       movementPulseCount;
+    uint8_t             activeChannel;  // Channel the jam detector is watching
+    motion_channel_info_t channels[MOTION_SENSOR_CHANNELS];
+    jam_latency_t       jamLatency;
+    sdcp_link_t         link;
 } printer_info_t;
 
+// Detection results published by the detection task for web/display readers
+typedef struct
+{
+    JamState      jamState;
+    float         expectedDistanceMm;   // Windowed expected distance
+    float         actualDistanceMm;     // Windowed sensor distance (active channel)
+    float         actualFilamentMM;     // Cumulative sensor distance this print
+    unsigned long movementPulseCount;   // All channels
+    bool          filamentStopped;
+    uint8_t       activeChannel;
+    motion_channel_info_t channels[MOTION_SENSOR_CHANNELS];
+} detection_snapshot_t;
+
+// WebSocketsClient that can enable TCP keepalive on its socket (the library
+// keeps the underlying client protected)
+class SdcpWebSocketClient : public WebSocketsClient
+{
+   public:
+    // Call once connected; false when there is no socket or lwIP refused
+    bool enableTcpKeepalive(int idleSeconds, int intervalSeconds, int probeCount);
+};
+
+// How SDCP status is refreshed while a job is active
+enum class StatusPollMode : uint8_t
+{
+    FIXED    = 0,  // Poll every 250ms
+    ADAPTIVE = 1,  // Poll interval follows the expected extrusion rate
+    PUSH     = 2,  // Rely on unsolicited status pushes, poll only when they go stale
+};
+
 class ElegooCC
 {
    private:
     struct TransportState
     {
-        WebSocketsClient webSocket;
-        String           ipAddress;
+        static constexpr size_t ADDRESS_BUFFER_SIZE = 64;  // IPv4 or hostname
+
+        SdcpWebSocketClient webSocket;
+        char             ipAddress[ADDRESS_BUFFER_SIZE] = {0};
         unsigned long    lastPing            = 0;
         bool             waitingForAck       = false;
         int              pendingAckCommand   = -1;
-        String           pendingAckRequestId;
+        char             pendingAckRequestId[SDCPProtocol::REQUEST_ID_BUFFER_SIZE] = {0};
         unsigned long    ackWaitStartTime    = 0;
         unsigned long    lastStatusRequestMs = 0;
         unsigned long    connectionStartMs   = 0;  // When connect() was called (for throttle bypass)
-        bool             blocked             = false;  // Discovery lockout for transport
 
         // Reconnection state
         unsigned long    lastReconnectAttemptMs = 0;   // When connect() was last called
         unsigned long    reconnectBackoffMs     = 5000; // Current backoff interval (5s-60s max)
         int              consecutiveFailures    = 0;    // For exponential backoff calculation
-        String           lastAttemptedIp;               // Detect IP changes for immediate reconnect
+        char             lastAttemptedIp[ADDRESS_BUFFER_SIZE] = {0};  // Detect IP changes for immediate reconnect
+        unsigned long    connectTimeoutMs       = SDCPTiming::CONNECT_TIMEOUT_MS;  // Current attempt
+
+        // Liveness and outages
+        bool             linkUp              = false;  // Between CONNECTED and DISCONNECTED
+        bool             pongSeen            = false;  // Printer answers WebSocket pings
+        unsigned long    lastRxMs            = 0;      // Last frame (text, ping or pong) received
+        unsigned long    disconnectedAtMs    = 0;      // Start of the current outage (0 = none)
+        bool             fastReconnect       = false;  // Next attempt skips the backoff
+        sdcp_link_t      link                = {};
     };
 
     TransportState        transport;
-    UUID                  uuid;
-    StaticJsonDocument<1200> messageDoc;
-
-    // Interrupt-driven pulse counter (replaces polling-based edge detection)
-    unsigned long lastIsrPulseCount;            // Last value read in main loop
+    // Parse arena shared by all sessions: every WebSocket event is handled on
+    // the main task from updateTransport(), one session at a time
+    static StaticJsonDocument<1200> messageDoc;
+    // Session holding the connect slot (-1 = free). WebSocketsClient blocks in
+    // loop() while a TCP connect is pending, so sessions take turns.
+    static int8_t connectingSession;
+
+    uint8_t sessionIndex;
+    uint8_t pulseChannelBase;  // First pulse counter channel of this printer
+    int     runoutPin;         // -1 = none
+    char    logPrefix[8];      // "[P1] " with several sessions, else ""
+
+    // Pulse source totals per channel (PCNT or ISR, see PulseCounter)
+    unsigned long lastIsrPulseCount[MOTION_SENSOR_CHANNELS];  // Last value read in main loop
+    unsigned long lastPulseDrainMs;             // When pulses were last drained (arrival time estimate)
+    uint16_t      pulseReductionAccumulator;    // Reduction filter carry (hundredths of a pulse)
 
     // Legacy pin tracking (used only when tracking is frozen after jam pause)
     int           lastMovementValue;  // Initialize to invalid value
     unsigned long lastChangeTime;
 
-    // machine/status info
-    String              mainboardID;
-    String              taskId;               // Current job identifier from SDCP
-    String              filename;             // Current print filename from SDCP
+    // machine/status info (fixed buffers sized like printer_info_t: no heap per status frame)
+    char                mainboardID[sizeof(printer_info_t::mainboardID)];
+    char                taskId[sizeof(printer_info_t::taskId)];      // Current job identifier from SDCP
+    char                filename[sizeof(printer_info_t::filename)];  // Current print filename from SDCP
     sdcp_print_status_t printStatus;
     uint8_t             machineStatusMask;  // Bitmask for active statuses
     int                 currentLayer;
@@ -182,9 +330,20 @@ class ElegooCC
     bool                telemetryAvailableLastStatus;
 
     unsigned long startedAt;
-    FilamentMotionSensor motionSensor;  // Windowed sensor tracking (Klipper-style)
+    SelectableMotionSensor motionSensor;  // Windowed sensor tracking (Klipper-style), geometry per settings
     JamDetector         jamDetector;    // Consolidated jam detection logic
-    unsigned long       movementPulseCount;
+    FlowHistory         flowHistory;    // Detector output of the current print (detectionLock)
+    unsigned long       movementPulseCount;  // All channels
+    // Only one filament path feeds the nozzle at a time: the jam detector
+    // watches the channel that is moving (see selectActiveChannel)
+    unsigned long       channelPulseCount[MOTION_SENSOR_CHANNELS];
+    uint8_t             activeChannel;
+    void                selectActiveChannel(const MotionWindowTotals &totals);
+    // Streaming movement_mm_per_pulse fit (main task, auto_calibrate_sensor)
+    MmPerPulseEstimator mmPerPulseEstimator;
+    float               estimatorExpectedMm;    // expectedFilamentMM at the last sample
+    unsigned long       estimatorPulseCount;    // movementPulseCount at the last sample
+    void                updateMmPerPulseEstimate(unsigned long pulseCount, bool healthy);
     unsigned long       lastFlowLogMs;
     unsigned long       lastSummaryLogMs;
     unsigned long       lastPinDebugLogMs;
@@ -202,6 +361,7 @@ class ElegooCC
 
     // Tracking state (for UI freeze on pause)
     bool          trackingFrozen;
+    bool          flowProfileActive;  // A FlowProfile matched this print (main task)
     bool          hasBeenPaused;
     
     // Jam detector state caching (for throttled updates)
@@ -210,11 +370,14 @@ class ElegooCC
     unsigned long lastJamDetectorUpdateMs;
     bool          pauseTriggeredByRunout;
 
-   public:
-    // Public static counter for the ISR to access safely
-    static volatile unsigned long isrPulseCounter;
+    // Jam-to-pause latency (main task only)
+    jam_latency_t jamLatency;
+    unsigned long latencyOnsetMs;
+    unsigned long latencyDetectMs;
+    unsigned long latencySendMs;   // 0 = no jam pause awaiting its ack
+    void          recordJamPauseSent(unsigned long onsetMs, unsigned long detectMs);
+    void          recordJamPauseAck();
 
-   private:
     // Settings caching (for hot-path optimization)
     struct CachedSettings {
         bool testRecordingMode;
@@ -222,25 +385,77 @@ class ElegooCC
         bool flowSummaryLogging;
         bool pinDebugLogging;
         bool motionMonitoringEnabled;
-        float pulseReductionPercent;
-        float movementMmPerPulse;
+        uint16_t pulseReductionCentiPct;  // pulse_reduction_percent * 100, 0-10000
+        // Setting, or the live estimate while auto-calibrating; converted once
+        // here so the pulse path needs no float math (see FlowMath.h)
+        flow_mm_t movementMmPerPulse;
+        bool autoCalibrateSensor;
+        MotionWindowProfile motionWindowProfile;
+        bool predictiveExpected;
+        StatusPollMode statusPollMode;
     };
     CachedSettings cachedSettings;
     JamConfig cachedJamConfig;
+    // Main task's copy of the settings snapshot; loop() refreshes the caches
+    // above when the published version moves
+    settings_snapshot_t settingsView;
+    uint32_t            settingsViewVersion;
     portMUX_TYPE cacheLock;
     portMUX_TYPE _stateMutex;
 
+    // Detection state (motionSensor, jamDetector, pulse totals) is shared between
+    // the detection task and SDCP handling in loop(). A FreeRTOS mutex rather
+    // than a spinlock because JamDetector::update() may log while holding it.
+    StaticSemaphore_t               detectionLockBuffer;
+    SemaphoreHandle_t               detectionLock;
+    SeqLock<detection_snapshot_t>   detectionSnapshot;
+    // One detection task serves every session
+    static TaskHandle_t             detectionTaskHandle;
+    void lockDetection();
+    void unlockDetection();
+    void publishDetectionSnapshot();  // Call with detectionLock held
+    static void detectionTaskEntry(void *param);
+    static void startDetectionTask();
+    unsigned long adaptiveStatusIntervalMs();
+
+    // printer_info_t published from loop() (only when it changed) so web,
+    // SSE and display readers never enter _stateMutex. Mutators of published
+    // state call markInfoChanged(); detection changes are seen through the
+    // detection snapshot's generation, so unchanged passes build nothing.
+    SeqLock<printer_info_t> infoSnapshot;
+    printer_info_t          lastPublishedInfo;
+    portMUX_TYPE            infoPublishLock;
+    uint32_t                infoRevision;
+    uint32_t                publishedInfoRevision;
+    uint32_t                publishedDetectionGeneration;
+    void markInfoChanged();
+    void publishCurrentInformation();
+    void buildCurrentInformation(printer_info_t &info);
+
     // Command tracking
     unsigned long lastPauseRequestMs;
     unsigned long lastPrintEndMs;
     static constexpr unsigned long STATUS_IDLE_INTERVAL_MS          = 10000;
     static constexpr unsigned long STATUS_ACTIVE_INTERVAL_MS        = 250;
     static constexpr unsigned long STATUS_POST_PRINT_COOLDOWN_MS    = 20000;
+    static constexpr unsigned long STATUS_ADAPTIVE_MAX_INTERVAL_MS  = 1000;
+    static constexpr float         STATUS_ADAPTIVE_MM_PER_POLL      = 1.0f;  // Target expected mm between polls
     static constexpr unsigned long JAM_DEBUG_INTERVAL_MS            = 1000;
     static constexpr unsigned long JAM_DETECTOR_UPDATE_INTERVAL_MS  = 250;  // 4Hz
+    static constexpr unsigned long JAM_DETECTOR_PREDICTIVE_INTERVAL_MS = 100;  // 10Hz with predictive_expected
+    static constexpr float         MOTION_CHANNEL_SWITCH_MM         = 2.0f;  // Window lead to change active channel
+    static constexpr unsigned long DETECTION_TASK_PERIOD_MS         = 10;   // Pulse drain cadence
+    static constexpr unsigned long DETECTION_TASK_IDLE_PERIOD_MS    = 100;  // No job: pulses wake it
+    // Deepest path: logger.logf (256-byte buffer + newlib vsnprintf with float
+    // conversion, ~2KB) under checkFilamentMovement/JamDetector frames and a
+    // snapshot copy (~1.5KB), with ~2KB headroom. Check the "detect" task's
+    // stackFreeMin at /api/perf/memory after a print with verbose logging.
+    static constexpr uint32_t      DETECTION_TASK_STACK_SIZE        = 6144;
+    static constexpr UBaseType_t   DETECTION_TASK_PRIORITY          = 5;    // Above loopTask/async_tcp, below WiFi
     static constexpr float         DEFAULT_RUNOUT_PAUSE_DELAY_MM    = 700.0f;  // TODO: make configurable
+    static constexpr unsigned long SESSION_PASS_BUDGET_MS           = 50;   // loopSessions() time slice
 
-    ElegooCC();
+    explicit ElegooCC(uint8_t session);
 
     // Delete copy constructor and assignment operator
     ElegooCC(const ElegooCC &)            = delete;
@@ -274,57 +489,123 @@ class ElegooCC
     bool isPrintJobActive();  // Returns true for any non-idle state (for polling decisions)
     bool shouldPausePrint(unsigned long currentTime);
     void checkFilamentMovement(unsigned long currentTime);
-    bool shouldApplyPulseReduction(float reductionPercent);  // Pulse reduction helper function
+    void logPinDebugPulses(unsigned long countedPulses);
+    unsigned long applyPulseReduction(unsigned long pulses);  // Pulses kept by the reduction filter
+    void cacheMmPerPulse(float mmPerPulse);  // Call with cacheLock held
+    unsigned long addPulseRun(uint8_t channel, unsigned long pulses, flow_mm_t movementMm,
+                              unsigned long pulseMs);
+    unsigned long drainChannelPulses(uint8_t channel, unsigned long newPulses, flow_mm_t movementMm,
+                                     unsigned long currentTime);
     void maybeRequestStatus(unsigned long currentTime);
     void checkFilamentRunout(unsigned long currentTime);
 
    public:
-    // Singleton access method
+    // Printer session 0 (the only one unless PRINTER_SESSIONS > 1)
     static ElegooCC &getInstance();
-
-    // Interrupt handler for pulse detection (static, attached to GPIO interrupt)
-    static void IRAM_ATTR pulseCounterISR();
-
-    void setup();
+    // Session by index; out of range returns session 0
+    static ElegooCC &getSession(uint8_t index);
+    uint8_t getSessionIndex() const { return sessionIndex; }
+
+    // Arm sensors of every session and the shared detection task (from setup(),
+    // no network needed), then connect once WiFi is up
+    static void setupSessions();
+    static void connectSessions();
+    /**
+     * Service every session once, round robin. A pass that runs over
+     * SESSION_PASS_BUDGET_MS stops early and the next call resumes with the
+     * session after the last one served, so a slow printer delays the others
+     * by at most one turn.
+     */
+    static void loopSessions();
+
+    /**
+     * True while the main loop must keep its 1 ms cadence: a job is active,
+     * a command awaits its ack, a connect attempt or discovery is running.
+     * Otherwise the loop sleeps until notified or its idle deadline.
+     */
+    static bool needsFastLoop();
+
+    void setup();  // Pins, pulse counting and caches; connect() comes later
     void loop();
 
     void refreshCaches();
+    static void refreshAllCaches();  // Every session, after a settings change
     void reconnect();  // Reconnect with current IP from settings
 
     // Get current printer information
+    // Lock-free copy of the state published at the end of the last loop()
     printer_info_t getCurrentInformation();
+    // Changes whenever getCurrentInformation() would return something new
+    uint32_t getInformationGeneration() const { return infoSnapshot.generation(); }
 
     // Status display accessors
-    bool isJammed() const { return cachedJamState.jammed; }
+    bool isJammed() const { return detectionSnapshot.read().jamState.jammed; }
+
+    // Lock-free copy of the latest detection results
+    detection_snapshot_t getDetectionSnapshot() const { return detectionSnapshot.read(); }
+    // Flow history of the current (or last) print in its wire format (see FlowHistory.h)
+    void writeFlowHistory(Print &out);
     bool isFilamentRunout() const { return filamentRunout; }
 
     // Discovery
     struct DiscoveryResult {
-        String ip;
-        String payload;
+        char          ip[16];
+        char          mainboardID[sizeof(printer_info_t::mainboardID)];  // "" if not in payload
+        char          payload[256];  // Probe response as received
+        unsigned long lastSeenMs;
     };
-    
+
     // Async discovery
-    typedef std::function<void(const std::vector<DiscoveryResult>&)> DiscoveryCallback;
-    bool startDiscoveryAsync(unsigned long timeoutMs, DiscoveryCallback callback);
-    void cancelDiscovery();
-    void updateDiscovery(unsigned long currentTime);
-    
-    // Accessors for async response handling
-    bool isDiscoveryActive() const { return discoveryState.active; }
-    std::vector<DiscoveryResult> getDiscoveryResults() const { return discoveryState.results; }
+    typedef std::function<void(const DiscoveryResult *results, size_t count)> DiscoveryCallback;
+    /**
+     * Discovery is board-wide, run from loopSessions() without blocking.
+     * A scan probes every DISCOVERY_PROBE_INTERVAL_MS until timeoutMs;
+     * connected sessions keep running, sessions without a printer hold
+     * their (blocking) connect attempts until it ends. Results are the
+     * cache, so printers seen passively before the scan are included.
+     */
+    static bool startDiscoveryAsync(unsigned long timeoutMs, DiscoveryCallback callback);
+    static void cancelDiscovery();
+    static void updateDiscovery(unsigned long currentTime);
+
+    // Accessors for async response handling (main loop only)
+    static bool isDiscoveryActive() { return discoveryState.phase == DISCOVERY_SCANNING; }
+    static size_t getDiscoveryResultCount() { return discoveryState.count; }
+    static const DiscoveryResult &getDiscoveryResult(size_t index) { return discoveryState.results[index]; }
+    // Changes whenever a result is added, refreshed or expires
+    static uint32_t getDiscoveryGeneration() { return discoveryState.generation; }
 
    private:
+    enum DiscoveryPhase : uint8_t
+    {
+        DISCOVERY_CLOSED,     // No socket (WiFi down, or passive mode off)
+        DISCOVERY_LISTENING,  // Passive: cache whatever arrives, rare probes
+        DISCOVERY_SCANNING    // Active scan until timeoutMs
+    };
     struct DiscoveryState {
-        bool active = false;
-        unsigned long startTime = 0;
-        unsigned long timeoutMs = 0;
-        unsigned long lastProbeTime = 0;
-        WiFiUDP udp;
-        std::vector<String> seenIps;
-        std::vector<DiscoveryResult> results;
+        DiscoveryPhase  phase              = DISCOVERY_CLOSED;
+        unsigned long   startTime          = 0;
+        unsigned long   timeoutMs          = 0;
+        unsigned long   lastProbeTime      = 0;
+        unsigned long   lastOpenAttemptMs  = 0;
+        unsigned long   lastExpiryCheckMs  = 0;
+        WiFiUDP         udp;
+        DiscoveryResult results[DISCOVERY_MAX_PRINTERS];
+        size_t          count              = 0;
+        uint32_t        generation         = 0;
         DiscoveryCallback callback;
-    } discoveryState;
+    };
+    static DiscoveryState discoveryState;
+    static bool openDiscoverySocket(unsigned long currentTime);
+    static void closeDiscoverySocket();
+    static void sendDiscoveryProbe(unsigned long currentTime);
+    static bool passiveProbeDue(unsigned long currentTime);
+    static void receiveDiscoveryResponses(unsigned long currentTime);
+    static void cacheDiscoveryResponse(const IPAddress &remoteIp, const char *payload,
+                                       unsigned long currentTime);
+    static void expireDiscoveryResults(unsigned long currentTime);
+    // Point a session whose printer answered from a new address (DHCP) at it
+    static void followMovedPrinter(const DiscoveryResult &result);
 };
 
 // Convenience macro for easier access
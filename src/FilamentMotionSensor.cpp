@@ -1,34 +1,81 @@
 #include "FilamentMotionSensor.h"
 
-FilamentMotionSensor::FilamentMotionSensor()
+#include <new>
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+const unsigned long FilamentMotionSensorT<BucketMs, WindowMs>::BUCKET_SIZE_MS;
+template <unsigned long BucketMs, unsigned long WindowMs>
+const unsigned long FilamentMotionSensorT<BucketMs, WindowMs>::WINDOW_SIZE_MS;
+template <unsigned long BucketMs, unsigned long WindowMs>
+const int FilamentMotionSensorT<BucketMs, WindowMs>::BUCKET_COUNT;
+template <unsigned long BucketMs, unsigned long WindowMs>
+const int FilamentMotionSensorT<BucketMs, WindowMs>::CHANNELS;
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+FilamentMotionSensorT<BucketMs, WindowMs>::FilamentMotionSensorT() : predictive(false)
 {
     reset();
 }
 
-void FilamentMotionSensor::reset()
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::setPredictive(bool enabled)
+{
+    predictive = enabled;
+    predictedRate = 0;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::setPredictedRate(float mmPerSecond)
+{
+    if (!predictive || !initialized)
+    {
+        return;
+    }
+    predictedRate = mmPerSecond > 0 ? flowFromMm(mmPerSecond) : 0;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::reset()
 {
     initialized           = false;
     firstPulseReceived    = false;
     lastExpectedUpdateMs  = millis();
-    lastTotalExtrusionMm  = 0.0f;
+    lastTotalExtrusionMm  = 0;
     
     // Reset global pulse counters
-    totalSensorMm         = 0.0f;
-    sensorMmAtLastUpdate  = 0.0f;
-    preInitActualMm       = 0.0f;
+    totalSensorMm         = 0;
+    sensorMmAtLastUpdate  = 0;
+    preInitActualMm       = 0;
     preInitPulseCount     = 0;
     lastSensorPulseMs     = millis();
 
+    predictedRate         = 0;
+    predictedSinceSample  = 0;
+
     // Clear buckets
     for (int i = 0; i < BUCKET_COUNT; i++)
     {
-        expectedBuckets[i]  = 0.0f;
-        actualBuckets[i]    = 0.0f;
+        expectedBuckets[i]  = 0;
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            actualBuckets[i][c] = 0;
+        }
         bucketTimestamps[i] = 0; // 0 will be treated as stale immediately
+        bucketInWindow[i]   = false;
+    }
+
+    windowExpectedSum  = 0;
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        windowActualSum[c] = 0;
     }
+    windowBucketCount  = 0;
+    evictCursor        = 0;
+    bucketsSinceResync = 0;
 }
 
-int FilamentMotionSensor::getCurrentBucketIndex()
+template <unsigned long BucketMs, unsigned long WindowMs>
+int FilamentMotionSensorT<BucketMs, WindowMs>::getCurrentBucketIndex()
 {
     unsigned long now = millis();
     int index = (now / BUCKET_SIZE_MS) % BUCKET_COUNT;
@@ -48,28 +95,146 @@ int FilamentMotionSensor::getCurrentBucketIndex()
     
     unsigned long bucketStart = (now / BUCKET_SIZE_MS) * BUCKET_SIZE_MS;
     
-    if (bucketTimestamps[index] != bucketStart)
+    clearStaleBuckets(now);
+    if (bucketTimestamps[index] != bucketStart || !bucketInWindow[index])
     {
         // This is a new time slot for this index. Reset it.
-        expectedBuckets[index] = 0.0f;
-        actualBuckets[index]   = 0.0f;
-        bucketTimestamps[index] = bucketStart;
+        claimBucket(index, bucketStart);
     }
     
     return index;
 }
 
-void FilamentMotionSensor::clearStaleBuckets(unsigned long currentTime)
+template <unsigned long BucketMs, unsigned long WindowMs>
+int FilamentMotionSensorT<BucketMs, WindowMs>::getBucketIndexAt(unsigned long timeMs, unsigned long now)
+{
+    unsigned long bucketStart = (timeMs / BUCKET_SIZE_MS) * BUCKET_SIZE_MS;
+    unsigned long cutoff      = (now < WINDOW_SIZE_MS) ? 0 : (now - WINDOW_SIZE_MS);
+    if (bucketStart < cutoff)
+    {
+        return -1;  // Already slid out of the window
+    }
+
+    clearStaleBuckets(now);
+    int index = (timeMs / BUCKET_SIZE_MS) % BUCKET_COUNT;
+    if (bucketInWindow[index] && bucketTimestamps[index] == bucketStart)
+    {
+        return index;
+    }
+    if (bucketInWindow[index] && bucketTimestamps[index] > bucketStart)
+    {
+        return -1;  // Slot already reused by a newer bucket
+    }
+
+    // Slot holds data from a previous lap; claim it for this bucket
+    claimBucket(index, bucketStart);
+    return index;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::claimBucket(int index, unsigned long bucketStart)
+{
+    if (bucketInWindow[index])
+    {
+        // Slot still counted from the previous lap (exact window boundary)
+        windowExpectedSum -= expectedBuckets[index];
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            windowActualSum[c] -= actualBuckets[index][c];
+        }
+        windowBucketCount--;
+    }
+    expectedBuckets[index]  = 0;
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        actualBuckets[index][c] = 0;
+    }
+    bucketTimestamps[index] = bucketStart;
+    bucketInWindow[index]   = true;
+    windowBucketCount++;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::clearStaleBuckets(unsigned long currentTime)
+{
+    // Evict buckets whose start has slid out of the window, oldest first.
+    // A bucket starting at T stays in the window while currentTime <= T + WINDOW.
+    // Each absolute bucket number is visited once, so the cost is amortized
+    // O(1) per elapsed bucket regardless of how often the window is queried.
+    unsigned long lastExpired = (currentTime > WINDOW_SIZE_MS)
+                                    ? (currentTime - WINDOW_SIZE_MS - 1) / BUCKET_SIZE_MS
+                                    : 0;
+    if (currentTime <= WINDOW_SIZE_MS || evictCursor > lastExpired)
+    {
+        return;
+    }
+
+    if (lastExpired - evictCursor >= (unsigned long) BUCKET_COUNT)
+    {
+        // Idle for longer than a whole window lap: visit each slot once
+        evictCursor = lastExpired + 1 - BUCKET_COUNT;
+    }
+
+    for (; evictCursor <= lastExpired; evictCursor++)
+    {
+        int index = evictCursor % BUCKET_COUNT;
+        if (bucketInWindow[index] && bucketTimestamps[index] + WINDOW_SIZE_MS < currentTime)
+        {
+            windowExpectedSum -= expectedBuckets[index];
+            for (int c = 0; c < CHANNELS; c++)
+            {
+                windowActualSum[c] -= actualBuckets[index][c];
+            }
+            windowBucketCount--;
+            bucketInWindow[index] = false;
+        }
+
+        if (++bucketsSinceResync >= BUCKET_COUNT)
+        {
+            resyncWindowSums();
+        }
+    }
+
+    if (windowBucketCount <= 0)
+    {
+        windowBucketCount = 0;
+        windowExpectedSum = 0;
+        for (int c = 0; c < CHANNELS; c++)
+        {
+            windowActualSum[c] = 0;
+        }
+    }
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::resyncWindowSums()
 {
-    // Optional maintenance: Iterate and clear buckets older than window
-    // This isn't strictly necessary for correctness if we only Sum valid ones,
-    // but helps debugging.
-    // We will rely on sumWindow() filtering instead for performance.
+    // Recompute from the buckets once per lap so repeated add/subtract
+    // rounding cannot accumulate over a long print
+    bucketsSinceResync = 0;
+    windowExpectedSum  = 0;
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        windowActualSum[c] = 0;
+    }
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        if (bucketInWindow[i])
+        {
+            windowExpectedSum += expectedBuckets[i];
+            for (int c = 0; c < CHANNELS; c++)
+            {
+                windowActualSum[c] += actualBuckets[i][c];
+            }
+        }
+    }
 }
 
-void FilamentMotionSensor::updateExpectedPosition(float totalExtrusionMm)
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::updateExpectedPosition(float totalExtrusionMmIn)
 {
     unsigned long now = millis();
+    flow_mm_t totalExtrusionMm = flowFromMm(totalExtrusionMmIn);
 
     if (!initialized)
     {
@@ -95,191 +260,320 @@ void FilamentMotionSensor::updateExpectedPosition(float totalExtrusionMm)
     }
 
     // 1. Calculate Raw Deltas
-    float expectedDelta = totalExtrusionMm - lastTotalExtrusionMm;
-    float actualSinceLast = totalSensorMm - sensorMmAtLastUpdate;
+    flow_mm_t expectedDelta = totalExtrusionMm - lastTotalExtrusionMm;
+    flow_mm_t actualSinceLast = totalSensorMm - sensorMmAtLastUpdate;
     
     // 2. Calculate "Orphaned" Actuals
     // These are pulses that happened since the last update but are NO LONGER in the window.
     // To find this, we sum the *current* window.
-    float winExpected, winActual;
+    flow_mm_t winExpected, winActual;
     sumWindow(winExpected, winActual);
     
     // If the window holds 20mm, but we moved 100mm since last update, 
     // then 80mm have fallen off the edge.
-    float orphanedActual = actualSinceLast - winActual;
-    if (orphanedActual < 0.0f) orphanedActual = 0.0f;
+    flow_mm_t orphanedActual = actualSinceLast - winActual;
+    if (orphanedActual < 0) orphanedActual = 0;
     
     // 3. Adjust Expected Delta (Orphan Subtraction)
     // Reduce the spike by the amount of history we lost.
-    float adjustedDelta = expectedDelta - orphanedActual;
-    if (adjustedDelta < 0.0f) adjustedDelta = 0.0f;
+    flow_mm_t adjustedDelta = expectedDelta - orphanedActual;
+    if (adjustedDelta < 0) adjustedDelta = 0;
 
-    // 4. Record to Bucket
-    if (adjustedDelta > 0.001f) // Filter tiny noise
+    // 4. Record to Bucket, net of what prediction already put there
+    flow_mm_t correction = adjustedDelta - predictedSinceSample;
+    if (correction > flowMmConst(0.001)) // Filter tiny noise
     {
         int index = getCurrentBucketIndex();
-        expectedBuckets[index] += adjustedDelta;
+        expectedBuckets[index] += correction;
+        windowExpectedSum      += correction;
+    }
+    else if (correction < 0)
+    {
+        removeExpected(-correction);  // Over-predicted (flow slowed or stopped)
     }
 
-    // 5. Update Snapshots
+    // 5. Short-horizon rate for the next interval. Only a recent, positive
+    //    delta predicts; retractions, gaps and stops stop the extrapolation.
+    unsigned long intervalMs = now - lastExpectedUpdateMs;
+    predictedSinceSample = 0;
+    predictedRate        = 0;
+    if (predictive && expectedDelta > 0 && intervalMs > 0 &&
+        intervalMs <= MOTION_PREDICT_MAX_INTERVAL_MS)
+    {
+        predictedRate = flowPerSecond(expectedDelta, intervalMs);
+    }
+
+    // 6. Update Snapshots
     lastTotalExtrusionMm = totalExtrusionMm;
     sensorMmAtLastUpdate = totalSensorMm;
     lastExpectedUpdateMs = now;
 }
 
-void FilamentMotionSensor::addSensorPulse(float mmPerPulse)
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::addSensorPulse(float mmPerPulse)
+{
+    addSensorPulse(mmPerPulse, millis());
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::addSensorPulse(float mmPerPulse, unsigned long pulseTimeMs)
 {
-    if (mmPerPulse <= 0.0f) return;
+    addSensorPulses(1, mmPerPulse, pulseTimeMs);
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::addSensorPulses(unsigned long count, float mmPerPulse,
+                                                                unsigned long pulseTimeMs)
+{
+    addChannelPulses(0, count, flowFromMm(mmPerPulse), pulseTimeMs);
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::addChannelPulses(uint8_t channel, unsigned long count,
+                                                                 flow_mm_t mmPerPulse, unsigned long pulseTimeMs)
+{
+    if (count == 0 || mmPerPulse <= 0 || channel >= CHANNELS) return;
+    flow_mm_t batchMm = (count == 1) ? mmPerPulse : mmPerPulse * (flow_mm_t) count;
 
     if (!initialized)
     {
-        preInitActualMm += mmPerPulse;
-        preInitPulseCount++;
-        totalSensorMm += mmPerPulse; // Maintain global total
+        preInitActualMm += batchMm;
+        preInitPulseCount += count;
+        totalSensorMm += batchMm; // Maintain global total
         return;
     }
 
-    // Simply add to the current time bucket
-    int index = getCurrentBucketIndex();
-    actualBuckets[index] += mmPerPulse;
+    // Add to the bucket covering the pulses' arrival time
+    unsigned long now = millis();
+    if (pulseTimeMs > now) pulseTimeMs = now;
+    int index = getBucketIndexAt(pulseTimeMs, now);
+    if (index >= 0)
+    {
+        actualBuckets[index][channel] += batchMm;
+        windowActualSum[channel]      += batchMm;
+    }
     
     // Maintain global monotonic counter
-    totalSensorMm += mmPerPulse;
-    lastSensorPulseMs = millis();
+    totalSensorMm += batchMm;
+    if (pulseTimeMs > lastSensorPulseMs) lastSensorPulseMs = pulseTimeMs;
     firstPulseReceived = true;
 }
 
-void FilamentMotionSensor::sumWindow(float &outExpected, float &outActual)
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::extrapolateExpected(unsigned long now)
 {
-    outExpected = 0.0f;
-    outActual   = 0.0f;
-    
-    unsigned long now = millis();
-    unsigned long cutoff = (now < WINDOW_SIZE_MS) ? 0 : (now - WINDOW_SIZE_MS);
-    
-    // Iterate all buckets
-    for (int i = 0; i < BUCKET_COUNT; i++)
+    if (predictedRate <= 0 || now <= lastExpectedUpdateMs)
+    {
+        return;
+    }
+
+    // Total prediction since the sample (not per call), so repeated queries
+    // neither lose fractions nor run past the horizon
+    unsigned long sinceSample = now - lastExpectedUpdateMs;
+    if (sinceSample > MOTION_PREDICT_HORIZON_MS)
+    {
+        sinceSample = MOTION_PREDICT_HORIZON_MS;
+    }
+    flow_mm_t target = flowOverMs(predictedRate, sinceSample);
+    flow_mm_t step   = target - predictedSinceSample;
+    if (step <= 0)
     {
-        // Only include buckets that are strictly within the window
-        // (bucketTimestamp >= cutoff)
-        if (bucketTimestamps[i] >= cutoff && bucketTimestamps[i] <= now)
+        return;
+    }
+
+    int index = getCurrentBucketIndex();
+    expectedBuckets[index] += step;
+    windowExpectedSum      += step;
+    predictedSinceSample    = target;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::removeExpected(flow_mm_t amount)
+{
+    // Prediction went into the newest buckets; take the excess back from there
+    int index = getCurrentBucketIndex();
+    for (int n = 0; n < BUCKET_COUNT && amount > 0; n++)
+    {
+        int i = (index - n + BUCKET_COUNT) % BUCKET_COUNT;
+        if (!bucketInWindow[i] || expectedBuckets[i] <= 0)
         {
-            outExpected += expectedBuckets[i];
-            outActual   += actualBuckets[i];
+            continue;
         }
+        flow_mm_t take = (expectedBuckets[i] < amount) ? expectedBuckets[i] : amount;
+        expectedBuckets[i] -= take;
+        windowExpectedSum  -= take;
+        amount             -= take;
     }
 }
 
-float FilamentMotionSensor::getDeficit()
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::sumWindow(flow_mm_t &outExpected, flow_mm_t &outActual)
+{
+    unsigned long now = millis();
+    clearStaleBuckets(now);
+    extrapolateExpected(now);
+    flow_mm_t actual = 0;
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        actual += windowActualSum[c];
+    }
+    outExpected = (windowExpectedSum > 0) ? windowExpectedSum : 0;
+    outActual   = (actual > 0) ? actual : 0;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+unsigned long FilamentMotionSensorT<BucketMs, WindowMs>::validWindowMs() const
+{
+    // Rates are taken over the time actually covered by buckets in the
+    // window (call after sumWindow(), which evicts stale ones)
+    static const unsigned long MIN_VALID_DURATION_MS = 250;
+    unsigned long validDuration = (unsigned long) windowBucketCount * BUCKET_SIZE_MS;
+
+    // If we have very little data (e.g. just started), prevent division by zero
+    return (validDuration < MIN_VALID_DURATION_MS) ? MIN_VALID_DURATION_MS : validDuration;
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+float FilamentMotionSensorT<BucketMs, WindowMs>::getDeficit()
 {
     if (!initialized) return 0.0f;
     
-    float exp, act;
+    flow_mm_t exp, act;
     sumWindow(exp, act);
     
-    float deficit = exp - act;
-    return (deficit > 0.0f) ? deficit : 0.0f;
+    flow_mm_t deficit = exp - act;
+    return (deficit > 0) ? flowToMm(deficit) : 0.0f;
 }
 
-float FilamentMotionSensor::getExpectedDistance()
+template <unsigned long BucketMs, unsigned long WindowMs>
+float FilamentMotionSensorT<BucketMs, WindowMs>::getExpectedDistance()
 {
     if (!initialized) return 0.0f;
-    float exp, act;
+    flow_mm_t exp, act;
     sumWindow(exp, act);
-    return exp;
+    return flowToMm(exp);
 }
 
-float FilamentMotionSensor::getSensorDistance()
+template <unsigned long BucketMs, unsigned long WindowMs>
+float FilamentMotionSensorT<BucketMs, WindowMs>::getSensorDistance()
 {
     if (!initialized) return 0.0f;
-    float exp, act;
+    flow_mm_t exp, act;
     sumWindow(exp, act);
-    return act;
+    return flowToMm(act);
 }
 
-void FilamentMotionSensor::getWindowedRates(float &expectedRate, float &actualRate)
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::getWindowedRates(float &expectedRate, float &actualRate)
 {
     expectedRate = 0.0f;
     actualRate   = 0.0f;
     
     if (!initialized) return;
 
-    float expSum, actSum;
+    flow_mm_t expSum, actSum;
     sumWindow(expSum, actSum);
-    
-    // In the decoupled model, we calculate rate over the full window size
-    // OR the valid duration.
-    // For simplicity and stability, we assume the window is filling up or full.
-    // We divide by WINDOW_SIZE_MS if full?
-    // Better: We track how much time is actually covered by the valid buckets.
-    
-        static const unsigned long MIN_VALID_DURATION_MS = 250;
-    
-        unsigned long now = millis();
-    
-        unsigned long cutoff;
-    
-        if (now < WINDOW_SIZE_MS) {
-    
-            cutoff = 0; // Prevent unsigned long underflow
-    
-        } else {
-    
-            cutoff = now - WINDOW_SIZE_MS;
-    
-        }
-    
-    
-    
-        unsigned long validDuration = 0;
-    
-        
-    
-        for (int i = 0; i < BUCKET_COUNT; i++)
-    
-        {
-    
-            if (bucketTimestamps[i] >= cutoff && bucketTimestamps[i] <= now)
-    
-            {
-    
-                validDuration += BUCKET_SIZE_MS;
-    
-            }
-    
-        }
-    
-        
-    
-        // If we have very little data (e.g. just started), prevent division by zero
-    
-        if (validDuration < MIN_VALID_DURATION_MS) validDuration = MIN_VALID_DURATION_MS;  
-    
-    float durationSec = validDuration / 1000.0f;
-    expectedRate = expSum / durationSec;
-    actualRate   = actSum / durationSec;
+
+    unsigned long validDuration = validWindowMs();
+    expectedRate = flowToMm(flowPerSecond(expSum, validDuration));
+    actualRate   = flowToMm(flowPerSecond(actSum, validDuration));
+}
+
+template <unsigned long BucketMs, unsigned long WindowMs>
+void FilamentMotionSensorT<BucketMs, WindowMs>::getWindowTotals(MotionWindowTotals &out)
+{
+    out.expectedMm   = 0.0f;
+    out.expectedRate = 0.0f;
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        out.actualMm[c]   = 0.0f;
+        out.actualRate[c] = 0.0f;
+    }
+    if (!initialized) return;
+
+    flow_mm_t expSum, actSum;
+    sumWindow(expSum, actSum);
+
+    unsigned long validDuration = validWindowMs();
+    out.expectedMm   = flowToMm(expSum);
+    out.expectedRate = flowToMm(flowPerSecond(expSum, validDuration));
+    for (int c = 0; c < CHANNELS; c++)
+    {
+        flow_mm_t actual  = (windowActualSum[c] > 0) ? windowActualSum[c] : 0;
+        out.actualMm[c]   = flowToMm(actual);
+        out.actualRate[c] = flowToMm(flowPerSecond(actual, validDuration));
+    }
 }
 
-bool FilamentMotionSensor::isInitialized() const
+template <unsigned long BucketMs, unsigned long WindowMs>
+bool FilamentMotionSensorT<BucketMs, WindowMs>::isInitialized() const
 {
     return initialized;
 }
 
-bool FilamentMotionSensor::isWithinGracePeriod(unsigned long gracePeriodMs) const
+template <unsigned long BucketMs, unsigned long WindowMs>
+bool FilamentMotionSensorT<BucketMs, WindowMs>::isWithinGracePeriod(unsigned long gracePeriodMs) const
 {
     if (!initialized || gracePeriodMs == 0) return false;
     unsigned long now = millis();
     return (now - lastExpectedUpdateMs) < gracePeriodMs;
 }
 
-float FilamentMotionSensor::getFlowRatio()
+template <unsigned long BucketMs, unsigned long WindowMs>
+float FilamentMotionSensorT<BucketMs, WindowMs>::getFlowRatio()
 {
     if (!initialized) return 0.0f;
-    float exp = getExpectedDistance();
-    if (exp <= 0.001f) return 0.0f;
+    flow_mm_t exp, act;
+    sumWindow(exp, act);
+    if (exp <= flowMmConst(0.001)) return 0.0f;
     
-    float ratio = getSensorDistance() / exp;
-    if (ratio > 1.5f) ratio = 1.5f;
-    if (ratio < 0.0f) ratio = 0.0f;
-    return ratio;
-}
\ No newline at end of file
+    flow_ratio_t ratio = flowRatio(act, exp);
+    if (ratio > flowRatioConst(1.5)) ratio = flowRatioConst(1.5);
+    if (ratio < 0) ratio = 0;
+    return flowRatioToFloat(ratio);
+}
+
+// Prebuilt geometries; add a line here (and a MotionWindowProfile) for new ones
+template class FilamentMotionSensorT<250, 5000>;
+template class FilamentMotionSensorT<100, 5000>;
+template class FilamentMotionSensorT<250, 10000>;
+
+// ============================================================================
+// SelectableMotionSensor
+// ============================================================================
+
+SelectableMotionSensor::SelectableMotionSensor()
+    : active(new (&storage) FilamentMotionSensor()), activeProfile(MotionWindowProfile::STANDARD)
+{
+}
+
+SelectableMotionSensor::~SelectableMotionSensor()
+{
+    active->~FilamentMotionSensorBase();
+}
+
+bool SelectableMotionSensor::select(MotionWindowProfile newProfile)
+{
+    if (newProfile == activeProfile)
+    {
+        return false;
+    }
+
+    active->~FilamentMotionSensorBase();
+    switch (newProfile)
+    {
+        case MotionWindowProfile::FAST:
+            active = new (&storage) FastFilamentMotionSensor();
+            break;
+        case MotionWindowProfile::LONG:
+            active = new (&storage) LongFilamentMotionSensor();
+            break;
+        case MotionWindowProfile::STANDARD:
+        default:
+            newProfile = MotionWindowProfile::STANDARD;
+            active     = new (&storage) FilamentMotionSensor();
+            break;
+    }
+    activeProfile = newProfile;
+    return true;
+}
@@ -3,48 +3,188 @@
 
 #include <Arduino.h>
 
+#include <type_traits>
+
+#include "FlowMath.h"
+
+// How far past the last telemetry sample the predictive mode extrapolates
+// (the worst-case SDCP sample interval)
+#ifndef MOTION_PREDICT_HORIZON_MS
+#define MOTION_PREDICT_HORIZON_MS 1000
+#endif
+
+// A sample interval longer than this gives no rate (telemetry gap, pause)
+#ifndef MOTION_PREDICT_MAX_INTERVAL_MS
+#define MOTION_PREDICT_MAX_INTERVAL_MS 2000
+#endif
+
+// Movement sensors (one per filament path) sharing the expected side
+#ifndef MOTION_SENSOR_CHANNELS
+#define MOTION_SENSOR_CHANNELS 1
+#endif
+
+static_assert(MOTION_SENSOR_CHANNELS >= 1 && MOTION_SENSOR_CHANNELS <= 4,
+              "MOTION_SENSOR_CHANNELS must be 1-4");
+
+// Window contents for every channel, from one window update
+struct MotionWindowTotals
+{
+    float expectedMm;                          // Windowed expected distance
+    float expectedRate;                        // mm/s
+    float actualMm[MOTION_SENSOR_CHANNELS];    // Windowed sensor distance per channel
+    float actualRate[MOTION_SENSOR_CHANNELS];  // mm/s per channel
+};
+
+/**
+ * MotionWindowProfile - prebuilt window/bucket geometries
+ *
+ * Selected with the motion_window_profile setting. Each profile is its own
+ * template specialization so bucket arrays stay statically sized.
+ */
+enum class MotionWindowProfile : uint8_t
+{
+    STANDARD = 0,  // 250ms buckets, 5s window (default)
+    FAST     = 1,  // 100ms buckets, 5s window: quicker hard-jam response
+    LONG     = 2,  // 250ms buckets, 10s window: slow prints (TPU)
+};
+
+/**
+ * FilamentMotionSensorBase - geometry-independent interface
+ *
+ * Lets the caller swap window geometry at runtime without knowing which
+ * specialization is active.
+ */
+class FilamentMotionSensorBase
+{
+   public:
+    virtual ~FilamentMotionSensorBase() {}
+
+    virtual void reset() = 0;
+
+    // Telemetry Update
+    virtual void updateExpectedPosition(float totalExtrusionMm) = 0;
+
+    // Pulse Update
+    virtual void addSensorPulse(float mmPerPulse) = 0;
+    // Pulse Update with known arrival time (millis() domain). Pulses are binned
+    // into the bucket they happened in; pulses older than the window only count
+    // toward the monotonic total.
+    virtual void addSensorPulse(float mmPerPulse, unsigned long pulseTimeMs) = 0;
+    // Batch of `count` pulses that all fall in the bucket of pulseTimeMs, in O(1)
+    virtual void addSensorPulses(unsigned long count, float mmPerPulse, unsigned long pulseTimeMs) = 0;
+    // Same, for one channel (0..MOTION_SENSOR_CHANNELS-1); the calls above feed channel 0.
+    // mmPerPulse is already converted (flowFromMm when the setting changes) so
+    // the pulse path does no float math in the fixed-point build
+    virtual void addChannelPulses(uint8_t channel, unsigned long count, flow_mm_t mmPerPulse,
+                                  unsigned long pulseTimeMs) = 0;
+
+    // Analysis. The sensor side of these is the sum over all channels.
+    virtual float getDeficit() = 0;
+    virtual float getExpectedDistance() = 0;
+    virtual float getSensorDistance() = 0;
+    virtual void getWindowedRates(float &expectedRate, float &actualRate) = 0;
+    // Expected side and every channel in one pass (one eviction/extrapolation step)
+    virtual void getWindowTotals(MotionWindowTotals &out) = 0;
+
+    // State Queries
+    virtual bool isInitialized() const = 0;
+    virtual bool isWithinGracePeriod(unsigned long gracePeriodMs) const = 0;
+    virtual float getFlowRatio() = 0;
+
+    // Predictive mode: between telemetry samples the expected side advances
+    // at the rate of the last sample interval (for up to
+    // MOTION_PREDICT_HORIZON_MS past it) and is reconciled when the next
+    // sample lands. Survives reset().
+    virtual void setPredictive(bool enabled) = 0;
+    virtual bool isPredictive() const = 0;
+    // Replace the rate taken from the last sample interval with a known one
+    // (e.g. from a FlowProfile). Call right after updateExpectedPosition();
+    // holds until the next sample. No effect unless predictive.
+    virtual void setPredictedRate(float mmPerSecond) = 0;
+
+    // Geometry
+    virtual unsigned long getBucketSizeMs() const = 0;
+    virtual unsigned long getWindowSizeMs() const = 0;
+};
+
 /**
- * FilamentMotionSensor - Decoupled Dual-Buffer Implementation
+ * FilamentMotionSensorT - Decoupled Dual-Buffer Implementation
  * 
  * Solves "Pipeline Latency" by storing Expected (Planner) and Actual (Executor)
  * data in independent time-series buffers. This allows the sliding window
  * to absorb the variable delay between planning and execution without
  * artifacting/coupling errors.
+ *
+ * BucketMs sets the time resolution (and so hard-jam reaction time),
+ * WindowMs how much history the ratios are taken over. Member definitions
+ * live in FilamentMotionSensor.cpp, which instantiates the prebuilt profiles.
+ *
+ * With MOTION_SENSOR_CHANNELS > 1 every filament path has its own actual
+ * series, stored channel-minor (all channels of a bucket side by side).
+ * Bucket timestamps, eviction, prediction and the expected series are
+ * shared, so a window update costs one pass however many channels there
+ * are, plus one add per channel for each evicted bucket.
  */
-class FilamentMotionSensor
+template <unsigned long BucketMs, unsigned long WindowMs>
+class FilamentMotionSensorT : public FilamentMotionSensorBase
 {
+    static_assert(BucketMs > 0 && WindowMs % BucketMs == 0,
+                  "Window must be a whole number of buckets");
+
    public:
-    FilamentMotionSensor();
+    FilamentMotionSensorT();
 
-    void reset();
+    void reset() override;
 
     // Telemetry Update
-    void updateExpectedPosition(float totalExtrusionMm);
+    void updateExpectedPosition(float totalExtrusionMm) override;
 
     // Pulse Update
-    void addSensorPulse(float mmPerPulse);
+    void addSensorPulse(float mmPerPulse) override;
+    void addSensorPulse(float mmPerPulse, unsigned long pulseTimeMs) override;
+    void addSensorPulses(unsigned long count, float mmPerPulse, unsigned long pulseTimeMs) override;
+    void addChannelPulses(uint8_t channel, unsigned long count, flow_mm_t mmPerPulse,
+                          unsigned long pulseTimeMs) override;
 
     // Analysis
-    float getDeficit();
-    float getExpectedDistance();
-    float getSensorDistance();
-    void getWindowedRates(float &expectedRate, float &actualRate);
+    float getDeficit() override;
+    float getExpectedDistance() override;
+    float getSensorDistance() override;
+    void getWindowedRates(float &expectedRate, float &actualRate) override;
+    void getWindowTotals(MotionWindowTotals &out) override;
 
     // State Queries
-    bool isInitialized() const;
-    bool isWithinGracePeriod(unsigned long gracePeriodMs) const;
-    float getFlowRatio();
+    bool isInitialized() const override;
+    bool isWithinGracePeriod(unsigned long gracePeriodMs) const override;
+    float getFlowRatio() override;
+
+    void setPredictive(bool enabled) override;
+    bool isPredictive() const override { return predictive; }
+    void setPredictedRate(float mmPerSecond) override;
+
+    unsigned long getBucketSizeMs() const override { return BucketMs; }
+    unsigned long getWindowSizeMs() const override { return WindowMs; }
 
    private:
     // Tracking Constants
-    static const int           BUCKET_SIZE_MS = 250;
-    static const int           WINDOW_SIZE_MS = 5000;
-    static const int           BUCKET_COUNT   = WINDOW_SIZE_MS / BUCKET_SIZE_MS; // 20
+    static const unsigned long BUCKET_SIZE_MS = BucketMs;
+    static const unsigned long WINDOW_SIZE_MS = WindowMs;
+    static const int           BUCKET_COUNT   = (int) (WindowMs / BucketMs); // 20 for STANDARD
+    static const int           CHANNELS       = MOTION_SENSOR_CHANNELS;
 
-    // Independent Circular Buffers
-    float         expectedBuckets[BUCKET_COUNT];
-    float         actualBuckets[BUCKET_COUNT];
+    // Independent Circular Buffers (flow_mm_t: see FlowMath.h)
+    flow_mm_t     expectedBuckets[BUCKET_COUNT];
+    flow_mm_t     actualBuckets[BUCKET_COUNT][CHANNELS];
     unsigned long bucketTimestamps[BUCKET_COUNT]; // For stale data clearing
+    bool          bucketInWindow[BUCKET_COUNT];   // Bucket contributes to the running sums
+
+    // Running window totals (O(1) queries). Adjusted when a bucket is written
+    // or evicted; re-summed once per window lap to cancel float drift.
+    flow_mm_t     windowExpectedSum;
+    flow_mm_t     windowActualSum[CHANNELS];
+    int           windowBucketCount;              // Buckets currently in the window
+    unsigned long evictCursor;                    // Next absolute bucket number to check for eviction
+    int           bucketsSinceResync;
 
     // State
     bool          initialized;
@@ -53,18 +193,66 @@ class FilamentMotionSensor
 
     // Pulse Tracking (Global/Monotonic for Dropout Recovery)
     unsigned long lastSensorPulseMs;
-    float         totalSensorMm;          // Monotonic total of all pulses since reset
-    float         sensorMmAtLastUpdate;   // Snapshot of totalSensorMm at last telemetry update
+    flow_mm_t     totalSensorMm;          // Monotonic total of all pulses since reset (all channels)
+    flow_mm_t     sensorMmAtLastUpdate;   // Snapshot of totalSensorMm at last telemetry update
+
+    // Prediction (see setPredictive)
+    bool          predictive;
+    flow_mm_t     predictedRate;          // Expected mm/s over the last sample interval
+    flow_mm_t     predictedSinceSample;   // Extrapolated expected already in the buckets
 
     // Telemetry Tracking
-    float         lastTotalExtrusionMm;   // Last known absolute extrusion from SDCP
-    float         preInitActualMm;        // Buffer pulses before init
+    flow_mm_t     lastTotalExtrusionMm;   // Last known absolute extrusion from SDCP
+    flow_mm_t     preInitActualMm;        // Buffer pulses before init
     unsigned long preInitPulseCount;
 
     // Helpers
     int           getCurrentBucketIndex();
-    void          sumWindow(float &outExpected, float &outActual);
+    int           getBucketIndexAt(unsigned long timeMs, unsigned long now);
+    void          sumWindow(flow_mm_t &outExpected, flow_mm_t &outActual);  // Actual over all channels
+    unsigned long validWindowMs() const;
     void          clearStaleBuckets(unsigned long currentTime);
+    void          claimBucket(int index, unsigned long bucketStart);
+    void          resyncWindowSums();
+    void          extrapolateExpected(unsigned long now);
+    void          removeExpected(flow_mm_t amount);
+};
+
+// Prebuilt geometries (see MotionWindowProfile)
+typedef FilamentMotionSensorT<250, 5000>  FilamentMotionSensor;
+typedef FilamentMotionSensorT<100, 5000>  FastFilamentMotionSensor;
+typedef FilamentMotionSensorT<250, 10000> LongFilamentMotionSensor;
+
+/**
+ * SelectableMotionSensor - holds whichever profile is active
+ *
+ * Storage is sized for the largest specialization and the active one is
+ * constructed in place, so switching profiles never touches the heap.
+ * select() discards all tracking state; only call it between prints.
+ */
+class SelectableMotionSensor
+{
+   public:
+    SelectableMotionSensor();
+    ~SelectableMotionSensor();
+
+    // Switch geometry (no-op if already active). Returns true if it changed.
+    bool select(MotionWindowProfile newProfile);
+    MotionWindowProfile profile() const { return activeProfile; }
+
+    FilamentMotionSensorBase *operator->() { return active; }
+    const FilamentMotionSensorBase *operator->() const { return active; }
+
+   private:
+    SelectableMotionSensor(const SelectableMotionSensor &) = delete;
+    SelectableMotionSensor &operator=(const SelectableMotionSensor &) = delete;
+
+    typedef std::aligned_union<0, FilamentMotionSensor, FastFilamentMotionSensor,
+                               LongFilamentMotionSensor>::type Storage;
+
+    Storage                   storage;
+    FilamentMotionSensorBase *active;
+    MotionWindowProfile       activeProfile;
 };
 
 #endif  // FILAMENT_MOTION_SENSOR_H
\ No newline at end of file
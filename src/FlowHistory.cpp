@@ -0,0 +1,290 @@
+#include "FlowHistory.h"
+
+#include <string.h>
+
+namespace
+{
+uint16_t quantizeRate(float mmPerSec)
+{
+    if (!(mmPerSec > 0.0f))
+    {
+        return 0;  // Also catches NaN
+    }
+    float scaled = mmPerSec * 100.0f + 0.5f;
+    return scaled >= 65535.0f ? 65535 : static_cast<uint16_t>(scaled);
+}
+
+uint8_t quantizeByte(float value, float scale, uint8_t limit)
+{
+    if (!(value > 0.0f))
+    {
+        return 0;
+    }
+    float scaled = value * scale + 0.5f;
+    return scaled >= limit ? limit : static_cast<uint8_t>(scaled);
+}
+
+uint8_t *writeDelta(uint8_t *out, int32_t delta)
+{
+    uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+    while (zigzag >= 0x80)
+    {
+        *out++ = static_cast<uint8_t>(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(zigzag);
+    return out;
+}
+
+void writeU16(uint8_t *out, uint32_t value)
+{
+    if (value > 0xFFFF)
+    {
+        value = 0xFFFF;
+    }
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeU32(uint8_t *out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+}  // namespace
+
+void FlowHistory::Accumulator::clear()
+{
+    memset(this, 0, sizeof(*this));
+}
+
+void FlowHistory::Accumulator::add(const flow_sample_t &sample)
+{
+    flags |= sample.flags;
+    if ((sample.flags & FLOW_SAMPLE_HAS_DATA) == 0)
+    {
+        return;
+    }
+    expectedSum += sample.expectedRate;
+    actualSum += sample.actualRate;
+    ratioSum += sample.passRatio;
+    count++;
+    if (sample.hardJam > hardMax)
+    {
+        hardMax = sample.hardJam;
+    }
+    if (sample.softJam > softMax)
+    {
+        softMax = sample.softJam;
+    }
+}
+
+flow_sample_t FlowHistory::Accumulator::result() const
+{
+    flow_sample_t sample = {0, 0, 0, hardMax, softMax, flags};
+    if (count > 0)
+    {
+        uint32_t half       = count / 2;
+        sample.expectedRate = static_cast<uint16_t>((expectedSum + half) / count);
+        sample.actualRate   = static_cast<uint16_t>((actualSum + half) / count);
+        sample.passRatio    = static_cast<uint8_t>((ratioSum + half) / count);
+    }
+    return sample;
+}
+
+FlowHistory::FlowHistory()
+{
+    begin(0);
+    running = false;  // Empty until the first print starts
+}
+
+void FlowHistory::begin(unsigned long nowMs)
+{
+    running        = true;
+    startMs        = nowMs;
+    lastCloseMs    = nowMs;
+    closedSec      = 0;
+    coarseInterval = FLOW_HISTORY_COARSE_INTERVAL_S;
+    fineHead       = 0;
+    fineSize       = 0;
+    coarseSize     = 0;
+    second.clear();
+    pendingCoarse.clear();
+}
+
+void FlowHistory::record(unsigned long nowMs, float expectedRate, float actualRate,
+                         float passRatio, float hardJamPercent, float softJamPercent,
+                         bool jammed, bool graceActive)
+{
+    if (!running)
+    {
+        return;
+    }
+
+    uint32_t sec = static_cast<uint32_t>((nowMs - startMs) / 1000UL);
+    if (sec > closedSec)
+    {
+        closeSecond(second.result());
+        second.clear();
+        addGapSeconds(sec - closedSec);
+    }
+
+    flow_sample_t sample;
+    sample.expectedRate = quantizeRate(expectedRate);
+    sample.actualRate   = quantizeRate(actualRate);
+    sample.passRatio    = quantizeByte(passRatio, 100.0f, 255);
+    sample.hardJam      = quantizeByte(hardJamPercent, 2.0f, 200);
+    sample.softJam      = quantizeByte(softJamPercent, 2.0f, 200);
+    sample.flags        = FLOW_SAMPLE_HAS_DATA | (jammed ? FLOW_SAMPLE_JAMMED : 0) |
+                   (graceActive ? FLOW_SAMPLE_GRACE : 0);
+    second.add(sample);
+}
+
+flow_sample_t FlowHistory::fineSample(uint16_t index) const
+{
+    uint16_t oldest = static_cast<uint16_t>(
+        (fineHead + FLOW_HISTORY_FINE_SAMPLES - fineSize) % FLOW_HISTORY_FINE_SAMPLES);
+    return fine[(oldest + index) % FLOW_HISTORY_FINE_SAMPLES];
+}
+
+void FlowHistory::closeSecond(const flow_sample_t &sample)
+{
+    pushFine(sample);
+    feedCoarse(sample, 1);
+    closedSec++;
+    lastCloseMs = startMs + closedSec * 1000UL;
+}
+
+void FlowHistory::addGapSeconds(uint32_t seconds)
+{
+    if (seconds == 0)
+    {
+        return;
+    }
+
+    // Gap samples repeat the last values so they encode as a mask byte alone
+    flow_sample_t gap = {0, 0, 0, 0, 0, 0};
+    if (fineSize > 0)
+    {
+        gap = fine[(fineHead + FLOW_HISTORY_FINE_SAMPLES - 1) % FLOW_HISTORY_FINE_SAMPLES];
+    }
+    gap.flags = 0;
+
+    // Only the last ring's worth of a long gap is visible in the fine tier
+    uint32_t visible = seconds < FLOW_HISTORY_FINE_SAMPLES ? seconds : FLOW_HISTORY_FINE_SAMPLES;
+    for (uint32_t i = 0; i < visible; i++)
+    {
+        pushFine(gap);
+    }
+    feedCoarse(gap, seconds);
+    closedSec += seconds;
+    lastCloseMs = startMs + closedSec * 1000UL;
+}
+
+void FlowHistory::pushFine(const flow_sample_t &sample)
+{
+    fine[fineHead] = sample;
+    fineHead       = static_cast<uint16_t>((fineHead + 1) % FLOW_HISTORY_FINE_SAMPLES);
+    if (fineSize < FLOW_HISTORY_FINE_SAMPLES)
+    {
+        fineSize++;
+    }
+}
+
+void FlowHistory::feedCoarse(const flow_sample_t &sample, uint32_t seconds)
+{
+    if (seconds > 0)
+    {
+        pendingCoarse.add(sample);  // Repeats add nothing to a mean of data seconds
+    }
+    while (seconds > 0)
+    {
+        uint32_t room  = coarseInterval - pendingCoarse.seconds;
+        uint32_t taken = seconds < room ? seconds : room;
+        pendingCoarse.seconds += taken;
+        seconds -= taken;
+        if (pendingCoarse.seconds < coarseInterval)
+        {
+            break;
+        }
+
+        if (coarseSize == FLOW_HISTORY_COARSE_SAMPLES)
+        {
+            // Halve the resolution; the pending aggregate grows to the new interval
+            mergeCoarse();
+            continue;
+        }
+        coarse[coarseSize++] = pendingCoarse.result();
+        pendingCoarse.clear();
+        if (seconds > 0)
+        {
+            pendingCoarse.add(sample);
+        }
+    }
+}
+
+void FlowHistory::mergeCoarse()
+{
+    uint16_t merged = 0;
+    for (uint16_t i = 0; i + 1 < coarseSize; i += 2)
+    {
+        Accumulator pair;
+        pair.clear();
+        pair.add(coarse[i]);
+        pair.add(coarse[i + 1]);
+        coarse[merged++] = pair.result();
+    }
+    if (coarseSize % 2 != 0)
+    {
+        coarse[merged++] = coarse[coarseSize - 1];
+    }
+    coarseSize = merged;
+    coarseInterval *= 2;
+}
+
+size_t FlowHistory::encodeSample(const flow_sample_t &previous, const flow_sample_t &sample,
+                                 uint8_t *out)
+{
+    const int32_t deltas[5] = {
+        static_cast<int32_t>(sample.expectedRate) - previous.expectedRate,
+        static_cast<int32_t>(sample.actualRate) - previous.actualRate,
+        static_cast<int32_t>(sample.passRatio) - previous.passRatio,
+        static_cast<int32_t>(sample.hardJam) - previous.hardJam,
+        static_cast<int32_t>(sample.softJam) - previous.softJam,
+    };
+
+    uint8_t  mask   = 0;
+    uint8_t *cursor = out + 1;
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        if (deltas[i] != 0)
+        {
+            mask |= static_cast<uint8_t>(1 << i);
+            cursor = writeDelta(cursor, deltas[i]);
+        }
+    }
+    if (sample.flags != previous.flags)
+    {
+        mask |= 1 << 5;
+        *cursor++ = sample.flags;
+    }
+    out[0] = mask;
+    return static_cast<size_t>(cursor - out);
+}
+
+size_t FlowHistory::encodeHeader(uint8_t *out, unsigned long nowMs) const
+{
+    out[0] = 'F';
+    out[1] = 'H';
+    out[2] = FLOW_HISTORY_VERSION;
+    out[3] = static_cast<uint8_t>(FLOW_HISTORY_HEADER_BYTES);
+    writeU32(out + 4, closedSec);
+    writeU32(out + 8, running ? static_cast<uint32_t>(nowMs - lastCloseMs) : 0);
+    writeU16(out + 12, 1);
+    writeU16(out + 14, fineSize);
+    writeU16(out + 16, coarseInterval);
+    writeU16(out + 18, coarseSize);
+    return FLOW_HISTORY_HEADER_BYTES;
+}
@@ -0,0 +1,187 @@
+#ifndef FLOW_HISTORY_H
+#define FLOW_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * FlowHistory - fixed-memory flow record of the current print
+ *
+ * Two resolutions, both fed from the detection cycle:
+ *
+ *  - Fine: one sample per second for the last FLOW_HISTORY_FINE_SAMPLES
+ *    seconds (a ring). Rates and pass ratio are the mean of the detector
+ *    updates in that second, jam percentages the highest.
+ *  - Coarse: FLOW_HISTORY_COARSE_INTERVAL_S aggregates from print start.
+ *    When FLOW_HISTORY_COARSE_SAMPLES are filled, neighbours are merged
+ *    pairwise and the interval doubles, so the whole print always fits.
+ *    Aggregates average the fine samples that had data and keep their
+ *    highest jam percentages and every flag raised.
+ *
+ * Seconds without a detector update (paused, telemetry lost, detection
+ * disarmed) become samples without FLOW_SAMPLE_HAS_DATA. The history is
+ * kept after the print ends and cleared when the next one starts.
+ *
+ * Samples are stored quantized, 8 bytes each:
+ *   expected/actual rate  uint16  0.01 mm/s (clamped to 0..655.35)
+ *   pass ratio            uint8   0.01      (0..2.55)
+ *   hard/soft jam         uint8   0.5 %     (0..100)
+ *   flags                 uint8   FlowSampleFlag bits
+ *
+ * Wire format (/api/flow_history.bin), little-endian:
+ *
+ * Offset  Type     Field
+ *  0      char[2]  magic "FH"
+ *  2      uint8    version (FLOW_HISTORY_VERSION)
+ *  3      uint8    header length (FLOW_HISTORY_HEADER_BYTES)
+ *  4      uint32   print elapsed seconds at the end of the last fine sample
+ *  8      uint32   ms since the last fine sample ended (at encode time)
+ * 12      uint16   fine interval (s)
+ * 14      uint16   fine sample count
+ * 16      uint16   coarse interval (s)
+ * 18      uint16   coarse sample count (complete aggregates only)
+ *
+ * Then the fine samples, oldest first, then the coarse ones from print
+ * start. Each sample is one mask byte followed by what changed since the
+ * previous sample of the same series (the first is relative to zero):
+ * bits 0-4 flag a zigzag LEB128 delta for expected rate, actual rate, pass
+ * ratio, hard jam, soft jam (in that order, raw units above); bit 5 flags the
+ * new flags byte, which follows the deltas. Steady flow costs 2-4 bytes per
+ * sample, a gap second after the first one byte.
+ */
+
+#ifndef FLOW_HISTORY_FINE_SAMPLES
+#define FLOW_HISTORY_FINE_SAMPLES 600  // 10 minutes at 1 s
+#endif
+
+#ifndef FLOW_HISTORY_COARSE_SAMPLES
+#define FLOW_HISTORY_COARSE_SAMPLES 480  // 4 hours at 30 s before the first merge
+#endif
+
+#ifndef FLOW_HISTORY_COARSE_INTERVAL_S
+#define FLOW_HISTORY_COARSE_INTERVAL_S 30
+#endif
+
+#define FLOW_HISTORY_VERSION 1
+
+static const size_t FLOW_HISTORY_HEADER_BYTES = 20;
+static const size_t FLOW_HISTORY_MAX_SAMPLE_BYTES = 1 + 2 * 3 + 3 * 2 + 1;
+
+enum FlowSampleFlag : uint8_t
+{
+    FLOW_SAMPLE_HAS_DATA = 1 << 0,  // At least one detector update in the interval
+    FLOW_SAMPLE_JAMMED   = 1 << 1,
+    FLOW_SAMPLE_GRACE    = 1 << 2,
+};
+
+struct flow_sample_t
+{
+    uint16_t expectedRate;  // 0.01 mm/s
+    uint16_t actualRate;    // 0.01 mm/s
+    uint8_t  passRatio;     // 0.01
+    uint8_t  hardJam;       // 0.5 %
+    uint8_t  softJam;       // 0.5 %
+    uint8_t  flags;
+};
+
+class FlowHistory
+{
+  public:
+    FlowHistory();
+
+    // Clear and restart the clock (call on print start)
+    void begin(unsigned long nowMs);
+
+    // One detector update; seconds before nowMs's second are closed first
+    void record(unsigned long nowMs, float expectedRate, float actualRate, float passRatio,
+                float hardJamPercent, float softJamPercent, bool jammed, bool graceActive);
+
+    bool     started() const { return running; }
+    uint16_t fineCount() const { return fineSize; }
+    uint16_t coarseCount() const { return coarseSize; }
+    uint32_t coarseIntervalSec() const { return coarseInterval; }
+    uint32_t elapsedSec() const { return closedSec; }  // Seconds closed since begin()
+
+    // Oldest first
+    flow_sample_t fineSample(uint16_t index) const;
+    flow_sample_t coarseSample(uint16_t index) const { return coarse[index]; }
+
+    /**
+     * Write the wire format to `sink`, anything with
+     * write(const uint8_t *data, size_t length) (AsyncResponseStream, Print).
+     */
+    template <typename Sink> void encode(Sink &sink, unsigned long nowMs) const;
+
+    // Encoded size of `sample` after `previous`, written to out (FLOW_HISTORY_MAX_SAMPLE_BYTES)
+    static size_t encodeSample(const flow_sample_t &previous, const flow_sample_t &sample,
+                               uint8_t *out);
+    size_t encodeHeader(uint8_t *out, unsigned long nowMs) const;
+
+  private:
+    // Accumulator for one interval (a second, or a coarse aggregate)
+    struct Accumulator
+    {
+        uint32_t expectedSum;
+        uint32_t actualSum;
+        uint32_t ratioSum;
+        uint16_t count;  // Inputs with data
+        uint8_t  hardMax;
+        uint8_t  softMax;
+        uint8_t  flags;
+        uint32_t seconds;  // Coarse only: seconds covered so far
+
+        void clear();
+        void add(const flow_sample_t &sample);
+        flow_sample_t result() const;
+    };
+
+    bool          running;
+    unsigned long startMs;
+    unsigned long lastCloseMs;  // End of the last closed second
+    uint32_t      closedSec;    // Seconds closed since begin()
+    Accumulator   second;       // Updates in second `closedSec`
+    Accumulator   pendingCoarse;
+    uint32_t      coarseInterval;
+
+    flow_sample_t fine[FLOW_HISTORY_FINE_SAMPLES];
+    uint16_t      fineHead;  // Next write position
+    uint16_t      fineSize;
+    flow_sample_t coarse[FLOW_HISTORY_COARSE_SAMPLES];
+    uint16_t      coarseSize;
+
+    void closeSecond(const flow_sample_t &sample);
+    void addGapSeconds(uint32_t seconds);
+    void pushFine(const flow_sample_t &sample);
+    void feedCoarse(const flow_sample_t &sample, uint32_t seconds);
+    void mergeCoarse();
+};
+
+template <typename Sink> void FlowHistory::encode(Sink &sink, unsigned long nowMs) const
+{
+    // Staged so the sink sees a few large writes rather than one per sample
+    uint8_t buffer[256];
+    size_t  used = encodeHeader(buffer, nowMs);
+
+    flow_sample_t previous = {0, 0, 0, 0, 0, 0};
+    for (uint32_t i = 0; i < (uint32_t) fineSize + coarseSize; i++)
+    {
+        if (i == fineSize)
+        {
+            previous = flow_sample_t{0, 0, 0, 0, 0, 0};  // Each series starts from zero
+        }
+        flow_sample_t sample = i < fineSize ? fineSample(i) : coarse[i - fineSize];
+        if (used + FLOW_HISTORY_MAX_SAMPLE_BYTES > sizeof(buffer))
+        {
+            sink.write(buffer, used);
+            used = 0;
+        }
+        used += encodeSample(previous, sample, buffer + used);
+        previous = sample;
+    }
+    if (used > 0)
+    {
+        sink.write(buffer, used);
+    }
+}
+
+#endif  // FLOW_HISTORY_H
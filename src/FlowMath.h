@@ -0,0 +1,243 @@
+#ifndef FLOW_MATH_H
+#define FLOW_MATH_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * FlowMath - number types for the detection pipeline
+ *
+ * FilamentMotionSensor and JamDetector do their arithmetic through these
+ * types and helpers rather than on float directly. With FLOW_FIXED_POINT=1
+ * distances are integer micrometres and ratios Q16.16, so FPU-less RISC-V
+ * parts (ESP32-C3/C6) run the detection hot path on integer instructions
+ * instead of soft-float library calls. With 0 every helper is the plain
+ * float expression the code used before.
+ *
+ * Public interfaces stay in float mm; values are converted at the boundary.
+ * Both variants run against the same unit tests (see
+ * test/build_and_run_all_tests.sh).
+ */
+
+#ifndef FLOW_FIXED_POINT
+#define FLOW_FIXED_POINT 0
+#endif
+
+#if FLOW_FIXED_POINT
+
+typedef int32_t flow_mm_t;     // Micrometres (+-2147 m)
+typedef int32_t flow_ratio_t;  // Q16.16
+
+static const flow_ratio_t FLOW_RATIO_ONE = 65536;
+
+// Compile-time constants (evaluated by the compiler, never at runtime)
+constexpr flow_mm_t flowMmConst(double mm)
+{
+    return static_cast<flow_mm_t>(mm * 1000.0 + (mm >= 0.0 ? 0.5 : -0.5));
+}
+constexpr flow_ratio_t flowRatioConst(double ratio)
+{
+    return static_cast<flow_ratio_t>(ratio * 65536.0 + (ratio >= 0.0 ? 0.5 : -0.5));
+}
+
+inline flow_mm_t flowFromMm(float mm)
+{
+    return static_cast<flow_mm_t>(mm * 1000.0f + (mm >= 0.0f ? 0.5f : -0.5f));
+}
+inline float flowToMm(flow_mm_t value) { return value * 0.001f; }
+
+inline flow_ratio_t flowRatioFromFloat(float ratio)
+{
+    return static_cast<flow_ratio_t>(ratio * 65536.0f + (ratio >= 0.0f ? 0.5f : -0.5f));
+}
+inline float flowRatioToFloat(flow_ratio_t ratio) { return ratio * (1.0f / 65536.0f); }
+
+// num / den as a ratio; den must be > 0
+inline flow_ratio_t flowRatio(flow_mm_t num, flow_mm_t den)
+{
+    return static_cast<flow_ratio_t>((static_cast<int64_t>(num) << 16) / den);
+}
+
+// Distance covered in durationMs as a per-second rate; durationMs must be > 0
+inline flow_mm_t flowPerSecond(flow_mm_t distance, unsigned long durationMs)
+{
+    return static_cast<flow_mm_t>(static_cast<int64_t>(distance) * 1000 /
+                                  static_cast<int64_t>(durationMs));
+}
+
+// Distance covered in durationMs at a per-second rate
+inline flow_mm_t flowOverMs(flow_mm_t ratePerSec, unsigned long durationMs)
+{
+    return static_cast<flow_mm_t>(static_cast<int64_t>(ratePerSec) *
+                                  static_cast<int64_t>(durationMs) / 1000);
+}
+
+// alpha * sample + (1 - alpha) * previous
+inline flow_ratio_t flowEwma(flow_ratio_t previous, flow_ratio_t sample, flow_ratio_t alpha)
+{
+    int64_t mixed = static_cast<int64_t>(alpha) * sample +
+                    static_cast<int64_t>(FLOW_RATIO_ONE - alpha) * previous;
+    return static_cast<flow_ratio_t>(mixed >> 16);
+}
+
+// 100 * part / whole as a float percentage; whole must be > 0
+inline float flowPercent(unsigned long part, unsigned long whole)
+{
+    return flowRatioToFloat(static_cast<flow_ratio_t>((static_cast<uint64_t>(part) * 100 << 16) / whole));
+}
+
+// a * b for two ratios
+inline flow_ratio_t flowRatioMul(flow_ratio_t a, flow_ratio_t b)
+{
+    return static_cast<flow_ratio_t>((static_cast<int64_t>(a) * b) >> 16);
+}
+
+/**
+ * Running mean / standard deviation of flow_mm_t or flow_ratio_t samples
+ * in constant memory. Welford's update divides every step, which loses
+ * the small deltas once the count is large in integer arithmetic, so the
+ * fixed-point variant keeps exact 64-bit sums instead: integer sums have
+ * no cancellation error, and they cannot overflow for values below ~10^6
+ * units over a print's worth of samples.
+ */
+struct flow_stats_t
+{
+    uint32_t count;
+    int64_t  sum;
+    int64_t  sumSquares;
+};
+
+inline void flowStatsReset(flow_stats_t &stats)
+{
+    stats.count      = 0;
+    stats.sum        = 0;
+    stats.sumSquares = 0;
+}
+
+inline void flowStatsAdd(flow_stats_t &stats, int32_t sample)
+{
+    stats.count++;
+    stats.sum += sample;
+    stats.sumSquares += static_cast<int64_t>(sample) * sample;
+}
+
+inline int32_t flowStatsMean(const flow_stats_t &stats)
+{
+    return stats.count ? static_cast<int32_t>(stats.sum / static_cast<int64_t>(stats.count)) : 0;
+}
+
+// Sample standard deviation (0 until two samples)
+inline int32_t flowStatsStdDev(const flow_stats_t &stats)
+{
+    if (stats.count < 2)
+    {
+        return 0;
+    }
+    int64_t mean     = stats.sum / static_cast<int64_t>(stats.count);
+    int64_t variance = (stats.sumSquares - mean * stats.sum) / static_cast<int64_t>(stats.count - 1);
+    if (variance <= 0)
+    {
+        return 0;
+    }
+
+    // Integer square root, bit by bit
+    uint64_t remainder = static_cast<uint64_t>(variance);
+    uint64_t root      = 0;
+    uint64_t bit       = 1ULL << 62;
+    while (bit > remainder)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (remainder >= root + bit)
+        {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<int32_t>(root);
+}
+
+#else  // Float
+
+typedef float flow_mm_t;
+typedef float flow_ratio_t;
+
+static const flow_ratio_t FLOW_RATIO_ONE = 1.0f;
+
+constexpr flow_mm_t    flowMmConst(double mm) { return static_cast<float>(mm); }
+constexpr flow_ratio_t flowRatioConst(double ratio) { return static_cast<float>(ratio); }
+
+inline flow_mm_t    flowFromMm(float mm) { return mm; }
+inline float        flowToMm(flow_mm_t value) { return value; }
+inline flow_ratio_t flowRatioFromFloat(float ratio) { return ratio; }
+inline float        flowRatioToFloat(flow_ratio_t ratio) { return ratio; }
+
+inline flow_ratio_t flowRatio(flow_mm_t num, flow_mm_t den) { return num / den; }
+
+inline flow_mm_t flowPerSecond(flow_mm_t distance, unsigned long durationMs)
+{
+    float durationSec = durationMs / 1000.0f;
+    return distance / durationSec;
+}
+
+inline flow_mm_t flowOverMs(flow_mm_t ratePerSec, unsigned long durationMs)
+{
+    return ratePerSec * (durationMs / 1000.0f);
+}
+
+inline flow_ratio_t flowEwma(flow_ratio_t previous, flow_ratio_t sample, flow_ratio_t alpha)
+{
+    return alpha * sample + (1.0f - alpha) * previous;
+}
+
+inline float flowPercent(unsigned long part, unsigned long whole)
+{
+    return 100.0f * static_cast<float>(part) / static_cast<float>(whole);
+}
+
+inline flow_ratio_t flowRatioMul(flow_ratio_t a, flow_ratio_t b) { return a * b; }
+
+// Welford's running mean / variance
+struct flow_stats_t
+{
+    uint32_t count;
+    float    mean;
+    float    m2;  // Sum of squared deviations from the mean
+};
+
+inline void flowStatsReset(flow_stats_t &stats)
+{
+    stats.count = 0;
+    stats.mean  = 0.0f;
+    stats.m2    = 0.0f;
+}
+
+inline void flowStatsAdd(flow_stats_t &stats, float sample)
+{
+    stats.count++;
+    float delta = sample - stats.mean;
+    stats.mean += delta / static_cast<float>(stats.count);
+    stats.m2 += delta * (sample - stats.mean);
+}
+
+inline float flowStatsMean(const flow_stats_t &stats) { return stats.mean; }
+
+inline float flowStatsStdDev(const flow_stats_t &stats)
+{
+    if (stats.count < 2 || stats.m2 <= 0.0f)
+    {
+        return 0.0f;
+    }
+    return sqrtf(stats.m2 / static_cast<float>(stats.count - 1));
+}
+
+#endif  // FLOW_FIXED_POINT
+
+#endif  // FLOW_MATH_H
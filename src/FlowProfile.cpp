@@ -0,0 +1,245 @@
+#include "FlowProfile.h"
+
+#include <string.h>
+
+#include "LockProfiler.h"
+
+namespace
+{
+const char *baseName(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+}  // namespace
+
+FlowProfile &FlowProfile::getInstance()
+{
+    static FlowProfile instance;
+    return instance;
+}
+
+FlowProfile::FlowProfile()
+{
+    loaded    = false;
+    pageFirst = 0;
+    pageCount = 0;
+    infoMutex = portMUX_INITIALIZER_UNLOCKED;
+    LOCK_PROFILE_NAME(&infoMutex, "FlowProfile::infoMutex");
+    memset(&header, 0, sizeof(header));
+}
+
+bool FlowProfile::validateFile(const char *path, flow_profile_header_t *headerOut)
+{
+    File candidate = LittleFS.open(path, "r");
+    if (!candidate)
+    {
+        return false;
+    }
+
+    flow_profile_header_t fileHeader;
+    bool valid = candidate.read(reinterpret_cast<uint8_t *>(&fileHeader), sizeof(fileHeader)) ==
+                 sizeof(fileHeader);
+    size_t fileSize = candidate.size();
+    candidate.close();
+
+    valid = valid && fileHeader.magic == FLOW_PROFILE_MAGIC &&
+            fileHeader.version == FLOW_PROFILE_VERSION &&
+            fileHeader.headerBytes >= sizeof(fileHeader) && fileHeader.msPerTick > 0 &&
+            fileHeader.ticksPerEntry > 0 && fileHeader.entryCount >= 2 &&
+            fileHeader.entryCount <= FLOW_PROFILE_MAX_ENTRIES &&
+            fileSize == fileHeader.headerBytes + fileHeader.entryCount * sizeof(uint32_t);
+    if (valid && headerOut != nullptr)
+    {
+        fileHeader.filename[sizeof(fileHeader.filename) - 1] = '\0';
+        *headerOut = fileHeader;
+    }
+    return valid;
+}
+
+bool FlowProfile::begin()
+{
+    return open();
+}
+
+bool FlowProfile::open()
+{
+    close();
+
+    flow_profile_header_t fileHeader;
+    if (!validateFile(FLOW_PROFILE_PATH, &fileHeader))
+    {
+        return false;
+    }
+    file = LittleFS.open(FLOW_PROFILE_PATH, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&infoMutex);
+    header = fileHeader;
+    loaded = true;
+    portEXIT_CRITICAL(&infoMutex);
+    return true;
+}
+
+void FlowProfile::close()
+{
+    if (file)
+    {
+        file.close();
+    }
+    portENTER_CRITICAL(&infoMutex);
+    loaded = false;
+    portEXIT_CRITICAL(&infoMutex);
+    pageCount = 0;
+}
+
+bool FlowProfile::install(const char *uploadPath)
+{
+    if (!validateFile(uploadPath))
+    {
+        LittleFS.remove(uploadPath);
+        return false;
+    }
+
+    close();
+    LittleFS.remove(FLOW_PROFILE_PATH);
+    if (!LittleFS.rename(uploadPath, FLOW_PROFILE_PATH))
+    {
+        LittleFS.remove(uploadPath);
+        return false;
+    }
+    return open();
+}
+
+void FlowProfile::clear()
+{
+    close();
+    LittleFS.remove(FLOW_PROFILE_PATH);
+}
+
+bool FlowProfile::matches(const char *printFilename) const
+{
+    if (!loaded)
+    {
+        return false;
+    }
+    if (header.filename[0] == '\0')
+    {
+        return true;
+    }
+    return printFilename != nullptr &&
+           strcmp(baseName(header.filename), baseName(printFilename)) == 0;
+}
+
+bool FlowProfile::entryAt(uint32_t index, uint32_t &um)
+{
+    if (index >= header.entryCount)
+    {
+        return false;
+    }
+
+    if (pageCount == 0 || index < pageFirst || index >= pageFirst + pageCount)
+    {
+        // Lookups walk forward, so the page starts at the requested entry
+        uint32_t count = header.entryCount - index;
+        if (count > FLOW_PROFILE_PAGE_ENTRIES)
+        {
+            count = FLOW_PROFILE_PAGE_ENTRIES;
+        }
+        size_t bytes = count * sizeof(uint32_t);
+        pageCount    = 0;
+        if (!file.seek(header.headerBytes + index * sizeof(uint32_t)) ||
+            file.read(reinterpret_cast<uint8_t *>(page), bytes) != bytes)
+        {
+            return false;
+        }
+        pageFirst = index;
+        pageCount = count;
+    }
+
+    um = page[index - pageFirst];
+    return true;
+}
+
+bool FlowProfile::expectedAt(uint32_t ticks, float &mm)
+{
+    if (!loaded)
+    {
+        return false;
+    }
+
+    uint32_t index = ticks / header.ticksPerEntry;
+    uint32_t lowUm = 0;
+    if (!entryAt(index, lowUm))
+    {
+        return false;
+    }
+
+    uint32_t offset = ticks % header.ticksPerEntry;
+    uint32_t highUm = lowUm;
+    if (offset != 0 && entryAt(index + 1, highUm))
+    {
+        float fraction = static_cast<float>(offset) / static_cast<float>(header.ticksPerEntry);
+        mm = (lowUm + (static_cast<float>(highUm) - lowUm) * fraction) * 0.001f;
+        return true;
+    }
+    mm = lowUm * 0.001f;
+    return true;
+}
+
+bool FlowProfile::rateAt(uint32_t ticks, uint32_t horizonMs, float &mmPerSecond)
+{
+    uint32_t lastTick = (header.entryCount - 1) * header.ticksPerEntry;
+    if (!loaded || ticks >= lastTick)
+    {
+        return false;
+    }
+
+    uint32_t horizonTicks = (horizonMs + header.msPerTick - 1) / header.msPerTick;
+    if (horizonTicks == 0)
+    {
+        horizonTicks = 1;
+    }
+
+    float startMm = 0;
+    float endMm   = 0;
+    if (!expectedAt(ticks, startMm))
+    {
+        return false;
+    }
+    // Near the end of the profile the horizon shrinks to what is left
+    if (ticks + horizonTicks > lastTick)
+    {
+        horizonTicks = lastTick - ticks;
+    }
+    if (!expectedAt(ticks + horizonTicks, endMm))
+    {
+        return false;
+    }
+
+    // Retractions in the profile never predict negative flow
+    float deltaMm = endMm - startMm;
+    mmPerSecond   = deltaMm > 0 ? deltaMm * 1000.0f / (horizonTicks * header.msPerTick) : 0;
+    return true;
+}
+
+void FlowProfile::getInfo(flow_profile_info_t &out)
+{
+    portENTER_CRITICAL(&infoMutex);
+    out.loaded        = loaded;
+    out.entryCount    = loaded ? header.entryCount : 0;
+    out.msPerTick     = loaded ? header.msPerTick : 0;
+    out.ticksPerEntry = loaded ? header.ticksPerEntry : 0;
+    if (loaded)
+    {
+        memcpy(out.filename, header.filename, sizeof(out.filename));
+    }
+    else
+    {
+        out.filename[0] = '\0';
+    }
+    portEXIT_CRITICAL(&infoMutex);
+}
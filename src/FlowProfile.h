@@ -0,0 +1,129 @@
+#ifndef FLOW_PROFILE_H
+#define FLOW_PROFILE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+/**
+ * FlowProfile - precomputed expected extrusion for the current print
+ *
+ * A profile is generated from the G-code ahead of the print
+ * (tools/gcode_flow_sim.py --profile-out) and uploaded to
+ * POST /api/flow_profile. It lists the cumulative expected extrusion at
+ * every ticksPerEntry SDCP CurrentTicks, so the expected flow over the next
+ * second is known before the printer reports it. ElegooCC feeds that rate
+ * to the motion sensor's predictive mode in place of the rate of the last
+ * sample interval, which stops prediction for travel and retraction
+ * sequences instead of extrapolating through them.
+ *
+ * File layout (little endian):
+ *   flow_profile_header_t
+ *   uint32_t expectedUm[entryCount]   Cumulative expected extrusion (um)
+ *
+ * LittleFS has no mmap, so the file stays open and entries are read a
+ * FLOW_PROFILE_PAGE_ENTRIES page at a time; a lookup near the current
+ * position is answered from RAM and touches flash about once per page.
+ *
+ * Lookups and install()/clear() belong to the main task; getInfo() is safe
+ * from any task.
+ */
+
+#ifndef FLOW_PROFILE_PATH
+#define FLOW_PROFILE_PATH "/flow_profile.bin"
+#endif
+
+// Upload target; swapped in by install() once complete
+#ifndef FLOW_PROFILE_UPLOAD_PATH
+#define FLOW_PROFILE_UPLOAD_PATH "/flow_profile.tmp"
+#endif
+
+// 256 KB of entries: ~18 h of print at one entry per second
+#ifndef FLOW_PROFILE_MAX_ENTRIES
+#define FLOW_PROFILE_MAX_ENTRIES 65536
+#endif
+
+// Entries cached in RAM (4 bytes each)
+#ifndef FLOW_PROFILE_PAGE_ENTRIES
+#define FLOW_PROFILE_PAGE_ENTRIES 64
+#endif
+
+static const uint32_t FLOW_PROFILE_MAGIC   = 0x46525046;  // "FPRF" on disk
+static const uint16_t FLOW_PROFILE_VERSION = 1;
+
+struct __attribute__((packed)) flow_profile_header_t
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerBytes;    // Offset of the first entry (newer headers may grow)
+    uint32_t msPerTick;      // Duration of one CurrentTicks step
+    uint32_t ticksPerEntry;  // Ticks between consecutive entries
+    uint32_t entryCount;
+    char     filename[64];   // Print this profile belongs to ("" = any print)
+};
+
+struct flow_profile_info_t
+{
+    bool     loaded;
+    uint32_t entryCount;
+    uint32_t msPerTick;
+    uint32_t ticksPerEntry;
+    char     filename[64];
+};
+
+class FlowProfile
+{
+  public:
+    static FlowProfile &getInstance();
+
+    // Open the stored profile, if any. Call after LittleFS is mounted.
+    bool begin();
+
+    /**
+     * Replace the profile with an uploaded file. An invalid upload is
+     * deleted and the current profile kept. Returns true if installed.
+     */
+    bool install(const char *uploadPath);
+
+    // Delete the stored profile
+    void clear();
+
+    bool isLoaded() const { return loaded; }
+
+    // Whether the profile belongs to the print with this SDCP filename
+    bool matches(const char *printFilename) const;
+
+    /**
+     * Expected extrusion rate (mm/s) over horizonMs starting at `ticks`.
+     * Returns false past the end of the profile or when none is loaded.
+     */
+    bool rateAt(uint32_t ticks, uint32_t horizonMs, float &mmPerSecond);
+
+    // Cumulative expected extrusion (mm) at `ticks`, interpolated between entries
+    bool expectedAt(uint32_t ticks, float &mm);
+
+    void getInfo(flow_profile_info_t &out);
+
+    // Header and size check of a profile file (any task)
+    static bool validateFile(const char *path, flow_profile_header_t *headerOut = nullptr);
+
+  private:
+    FlowProfile();
+    FlowProfile(const FlowProfile &) = delete;
+    FlowProfile &operator=(const FlowProfile &) = delete;
+
+    File                  file;
+    bool                  loaded;
+    flow_profile_header_t header;
+    uint32_t              page[FLOW_PROFILE_PAGE_ENTRIES];
+    uint32_t              pageFirst;  // Index of page[0]
+    uint32_t              pageCount;  // Valid entries in page (0 = empty)
+    portMUX_TYPE          infoMutex;
+
+    bool open();
+    void close();
+    bool entryAt(uint32_t index, uint32_t &um);
+};
+
+#define flowProfile FlowProfile::getInstance()
+
+#endif  // FLOW_PROFILE_H
@@ -1,35 +1,44 @@
 #include "JamDetector.h"
 #include "Logger.h"
-#include "SettingsManager.h"
 
 // Global singletons (provided elsewhere)
 
 namespace
 {
     // Minimum windowed distance before we even try to declare a jam.
-    constexpr float MIN_HARD_WINDOW_MM       = 10.0f;
-    constexpr float MIN_SOFT_WINDOW_MM       = 8.0f;
-    constexpr float MIN_SOFT_DEFICIT_MM      = 4.0f;
+    constexpr flow_mm_t MIN_HARD_WINDOW_MM       = flowMmConst(10.0);
+    constexpr flow_mm_t MIN_SOFT_WINDOW_MM       = flowMmConst(8.0);
+    constexpr flow_mm_t MIN_SOFT_DEFICIT_MM      = flowMmConst(4.0);
 
     // For rate-based detection (mm/s)
-    constexpr float MIN_EXPECTED_RATE_MM_S   = 0.4f;   // below this we consider it not really extruding
-    constexpr float MIN_RATE_FOR_RATIO_MM_S  = 0.2f;   // below this we just treat ratio as 1.0
-    constexpr float MIN_ACTUAL_RATE_MM_S     = 0.05f;  // basically no movement
+    constexpr flow_mm_t MIN_EXPECTED_RATE_MM_S   = flowMmConst(0.4);   // below this we consider it not really extruding
+    constexpr flow_mm_t MIN_RATE_FOR_RATIO_MM_S  = flowMmConst(0.2);   // below this we just treat ratio as 1.0
+    constexpr flow_mm_t MIN_ACTUAL_RATE_MM_S     = flowMmConst(0.05);  // basically no movement
+    constexpr flow_mm_t LOW_SPEED_RATE_MM_S      = flowMmConst(1.0);   // low-speed diagnostic band
 
-    constexpr float HARD_RATE_RATIO          = 0.25f;  // hard jam if sensor < 25% of expected
-    constexpr float HARD_RECOVERY_RATIO      = 0.75f;  // recovery once >= 75% of expected rate
+    constexpr flow_ratio_t HARD_RATE_RATIO       = flowRatioConst(0.25);  // hard jam if sensor < 25% of expected
+    constexpr flow_ratio_t HARD_RECOVERY_RATIO   = flowRatioConst(0.75);  // recovery once >= 75% of expected rate
+    constexpr flow_ratio_t MAX_PASS_RATIO        = flowRatioConst(1.5);
 
     // Smoothed "how bad is the deficit" purely for UI
-    constexpr float RATIO_SMOOTHING_ALPHA    = 0.08f;
+    constexpr flow_ratio_t RATIO_SMOOTHING_ALPHA = flowRatioConst(0.08);
+    constexpr flow_mm_t    MIN_RATIO_WINDOW_MM   = flowMmConst(1.0);
 
     // Resume grace: disable detection until we have moved enough again
-    constexpr float         RESUME_GRACE_15MM_THRESHOLD = 15.0f;  // ~15mm expected extrusion after resume
+    constexpr flow_mm_t     RESUME_GRACE_15MM_THRESHOLD = flowMmConst(15.0);  // ~15mm expected extrusion after resume
     constexpr unsigned long RESUME_MIN_PULSES           = 5;      // or a few pulses, whichever comes first
 
     // We do not let dt explode; caps keep rates reasonably stable
     constexpr unsigned long MAX_EVAL_INTERVAL_MS        = 1000;
     constexpr unsigned long DEFAULT_EVAL_INTERVAL_MS    = 1000;
     constexpr bool          USE_WINDOWED_RATE_SAMPLES   = true;
+
+    // Baseline learning: expected-rate band upper edges (mm/s); the last band is open
+    constexpr flow_mm_t     BASELINE_BAND_EDGES_MM_S[]  = {flowMmConst(2.0), flowMmConst(5.0), flowMmConst(10.0)};
+    constexpr unsigned long BASELINE_SAMPLE_INTERVAL_MS = 500;   // same weight at 4 Hz and 10 Hz evaluation
+    constexpr uint32_t      BASELINE_MIN_SAMPLES        = 12;    // ~6s in the band, inside the default soft jam time
+    constexpr int32_t       BASELINE_SIGMAS             = 3;     // normal spread tolerated below the mean
+    constexpr flow_ratio_t  ADAPTIVE_MIN_RATIO          = HARD_RATE_RATIO;  // below this it is a hard jam
 }
 
 JamDetector::JamDetector()
@@ -50,22 +59,33 @@ void JamDetector::reset(unsigned long currentTimeMs)
     state.deficit              = 0.0f;
     state.expectedRateMmPerSec = 0.0f;
     state.actualRateMmPerSec   = 0.0f;
+    state.deficitRatio         = 0.0f;
     state.graceState           = GraceState::IDLE;
     state.graceActive          = false;
     state.tripCode             = TripCode::NONE;
+    state.softJamThreshold     = 0.0f;
 
     hardJamAccumulatedMs       = 0;
     softJamAccumulatedMs       = 0;
     lastEvalMs                 = 0;
     lastPulseCount             = 0;
     resumeGracePulseBaseline   = 0;
-    resumeGraceActualBaseline  = 0.0f;
+    resumeGraceActualBaseline  = 0;
     resumeGraceStartTimeMs     = 0;
-    prevExpectedDistance       = 0.0f;
-    prevActualDistance         = 0.0f;
+    tripOnsetMs                = 0;
+    jamDetectedMs              = 0;
+    prevExpectedDistance       = 0;
+    prevActualDistance         = 0;
     jamPauseRequested          = false;
     wasInGrace                 = false;
-    smoothedDeficitRatio       = 0.0f;
+    smoothedDeficitRatio       = 0;
+    lastBaselineSampleMs       = 0;
+
+    for (uint8_t i = 0; i < BASELINE_BANDS; i++)
+    {
+        flowStatsReset(baselines[i].passRatio);
+        flowStatsReset(baselines[i].expectedRate);
+    }
 }
 
 void JamDetector::onResume(unsigned long currentTimeMs,
@@ -76,7 +96,7 @@ void JamDetector::onResume(unsigned long currentTimeMs,
     state.graceActive = true;
 
     resumeGracePulseBaseline  = currentPulseCount;
-    resumeGraceActualBaseline = currentActualMm;
+    resumeGraceActualBaseline = flowFromMm(currentActualMm);
     resumeGraceStartTimeMs    = currentTimeMs;
 
     // Clear existing jam accumulation so we do not instantly re-trigger
@@ -87,6 +107,8 @@ void JamDetector::onResume(unsigned long currentTimeMs,
     state.jammed           = false;
     state.hardJamTriggered = false;
     state.softJamTriggered = false;
+    tripOnsetMs            = 0;
+    jamDetectedMs          = 0;
 
     // Clear pause request flag so future jams can be detected
     jamPauseRequested = false;
@@ -94,7 +116,7 @@ void JamDetector::onResume(unsigned long currentTimeMs,
 
 bool JamDetector::evaluateGraceState(unsigned long currentTimeMs,
                                      unsigned long printStartTimeMs,
-                                     float         expectedDistance,
+                                     flow_mm_t     expectedDistance,
                                      unsigned long movementPulseCount,
                                      const JamConfig& config)
 {
@@ -154,10 +176,10 @@ bool JamDetector::evaluateGraceState(unsigned long currentTimeMs,
     return false;
 }
 
-bool JamDetector::evaluateHardJam(float         expectedDistance,
-                                  float         passRatio,
-                                  float         expectedRate,
-                                  float         actualRate,
+bool JamDetector::evaluateHardJam(flow_mm_t     expectedDistance,
+                                  flow_ratio_t  passRatio,
+                                  flow_mm_t     expectedRate,
+                                  flow_mm_t     actualRate,
                                   unsigned long elapsedMs,
                                   const JamConfig& config)
 {
@@ -176,7 +198,7 @@ bool JamDetector::evaluateHardJam(float         expectedDistance,
 
     // Detect low-speed edge case for diagnostics
     bool lowSpeedEdgeCase = extrudingNow && 
-                            (expectedRate < 1.0f) && 
+                            (expectedRate < LOW_SPEED_RATE_MM_S) && 
                             (actualRate < MIN_ACTUAL_RATE_MM_S);
 
     if (hardCondition)
@@ -188,19 +210,21 @@ bool JamDetector::evaluateHardJam(float         expectedDistance,
         }
 
         // Diagnostic logging for hard jam conditions
-        if (settingsManager.getVerboseLogging())
+        if (config.verboseLogging)
         {
             if (actualRate < MIN_ACTUAL_RATE_MM_S)
             {
                 state.tripCode = TripCode::HARD_ZERO_FLOW;
-                logger.logf("JAM_DEBUG: hard_cond=1 type=ZERO_FLOW exp_rate=%.3f act_rate=%.3f pass=%.2f exp_dist=%.1f accum_ms=%u",
-                            expectedRate, actualRate, passRatio, expectedDistance, hardJamAccumulatedMs);
+                logger.logDeferred(LOG_NORMAL, "JAM_DEBUG: hard_cond=1 type=ZERO_FLOW exp_rate=%.3f act_rate=%.3f pass=%.2f exp_dist=%.1f accum_ms=%u",
+                                   flowToMm(expectedRate), flowToMm(actualRate), flowRatioToFloat(passRatio),
+                                   flowToMm(expectedDistance), hardJamAccumulatedMs);
             }
             else
             {
                 state.tripCode = TripCode::HARD_RATE_RATIO;
-                logger.logf("JAM_DEBUG: hard_cond=1 type=RATE_RATIO exp_rate=%.3f act_rate=%.3f pass=%.2f exp_dist=%.1f accum_ms=%u",
-                            expectedRate, actualRate, passRatio, expectedDistance, hardJamAccumulatedMs);
+                logger.logDeferred(LOG_NORMAL, "JAM_DEBUG: hard_cond=1 type=RATE_RATIO exp_rate=%.3f act_rate=%.3f pass=%.2f exp_dist=%.1f accum_ms=%u",
+                                   flowToMm(expectedRate), flowToMm(actualRate), flowRatioToFloat(passRatio),
+                                   flowToMm(expectedDistance), hardJamAccumulatedMs);
             }
         }
     }
@@ -213,19 +237,18 @@ bool JamDetector::evaluateHardJam(float         expectedDistance,
         }
 
         // Log low-speed edge cases for analysis (even when not triggering jam)
-        if (lowSpeedEdgeCase && settingsManager.getVerboseLogging())
+        if (lowSpeedEdgeCase && config.verboseLogging)
         {
             state.tripCode = TripCode::LOW_SPEED_ANOMALY;
-            logger.logf("LOW_SPEED_TRIP: exp_rate=%.3f act_rate=%.3f pass=%.2f accum_ms=%u (not triggering - pass_ratio ok)",
-                        expectedRate, actualRate, passRatio, hardJamAccumulatedMs);
+            logger.logDeferred(LOG_NORMAL, "LOW_SPEED_TRIP: exp_rate=%.3f act_rate=%.3f pass=%.2f accum_ms=%u (not triggering - pass_ratio ok)",
+                               flowToMm(expectedRate), flowToMm(actualRate), flowRatioToFloat(passRatio),
+                               hardJamAccumulatedMs);
         }
     }
 
     if (config.hardJamTimeMs > 0)
     {
-        state.hardJamPercent =
-            (100.0f * static_cast<float>(hardJamAccumulatedMs) /
-             static_cast<float>(config.hardJamTimeMs));
+        state.hardJamPercent = flowPercent(hardJamAccumulatedMs, config.hardJamTimeMs);
     }
     else
     {
@@ -235,11 +258,12 @@ bool JamDetector::evaluateHardJam(float         expectedDistance,
     return (hardJamAccumulatedMs >= config.hardJamTimeMs);
 }
 
-bool JamDetector::evaluateSoftJam(float         expectedDistance,
-                                  float         deficit,
-                                  float         passRatio,
-                                  float         expectedRate,
-                                  float         actualRate,
+bool JamDetector::evaluateSoftJam(flow_mm_t     expectedDistance,
+                                  flow_mm_t     deficit,
+                                  flow_ratio_t  passRatio,
+                                  flow_mm_t     expectedRate,
+                                  flow_mm_t     actualRate,
+                                  flow_ratio_t  ratioThreshold,
                                   unsigned long elapsedMs,
                                   const JamConfig& config)
 {
@@ -252,7 +276,7 @@ bool JamDetector::evaluateSoftJam(float         expectedDistance,
         extrudingNow &&
         (expectedDistance >= MIN_SOFT_WINDOW_MM) &&
         (deficit >= MIN_SOFT_DEFICIT_MM) &&
-        (passRatio < config.ratioThreshold);
+        (passRatio < ratioThreshold);
 
     if (softCondition)
     {
@@ -263,11 +287,12 @@ bool JamDetector::evaluateSoftJam(float         expectedDistance,
         }
 
         // Diagnostic logging for soft jam conditions
-        if (settingsManager.getVerboseLogging())
+        if (config.verboseLogging)
         {
             state.tripCode = TripCode::SOFT_UNDER_EXT;
-            logger.logf("JAM_DEBUG: soft_cond=1 type=UNDER_EXT exp_rate=%.3f act_rate=%.3f pass=%.2f deficit=%.2f accum_ms=%u",
-                        expectedRate, actualRate, passRatio, deficit, softJamAccumulatedMs);
+            logger.logDeferred(LOG_NORMAL, "JAM_DEBUG: soft_cond=1 type=UNDER_EXT exp_rate=%.3f act_rate=%.3f pass=%.2f thr=%.2f deficit=%.2f accum_ms=%u",
+                               flowToMm(expectedRate), flowToMm(actualRate), flowRatioToFloat(passRatio),
+                               flowRatioToFloat(ratioThreshold), flowToMm(deficit), softJamAccumulatedMs);
         }
     }
     else
@@ -288,7 +313,7 @@ bool JamDetector::evaluateSoftJam(float         expectedDistance,
                 softJamAccumulatedMs = 0;
             }
         }
-        else if (passRatio >= config.ratioThreshold)
+        else if (passRatio >= ratioThreshold)
         {
             // Flow is healthy (above threshold) - decay at 1x rate
             if (softJamAccumulatedMs > elapsedMs)
@@ -306,9 +331,7 @@ bool JamDetector::evaluateSoftJam(float         expectedDistance,
 
     if (config.softJamTimeMs > 0)
     {
-        state.softJamPercent =
-            (100.0f * static_cast<float>(softJamAccumulatedMs) /
-             static_cast<float>(config.softJamTimeMs));
+        state.softJamPercent = flowPercent(softJamAccumulatedMs, config.softJamTimeMs);
     }
     else
     {
@@ -318,8 +341,111 @@ bool JamDetector::evaluateSoftJam(float         expectedDistance,
     return (softJamAccumulatedMs >= config.softJamTimeMs);
 }
 
-JamState JamDetector::update(float         expectedDistance,
-                             float         actualDistance,
+uint8_t JamDetector::baselineBand(flow_mm_t expectedRate)
+{
+    uint8_t band = 0;
+    while (band < BASELINE_BANDS - 1 && expectedRate >= BASELINE_BAND_EDGES_MM_S[band])
+    {
+        band++;
+    }
+    return band;
+}
+
+flow_ratio_t JamDetector::softJamThreshold(flow_mm_t expectedRate, const JamConfig& config) const
+{
+    flow_ratio_t staticThreshold = flowRatioFromFloat(config.ratioThreshold);
+    if (!config.adaptiveSoftJam)
+    {
+        return staticThreshold;
+    }
+
+    const flow_stats_t &learned = baselines[baselineBand(expectedRate)].passRatio;
+    if (learned.count < BASELINE_MIN_SAMPLES)
+    {
+        return staticThreshold;
+    }
+    return baselineThreshold(learned, staticThreshold);
+}
+
+flow_ratio_t JamDetector::baselineThreshold(const flow_stats_t &learned, flow_ratio_t staticThreshold)
+{
+    // ratioThreshold becomes a fraction of the learned pass ratio, widened
+    // to the band's normal spread when that is noisier
+    flow_ratio_t mean      = flowStatsMean(learned);
+    flow_ratio_t relative  = flowRatioMul(staticThreshold, mean);
+    flow_ratio_t spread    = mean - BASELINE_SIGMAS * flowStatsStdDev(learned);
+    flow_ratio_t threshold = (spread < relative) ? spread : relative;
+
+    if (threshold < ADAPTIVE_MIN_RATIO)
+    {
+        threshold = ADAPTIVE_MIN_RATIO;
+    }
+    if (threshold > staticThreshold)
+    {
+        threshold = staticThreshold;
+    }
+    return threshold;
+}
+
+void JamDetector::learnBaseline(flow_mm_t     expectedDistance,
+                                flow_ratio_t  passRatio,
+                                flow_mm_t     expectedRate,
+                                flow_ratio_t  staticThreshold,
+                                unsigned long currentTimeMs)
+{
+    // Any extruding flow that is not jammed, whatever the static threshold
+    // says: a print that runs steadily below it is exactly what the baseline
+    // is for, and censoring at it would bias the mean up and the spread down.
+    // Once a band has a baseline, samples below the threshold it supports
+    // are drops, not normal flow, so a developing clog is not learned.
+    bool healthy = (expectedRate >= MIN_EXPECTED_RATE_MM_S) &&
+                   (expectedDistance >= MIN_SOFT_WINDOW_MM) &&
+                   !state.jammed &&
+                   hardJamAccumulatedMs == 0;
+    if (!healthy ||
+        (lastBaselineSampleMs != 0 && currentTimeMs - lastBaselineSampleMs < BASELINE_SAMPLE_INTERVAL_MS))
+    {
+        return;
+    }
+
+    uint8_t       bandIndex = baselineBand(expectedRate);
+    BaselineBand &band      = baselines[bandIndex];
+    if (band.passRatio.count >= BASELINE_MIN_SAMPLES &&
+        passRatio < baselineThreshold(band.passRatio, staticThreshold))
+    {
+        return;
+    }
+    lastBaselineSampleMs = currentTimeMs;
+
+    flowStatsAdd(band.passRatio, passRatio);
+    flowStatsAdd(band.expectedRate, expectedRate);
+
+    if (band.passRatio.count == BASELINE_MIN_SAMPLES)
+    {
+        logger.logf("Flow baseline learned: band=%u rate=%.2f+-%.2f mm/s pass=%.2f+-%.2f",
+                    bandIndex,
+                    flowToMm(flowStatsMean(band.expectedRate)),
+                    flowToMm(flowStatsStdDev(band.expectedRate)),
+                    flowRatioToFloat(flowStatsMean(band.passRatio)),
+                    flowRatioToFloat(flowStatsStdDev(band.passRatio)));
+    }
+}
+
+FlowBaseline JamDetector::getBaseline(float expectedRateMmPerSec) const
+{
+    const BaselineBand &band = baselines[baselineBand(flowFromMm(expectedRateMmPerSec))];
+
+    FlowBaseline baseline;
+    baseline.samples            = band.passRatio.count;
+    baseline.passRatioMean      = flowRatioToFloat(flowStatsMean(band.passRatio));
+    baseline.passRatioStdDev    = flowRatioToFloat(flowStatsStdDev(band.passRatio));
+    baseline.expectedRateMean   = flowToMm(flowStatsMean(band.expectedRate));
+    baseline.expectedRateStdDev = flowToMm(flowStatsStdDev(band.expectedRate));
+    return baseline;
+}
+
+JamState JamDetector::update(float         expectedDistanceMm,
+                             float         actualDistanceMm,
                              unsigned long movementPulseCount,
                              bool          isPrinting,
                              bool          hasTelemetry,
@@ -329,6 +455,9 @@ JamState JamDetector::update(float         expectedDistance,
                              float         windowedExpectedRateMmPerSec,
                              float         windowedActualRateMmPerSec)
 {
+    flow_mm_t expectedDistance = flowFromMm(expectedDistanceMm);
+    flow_mm_t actualDistance   = flowFromMm(actualDistanceMm);
+
     // If not printing or no telemetry, reset to idle-ish state
     if (!isPrinting || !hasTelemetry)
     {
@@ -341,6 +470,8 @@ JamState JamDetector::update(float         expectedDistance,
             state.softJamTriggered = false;
             hardJamAccumulatedMs   = 0;
             softJamAccumulatedMs   = 0;
+            tripOnsetMs            = 0;
+            jamDetectedMs          = 0;
         }
 
         lastEvalMs               = currentTimeMs;
@@ -372,68 +503,69 @@ JamState JamDetector::update(float         expectedDistance,
     }
     lastEvalMs = currentTimeMs;
 
-    float expectedRate = 0.0f;
-    float actualRate   = 0.0f;
+    flow_mm_t expectedRate = 0;
+    flow_mm_t actualRate   = 0;
 
     if (!USE_WINDOWED_RATE_SAMPLES)
     {
         // First derivative: compute rates from windowed distances
-        float dtSec = static_cast<float>(elapsedMs) / 1000.0f;
-        float dExp  = expectedDistance - prevExpectedDistance;
-        float dAct  = actualDistance   - prevActualDistance;
+        flow_mm_t dExp = expectedDistance - prevExpectedDistance;
+        flow_mm_t dAct = actualDistance   - prevActualDistance;
 
         // Handle retractions / window resets: treat negative deltas as zero flow
-        if (dExp < 0.0f) dExp = 0.0f;
-        if (dAct < 0.0f) dAct = 0.0f;
+        if (dExp < 0) dExp = 0;
+        if (dAct < 0) dAct = 0;
 
-        expectedRate = (dtSec > 0.0f) ? (dExp / dtSec) : 0.0f;  // mm/s
-        actualRate   = (dtSec > 0.0f) ? (dAct / dtSec) : 0.0f;  // mm/s
+        expectedRate = flowPerSecond(dExp, elapsedMs);  // mm/s (elapsedMs >= 1)
+        actualRate   = flowPerSecond(dAct, elapsedMs);
 
         prevExpectedDistance = expectedDistance;
         prevActualDistance   = actualDistance;
     }
     else
     {
-        expectedRate        = windowedExpectedRateMmPerSec;
-        actualRate          = windowedActualRateMmPerSec;
+        expectedRate        = flowFromMm(windowedExpectedRateMmPerSec);
+        actualRate          = flowFromMm(windowedActualRateMmPerSec);
         prevExpectedDistance = expectedDistance;
         prevActualDistance   = actualDistance;
     }
 
     // Expose rates for callers / logging
-    state.expectedRateMmPerSec = expectedRate;
-    state.actualRateMmPerSec   = actualRate;
+    state.expectedRateMmPerSec = flowToMm(expectedRate);
+    state.actualRateMmPerSec   = flowToMm(actualRate);
 
     // Rate-based pass ratio
-    float passRatio;
+    flow_ratio_t passRatio;
     if (expectedRate > MIN_RATE_FOR_RATIO_MM_S)
     {
         // expectedRate is guaranteed > 0 here
-        passRatio = actualRate / expectedRate;
+        passRatio = flowRatio(actualRate, expectedRate);
     }
     else
     {
         // When flow is tiny, treat as OK to avoid noise on drip moves
-        passRatio = 1.0f;
+        passRatio = FLOW_RATIO_ONE;
     }
 
-    if (passRatio < 0.0f) passRatio = 0.0f;
-    if (passRatio > 1.5f) passRatio = 1.5f;
+    if (passRatio < 0) passRatio = 0;
+    if (passRatio > MAX_PASS_RATIO) passRatio = MAX_PASS_RATIO;
 
     // Distance-based deficit (still useful for UI + soft jam gating)
-    float deficit = expectedDistance - actualDistance;
-    if (deficit < 0.0f) deficit = 0.0f;
+    flow_mm_t deficit = expectedDistance - actualDistance;
+    if (deficit < 0) deficit = 0;
 
     // For UI: smooth a deficit ratio (distance-based) so the graph is not jumpy
-    float deficitRatioValue =
-        (expectedDistance > 1.0f) ? (deficit / expectedDistance) : 0.0f;
-    smoothedDeficitRatio =
-        RATIO_SMOOTHING_ALPHA * deficitRatioValue +
-        (1.0f - RATIO_SMOOTHING_ALPHA) * smoothedDeficitRatio;
+    flow_ratio_t deficitRatioValue =
+        (expectedDistance > MIN_RATIO_WINDOW_MM) ? flowRatio(deficit, expectedDistance) : 0;
+    smoothedDeficitRatio = flowEwma(smoothedDeficitRatio, deficitRatioValue, RATIO_SMOOTHING_ALPHA);
 
     // Update state metrics exposed externally
-    state.passRatio = passRatio;   // rate-based
-    state.deficit   = deficit;     // windowed (distance-based)
+    state.passRatio    = flowRatioToFloat(passRatio);             // rate-based
+    state.deficit      = flowToMm(deficit);                       // windowed (distance-based)
+    state.deficitRatio = flowRatioToFloat(smoothedDeficitRatio);  // windowed, smoothed
+
+    flow_ratio_t ratioThreshold = softJamThreshold(expectedRate, config);
+    state.softJamThreshold      = flowRatioToFloat(ratioThreshold);
 
     // Initialize grace state at print start if needed
     if (state.graceState == GraceState::IDLE)
@@ -458,6 +590,8 @@ JamState JamDetector::update(float         expectedDistance,
         state.jammed           = false;
         state.hardJamTriggered = false;
         state.softJamTriggered = false;
+        tripOnsetMs            = 0;
+        jamDetectedMs          = 0;
 
         wasInGrace = true;
         return state;
@@ -492,6 +626,7 @@ JamState JamDetector::update(float         expectedDistance,
                             passRatio,
                             expectedRate,
                             actualRate,
+                            ratioThreshold,
                             elapsedMs,
                             config);
     }
@@ -502,11 +637,35 @@ JamState JamDetector::update(float         expectedDistance,
         state.softJamTriggered = false;
     }
 
+    learnBaseline(expectedDistance, passRatio, expectedRate, flowRatioFromFloat(config.ratioThreshold),
+                  currentTimeMs);
+
     bool wasJammed = state.jammed;
     state.jammed   = state.hardJamTriggered || state.softJamTriggered;
 
+    // Latency stages: an episode starts with the first accumulating
+    // evaluation and ends when both accumulators have drained
+    bool accumulating = hardJamAccumulatedMs > 0 || softJamAccumulatedMs > 0;
+    if (accumulating && tripOnsetMs == 0)
+    {
+        tripOnsetMs = currentTimeMs;
+    }
+    else if (!accumulating && !state.jammed)
+    {
+        tripOnsetMs   = 0;
+        jamDetectedMs = 0;
+    }
+    if (state.jammed && !wasJammed)
+    {
+        jamDetectedMs = currentTimeMs;
+        if (tripOnsetMs == 0)
+        {
+            tripOnsetMs = currentTimeMs;  // Zero-time thresholds trip on the first evaluation
+        }
+    }
+
     // Logging on jam transitions (kept conservative to avoid spam)
-    if (state.jammed && !wasJammed && settingsManager.getVerboseLogging())
+    if (state.jammed && !wasJammed && config.verboseLogging)
     {
         const char* jamType = "soft";
         if (state.hardJamTriggered && state.softJamTriggered)
@@ -521,14 +680,15 @@ JamState JamDetector::update(float         expectedDistance,
         logger.logf(
             "Filament jam detected (%s)! "
             "win_exp=%.2f win_sns=%.2f deficit=%.2f "
-            "rate_exp=%.3f rate_sns=%.3f pass=%.2f",
+            "rate_exp=%.3f rate_sns=%.3f pass=%.2f thr=%.2f",
             jamType,
-            expectedDistance,
-            actualDistance,
-            deficit,
-            expectedRate,
-            actualRate,
-            passRatio);
+            expectedDistanceMm,
+            actualDistanceMm,
+            flowToMm(deficit),
+            flowToMm(expectedRate),
+            flowToMm(actualRate),
+            flowRatioToFloat(passRatio),
+            state.softJamThreshold);
     }
     else if (!state.jammed && wasJammed && !jamPauseRequested)
     {
@@ -6,6 +6,8 @@
 
 #include <Arduino.h>
 
+#include "FlowMath.h"
+
 // Grace period states for jam detection
 enum class GraceState : uint8_t
 {
@@ -46,9 +48,11 @@ struct JamState
     float      deficit;              // Current deficit in mm (windowed)
     float      expectedRateMmPerSec; // Derived expected flow rate (mm/s)
     float      actualRateMmPerSec;   // Derived sensor flow rate (mm/s)
+    float      deficitRatio;         // Smoothed windowed deficit / expected (0-1, EWMA)
     GraceState graceState;           // Current grace period state
     bool       graceActive;          // True if any grace is active
     TripCode   tripCode;             // Current trip classification (for debugging)
+    float      softJamThreshold;     // Pass ratio the soft check trips below (static or adaptive)
 };
 
 // Configuration for jam detection (stored separately to save RAM)
@@ -60,6 +64,18 @@ struct JamConfig
     uint16_t     hardJamTimeMs;    // Hard jam accumulation time (ms)
     uint16_t     graceTimeMs;      // Grace period after print start and resume (ms)
     DetectionMode detectionMode = DetectionMode::BOTH;
+    bool         adaptiveSoftJam = false;  // Soft threshold relative to the learned baseline
+    bool         verboseLogging  = false;  // JAM_DEBUG / LOW_SPEED_TRIP diagnostics
+};
+
+// Learned steady-state flow for one expected-rate band (see JamDetector)
+struct FlowBaseline
+{
+    uint32_t samples;
+    float    passRatioMean;
+    float    passRatioStdDev;
+    float    expectedRateMean;    // mm/s
+    float    expectedRateStdDev;  // mm/s
 };
 
 /**
@@ -67,6 +83,14 @@ struct JamConfig
  *
  * Public API is kept stable so callers (ElegooCC, etc.) only need
  * to consume JamState fields and JamConfig as before.
+ *
+ * While flow is not jammed the detector learns the print's steady-state pass
+ * ratio per expected-rate band (running mean and deviation, constant
+ * memory, cleared by reset()). Pass ratio drifts with speed and material:
+ * a fast print may run steadily at 0.3. With JamConfig::adaptiveSoftJam the
+ * soft check trips on a drop relative to the band's baseline instead of
+ * at the fixed ratioThreshold; the adaptive threshold only ever relaxes
+ * the fixed one, and never below the hard-jam ratio.
  */
 class JamDetector
 {
@@ -117,6 +141,15 @@ public:
      */
     JamState getState() const { return state; }
 
+    /**
+     * Latency stage timestamps (millis, 0 = not reached) for the current jam
+     * episode: the first evaluation that started accumulating, and the one
+     * that crossed the jam threshold. Both are cleared once flow recovers (the
+     * accumulators drain with no jam latched), on resume, and in grace/idle.
+     */
+    unsigned long getTripOnsetMs() const { return tripOnsetMs; }
+    unsigned long getJamDetectedMs() const { return jamDetectedMs; }
+
     /**
      * Check if pause was requested due to jam.
      */
@@ -132,7 +165,23 @@ public:
      */
     void clearPauseRequest() { jamPauseRequested = false; }
 
+    /**
+     * Learned baseline of the band covering this expected rate.
+     */
+    FlowBaseline getBaseline(float expectedRateMmPerSec) const;
+
 private:
+    static constexpr uint8_t BASELINE_BANDS = 4;
+
+    // Per-print steady-state flow, one entry per expected-rate band
+    struct BaselineBand
+    {
+        flow_stats_t passRatio;
+        flow_stats_t expectedRate;
+    };
+    BaselineBand  baselines[BASELINE_BANDS];
+    unsigned long lastBaselineSampleMs;
+
     // Current state
     JamState state;
 
@@ -148,42 +197,60 @@ private:
 
     // Resume grace tracking
     unsigned long resumeGracePulseBaseline;
-    float         resumeGraceActualBaseline;
+    flow_mm_t     resumeGraceActualBaseline;
     unsigned long resumeGraceStartTimeMs;
 
+    // Jam latency stages (see getTripOnsetMs)
+    unsigned long tripOnsetMs;
+    unsigned long jamDetectedMs;
+
     // Previous windowed distances (for rate derivation)
-    float prevExpectedDistance;
-    float prevActualDistance;
+    flow_mm_t prevExpectedDistance;
+    flow_mm_t prevActualDistance;
 
     // Flags (bit fields to save RAM)
     bool jamPauseRequested : 1;
     bool wasInGrace        : 1;  // Track grace transitions for logging
 
     // Smoothed deficit ratio for display (EWMA)
-    float smoothedDeficitRatio;
+    flow_ratio_t smoothedDeficitRatio;
+
+    // Internal math uses flow_mm_t / flow_ratio_t (FlowMath.h); rates are
+    // flow_mm_t per second. update() converts its float inputs once.
 
     // Grace period helper
     bool evaluateGraceState(unsigned long currentTimeMs,
                             unsigned long printStartTimeMs,
-                            float         expectedDistance,
+                            flow_mm_t     expectedDistance,
                             unsigned long movementPulseCount,
                             const JamConfig& config);
 
     // Jam condition evaluators (rate-based)
-    bool evaluateHardJam(float          expectedDistance,
-                         float          passRatio,
-                         float          expectedRate,
-                         float          actualRate,
+    bool evaluateHardJam(flow_mm_t      expectedDistance,
+                         flow_ratio_t   passRatio,
+                         flow_mm_t      expectedRate,
+                         flow_mm_t      actualRate,
                          unsigned long  elapsedMs,
                          const JamConfig& config);
 
-    bool evaluateSoftJam(float          expectedDistance,
-                         float          deficit,
-                         float          passRatio,
-                         float          expectedRate,
-                         float          actualRate,
+    bool evaluateSoftJam(flow_mm_t      expectedDistance,
+                         flow_mm_t      deficit,
+                         flow_ratio_t   passRatio,
+                         flow_mm_t      expectedRate,
+                         flow_mm_t      actualRate,
+                         flow_ratio_t   ratioThreshold,
                          unsigned long  elapsedMs,
                          const JamConfig& config);
+
+    // Baseline helpers
+    static uint8_t baselineBand(flow_mm_t expectedRate);
+    static flow_ratio_t baselineThreshold(const flow_stats_t &learned, flow_ratio_t staticThreshold);
+    flow_ratio_t   softJamThreshold(flow_mm_t expectedRate, const JamConfig& config) const;
+    void           learnBaseline(flow_mm_t     expectedDistance,
+                                 flow_ratio_t  passRatio,
+                                 flow_mm_t     expectedRate,
+                                 flow_ratio_t  staticThreshold,
+                                 unsigned long currentTimeMs);
 };
 
 #endif  // JAM_DETECTOR_IFACE_H
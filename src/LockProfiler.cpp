@@ -0,0 +1,187 @@
+#include "LockProfiler.h"
+
+#include <string.h>
+
+// On the device the slot is copied and cleared under its own lock, taken
+// directly so the profiler does not record itself. The host stress test
+// reads the table after its threads have joined.
+#if LOCK_PROFILING
+#define LOCK_SLOT_ENTER(lock) vPortEnterCritical((portMUX_TYPE *) (lock))
+#define LOCK_SLOT_EXIT(lock) vPortExitCritical((portMUX_TYPE *) (lock))
+#else
+#define LOCK_SLOT_ENTER(lock) ((void) 0)
+#define LOCK_SLOT_EXIT(lock) ((void) 0)
+#endif
+
+LockProfiler LockProfiler::instance;
+
+LockProfiler &LockProfiler::getInstance()
+{
+    return instance;
+}
+
+LockProfiler::Slot *LockProfiler::find(const void *lock, bool create)
+{
+    for (uint8_t i = 0; i < LOCK_PROFILE_SLOTS; i++)
+    {
+        const void *owner = __atomic_load_n(&slots[i].stats.lock, __ATOMIC_ACQUIRE);
+        if (owner == nullptr && create)
+        {
+            // Claim the free slot; on a lost race `owner` holds the winner
+            if (__atomic_compare_exchange_n(&slots[i].stats.lock, &owner, lock, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                return &slots[i];
+            }
+        }
+        if (owner == lock)
+        {
+            return &slots[i];
+        }
+        if (owner == nullptr)
+        {
+            return nullptr;  // Slots fill in order: the lock has none
+        }
+    }
+    if (create)
+    {
+        __atomic_fetch_add(&overflow, 1, __ATOMIC_RELAXED);
+    }
+    return nullptr;
+}
+
+void LockProfiler::setName(const void *lock, const char *name)
+{
+    Slot *slot = find(lock, true);
+    if (slot != nullptr)
+    {
+        __atomic_store_n(&slot->stats.name, name, __ATOMIC_RELEASE);
+    }
+}
+
+void LockProfiler::acquired(const void *lock, uint32_t waitTicks, bool contended,
+                            uint32_t nowTicks)
+{
+    Slot *slot = find(lock, true);
+    if (slot == nullptr || slot->depth++ > 0)
+    {
+        return;
+    }
+
+    lock_stats_t &stats = slot->stats;
+    stats.acquisitions++;
+    if (contended)
+    {
+        stats.contended++;
+    }
+    stats.waitTicks += waitTicks;
+    if (waitTicks > stats.maxWaitTicks)
+    {
+        stats.maxWaitTicks = waitTicks;
+    }
+    slot->holdStartTicks = nowTicks;
+}
+
+void LockProfiler::released(const void *lock, uint32_t nowTicks)
+{
+    Slot *slot = find(lock, false);
+    if (slot == nullptr || slot->depth == 0 || --slot->depth > 0)
+    {
+        return;
+    }
+
+    uint32_t      hold  = nowTicks - slot->holdStartTicks;
+    lock_stats_t &stats = slot->stats;
+    stats.holdTicks += hold;
+    if (hold > stats.maxHoldTicks)
+    {
+        stats.maxHoldTicks = hold;
+    }
+    uint8_t bucket = hold == 0 ? 0 : static_cast<uint8_t>(31 - __builtin_clz(hold));
+    if (bucket >= LOCK_BUCKET_COUNT)
+    {
+        bucket = LOCK_BUCKET_COUNT - 1;
+    }
+    stats.holdBuckets[bucket]++;
+}
+
+bool LockProfiler::snapshot(uint8_t index, lock_stats_t &out)
+{
+    if (index >= LOCK_PROFILE_SLOTS)
+    {
+        return false;
+    }
+    const void *lock = __atomic_load_n(&slots[index].stats.lock, __ATOMIC_ACQUIRE);
+    if (lock == nullptr)
+    {
+        return false;
+    }
+
+    LOCK_SLOT_ENTER(lock);
+    out = slots[index].stats;
+    LOCK_SLOT_EXIT(lock);
+    return true;
+}
+
+void LockProfiler::reset()
+{
+    // Slots keep their lock and name so the table order stays stable
+    for (uint8_t i = 0; i < LOCK_PROFILE_SLOTS; i++)
+    {
+        const void *lock = __atomic_load_n(&slots[i].stats.lock, __ATOMIC_ACQUIRE);
+        if (lock == nullptr)
+        {
+            break;
+        }
+        LOCK_SLOT_ENTER(lock);
+        lock_stats_t &stats = slots[i].stats;
+        stats.acquisitions  = 0;
+        stats.contended     = 0;
+        stats.maxWaitTicks  = 0;
+        stats.maxHoldTicks  = 0;
+        stats.waitTicks     = 0;
+        stats.holdTicks     = 0;
+        memset(stats.holdBuckets, 0, sizeof(stats.holdBuckets));
+        LOCK_SLOT_EXIT(lock);
+    }
+    overflow = 0;
+#if LOCK_PROFILING
+    resetAtMs = millis();
+#endif
+}
+
+uint32_t LockProfiler::sinceResetMs() const
+{
+#if LOCK_PROFILING
+    return millis() - resetAtMs;
+#else
+    return 0;
+#endif
+}
+
+uint32_t LockProfiler::holdPercentileTicks(const lock_stats_t &stats, float percentile)
+{
+    if (stats.acquisitions == 0)
+    {
+        return 0;
+    }
+
+    // Smallest bucket whose cumulative count reaches the rank
+    uint64_t rank = static_cast<uint64_t>(stats.acquisitions * (percentile / 100.0f) + 0.5f);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < LOCK_BUCKET_COUNT; i++)
+    {
+        seen += stats.holdBuckets[i];
+        if (seen >= rank)
+        {
+            uint32_t upper =
+                (i + 1 < LOCK_BUCKET_COUNT) ? ((1UL << (i + 1)) - 1) : stats.maxHoldTicks;
+            return upper < stats.maxHoldTicks ? upper : stats.maxHoldTicks;
+        }
+    }
+    return stats.maxHoldTicks;
+}
@@ -0,0 +1,135 @@
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <stdint.h>
+
+/**
+ * LockProfiler - hold and wait times per critical-section lock
+ *
+ * portENTER_CRITICAL masks interrupts on the ESP32, so every tick a lock is
+ * held delays pulseCounterISR. Each lock gets a slot (found by its address)
+ * with acquisition and contention counts, total/max wait and hold, and a
+ * histogram of power-of-two hold buckets (bucket i holds [2^i, 2^(i+1))
+ * ticks, bucket 0 also holds 0, the last one everything longer).
+ *
+ * Times are in ticks of whatever clock the caller passes: CPU cycles on the
+ * device, nanoseconds in the host stress test. A slot is only written while
+ * its own lock is held, so recording needs no lock of its own.
+ *
+ * On the device it is off unless built with -D LOCK_PROFILING=1, which
+ * replaces portENTER_CRITICAL/portEXIT_CRITICAL in every file including this
+ * header with cycle-counted versions (include it after Arduino.h), and serves
+ * the table at /api/perf/locks (reset with POST /api/perf/locks/reset). The
+ * wrappers cost two cycle-count reads and a slot lookup per section, which
+ * is why it is not a production default.
+ *
+ * test_thread_safety feeds it from its mutex-backed mocks instead.
+ */
+
+#ifndef LOCK_PROFILING
+#define LOCK_PROFILING 0
+#endif
+
+// Waits longer than this count as contended on the device (~1 us at 160 MHz)
+#ifndef LOCK_CONTENDED_CYCLES
+#define LOCK_CONTENDED_CYCLES 160
+#endif
+
+static const uint8_t LOCK_PROFILE_SLOTS = 16;
+static const uint8_t LOCK_BUCKET_COUNT  = 24;  // Last bucket: >= 2^23 ticks
+
+struct lock_stats_t
+{
+    const void *lock;  // Address of the portMUX_TYPE
+    const char *name;  // nullptr until named
+    uint32_t    acquisitions;
+    uint32_t    contended;
+    uint32_t    maxWaitTicks;
+    uint32_t    maxHoldTicks;
+    uint64_t    waitTicks;
+    uint64_t    holdTicks;
+    uint32_t    holdBuckets[LOCK_BUCKET_COUNT];
+};
+
+class LockProfiler
+{
+  public:
+    static LockProfiler &getInstance();
+
+    void setName(const void *lock, const char *name);
+
+    // Both called with `lock` held; nested entries of one lock count once
+    void acquired(const void *lock, uint32_t waitTicks, bool contended, uint32_t nowTicks);
+    void released(const void *lock, uint32_t nowTicks);
+
+    // Copy of slot `index`; false past the last slot in use
+    bool snapshot(uint8_t index, lock_stats_t &out);
+
+    // Locks seen after all slots were taken (not recorded)
+    uint32_t overflowed() const { return overflow; }
+
+    void reset();
+
+    // Milliseconds since the last reset (device only, 0 on the host)
+    uint32_t sinceResetMs() const;
+
+    // Upper bound of the hold bucket holding the given percentile (0-100), capped at the max
+    static uint32_t holdPercentileTicks(const lock_stats_t &stats, float percentile);
+
+  private:
+    LockProfiler() = default;  // Constant-initialized: usable before constructors run
+    LockProfiler(const LockProfiler &) = delete;
+    LockProfiler &operator=(const LockProfiler &) = delete;
+
+    struct Slot
+    {
+        lock_stats_t stats;
+        uint32_t     holdStartTicks;
+        uint32_t     depth;
+    };
+
+    static LockProfiler instance;
+
+    Slot     slots[LOCK_PROFILE_SLOTS];
+    uint32_t overflow;
+    uint32_t resetAtMs;
+
+    Slot *find(const void *lock, bool create);
+};
+
+#define lockProfiler LockProfiler::getInstance()
+
+#if LOCK_PROFILING
+#include <Arduino.h>
+
+inline void lockProfiledEnter(portMUX_TYPE *mux)
+{
+    uint32_t start = ESP.getCycleCount();
+    vPortEnterCritical(mux);
+    uint32_t now  = ESP.getCycleCount();
+    uint32_t wait = now - start;
+    lockProfiler.acquired(mux, wait, wait > LOCK_CONTENDED_CYCLES, now);
+}
+
+inline void lockProfiledExit(portMUX_TYPE *mux)
+{
+    lockProfiler.released(mux, ESP.getCycleCount());
+    vPortExitCritical(mux);
+}
+
+#undef portENTER_CRITICAL
+#undef portEXIT_CRITICAL
+#define portENTER_CRITICAL(mux) lockProfiledEnter(mux)
+#define portEXIT_CRITICAL(mux) lockProfiledExit(mux)
+#endif  // LOCK_PROFILING
+
+// Labels a lock in the report; hosts that profile their own mocks define it first
+#ifndef LOCK_PROFILE_NAME
+#if LOCK_PROFILING
+#define LOCK_PROFILE_NAME(lock, name) lockProfiler.setName(lock, name)
+#else
+#define LOCK_PROFILE_NAME(lock, name) ((void) 0)
+#endif
+#endif
+
+#endif  // LOCK_PROFILER_H
@@ -0,0 +1,249 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * LogRing - byte ring of variable-length log records
+ *
+ * Each record is a fixed 12-byte header followed by the message bytes (no
+ * terminator), so a short line costs a few dozen bytes instead of a full
+ * fixed-size slot. Pushing evicts the oldest records until the new one fits.
+ *
+ * Records are numbered by the caller with consecutive sequence numbers; the
+ * ring relies on that to locate a record by number. Positions are kept as
+ * free-running 32-bit byte offsets, masked into the buffer on access, so
+ * records may straddle the end of the buffer.
+ *
+ * Not thread-safe: the caller serializes push/read/clear. The storage is
+ * supplied by the caller so it can come from the heap with a fallback size.
+ * Capacity must be a power of two.
+ */
+class LogRing
+{
+  public:
+    struct Header
+    {
+        uint32_t seq;
+        uint32_t timestamp;
+        uint16_t length;  // Message bytes following the header
+        uint8_t  level;
+        uint8_t  flags;   // FLAG_* bits, opaque to the ring
+    };
+
+    static const size_t HEADER_SIZE = sizeof(Header);
+
+    // Payload is a DeferredLog format pointer + packed arguments, not text
+    static const uint8_t FLAG_DEFERRED = 0x01;
+
+    // Where a reader last found a record; each reader keeps its own so
+    // interleaved readers do not rescan from the tail. A zeroed hint is empty.
+    struct ReadHint
+    {
+        uint32_t pos        = 0;
+        uint32_t seq        = 0;
+        uint32_t generation = 0;  // clear() count when taken (0 = never set)
+    };
+
+    LogRing() : buffer(nullptr), mask(0), head(0), tail(0), records(0), firstSeq(0),
+                generation(0) {}
+
+    // Attach storage; capacity must be a power of two. Returns false otherwise.
+    bool begin(uint8_t *storage, size_t capacity)
+    {
+        if (storage == nullptr || capacity < HEADER_SIZE * 2 || (capacity & (capacity - 1)) != 0)
+        {
+            buffer = nullptr;
+            mask   = 0;
+            return false;
+        }
+        buffer = storage;
+        mask   = static_cast<uint32_t>(capacity - 1);
+        clear();
+        return true;
+    }
+
+    size_t capacity() const { return buffer ? static_cast<size_t>(mask) + 1 : 0; }
+    size_t count() const { return records; }
+    size_t bytesUsed() const { return head - tail; }
+
+    // Largest message a single record can hold
+    size_t maxMessageLength() const
+    {
+        size_t room = capacity() > HEADER_SIZE ? capacity() - HEADER_SIZE : 0;
+        return room > 0xFFFF ? 0xFFFF : room;
+    }
+
+    // Sequence number of the oldest stored record (meaningless when empty)
+    uint32_t oldestSeq() const { return firstSeq; }
+
+    void clear()
+    {
+        head     = 0;
+        tail     = 0;
+        records  = 0;
+        firstSeq = 0;
+        generation++;  // Hints taken before now point at discarded records
+    }
+
+    /**
+     * Append a record, evicting old ones as needed. `seq` must be one more
+     * than the previous push (any value after clear()). Messages longer than
+     * maxMessageLength() are truncated.
+     */
+    bool push(uint32_t seq, uint32_t timestamp, uint8_t level, const char *message,
+              size_t length, uint8_t flags = 0)
+    {
+        if (buffer == nullptr)
+        {
+            return false;
+        }
+        if (length > maxMessageLength())
+        {
+            length = maxMessageLength();
+        }
+
+        size_t needed = HEADER_SIZE + length;
+        while (capacity() - bytesUsed() < needed)
+        {
+            dropOldest();
+        }
+
+        Header header;
+        header.seq       = seq;
+        header.timestamp = timestamp;
+        header.length    = static_cast<uint16_t>(length);
+        header.level     = level;
+        header.flags     = flags;
+
+        if (records == 0)
+        {
+            firstSeq = seq;
+        }
+        copyIn(head, reinterpret_cast<const uint8_t *>(&header), HEADER_SIZE);
+        copyIn(head + HEADER_SIZE, reinterpret_cast<const uint8_t *>(message), length);
+        head += static_cast<uint32_t>(needed);
+        records++;
+        return true;
+    }
+
+    /**
+     * Copy out the oldest record whose number is >= `seq`. The message is
+     * NUL-terminated and truncated to fit `messageSize` (binary payloads
+     * should use header.length rather than the terminator). Returns false when
+     * no such record is stored.
+     *
+     * With a `hint`, sequential reads by the same reader are O(1): the scan
+     * resumes from the record it found last time, and the hint is updated.
+     * Without one the scan starts at the oldest record.
+     */
+    bool read(uint32_t seq, Header &header, char *message, size_t messageSize,
+              ReadHint *hint = nullptr)
+    {
+        if (records == 0)
+        {
+            return false;
+        }
+
+        uint32_t newestSeq = firstSeq + static_cast<uint32_t>(records) - 1;
+        if (static_cast<int32_t>(seq - firstSeq) < 0)
+        {
+            seq = firstSeq;  // Requested records were evicted
+        }
+        if (static_cast<int32_t>(newestSeq - seq) < 0)
+        {
+            return false;
+        }
+
+        // Resume from the hint when it is still stored and not past the target
+        uint32_t pos;
+        uint32_t posSeq;
+        if (hint != nullptr && hint->generation == generation &&
+            static_cast<int32_t>(hint->seq - firstSeq) >= 0 &&
+            static_cast<int32_t>(seq - hint->seq) >= 0 && hint->pos - tail < head - tail)
+        {
+            pos    = hint->pos;
+            posSeq = hint->seq;
+        }
+        else
+        {
+            pos    = tail;
+            posSeq = firstSeq;
+        }
+
+        Header current;
+        copyOut(pos, reinterpret_cast<uint8_t *>(&current), HEADER_SIZE);
+        while (posSeq != seq)
+        {
+            pos += static_cast<uint32_t>(HEADER_SIZE + current.length);
+            posSeq++;
+            copyOut(pos, reinterpret_cast<uint8_t *>(&current), HEADER_SIZE);
+        }
+
+        if (hint != nullptr)
+        {
+            hint->pos        = pos;
+            hint->seq        = posSeq;
+            hint->generation = generation;
+        }
+        header = current;
+
+        if (message != nullptr && messageSize > 0)
+        {
+            size_t copyLength = current.length;
+            if (copyLength > messageSize - 1)
+            {
+                copyLength = messageSize - 1;
+            }
+            copyOut(pos + HEADER_SIZE, reinterpret_cast<uint8_t *>(message), copyLength);
+            message[copyLength] = '\0';
+        }
+        return true;
+    }
+
+  private:
+    uint8_t *buffer;
+    uint32_t mask;
+    uint32_t head;      // Free-running byte position of the next write
+    uint32_t tail;      // Free-running byte position of the oldest record
+    size_t   records;
+    uint32_t firstSeq;  // Sequence number of the record at tail
+    uint32_t generation;  // Bumped by clear() to invalidate outstanding hints
+
+    void dropOldest()
+    {
+        Header oldest;
+        copyOut(tail, reinterpret_cast<uint8_t *>(&oldest), HEADER_SIZE);
+        tail += static_cast<uint32_t>(HEADER_SIZE + oldest.length);
+        records--;
+        firstSeq++;
+    }
+
+    void copyIn(uint32_t pos, const uint8_t *src, size_t length)
+    {
+        uint32_t start = pos & mask;
+        size_t   first = capacity() - start;
+        if (first > length)
+        {
+            first = length;
+        }
+        memcpy(buffer + start, src, first);
+        memcpy(buffer, src + first, length - first);
+    }
+
+    void copyOut(uint32_t pos, uint8_t *dst, size_t length) const
+    {
+        uint32_t start = pos & mask;
+        size_t   first = capacity() - start;
+        if (first > length)
+        {
+            first = length;
+        }
+        memcpy(dst, buffer + start, first);
+        memcpy(dst + first, buffer, length - first);
+    }
+};
+
+#endif  // LOG_RING_H
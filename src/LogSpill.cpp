@@ -0,0 +1,242 @@
+#include "LogSpill.h"
+
+#include <LittleFS.h>
+#include <new>
+#include <stdlib.h>
+
+LogSpill &LogSpill::getInstance()
+{
+    static LogSpill instance;
+    return instance;
+}
+
+LogSpill::LogSpill()
+{
+    lock          = xSemaphoreCreateMutex();
+    active        = false;
+    page          = nullptr;
+    pageUsed      = 0;
+    pageLastSeq   = 0;
+    pageStartedMs = 0;
+    firstIndex    = 0;
+    nextIndex     = 0;
+    newestSize    = 0;
+    writtenSeq    = 0;
+}
+
+void LogSpill::segmentPath(uint32_t index, char *out, size_t outSize)
+{
+    snprintf(out, outSize, LOG_SPILL_DIR "/%08lu.log", (unsigned long) index);
+}
+
+bool LogSpill::begin()
+{
+#if LOG_SPILL_ENABLED
+    if (active || lock == nullptr)
+    {
+        return active;
+    }
+
+    page = new (std::nothrow) uint8_t[LOG_SPILL_PAGE_BYTES];
+    if (page == nullptr)
+    {
+        return false;
+    }
+
+    if (!LittleFS.exists(LOG_SPILL_DIR) && !LittleFS.mkdir(LOG_SPILL_DIR))
+    {
+        delete[] page;
+        page = nullptr;
+        return false;
+    }
+
+    // Pick up the segments left by previous boots
+    bool     found  = false;
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    File     dir    = LittleFS.open(LOG_SPILL_DIR);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+    {
+        const char *name  = strrchr(entry.name(), '/');
+        name              = name ? name + 1 : entry.name();
+        char    *end      = nullptr;
+        uint32_t index    = strtoul(name, &end, 10);
+        bool     isSegment = end != name && end != nullptr && strcmp(end, ".log") == 0;
+        if (isSegment)
+        {
+            if (!found || index < lowest)
+            {
+                lowest = index;
+            }
+            if (!found || index > highest)
+            {
+                highest    = index;
+                newestSize = entry.size();
+            }
+            found = true;
+        }
+        entry.close();
+    }
+    dir.close();
+
+    if (found)
+    {
+        firstIndex = lowest;
+        nextIndex  = highest + 1;
+        // Never resume a segment from an earlier boot
+        if (newestSize > 0)
+        {
+            nextIndex++;
+            newestSize = 0;
+        }
+    }
+    else
+    {
+        firstIndex = 0;
+        nextIndex  = 1;
+        newestSize = 0;
+    }
+
+    // Old boots' segments count against the budget too
+    while (nextIndex - firstIndex > LOG_SPILL_SEGMENTS)
+    {
+        char path[32];
+        segmentPath(firstIndex++, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+
+    active = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void LogSpill::append(const char *line, size_t length, uint32_t seq)
+{
+    if (!active || length == 0)
+    {
+        return;
+    }
+    if (length > LOG_SPILL_PAGE_BYTES)
+    {
+        length = LOG_SPILL_PAGE_BYTES;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (pageUsed + length > LOG_SPILL_PAGE_BYTES)
+    {
+        writePage();
+    }
+    if (pageUsed == 0)
+    {
+        pageStartedMs = millis();
+    }
+    memcpy(page + pageUsed, line, length);
+    pageUsed += length;
+    pageLastSeq = seq;
+    xSemaphoreGive(lock);
+}
+
+void LogSpill::flushIfDue(unsigned long now)
+{
+    if (!active)
+    {
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (pageUsed > 0 && now - pageStartedMs >= LOG_SPILL_FLUSH_MS)
+    {
+        writePage();
+    }
+    xSemaphoreGive(lock);
+}
+
+void LogSpill::writePage()
+{
+    if (pageUsed == 0)
+    {
+        return;
+    }
+
+    // Start a new segment instead of splitting a page across two
+    if (newestSize > 0 && newestSize + pageUsed > LOG_SPILL_SEGMENT_BYTES)
+    {
+        nextIndex++;
+        newestSize = 0;
+        while (nextIndex - firstIndex > LOG_SPILL_SEGMENTS)
+        {
+            char oldest[32];
+            segmentPath(firstIndex++, oldest, sizeof(oldest));
+            LittleFS.remove(oldest);
+        }
+    }
+
+    char path[32];
+    segmentPath(nextIndex - 1, path, sizeof(path));
+    File file = LittleFS.open(path, "a");
+    if (file)
+    {
+        size_t written = file.write(page, pageUsed);
+        file.close();
+        newestSize += written;
+        if (written == pageUsed)
+        {
+            writtenSeq = pageLastSeq;
+        }
+    }
+    // On a write failure (e.g. filesystem full) the page is dropped rather
+    // than retried forever; the RAM ring still has the entries
+    pageUsed = 0;
+}
+
+void LogSpill::clear()
+{
+    if (!active)
+    {
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    for (uint32_t index = firstIndex; index != nextIndex; index++)
+    {
+        char path[32];
+        segmentPath(index, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+    firstIndex = nextIndex;
+    nextIndex++;
+    newestSize = 0;
+    pageUsed   = 0;
+    xSemaphoreGive(lock);
+}
+
+void LogSpill::snapshot(Snapshot &out)
+{
+    out.firstIndex = 0;
+    out.count      = 0;
+    out.writtenSeq = 0;
+    if (!active)
+    {
+        return;
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    out.firstIndex = firstIndex;
+    out.count      = nextIndex - firstIndex;
+    out.writtenSeq = writtenSeq;
+    for (uint32_t i = 0; i < out.count; i++)
+    {
+        char path[32];
+        segmentPath(firstIndex + i, path, sizeof(path));
+        out.sizes[i] = 0;
+        if (LittleFS.exists(path))  // The newest segment is created by its first page
+        {
+            File file    = LittleFS.open(path, "r");
+            out.sizes[i] = file ? static_cast<uint32_t>(file.size()) : 0;
+            file.close();
+        }
+    }
+    xSemaphoreGive(lock);
+}
@@ -0,0 +1,107 @@
+#ifndef LOG_SPILL_H
+#define LOG_SPILL_H
+
+#include <Arduino.h>
+
+/**
+ * LogSpill - persistent copy of the log in rotating LittleFS segments
+ *
+ * The logger's sink task hands every formatted line ("YYYY-MM-DD HH:MM:SS
+ * message\n", the /api/logs_text format) to append(). Lines collect in a RAM
+ * page and are written to the newest segment one page at a time, so flash is
+ * touched every few kilobytes (or every LOG_SPILL_FLUSH_MS) rather than per
+ * line, and never from the main loop or the detection task.
+ *
+ * Segments are append-only files LOG_SPILL_DIR/NNNNNNNN.log numbered in
+ * order. When the newest one reaches LOG_SPILL_SEGMENT_BYTES a new one is
+ * started, and the oldest is deleted once there are more than
+ * LOG_SPILL_SEGMENTS. Together they survive reboots, which is what makes
+ * whole-print flow logs and post-crash context retrievable over HTTP.
+ *
+ * All methods are safe to call from any task.
+ */
+
+#ifndef LOG_SPILL_ENABLED
+#define LOG_SPILL_ENABLED 1
+#endif
+
+#ifndef LOG_SPILL_DIR
+#define LOG_SPILL_DIR "/logs"
+#endif
+
+// Flash write batch (LittleFS block size)
+#ifndef LOG_SPILL_PAGE_BYTES
+#define LOG_SPILL_PAGE_BYTES 4096
+#endif
+
+#ifndef LOG_SPILL_SEGMENT_BYTES
+#define LOG_SPILL_SEGMENT_BYTES 32768
+#endif
+
+// Segments kept on flash (total budget = SEGMENTS * SEGMENT_BYTES)
+#ifndef LOG_SPILL_SEGMENTS
+#define LOG_SPILL_SEGMENTS 4
+#endif
+
+// A partly filled page is written after this long, bounding what a crash loses
+#ifndef LOG_SPILL_FLUSH_MS
+#define LOG_SPILL_FLUSH_MS 30000
+#endif
+
+class LogSpill
+{
+  public:
+    // Segment files as they were when snapshot() was called
+    struct Snapshot
+    {
+        uint32_t firstIndex;   // Index of the oldest segment
+        uint32_t count;        // Number of segments
+        uint32_t sizes[LOG_SPILL_SEGMENTS + 1];
+        uint32_t writtenSeq;   // Number of the last log entry on flash (0 = none)
+    };
+
+    static LogSpill &getInstance();
+
+    /**
+     * Find existing segments and allocate the page buffer.
+     * Call after LittleFS is mounted. Returns false if spilling is unavailable.
+     */
+    bool begin();
+    bool isActive() const { return active; }
+
+    // Buffer one formatted line belonging to log entry `seq`
+    void append(const char *line, size_t length, uint32_t seq);
+
+    // Write the page if it has waited LOG_SPILL_FLUSH_MS (called by the sink task)
+    void flushIfDue(unsigned long now);
+
+    // Delete all segments and drop the buffered page
+    void clear();
+
+    // Consistent view of the segment files for a reader
+    void snapshot(Snapshot &out);
+
+    static void segmentPath(uint32_t index, char *out, size_t outSize);
+
+  private:
+    LogSpill();
+    LogSpill(const LogSpill &) = delete;
+    LogSpill &operator=(const LogSpill &) = delete;
+
+    SemaphoreHandle_t lock;
+    bool              active;
+    uint8_t          *page;
+    size_t            pageUsed;
+    uint32_t          pageLastSeq;    // Newest entry in the page
+    unsigned long     pageStartedMs;  // When the first line went into the page
+    uint32_t          firstIndex;
+    uint32_t          nextIndex;      // One past the newest segment
+    uint32_t          newestSize;     // Bytes in segment nextIndex - 1
+    uint32_t          writtenSeq;
+
+    void writePage();  // Caller holds the lock
+};
+
+#define logSpill LogSpill::getInstance()
+
+#endif  // LOG_SPILL_H
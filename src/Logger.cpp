@@ -1,6 +1,9 @@
 #include "Logger.h"
+#include "LockProfiler.h"
+#include "LogSpill.h"
 #include "time.h"
 #include <cstdarg>
+#include <cstdlib>
 #include <cstring>
 
 // External function to get current time (from main.cpp)
@@ -14,40 +17,33 @@ Logger &Logger::getInstance()
 
 Logger::Logger()
 {
-    currentIndex    = 0;
-    totalEntries    = 0;
-    logCapacity     = MAX_LOG_ENTRIES;
-    uuidCounter     = 0;
+    ringStorage     = nullptr;
+    sequenceCounter = 0;
     currentLogLevel = LOG_NORMAL;  // Default to normal logging
     _logMutex       = portMUX_INITIALIZER_UNLOCKED;
-
-    logBuffer = new (std::nothrow) LogEntry[logCapacity];
-    if (!logBuffer)
-    {
-        logCapacity = FALLBACK_LOG_ENTRIES;
-        logBuffer   = new (std::nothrow) LogEntry[logCapacity];
-        if (!logBuffer)
-        {
-            logCapacity = 0;
-        }
-    }
-
-    // Initialize buffer to avoid garbage data
-    if (logBuffer && logCapacity > 0)
+    LOCK_PROFILE_NAME(&_logMutex, "Logger::_logMutex");
+    sinkTask        = nullptr;
+    serialFromSink  = false;
+    serialCursor    = 0;
+    serialDropped   = 0;
+    spillCursor     = 0;
+
+    ringStorage = new (std::nothrow) uint8_t[LOGGER_RING_BYTES];
+    if (!ringStorage || !ring.begin(ringStorage, LOGGER_RING_BYTES))
     {
-        for (int i = 0; i < logCapacity; i++)
+        delete[] ringStorage;
+        ringStorage = new (std::nothrow) uint8_t[FALLBACK_RING_BYTES];
+        if (ringStorage && !ring.begin(ringStorage, FALLBACK_RING_BYTES))
         {
-            memset(logBuffer[i].uuid, 0, sizeof(logBuffer[i].uuid));
-            logBuffer[i].timestamp = 0;
-            memset(logBuffer[i].message, 0, sizeof(logBuffer[i].message));
-            logBuffer[i].level = LOG_NORMAL;
+            delete[] ringStorage;
+            ringStorage = nullptr;
         }
     }
 }
 
 Logger::~Logger()
 {
-    delete[] logBuffer;
+    delete[] ringStorage;
 }
 
 void Logger::setLogLevel(LogLevel level)
@@ -60,21 +56,6 @@ LogLevel Logger::getLogLevel() const
     return currentLogLevel;
 }
 
-void Logger::generateUUID(char *buffer)
-{
-    // Simple UUID-like string: timestamp-counter format
-    // Format: XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX (36 chars)
-    // This is much faster than true UUID generation and sufficient for log tracking
-    uuidCounter++;
-    snprintf(buffer, 37, "%08lx-%04x-%04x-%04x-%08lx%04x",
-             (unsigned long)millis(),
-             (unsigned int)((uuidCounter >> 16) & 0xFFFF),
-             (unsigned int)(uuidCounter & 0xFFFF),
-             (unsigned int)((uuidCounter >> 8) & 0xFFFF),
-             (unsigned long)ESP.getCycleCount(),
-             (unsigned int)(uuidCounter & 0xFFFF));
-}
-
 void Logger::logInternal(const char *message, LogLevel level)
 {
     // Filter based on current log level
@@ -83,43 +64,176 @@ void Logger::logInternal(const char *message, LogLevel level)
         return;  // Don't log messages above current level
     }
 
-    // Print to serial first (keep simple to avoid blocking WiFi stack)
-    Serial.println(message);
+    // Without the sink task, print to serial first (may block on a full UART)
+    if (!serialFromSink)
+    {
+        Serial.println(message);
+    }
 
-    if (logCapacity == 0 || logBuffer == nullptr)
+    if (ringStorage == nullptr)
     {
         return;
     }
 
     // Get current timestamp (safe to call outside critical section)
     unsigned long timestamp = getTime();
+    size_t        length    = strnlen(message, LOG_MESSAGE_MAX_LENGTH);
 
-    // Critical section for buffer update - UUID generation is inside
-    // to prevent duplicate uuidCounter values from concurrent log() calls
+    // Numbering and the ring update share one critical section so concurrent
+    // log() calls store consecutive numbers in order
     portENTER_CRITICAL(&_logMutex);
+    sequenceCounter++;
+    ring.push(sequenceCounter, static_cast<uint32_t>(timestamp), static_cast<uint8_t>(level),
+              message, length);
+    portEXIT_CRITICAL(&_logMutex);
 
-    // Generate UUID inside critical section (uuidCounter++ must be atomic)
-    char uuid[37];
-    generateUUID(uuid);
+    wakeSinkTask();
+}
+
+void Logger::logPacked(const uint8_t *payload, size_t length, LogLevel level)
+{
+    // Deferred entries only reach Serial through the sink task
+    if (ringStorage == nullptr)
+    {
+        return;
+    }
 
-    // Store in circular buffer with fixed-size copy
-    strncpy(logBuffer[currentIndex].uuid, uuid, sizeof(logBuffer[currentIndex].uuid) - 1);
-    logBuffer[currentIndex].uuid[sizeof(logBuffer[currentIndex].uuid) - 1] = '\0';
+    unsigned long timestamp = getTime();
 
-    logBuffer[currentIndex].timestamp = timestamp;
+    portENTER_CRITICAL(&_logMutex);
+    sequenceCounter++;
+    ring.push(sequenceCounter, static_cast<uint32_t>(timestamp), static_cast<uint8_t>(level),
+              reinterpret_cast<const char *>(payload), length, LogRing::FLAG_DEFERRED);
+    portEXIT_CRITICAL(&_logMutex);
 
-    strncpy(logBuffer[currentIndex].message, message, sizeof(logBuffer[currentIndex].message) - 1);
-    logBuffer[currentIndex].message[sizeof(logBuffer[currentIndex].message) - 1] = '\0';
+    wakeSinkTask();
+}
 
-    logBuffer[currentIndex].level = level;
+void Logger::wakeSinkTask()
+{
+    if (sinkTask != nullptr)
+    {
+        xTaskNotifyGive(sinkTask);
+    }
+}
 
-    // Update indices
-    currentIndex = (currentIndex + 1) % logCapacity;
-    if (totalEntries < logCapacity)
+void Logger::beginSinkTask()
+{
+    if (sinkTask != nullptr || ringStorage == nullptr)
     {
-        totalEntries = totalEntries + 1;  // Avoid ++ with volatile
+        return;
     }
-    portEXIT_CRITICAL(&_logMutex);
+
+    logSpill.begin();
+
+    // Everything logged so far was printed synchronously
+    serialCursor = getLatestSequence();
+
+    // Core 0 (PRO_CPU on dual-core chips), away from the detection task
+    const BaseType_t core = 0;
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(sinkTaskEntry, "logsink", LOGGER_SINK_TASK_STACK_SIZE, this, 1,
+                                &handle, core) != pdPASS)
+    {
+        log("Failed to start log sink task, printing synchronously");
+        return;
+    }
+    serialFromSink = LOGGER_ASYNC_SERIAL;
+    sinkTask       = handle;
+}
+
+uint32_t Logger::getSerialDroppedCount() const
+{
+    return serialDropped;
+}
+
+void Logger::sinkTaskEntry(void *param)
+{
+    Logger *self = static_cast<Logger *>(param);
+    for (;;)
+    {
+        // Woken per entry; the timeout also paces the spill's flush check
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        self->drainToSpill();
+        if (self->serialFromSink)
+        {
+            self->drainToSerial();
+        }
+        logSpill.flushIfDue(millis());
+    }
+}
+
+void Logger::drainToSpill()
+{
+    if (!logSpill.isActive())
+    {
+        return;
+    }
+
+    LogRing::Header header;
+    char            message[LOG_MESSAGE_MAX_LENGTH + 1];
+    char            line[LOG_LINE_BUFFER_SIZE];
+    while (readNextEntry(spillCursor, spillHint, getLatestSequence(), header, message))
+    {
+        size_t len = formatEntry(header, message, line, sizeof(line));
+        logSpill.append(line, len, header.seq);
+    }
+}
+
+void Logger::drainToSerial()
+{
+    LogRing::Header header;
+    char            message[LOG_MESSAGE_MAX_LENGTH + 1];
+    uint32_t        reported = serialDropped;
+
+    uint32_t previous = serialCursor;
+    while (readNextEntry(serialCursor, serialHint, getLatestSequence(), header, message))
+    {
+        // Gaps are entries the ring overwrote (or clearLogs removed) first
+        uint32_t skipped = serialCursor - previous - 1;
+        previous         = serialCursor;
+        if (skipped > 0)
+        {
+            serialDropped += skipped;
+        }
+        if (serialDropped != reported)
+        {
+            char note[64];
+            snprintf(note, sizeof(note), "[log] %lu lines dropped (serial backlog)",
+                     (unsigned long) (serialDropped - reported));
+            reported = serialDropped;
+            writeSerialLine(note, strlen(note));
+        }
+
+        writeSerialLine(message, strlen(message));
+
+        // Keep the spill current while the UART is the bottleneck
+        drainToSpill();
+    }
+}
+
+void Logger::writeSerialLine(const char *text, size_t length)
+{
+    // Write what the TX buffer takes and sleep for the rest; only this task waits
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(text);
+    while (length > 0)
+    {
+        int room = Serial.availableForWrite();
+        if (room <= 0)
+        {
+            vTaskDelay(1);
+            continue;
+        }
+        size_t chunk = length < static_cast<size_t>(room) ? length : static_cast<size_t>(room);
+        chunk        = Serial.write(data, chunk);
+        data += chunk;
+        length -= chunk;
+    }
+    while (Serial.availableForWrite() < 2)
+    {
+        vTaskDelay(1);
+    }
+    Serial.write("\r\n", 2);
 }
 
 void Logger::log(const char *message, LogLevel level)
@@ -207,166 +321,174 @@ String Logger::getLogsAsText(int maxEntries)
 {
     String result;
 
-    if (logCapacity == 0 || logBuffer == nullptr)
+    uint32_t endSeq = getLatestSequence();
+    uint32_t cursor = 0;
+    if (maxEntries > 0 && endSeq > static_cast<uint32_t>(maxEntries))
     {
-        return result;
+        cursor = endSeq - static_cast<uint32_t>(maxEntries);
     }
 
-    // Snapshot indices atomically under mutex (same pattern as streamLogs)
-    portENTER_CRITICAL(&_logMutex);
-    int snapshotIndex = currentIndex;
-    int snapshotCount = totalEntries;
-    portEXIT_CRITICAL(&_logMutex);
-
-    // Validate snapshot
-    if (snapshotCount < 0 || snapshotCount > logCapacity)
+    LogRing::ReadHint hint;
+    char              line[LOG_LINE_BUFFER_SIZE];
+    size_t            len = 0;
+    while (formatNextLogLine(cursor, hint, endSeq, line, sizeof(line), len))
     {
-        snapshotCount = 0;  // Corrupted, return empty
+        result += line;
     }
-    if (snapshotIndex < 0 || snapshotIndex >= logCapacity)
+
+    return result;
+}
+
+void Logger::streamLogs(Print* printer)
+{
+    if (printer == nullptr)
     {
-        snapshotIndex = 0;  // Corrupted, return empty
+        return;
     }
 
-    if (snapshotCount == 0)
+    // One entry at a time through a stack buffer: the lock is held only
+    // while copying a single entry out of the ring
+    uint32_t          endSeq = getLatestSequence();
+    uint32_t          cursor = 0;
+    LogRing::ReadHint hint;
+    char              line[LOG_LINE_BUFFER_SIZE];
+    size_t            len = 0;
+    int               count = 0;
+    while (formatNextLogLine(cursor, hint, endSeq, line, sizeof(line), len))
     {
-        return result;
+        printer->write(reinterpret_cast<const uint8_t *>(line), len);
+
+        // Yield to watchdog occasionally
+        if (++count % 10 == 0) {
+            yield();
+        }
     }
+}
 
-    // Limit entries
-    int  returnCount = snapshotCount;
-    bool truncated   = false;
-    if (returnCount > maxEntries)
+size_t Logger::formatEntry(const LogRing::Header &header, const char *message, char *out,
+                           size_t outSize)
+{
+    // Format timestamp as YYYY-MM-DD HH:MM:SS (local time)
+    char       timeStr[24];
+    time_t     localTimestamp = header.timestamp;
+    struct tm *timeinfo       = localtime(&localTimestamp);
+    if (timeinfo != nullptr)
+    {
+        strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", timeinfo);
+    }
+    else
     {
-        returnCount = maxEntries;
-        truncated   = true;
+        snprintf(timeStr, sizeof(timeStr), "%lu", (unsigned long) header.timestamp);
     }
 
-    // Pre-allocate to avoid repeated reallocations
-    result.reserve(returnCount * 80 + 100);
+    int len = snprintf(out, outSize, "%s %s\n", timeStr, message);
+    if (len < 0)
+    {
+        out[0] = '\0';
+        return 0;
+    }
+    return (static_cast<size_t>(len) < outSize) ? static_cast<size_t>(len) : outSize - 1;
+}
 
-    // If we have less than logCapacity entries, start from 0
-    // Otherwise, start from currentIndex (oldest entry)
-    int startIndex = (snapshotCount < logCapacity) ? 0 : snapshotIndex;
+uint32_t Logger::getLatestSequence()
+{
+    portENTER_CRITICAL(&_logMutex);
+    uint32_t latest = sequenceCounter;
+    portEXIT_CRITICAL(&_logMutex);
+    return latest;
+}
 
-    // If we're limiting entries, skip to the most recent ones
-    if (snapshotCount > returnCount)
+uint32_t Logger::parseCursor(const char *text)
+{
+    if (text == nullptr)
     {
-        startIndex = (startIndex + (snapshotCount - returnCount)) % logCapacity;
+        return 0;
     }
 
-    for (int i = 0; i < returnCount; i++)
+    // Entries used to be identified by a UUID-like string carrying the
+    // number in its 2nd and 3rd groups: %08lx-<hi16>-<lo16>-...
+    const char *dash = strchr(text, '-');
+    if (dash != nullptr)
     {
-        int bufferIndex = (startIndex + i) % logCapacity;
-
-        // Bounds check to avoid reading garbage
-        if (bufferIndex < 0 || bufferIndex >= logCapacity)
+        char    *end  = nullptr;
+        uint32_t high = strtoul(dash + 1, &end, 16);
+        if (end == nullptr || *end != '-')
         {
-            continue;  // Skip corrupted index
-        }
-
-        // Format timestamp as MM.DD.YY-HH:MM:SS (local time)
-        time_t localTimestamp = logBuffer[bufferIndex].timestamp;
-        struct tm *timeinfo = localtime(&localTimestamp);
-        if (timeinfo != nullptr) {
-            char timeStr[24];
-            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", timeinfo);
-            result += timeStr;
-        } else {
-            result += String(logBuffer[bufferIndex].timestamp);
+            return 0;
         }
-        result += " ";
-        result += logBuffer[bufferIndex].message;
-        result += "\n";
+        uint32_t low = strtoul(end + 1, nullptr, 16);
+        return ((high & 0xFFFF) << 16) | (low & 0xFFFF);
     }
 
-    return result;
+    return strtoul(text, nullptr, 10);
 }
 
-void Logger::streamLogs(Print* printer)
+bool Logger::readNextEntry(uint32_t &cursor, LogRing::ReadHint &hint, uint32_t endSeq,
+                           LogRing::Header &header, char *message)
 {
-    if (logCapacity == 0 || logBuffer == nullptr || printer == nullptr)
+    if (ringStorage == nullptr || static_cast<int32_t>(endSeq - cursor) <= 0)
     {
-        return;
+        return false;
     }
 
+    // Copy one record out under the lock, render it outside
+    char raw[LOG_MESSAGE_MAX_LENGTH + 1];
     portENTER_CRITICAL(&_logMutex);
-    int snapshotIndex = currentIndex;
-    int snapshotCount = totalEntries;
+    bool found = ring.read(cursor + 1, header, raw, sizeof(raw), &hint);
     portEXIT_CRITICAL(&_logMutex);
 
-    if (snapshotCount == 0)
+    // Records past endSeq were logged after the reader took its snapshot
+    if (!found || static_cast<int32_t>(endSeq - header.seq) < 0)
     {
-        return;
+        return false;
     }
 
-    // Determine start index based on whether buffer has wrapped
-    int startIndex = (snapshotCount < logCapacity) ? 0 : snapshotIndex;
-
-    for (int i = 0; i < snapshotCount; i++)
+    cursor = header.seq;
+    if (header.flags & LogRing::FLAG_DEFERRED)
     {
-        int bufferIndex = (startIndex + i) % logCapacity;
-        
-        // Bounds check
-        if (bufferIndex < 0 || bufferIndex >= logCapacity) continue;
-
-        // Note: Reading inside critical section for 250 entries might hold lock too long.
-        // Reading outside is risky but acceptable for "snapshot-like" streaming if
-        // we accept minor tearing. For safety with corruptable pointers, we'll
-        // format into a stack buffer one by one inside a short critical section,
-        // or just accept the race on the content (but not the pointer).
-        // Best approach here: lock, copy ONE entry to local stack, unlock, print, repeat.
-        
-        LogEntry entryCopy;
-        portENTER_CRITICAL(&_logMutex);
-        entryCopy = logBuffer[bufferIndex];
-        portEXIT_CRITICAL(&_logMutex);
-
-        // Format and print
-        time_t localTimestamp = entryCopy.timestamp;
-        struct tm *timeinfo = localtime(&localTimestamp);
-        
-        if (timeinfo != nullptr) {
-            char timeStr[24];
-            strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", timeinfo);
-            printer->print(timeStr);
-        } else {
-            printer->print(entryCopy.timestamp);
-        }
-        printer->print(" ");
-        printer->print(entryCopy.message);
-        printer->print("\n");
-        
-        // Yield to watchdog occasionally
-        if (i % 10 == 0) {
-            yield();
-        }
+        DeferredLog::render(reinterpret_cast<const uint8_t *>(raw), header.length, message,
+                            LOG_MESSAGE_MAX_LENGTH + 1);
+    }
+    else
+    {
+        memcpy(message, raw, sizeof(raw));
     }
+    return true;
 }
 
-
-void Logger::clearLogs()
+bool Logger::formatNextLogLine(uint32_t &cursor, LogRing::ReadHint &hint, uint32_t endSeq,
+                               char *out, size_t outSize, size_t &len)
 {
-    if (logCapacity == 0 || logBuffer == nullptr)
+    len = 0;
+    if (outSize == 0)
     {
-        return;
+        return false;
     }
-    // Clear the buffer - indices MUST be inside the critical section
-    // to avoid TOCTOU race with logInternal()
-    portENTER_CRITICAL(&_logMutex);
-    currentIndex = 0;
-    totalEntries = 0;
-    for (int i = 0; i < logCapacity; i++)
+
+    LogRing::Header header;
+    char            message[LOG_MESSAGE_MAX_LENGTH + 1];
+    if (!readNextEntry(cursor, hint, endSeq, header, message))
     {
-        memset(logBuffer[i].uuid, 0, sizeof(logBuffer[i].uuid));
-        logBuffer[i].timestamp = 0;
-        memset(logBuffer[i].message, 0, sizeof(logBuffer[i].message));
-        logBuffer[i].level = LOG_NORMAL;
+        return false;
     }
+
+    len = formatEntry(header, message, out, outSize);
+    return true;
+}
+
+void Logger::clearLogs()
+{
+    // Numbering continues across a clear so readers holding a cursor
+    // simply see no entries until new ones arrive
+    portENTER_CRITICAL(&_logMutex);
+    ring.clear();
     portEXIT_CRITICAL(&_logMutex);
 }
 
 int Logger::getLogCount()
 {
-    return totalEntries;
+    portENTER_CRITICAL(&_logMutex);
+    int count = static_cast<int>(ring.count());
+    portEXIT_CRITICAL(&_logMutex);
+    return count;
 }
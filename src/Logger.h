@@ -4,6 +4,27 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include "DeferredLog.h"
+#include "LogRing.h"
+
+// Log history size in bytes. Records are variable length (12-byte header +
+// message), so at a typical ~70 bytes per line this holds ~450 entries.
+#ifndef LOGGER_RING_BYTES
+#define LOGGER_RING_BYTES 32768
+#endif
+
+// Write Serial output from a low-priority task that drains the ring, so a
+// full UART never stalls the caller. Lines logged while the sink is behind
+// and already overwritten in the ring are counted and reported, not waited on.
+#ifndef LOGGER_ASYNC_SERIAL
+#define LOGGER_ASYNC_SERIAL 1
+#endif
+
+// The sink task also feeds the LittleFS spill (see LogSpill.h)
+#ifndef LOGGER_SINK_TASK_STACK_SIZE
+#define LOGGER_SINK_TASK_STACK_SIZE 4096
+#endif
+
 // Log levels - each level includes all previous levels
 enum LogLevel : uint8_t
 {
@@ -12,27 +33,15 @@ enum LogLevel : uint8_t
     LOG_PIN_VALUES  = 2   // Adds: raw pin states (very verbose - emergency debugging only)
 };
 
-// Fixed-size log entry to avoid heap fragmentation
-struct LogEntry
-{
-    char          uuid[37];        // UUID string (36 chars + null terminator)
-    unsigned long timestamp;       // Unix timestamp
-    char          message[256];    // Fixed-size message buffer
-    LogLevel      level;           // Log level for this entry
-};
-
 class Logger
 {
   private:
-    static const int MAX_LOG_ENTRIES = 250;
-    static const int FALLBACK_LOG_ENTRIES = 128;
-    static const int MAX_RETURNED_LOG_ENTRIES = 250;
+    static const size_t FALLBACK_RING_BYTES = 8192;  // Used if LOGGER_RING_BYTES can't be allocated
+    static const int    MAX_RETURNED_LOG_ENTRIES = 250;
 
-    LogEntry *logBuffer;
-    int       logCapacity;
-    volatile int currentIndex;  // volatile to prevent compiler optimization issues
-    volatile int totalEntries;
-    uint32_t  uuidCounter;      // Simple counter-based UUID for efficiency
+    uint8_t *ringStorage;
+    LogRing  ring;
+    uint32_t sequenceCounter;  // Number of the newest entry (0 = none yet)
 
     // Current log level (loaded from settings)
     LogLevel currentLogLevel;
@@ -40,24 +49,59 @@ class Logger
     // Concurrency protection
     portMUX_TYPE _logMutex;
 
+    // Sink task state (cursors are owned by the task once it is running)
+    TaskHandle_t      sinkTask;
+    bool              serialFromSink;  // Serial is written by the task, not log()
+    uint32_t          serialCursor;    // Number of the last entry written to Serial
+    LogRing::ReadHint serialHint;
+    volatile uint32_t serialDropped;   // Entries overwritten before reaching Serial
+    uint32_t          spillCursor;     // Number of the last entry handed to LogSpill
+    LogRing::ReadHint spillHint;
+
     Logger();
 
     // Delete copy constructor and assignment operator
     Logger(const Logger &) = delete;
     Logger &operator=(const Logger &) = delete;
 
-    // Helper to generate simple UUID
-    void generateUUID(char *buffer);
-
     // Internal log function with level
     void logInternal(const char *message, LogLevel level);
 
+    // Store an already packed DeferredLog payload
+    void logPacked(const uint8_t *payload, size_t length, LogLevel level);
+
+    // Copy the first entry after `cursor` (up to `endSeq`) out of the ring as
+    // text, rendering deferred entries. `message` holds LOG_MESSAGE_MAX_LENGTH + 1.
+    // `hint` belongs to the reader that owns `cursor`.
+    bool readNextEntry(uint32_t &cursor, LogRing::ReadHint &hint, uint32_t endSeq,
+                       LogRing::Header &header, char *message);
+
+    static void sinkTaskEntry(void *param);
+    void        drainToSerial();
+    void        drainToSpill();
+    void        wakeSinkTask();
+    void        writeSerialLine(const char *text, size_t length);
+
+    // Format one entry as "YYYY-MM-DD HH:MM:SS message\n", returns length
+    static size_t formatEntry(const LogRing::Header &header, const char *message, char *out,
+                              size_t outSize);
+
   public:
     // Singleton access method
     static Logger &getInstance();
 
     ~Logger();
 
+    /**
+     * Start the sink task that feeds Serial and the LittleFS spill. Until it
+     * runs (or if it cannot be created) log() prints to Serial synchronously,
+     * so early boot output is kept. The spill starts from the first entry.
+     */
+    void beginSinkTask();
+
+    // Entries that were overwritten in the ring before the sink printed them
+    uint32_t getSerialDroppedCount() const;
+
     // Set the current log level (called from settings)
     void setLogLevel(LogLevel level);
     LogLevel getLogLevel() const;
@@ -75,11 +119,54 @@ class Logger
     void logVerbose(const char *format, ...);
     void logPinValues(const char *format, ...);
 
+    /**
+     * Hot-path logging: stores the format pointer and the raw numeric
+     * arguments, and formats only when the entry is read. `format` must be a
+     * string literal and the arguments numbers (see DeferredLog.h).
+     */
+    template <typename... Args>
+    void logDeferred(LogLevel level, const char *format, Args... args)
+    {
+        if (level > currentLogLevel)
+        {
+            return;
+        }
+        uint8_t payload[DeferredLog::MAX_PAYLOAD];
+        size_t  length = DeferredLog::pack(payload, sizeof(payload), format, args...);
+        if (length == 0)
+        {
+            logf(level, format, args...);  // Too many arguments to pack
+            return;
+        }
+        logPacked(payload, length, level);
+    }
+
     String getLogsAsText();
     String getLogsAsText(int maxEntries);
     void   streamLogs(Print* printer);
     void   clearLogs();
     int    getLogCount();
+
+    // Incremental reads. Entries are numbered from 1 and numbers are never
+    // reused (not even by clearLogs), so a reader keeps the number of the
+    // last entry it saw and resumes after it without any buffering.
+    static const size_t LOG_MESSAGE_MAX_LENGTH = 255;
+    static const size_t LOG_LINE_BUFFER_SIZE   = 24 + LOG_MESSAGE_MAX_LENGTH + 2;
+
+    // Number of the newest entry (0 if nothing was logged yet)
+    uint32_t getLatestSequence();
+
+    // Parse a read cursor: a decimal entry number or a legacy entry UUID
+    static uint32_t parseCursor(const char *text);
+
+    /**
+     * Format the first entry after `cursor` (up to and including `endSeq`) into
+     * `out` and advance `cursor` to it. Entries already overwritten are skipped.
+     * Returns false when there is no such entry. Each reader passes its own
+     * `hint` (kept alongside its cursor) so consecutive calls are O(1).
+     */
+    bool formatNextLogLine(uint32_t &cursor, LogRing::ReadHint &hint, uint32_t endSeq, char *out,
+                           size_t outSize, size_t &len);
 };
 
 // Convenience macro for easier access
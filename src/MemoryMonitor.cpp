@@ -0,0 +1,422 @@
+#include "MemoryMonitor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "LockProfiler.h"
+#include "Logger.h"
+
+namespace
+{
+// Set once the instance is constructed. The malloc wrappers go through this
+// instead of getInstance(): a function-local static guard may itself
+// allocate, and allocations made before construction are simply not counted.
+MemoryMonitor *volatile countingTarget = nullptr;
+
+constexpr float kFragmentationWarnPct = 30.0f;
+constexpr uint32_t kCriticalMinHeap   = 2000;
+
+float fragmentationOf(uint32_t freeHeap, uint32_t maxAlloc)
+{
+    if (freeHeap == 0)
+    {
+        return 0.0f;
+    }
+    return 100.0f * (1.0f - ((float) maxAlloc / (float) freeHeap));
+}
+}  // namespace
+
+MemoryMonitor &MemoryMonitor::getInstance()
+{
+    static MemoryMonitor instance;
+    return instance;
+}
+
+MemoryMonitor::MemoryMonitor()
+{
+    statsMutex    = portMUX_INITIALIZER_UNLOCKED;
+    LOCK_PROFILE_NAME(&statsMutex, "MemoryMonitor::statsMutex");
+    taskSlotsUsed = 0;
+    lastSampleMs  = 0;
+    lastLogMs     = 0;
+    memset(tasks, 0, sizeof(tasks));
+    clearLocked();
+    countingTarget = this;
+}
+
+void MemoryMonitor::clearLocked()
+{
+    memset(phases, 0, sizeof(phases));
+    for (uint8_t i = 0; i < MEM_PHASE_COUNT; i++)
+    {
+        phases[i].lowWaterFree = UINT32_MAX;
+    }
+    memset(&heap, 0, sizeof(heap));
+    heap.minMaxAllocHeap = UINT32_MAX;
+    for (uint8_t i = 0; i < taskSlotsUsed; i++)
+    {
+        tasks[i].allocs     = 0;
+        tasks[i].frees      = 0;
+        tasks[i].allocBytes = 0;
+    }
+    resetAtMs = millis();
+}
+
+int MemoryMonitor::findTask(TaskHandle_t handle) const
+{
+    if (handle == nullptr)
+    {
+        return -1;
+    }
+    uint8_t used = __atomic_load_n(&taskSlotsUsed, __ATOMIC_ACQUIRE);
+    for (uint8_t i = 0; i < used; i++)
+    {
+        if (tasks[i].handle == handle)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool MemoryMonitor::registerTask(const char *name, TaskHandle_t handle)
+{
+    if (handle == nullptr)
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    int  index = findTask(handle);
+    bool added = false;
+    if (index < 0 && taskSlotsUsed < MEM_TASK_SLOTS)
+    {
+        index                      = taskSlotsUsed;
+        tasks[index].handle        = handle;
+        tasks[index].stackFreeMin  = UINT32_MAX;
+        added                      = true;
+    }
+    if (index >= 0)
+    {
+        snprintf(tasks[index].name, sizeof(tasks[index].name), "%s", name ? name : "");
+    }
+    if (added)
+    {
+        // The slot is complete before the wrappers can see it
+        __atomic_store_n(&taskSlotsUsed, (uint8_t) (index + 1), __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL(&statsMutex);
+    return index >= 0;
+}
+
+void MemoryMonitor::countAllocation(size_t bytes)
+{
+    int index = findTask(xTaskGetCurrentTaskHandle());
+    if (index < 0)
+    {
+        return;
+    }
+    // Only the owning task writes its counters, so no lock is needed
+    tasks[index].allocs++;
+    tasks[index].allocBytes += bytes;
+}
+
+void MemoryMonitor::countFree()
+{
+    int index = findTask(xTaskGetCurrentTaskHandle());
+    if (index >= 0)
+    {
+        tasks[index].frees++;
+    }
+}
+
+mem_phase_mark_t MemoryMonitor::beginPhase()
+{
+    mem_phase_mark_t mark;
+    memset(&mark, 0, sizeof(mark));
+#if MEMORY_MONITOR_ENABLED
+    int index = findTask(xTaskGetCurrentTaskHandle());
+    if (index >= 0)
+    {
+        mark.allocs     = tasks[index].allocs;
+        mark.frees      = tasks[index].frees;
+        mark.allocBytes = tasks[index].allocBytes;
+    }
+    mark.minFreeHeap = ESP.getMinFreeHeap();
+    mark.freeHeap    = ESP.getFreeHeap();
+#endif
+    return mark;
+}
+
+void MemoryMonitor::endPhase(MemPhase phase, const mem_phase_mark_t &mark)
+{
+#if !MEMORY_MONITOR_ENABLED
+    return;
+#endif
+    if (phase >= MEM_PHASE_COUNT)
+    {
+        return;
+    }
+
+    uint32_t exitFree = ESP.getFreeHeap();
+    uint32_t exitMin  = ESP.getMinFreeHeap();
+    uint32_t allocs = 0, frees = 0, allocBytes = 0;
+    int      index  = findTask(xTaskGetCurrentTaskHandle());
+    if (index >= 0)
+    {
+        // Counters only move forward between a reset; a reset mid-phase reads as zero
+        allocs     = tasks[index].allocs >= mark.allocs ? tasks[index].allocs - mark.allocs : 0;
+        frees      = tasks[index].frees >= mark.frees ? tasks[index].frees - mark.frees : 0;
+        allocBytes = tasks[index].allocBytes >= mark.allocBytes
+                         ? tasks[index].allocBytes - mark.allocBytes
+                         : 0;
+    }
+
+    // A new boot-wide minimum was reached inside the phase: that is its low-water
+    // mark exactly. Otherwise the lower of the entry and exit readings.
+    bool     exact    = exitMin < mark.minFreeHeap;
+    uint32_t lowWater = exact ? exitMin : (exitFree < mark.freeHeap ? exitFree : mark.freeHeap);
+    int32_t  retained = (int32_t) (mark.freeHeap - exitFree);
+
+    portENTER_CRITICAL(&statsMutex);
+    mem_phase_stats_t &stats = phases[phase];
+    stats.count++;
+    if (lowWater < stats.lowWaterFree)
+    {
+        stats.lowWaterFree = lowWater;
+    }
+    if (exact)
+    {
+        stats.lowWaterExact++;
+    }
+    if (retained > 0 && (uint32_t) retained > stats.maxRetained)
+    {
+        stats.maxRetained = (uint32_t) retained;
+    }
+    stats.netRetained += retained;
+    stats.allocs += allocs;
+    stats.frees += frees;
+    stats.allocBytes += allocBytes;
+    portEXIT_CRITICAL(&statsMutex);
+}
+
+void MemoryMonitor::sampleLocked(uint32_t freeHeap, uint32_t minFreeHeap, uint32_t maxAlloc)
+{
+    heap.freeHeap         = freeHeap;
+    heap.minFreeHeap      = minFreeHeap;
+    heap.maxAllocHeap     = maxAlloc;
+    heap.fragmentationPct = fragmentationOf(freeHeap, maxAlloc);
+    if (maxAlloc < heap.minMaxAllocHeap)
+    {
+        heap.minMaxAllocHeap = maxAlloc;
+    }
+    if (heap.fragmentationPct > heap.maxFragmentationPct)
+    {
+        heap.maxFragmentationPct = heap.fragmentationPct;
+    }
+    heap.samples++;
+}
+
+void MemoryMonitor::loop(unsigned long now)
+{
+#if !MEMORY_MONITOR_ENABLED
+    return;
+#endif
+    if (heap.samples != 0 && now - lastSampleMs < MEMORY_SAMPLE_INTERVAL_MS)
+    {
+        return;
+    }
+    lastSampleMs = now;
+
+    // Read outside the lock: the largest-block query walks the heap
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t minHeap  = ESP.getMinFreeHeap();
+    uint32_t maxAlloc = ESP.getMaxAllocHeap();
+
+    uint32_t stackFree[MEM_TASK_SLOTS];
+    uint8_t  used = __atomic_load_n(&taskSlotsUsed, __ATOMIC_ACQUIRE);
+    for (uint8_t i = 0; i < used; i++)
+    {
+        stackFree[i] = uxTaskGetStackHighWaterMark(tasks[i].handle);
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    sampleLocked(freeHeap, minHeap, maxAlloc);
+    for (uint8_t i = 0; i < used; i++)
+    {
+        if (stackFree[i] < tasks[i].stackFreeMin)
+        {
+            tasks[i].stackFreeMin = stackFree[i];
+        }
+    }
+    portEXIT_CRITICAL(&statsMutex);
+
+    if (now - lastLogMs <= MEMORY_LOG_INTERVAL_MS)
+    {
+        return;
+    }
+    lastLogMs = now;
+
+    float    fragmentation = fragmentationOf(freeHeap, maxAlloc);
+    MemPhase retainer      = topRetainer();
+    logger.logf(LOG_VERBOSE, "Heap: free=%lu min=%lu maxAlloc=%lu frag=%.1f%% topRetainer=%s",
+                (unsigned long) freeHeap, (unsigned long) minHeap, (unsigned long) maxAlloc,
+                fragmentation, phaseName(retainer));
+
+    if (fragmentation > kFragmentationWarnPct)
+    {
+        logger.logf(LOG_NORMAL, "WARNING: Heap fragmentation high! (%.1f%%, most retained by %s)",
+                    fragmentation, phaseName(retainer));
+    }
+
+    if (minHeap < kCriticalMinHeap)
+    {
+        logger.logf(LOG_NORMAL, "CRITICAL: Low memory! Min heap: %lu", (unsigned long) minHeap);
+    }
+}
+
+void MemoryMonitor::heapSnapshot(mem_heap_stats_t &out)
+{
+    portENTER_CRITICAL(&statsMutex);
+    out = heap;
+    portEXIT_CRITICAL(&statsMutex);
+
+    if (out.samples == 0)
+    {
+        out.minMaxAllocHeap = 0;
+    }
+}
+
+void MemoryMonitor::phaseSnapshot(MemPhase phase, mem_phase_stats_t &out)
+{
+    if (phase >= MEM_PHASE_COUNT)
+    {
+        memset(&out, 0, sizeof(out));
+        return;
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    out = phases[phase];
+    portEXIT_CRITICAL(&statsMutex);
+
+    if (out.count == 0)
+    {
+        out.lowWaterFree = 0;
+    }
+}
+
+bool MemoryMonitor::taskSnapshot(uint8_t index, mem_task_stats_t &out)
+{
+    memset(&out, 0, sizeof(out));
+    if (index >= taskCount())
+    {
+        return false;
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    const TaskSlot &slot = tasks[index];
+    memcpy(out.name, slot.name, sizeof(out.name));
+    out.stackFreeMin = slot.stackFreeMin == UINT32_MAX ? 0 : slot.stackFreeMin;
+    out.allocs       = slot.allocs;
+    out.frees        = slot.frees;
+    out.allocBytes   = slot.allocBytes;
+    portEXIT_CRITICAL(&statsMutex);
+    return true;
+}
+
+uint8_t MemoryMonitor::taskCount() const
+{
+    return __atomic_load_n(&taskSlotsUsed, __ATOMIC_ACQUIRE);
+}
+
+MemPhase MemoryMonitor::topRetainer()
+{
+    MemPhase top  = MEM_PHASE_COUNT;
+    int32_t  most = 0;
+    portENTER_CRITICAL(&statsMutex);
+    for (uint8_t i = 0; i < MEM_PHASE_COUNT; i++)
+    {
+        if (phases[i].netRetained > most)
+        {
+            most = phases[i].netRetained;
+            top  = static_cast<MemPhase>(i);
+        }
+    }
+    portEXIT_CRITICAL(&statsMutex);
+    return top;
+}
+
+void MemoryMonitor::reset()
+{
+    portENTER_CRITICAL(&statsMutex);
+    clearLocked();
+    portEXIT_CRITICAL(&statsMutex);
+}
+
+uint32_t MemoryMonitor::sinceResetMs() const
+{
+    return millis() - resetAtMs;
+}
+
+const char *MemoryMonitor::phaseName(MemPhase phase)
+{
+    switch (phase)
+    {
+        case MEM_SDCP_PARSE:    return "sdcpParse";
+        case MEM_SSE_BROADCAST: return "sseBroadcast";
+        case MEM_LOG_DUMP:      return "logDump";
+        case MEM_OTA:           return "ota";
+        default:                return "none";
+    }
+}
+
+#if MEMORY_COUNT_ALLOCATIONS
+// Link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+    void  __real_free(void *ptr);
+
+    void *__wrap_malloc(size_t size)
+    {
+        MemoryMonitor *target = countingTarget;
+        if (target != nullptr)
+        {
+            target->countAllocation(size);
+        }
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        MemoryMonitor *target = countingTarget;
+        if (target != nullptr)
+        {
+            target->countAllocation(count * size);
+        }
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        MemoryMonitor *target = countingTarget;
+        if (target != nullptr)
+        {
+            target->countAllocation(size);
+        }
+        return __real_realloc(ptr, size);
+    }
+
+    void __wrap_free(void *ptr)
+    {
+        MemoryMonitor *target = countingTarget;
+        if (target != nullptr && ptr != nullptr)
+        {
+            target->countFree();
+        }
+        __real_free(ptr);
+    }
+}
+#endif  // MEMORY_COUNT_ALLOCATIONS
@@ -0,0 +1,190 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+
+/**
+ * MemoryMonitor - continuous heap and stack instrumentation
+ *
+ * Three views, all fixed-size; allocation counting is a profiling-build option:
+ *
+ *  - Heap: free, boot-wide minimum and largest free block, sampled every
+ *    MEMORY_SAMPLE_INTERVAL_MS from loop(), with the lowest largest block and
+ *    the worst fragmentation seen since reset.
+ *  - Phases: per subsystem path (SDCP parse, SSE broadcast, log dump, OTA) the
+ *    lowest free heap seen around it, the bytes it left allocated, and the
+ *    allocations it made. When a phase drives the boot-wide minimum down, the
+ *    new minimum is its exact low-water mark; otherwise its entry and exit
+ *    readings bound it.
+ *  - Tasks: stack high-water marks of the registered tasks, and with
+ *    MEMORY_COUNT_ALLOCATIONS the malloc/free calls each task made.
+ *
+ * Allocation counting wraps malloc, calloc, realloc and free at link time
+ * (-Wl,--wrap=... in platformio.ini); the wrappers cost a handle lookup per
+ * call. Without the flag the counts read zero and the rest still works.
+ *
+ * Served at /api/perf/memory (JSON) and reset with POST /api/perf/memory/reset,
+ * which clears phases, counts and low-water marks but not stack marks (those
+ * come from FreeRTOS and only ever fall).
+ *
+ * Usage:
+ *   {
+ *       MemScope scope(MEM_SSE_BROADCAST);
+ *       broadcastStatusUpdate();
+ *   }
+ */
+
+#ifndef MEMORY_MONITOR_ENABLED
+#define MEMORY_MONITOR_ENABLED 1
+#endif
+
+#ifndef MEMORY_COUNT_ALLOCATIONS
+#define MEMORY_COUNT_ALLOCATIONS 0
+#endif
+
+#ifndef MEMORY_SAMPLE_INTERVAL_MS
+#define MEMORY_SAMPLE_INTERVAL_MS 1000
+#endif
+
+// Heap summary in the log (verbose) and the fragmentation/low-memory warnings
+#ifndef MEMORY_LOG_INTERVAL_MS
+#define MEMORY_LOG_INTERVAL_MS 300000
+#endif
+
+enum MemPhase : uint8_t
+{
+    MEM_SDCP_PARSE = 0,  // ElegooCC::webSocketEvent text frames (parse + handlers)
+    MEM_SSE_BROADCAST,   // WebServer::broadcastStatusUpdate()
+    MEM_LOG_DUMP,        // Log responses: setup and every chunk filled
+    MEM_OTA,             // ElegantOTA upload, start to end
+    MEM_PHASE_COUNT
+};
+
+static const uint8_t MEM_TASK_SLOTS = 8;
+
+struct mem_phase_stats_t
+{
+    uint32_t count;
+    uint32_t lowWaterFree;     // Lowest free heap around the phase (UINT32_MAX until run)
+    uint32_t lowWaterExact;    // Runs whose low-water came from a new boot-wide minimum
+    uint32_t maxRetained;      // Largest entry-to-exit drop in free heap of one run
+    int32_t  netRetained;      // Sum of entry-to-exit drops (negative: it freed more)
+    uint32_t allocs;           // malloc/calloc/realloc calls made inside the phase
+    uint32_t frees;
+    uint32_t allocBytes;
+};
+
+struct mem_task_stats_t
+{
+    char     name[16];
+    uint32_t stackFreeMin;  // Bytes of stack never touched (FreeRTOS high-water mark)
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t allocBytes;
+};
+
+struct mem_heap_stats_t
+{
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;         // Since boot
+    uint32_t maxAllocHeap;        // Largest free block
+    uint32_t minMaxAllocHeap;     // Lowest largest free block since reset
+    float    fragmentationPct;    // 100 * (1 - maxAlloc / free)
+    float    maxFragmentationPct; // Since reset
+    uint32_t samples;
+};
+
+// Taken by beginPhase(), handed back to endPhase()
+struct mem_phase_mark_t
+{
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t allocBytes;
+};
+
+class MemoryMonitor
+{
+  public:
+    static MemoryMonitor &getInstance();
+
+    // Track a task's stack and allocations; false when all slots are taken.
+    // Registering the same handle again only renames it.
+    bool registerTask(const char *name, TaskHandle_t handle);
+
+    // Samples heap and stacks when due, logs the periodic summary (main loop)
+    void loop(unsigned long now);
+
+    mem_phase_mark_t beginPhase();
+    void             endPhase(MemPhase phase, const mem_phase_mark_t &mark);
+
+    void heapSnapshot(mem_heap_stats_t &out);
+    void phaseSnapshot(MemPhase phase, mem_phase_stats_t &out);
+    // False past the registered tasks
+    bool taskSnapshot(uint8_t index, mem_task_stats_t &out);
+    uint8_t taskCount() const;
+
+    // Phase with the largest net retained bytes, or MEM_PHASE_COUNT if none kept any
+    MemPhase topRetainer();
+
+    void reset();
+
+    // Milliseconds since the last reset
+    uint32_t sinceResetMs() const;
+
+    static const char *phaseName(MemPhase phase);
+
+    // Called by the malloc wrappers
+    void countAllocation(size_t bytes);
+    void countFree();
+
+  private:
+    MemoryMonitor();
+    MemoryMonitor(const MemoryMonitor &) = delete;
+    MemoryMonitor &operator=(const MemoryMonitor &) = delete;
+
+    struct TaskSlot
+    {
+        TaskHandle_t handle;
+        char         name[16];
+        uint32_t     stackFreeMin;
+        // Written only by the task itself (from the wrappers), read anywhere
+        uint32_t     allocs;
+        uint32_t     frees;
+        uint32_t     allocBytes;
+    };
+
+    int  findTask(TaskHandle_t handle) const;
+    void sampleLocked(uint32_t freeHeap, uint32_t minFreeHeap, uint32_t maxAlloc);
+    void clearLocked();
+
+    TaskSlot          tasks[MEM_TASK_SLOTS];
+    uint8_t           taskSlotsUsed;
+    mem_phase_stats_t phases[MEM_PHASE_COUNT];
+    mem_heap_stats_t  heap;
+    uint32_t          resetAtMs;
+    unsigned long     lastSampleMs;
+    unsigned long     lastLogMs;
+    portMUX_TYPE      statsMutex;
+};
+
+#define memoryMonitor MemoryMonitor::getInstance()
+
+// Accounts the enclosing scope to a phase
+class MemScope
+{
+  public:
+#if MEMORY_MONITOR_ENABLED
+    explicit MemScope(MemPhase phase) : phase(phase), mark(memoryMonitor.beginPhase()) {}
+    ~MemScope() { memoryMonitor.endPhase(phase, mark); }
+
+  private:
+    MemPhase         phase;
+    mem_phase_mark_t mark;
+#else
+    explicit MemScope(MemPhase) {}
+#endif
+};
+
+#endif  // MEMORY_MONITOR_H
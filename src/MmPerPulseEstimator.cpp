@@ -0,0 +1,110 @@
+#include "MmPerPulseEstimator.h"
+
+#include <math.h>
+
+namespace
+{
+// Prior weight of the seed, about four segments' worth of pulses^2
+const float kInitialCovariance = 0.001f;
+}  // namespace
+
+MmPerPulseEstimator::MmPerPulseEstimator()
+{
+    reset(2.88f);
+}
+
+void MmPerPulseEstimator::reset(float seedMmPerPulse)
+{
+    // A setting outside the plausible range is some other sensor: leave it alone
+    usable        = seedMmPerPulse >= MM_PER_PULSE_MIN && seedMmPerPulse <= MM_PER_PULSE_MAX;
+    seed          = seedMmPerPulse;
+    fitted        = seedMmPerPulse;
+    covariance    = kInitialCovariance;
+    // Pulse quantisation at both segment ends: ~0.5 pulse of error
+    residualVar   = 0.25f * seedMmPerPulse * seedMmPerPulse;
+    segmentMm     = 0;
+    segmentPulses = 0;
+    segments      = 0;
+}
+
+bool MmPerPulseEstimator::addSample(float expectedMm, unsigned long pulses, bool healthy)
+{
+    if (!usable)
+    {
+        return false;
+    }
+    if (!healthy)
+    {
+        segmentMm     = 0;
+        segmentPulses = 0;
+        return false;
+    }
+    segmentMm += expectedMm;  // Net of retractions, like the print-end calibration
+    segmentPulses += pulses;
+    if (segmentMm < MM_PER_PULSE_SEGMENT_MM)
+    {
+        return false;
+    }
+
+    float         closedMm     = segmentMm;
+    unsigned long closedPulses = segmentPulses;
+    segmentMm                  = 0;
+    segmentPulses              = 0;
+    if (closedPulses == 0)
+    {
+        return false;  // No flow seen at all: a jam, not a calibration point
+    }
+
+    float error = closedMm - fitted * closedPulses;
+    if (fabsf(error) > closedMm * (MM_PER_PULSE_OUTLIER_PCT / 100.0f))
+    {
+        return false;
+    }
+    fitSegment(closedMm, closedPulses);
+    return true;
+}
+
+void MmPerPulseEstimator::fitSegment(float expectedMm, unsigned long pulses)
+{
+    const float lambda = MM_PER_PULSE_FORGETTING;
+    float       x      = static_cast<float>(pulses);
+    float       error  = expectedMm - fitted * x;
+
+    float gain = covariance * x / (lambda + x * covariance * x);
+    fitted += gain * error;
+    covariance  = (covariance - gain * x * covariance) / lambda;
+    residualVar = lambda * residualVar + (1.0f - lambda) * error * error;
+    segments++;
+}
+
+float MmPerPulseEstimator::estimate() const
+{
+    if (segments < MM_PER_PULSE_MIN_SEGMENTS)
+    {
+        return seed;
+    }
+
+    float low  = seed * (1.0f - MM_PER_PULSE_MAX_DRIFT_PCT / 100.0f);
+    float high = seed * (1.0f + MM_PER_PULSE_MAX_DRIFT_PCT / 100.0f);
+    if (low < MM_PER_PULSE_MIN)
+    {
+        low = MM_PER_PULSE_MIN;
+    }
+    if (high > MM_PER_PULSE_MAX)
+    {
+        high = MM_PER_PULSE_MAX;
+    }
+    return fitted < low ? low : fitted > high ? high : fitted;
+}
+
+float MmPerPulseEstimator::standardErrorPercent() const
+{
+    return 100.0f * sqrtf(residualVar * covariance) / fitted;
+}
+
+bool MmPerPulseEstimator::isConverged() const
+{
+    // A fit pinned at the drift limit has not converged on the value it reports
+    return segments >= MM_PER_PULSE_MIN_SEGMENTS &&
+           standardErrorPercent() < MM_PER_PULSE_CONVERGED_PCT && estimate() == fitted;
+}
@@ -0,0 +1,88 @@
+#ifndef MM_PER_PULSE_ESTIMATOR_H
+#define MM_PER_PULSE_ESTIMATOR_H
+
+/**
+ * MmPerPulseEstimator - streaming movement_mm_per_pulse calibration
+ *
+ * Fits expectedMm = mmPerPulse * pulses by recursive least squares with a
+ * forgetting factor, one regression point per MM_PER_PULSE_SEGMENT_MM of
+ * expected extrusion. Segments are contiguous, so the sensor's lag behind
+ * telemetry moves pulses between neighbouring segments instead of biasing
+ * the fit. State is a handful of floats regardless of print length.
+ *
+ * Only healthy flow is fitted: a sample flagged unhealthy (jam, grace,
+ * pause) drops the open segment, and a segment more than
+ * MM_PER_PULSE_OUTLIER_PCT off the current estimate is ignored. The value
+ * handed to detection stays within MM_PER_PULSE_MAX_DRIFT_PCT of the seed
+ * (the stored setting), which bounds how much under-extrusion a print can
+ * calibrate away. Persisting is left to the caller once isConverged().
+ */
+
+#ifndef MM_PER_PULSE_SEGMENT_MM
+#define MM_PER_PULSE_SEGMENT_MM 50.0f
+#endif
+
+// Weight of the previous fit per segment (memory of ~1 / (1 - factor) segments)
+#ifndef MM_PER_PULSE_FORGETTING
+#define MM_PER_PULSE_FORGETTING 0.98f
+#endif
+
+// Converged once the standard error is below this percentage of the estimate
+#ifndef MM_PER_PULSE_CONVERGED_PCT
+#define MM_PER_PULSE_CONVERGED_PCT 1.0f
+#endif
+
+#ifndef MM_PER_PULSE_MIN_SEGMENTS
+#define MM_PER_PULSE_MIN_SEGMENTS 20
+#endif
+
+#ifndef MM_PER_PULSE_MAX_DRIFT_PCT
+#define MM_PER_PULSE_MAX_DRIFT_PCT 5.0f
+#endif
+
+#ifndef MM_PER_PULSE_OUTLIER_PCT
+#define MM_PER_PULSE_OUTLIER_PCT 25.0f
+#endif
+
+// Plausible range for the SFS 2.0; other seeds are passed through unfitted
+static const float MM_PER_PULSE_MIN = 2.5f;
+static const float MM_PER_PULSE_MAX = 3.5f;
+
+class MmPerPulseEstimator
+{
+  public:
+    MmPerPulseEstimator();
+
+    // Start over from the stored value (call on print start)
+    void reset(float seedMmPerPulse);
+
+    /**
+     * Feed one telemetry interval: expected extrusion and pulses counted
+     * since the previous call. Returns true when a segment closed and the
+     * estimate was updated.
+     */
+    bool addSample(float expectedMm, unsigned long pulses, bool healthy);
+
+    // Current value for detection (seed until MM_PER_PULSE_MIN_SEGMENTS fitted)
+    float estimate() const;
+    bool  isConverged() const;
+    float seedValue() const { return seed; }
+
+    // Standard error of the fit as a percentage of the estimate
+    float standardErrorPercent() const;
+    unsigned long segmentCount() const { return segments; }
+
+  private:
+    bool          usable;        // Seed in the plausible range
+    float         seed;
+    float         fitted;        // Unclamped RLS estimate
+    float         covariance;    // RLS P (scaled by the residual variance)
+    float         residualVar;   // EWMA of squared prediction errors (mm^2)
+    float         segmentMm;     // Open segment
+    unsigned long segmentPulses;
+    unsigned long segments;      // Segments fitted since reset
+
+    void fitSegment(float expectedMm, unsigned long pulses);
+};
+
+#endif  // MM_PER_PULSE_ESTIMATOR_H
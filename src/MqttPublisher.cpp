@@ -0,0 +1,247 @@
+/**
+ * MqttPublisher - Optional push telemetry to an MQTT broker
+ *
+ * Compile with -D ENABLE_MQTT=1 to enable (links PubSubClient).
+ *
+ * Runs on the main loop task. Everything it publishes comes from the lock-free
+ * ElegooCC snapshots, so it never contends with the detection task or the
+ * async web handlers. Connecting is blocking in PubSubClient, so attempts are
+ * spaced with the same 5s-60s exponential backoff the SDCP transport uses.
+ */
+
+#include "MqttPublisher.h"
+
+#ifdef ENABLE_MQTT
+
+#include <PubSubClient.h>
+#include <WiFi.h>
+
+#include "ElegooCC.h"
+#include "Logger.h"
+#include "SettingsManager.h"
+
+namespace
+{
+constexpr unsigned long kReconnectMinBackoffMs = 5000;
+constexpr unsigned long kReconnectMaxBackoffMs = 60000;
+constexpr uint16_t      kMqttBufferSize        = 768;   // Fits the status JSON plus topic
+constexpr size_t        kTopicBufSize          = 48;
+constexpr size_t        kStatusBufSize         = 640;
+
+WiFiClient   wifiClient;
+PubSubClient mqttClient(wifiClient);
+
+// PubSubClient keeps a pointer to the host string, so it lives here
+String broker;
+String user;
+String password;
+int    port       = 1883;
+bool   configured = false;
+
+volatile bool settingsDirty = true;
+
+char topicPrefix[20] = {0};  // "ofs/" + 12 hex digits
+char clientId[20]    = {0};  // "ofs-" + 12 hex digits
+
+unsigned long lastAttemptMs = 0;
+unsigned long backoffMs     = kReconnectMinBackoffMs;
+bool          wasConnected  = false;
+
+// Last values sent, -1 = not published on this connection yet
+int8_t        lastJam      = -1;
+int8_t        lastRunout   = -1;
+uint32_t      lastInfoGen  = 0;
+unsigned long lastMetricsMs = 0;
+
+void buildTopic(char *out, const char *leaf)
+{
+    snprintf(out, kTopicBufSize, "%s/%s", topicPrefix, leaf);
+}
+
+bool publishLeaf(const char *leaf, const char *payload, bool retained)
+{
+    char topic[kTopicBufSize];
+    buildTopic(topic, leaf);
+    return mqttClient.publish(topic, payload, retained);
+}
+
+const char *boolText(bool value)
+{
+    return value ? "true" : "false";
+}
+
+void applySettings()
+{
+    settingsDirty = false;
+
+    if (mqttClient.connected())
+    {
+        publishLeaf("availability", "offline", true);
+        mqttClient.disconnect();
+    }
+
+    broker     = settingsManager.getMqttBroker();
+    user       = settingsManager.getMqttUser();
+    password   = settingsManager.getMqttPassword();
+    port       = settingsManager.getMqttPort();
+    configured = broker.length() > 0;
+
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(topicPrefix, sizeof(topicPrefix), "ofs/%02x%02x%02x%02x%02x%02x", mac[0], mac[1],
+             mac[2], mac[3], mac[4], mac[5]);
+    snprintf(clientId, sizeof(clientId), "ofs-%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2],
+             mac[3], mac[4], mac[5]);
+
+    if (configured)
+    {
+        mqttClient.setServer(broker.c_str(), (uint16_t) port);
+        logger.logf("MQTT publishing to %s:%d under %s", broker.c_str(), port, topicPrefix);
+    }
+
+    // Retry immediately with the new settings
+    lastAttemptMs = 0;
+    backoffMs     = kReconnectMinBackoffMs;
+}
+
+bool tryConnect(unsigned long now)
+{
+    if (lastAttemptMs != 0 && now - lastAttemptMs < backoffMs)
+    {
+        return false;
+    }
+    lastAttemptMs = now;
+
+    char willTopic[kTopicBufSize];
+    buildTopic(willTopic, "availability");
+    const char *userArg = user.length() > 0 ? user.c_str() : nullptr;
+    const char *passArg = password.length() > 0 ? password.c_str() : nullptr;
+
+    if (!mqttClient.connect(clientId, userArg, passArg, willTopic, 0, true, "offline"))
+    {
+        backoffMs = (backoffMs * 2 > kReconnectMaxBackoffMs) ? kReconnectMaxBackoffMs : backoffMs * 2;
+        logger.logf("MQTT connect to %s failed (state %d), retry in %lus", broker.c_str(),
+                    mqttClient.state(), backoffMs / 1000);
+        return false;
+    }
+
+    backoffMs = kReconnectMinBackoffMs;
+    mqttClient.publish(willTopic, "online", true);
+    logger.log("MQTT connected");
+
+    // Republish everything on the new session
+    lastJam     = -1;
+    lastRunout  = -1;
+    lastInfoGen = 0;
+    return true;
+}
+
+void publishMetrics(unsigned long now)
+{
+    printer_info_t       info      = elegooCC.getCurrentInformation();
+    detection_snapshot_t detection = elegooCC.getDetectionSnapshot();
+    const JamState      &jam       = detection.jamState;
+
+    char payload[kStatusBufSize];
+    int  len = snprintf(
+        payload, sizeof(payload),
+        "{\"stopped\":%s,\"filamentRunout\":%s,\"elegoo\":{"
+        "\"printStatus\":%d,\"isPrinting\":%s,\"progress\":%d,"
+        "\"currentLayer\":%d,\"totalLayer\":%d,"
+        "\"expectedFilament\":%.2f,\"actualFilament\":%.2f,"
+        "\"currentDeficitMm\":%.2f,\"deficitRatio\":%.3f,\"smoothedDeficitRatio\":%.3f,"
+        "\"passRatio\":%.3f,\"hardJamPercent\":%.1f,\"softJamPercent\":%.1f,"
+        "\"expectedRateMmPerSec\":%.2f,\"actualRateMmPerSec\":%.2f,"
+        "\"graceActive\":%s,\"graceState\":%u,\"telemetryAvailable\":%s}}",
+        boolText(jam.jammed), boolText(info.filamentRunout), (int) info.printStatus,
+        boolText(info.isPrinting), info.progress, info.currentLayer, info.totalLayer,
+        info.expectedFilamentMM, info.actualFilamentMM, jam.deficit, info.deficitRatio,
+        jam.deficitRatio, jam.passRatio, jam.hardJamPercent, jam.softJamPercent,
+        jam.expectedRateMmPerSec, jam.actualRateMmPerSec, boolText(jam.graceActive),
+        (unsigned) jam.graceState, boolText(info.telemetryAvailable));
+    if (len <= 0 || (size_t) len >= sizeof(payload))
+    {
+        return;
+    }
+
+    if (publishLeaf("status", payload, false))
+    {
+        lastMetricsMs = now;
+    }
+}
+}  // namespace
+
+void mqttPublisherBegin()
+{
+    mqttClient.setBufferSize(kMqttBufferSize);
+    settingsDirty = true;  // Settings and MAC are read on the first loop
+}
+
+void mqttPublisherRefreshSettings()
+{
+    settingsDirty = true;
+}
+
+void mqttPublisherLoop()
+{
+    if (settingsDirty)
+    {
+        applySettings();
+    }
+
+    if (!configured || WiFi.status() != WL_CONNECTED)
+    {
+        return;
+    }
+
+    unsigned long now = millis();
+
+    if (!mqttClient.connected())
+    {
+        if (wasConnected)
+        {
+            wasConnected = false;
+            logger.log("MQTT connection lost");
+        }
+        if (!tryConnect(now))
+        {
+            return;
+        }
+        wasConnected = true;
+    }
+
+    mqttClient.loop();
+
+    // Transitions go out immediately, metrics are rate limited
+    int8_t jam    = elegooCC.isJammed() ? 1 : 0;
+    int8_t runout = elegooCC.isFilamentRunout() ? 1 : 0;
+    bool   transition = false;
+
+    if (jam != lastJam && publishLeaf("jam", jam ? "ON" : "OFF", true))
+    {
+        lastJam    = jam;
+        transition = true;
+    }
+    if (runout != lastRunout && publishLeaf("runout", runout ? "ON" : "OFF", true))
+    {
+        lastRunout = runout;
+        transition = true;
+    }
+
+    uint32_t infoGen = elegooCC.getInformationGeneration();
+    if (transition ||
+        (infoGen != lastInfoGen && now - lastMetricsMs >= MQTT_METRICS_INTERVAL_MS))
+    {
+        lastInfoGen = infoGen;
+        publishMetrics(now);
+    }
+}
+
+#else // ENABLE_MQTT not defined
+
+// No-op stubs when MQTT is disabled
+void mqttPublisherBegin() {}
+void mqttPublisherLoop() {}
+void mqttPublisherRefreshSettings() {}
+
+#endif // ENABLE_MQTT
@@ -0,0 +1,45 @@
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <Arduino.h>
+
+/**
+ * MqttPublisher - Optional push telemetry to an MQTT broker
+ *
+ * Enabled via -D ENABLE_MQTT=1 build flag and a non-empty mqtt_broker setting.
+ * When disabled, all functions are no-ops for zero overhead.
+ *
+ * Topics (prefix is ofs/<mac without colons, lowercase>):
+ *   <prefix>/availability   "online"/"offline" (retained, offline is the LWT)
+ *   <prefix>/jam            "ON"/"OFF" (retained), published on every transition
+ *   <prefix>/runout         "ON"/"OFF" (retained), published on every transition
+ *   <prefix>/status         JSON metrics in the /sensor_status shape, published
+ *                           when they change but at most every MQTT_METRICS_INTERVAL_MS
+ *
+ * Jam and runout transitions are read from the lock-free ElegooCC snapshots on
+ * every main loop pass, so they reach the broker within a few milliseconds of
+ * the detection task raising them instead of one HTTP poll interval later.
+ */
+
+// Minimum spacing between metrics publishes (transitions are never throttled)
+#ifndef MQTT_METRICS_INTERVAL_MS
+#define MQTT_METRICS_INTERVAL_MS 1000
+#endif
+
+/**
+ * Initialize the publisher from settings.
+ * Call once after WiFi is up.
+ */
+void mqttPublisherBegin();
+
+/**
+ * Service the MQTT connection and publish pending changes (call in main loop).
+ */
+void mqttPublisherLoop();
+
+/**
+ * Re-read broker settings and reconnect on the next loop (call after settings save).
+ */
+void mqttPublisherRefreshSettings();
+
+#endif // MQTT_PUBLISHER_H
@@ -0,0 +1,133 @@
+#include "PerfMonitor.h"
+
+#include <string.h>
+
+#include "LockProfiler.h"
+
+PerfMonitor &PerfMonitor::getInstance()
+{
+    static PerfMonitor instance;
+    return instance;
+}
+
+PerfMonitor::PerfMonitor()
+{
+    statsMutex = portMUX_INITIALIZER_UNLOCKED;
+    LOCK_PROFILE_NAME(&statsMutex, "PerfMonitor::statsMutex");
+    clearLocked();
+}
+
+void PerfMonitor::clearLocked()
+{
+    memset(phases, 0, sizeof(phases));
+    for (uint8_t i = 0; i < PERF_PHASE_COUNT; i++)
+    {
+        phases[i].minUs = UINT32_MAX;
+    }
+    resetAtMs = millis();
+}
+
+void PerfMonitor::record(PerfPhase phase, uint32_t durationUs)
+{
+#if !PERF_MONITOR_ENABLED
+    return;
+#endif
+    if (phase >= PERF_PHASE_COUNT)
+    {
+        return;
+    }
+
+    // Bucket = position of the highest set bit, computed before taking the lock
+    uint8_t bucket = durationUs == 0 ? 0 : static_cast<uint8_t>(31 - __builtin_clz(durationUs));
+    if (bucket >= PERF_BUCKET_COUNT)
+    {
+        bucket = PERF_BUCKET_COUNT - 1;
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    perf_phase_stats_t &stats = phases[phase];
+    stats.count++;
+    stats.totalUs += durationUs;
+    if (durationUs < stats.minUs)
+    {
+        stats.minUs = durationUs;
+    }
+    if (durationUs > stats.maxUs)
+    {
+        stats.maxUs = durationUs;
+    }
+    stats.buckets[bucket]++;
+    portEXIT_CRITICAL(&statsMutex);
+}
+
+void PerfMonitor::snapshot(PerfPhase phase, perf_phase_stats_t &out)
+{
+    if (phase >= PERF_PHASE_COUNT)
+    {
+        memset(&out, 0, sizeof(out));
+        return;
+    }
+
+    portENTER_CRITICAL(&statsMutex);
+    out = phases[phase];
+    portEXIT_CRITICAL(&statsMutex);
+
+    if (out.count == 0)
+    {
+        out.minUs = 0;
+    }
+}
+
+void PerfMonitor::reset()
+{
+    portENTER_CRITICAL(&statsMutex);
+    clearLocked();
+    portEXIT_CRITICAL(&statsMutex);
+}
+
+uint32_t PerfMonitor::sinceResetMs() const
+{
+    return millis() - resetAtMs;
+}
+
+const char *PerfMonitor::phaseName(PerfPhase phase)
+{
+    switch (phase)
+    {
+        case PERF_MAIN_LOOP:       return "mainLoop";
+        case PERF_SYSTEM_SERVICES: return "systemServices";
+        case PERF_ELEGOO_LOOP:     return "elegooLoop";
+        case PERF_SDCP_JSON_PARSE: return "sdcpJsonParse";
+        case PERF_DETECTION_CYCLE: return "detectionCycle";
+        case PERF_REFRESH_CACHE:   return "refreshCache";
+        case PERF_SSE_BROADCAST:   return "sseBroadcast";
+        case PERF_DISPLAY_LOOP:    return "displayLoop";
+        default:                   return "unknown";
+    }
+}
+
+uint32_t PerfMonitor::percentileUs(const perf_phase_stats_t &stats, float percentile)
+{
+    if (stats.count == 0)
+    {
+        return 0;
+    }
+
+    // Smallest bucket whose cumulative count reaches the rank
+    uint64_t rank = static_cast<uint64_t>(stats.count * (percentile / 100.0f) + 0.5f);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (uint8_t i = 0; i < PERF_BUCKET_COUNT; i++)
+    {
+        seen += stats.buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t upper = (i + 1 < PERF_BUCKET_COUNT) ? ((1UL << (i + 1)) - 1) : stats.maxUs;
+            return upper < stats.maxUs ? upper : stats.maxUs;
+        }
+    }
+    return stats.maxUs;
+}
@@ -0,0 +1,102 @@
+#ifndef PERF_MONITOR_H
+#define PERF_MONITOR_H
+
+#include <Arduino.h>
+
+/**
+ * PerfMonitor - fixed-bucket latency histograms per firmware phase
+ *
+ * Each phase keeps a count, min/max/total and a histogram of power-of-two
+ * microsecond buckets (bucket i holds durations in [2^i, 2^(i+1)) us, bucket
+ * 0 also holds 0 us, the last one everything longer). Recording is a few
+ * adds under a spinlock, cheap enough to leave on in production builds.
+ *
+ * Served at /api/perf (JSON, includes an estimated p99 per phase) and reset
+ * with POST /api/perf/reset.
+ *
+ * Usage:
+ *   {
+ *       PerfScope scope(PERF_ELEGOO_LOOP);
+ *       ElegooCC::loopSessions();
+ *   }
+ */
+
+#ifndef PERF_MONITOR_ENABLED
+#define PERF_MONITOR_ENABLED 1
+#endif
+
+enum PerfPhase : uint8_t
+{
+    PERF_MAIN_LOOP = 0,      // One full pass of loop()
+    PERF_SYSTEM_SERVICES,    // systemServices.loop()
+    PERF_ELEGOO_LOOP,        // ElegooCC::loopSessions() (SDCP transport + protocol)
+    PERF_SDCP_JSON_PARSE,    // deserializeJson in ElegooCC::webSocketEvent
+    PERF_DETECTION_CYCLE,    // One checkFilamentMovement() on the detection task
+    PERF_REFRESH_CACHE,      // WebServer::refreshCachedResponses()
+    PERF_SSE_BROADCAST,      // WebServer::broadcastStatusUpdate()
+    PERF_DISPLAY_LOOP,       // statusDisplayLoop()
+    PERF_PHASE_COUNT
+};
+
+static const uint8_t PERF_BUCKET_COUNT = 22;  // Last bucket: >= 2^21 us (~2.1 s)
+
+struct perf_phase_stats_t
+{
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t buckets[PERF_BUCKET_COUNT];
+};
+
+class PerfMonitor
+{
+  public:
+    static PerfMonitor &getInstance();
+
+    void record(PerfPhase phase, uint32_t durationUs);
+
+    // Consistent copy of one phase's counters
+    void snapshot(PerfPhase phase, perf_phase_stats_t &out);
+
+    void reset();
+
+    // Milliseconds since the last reset
+    uint32_t sinceResetMs() const;
+
+    static const char *phaseName(PerfPhase phase);
+
+    // Upper bound of the bucket holding the given percentile (0-100), capped at maxUs
+    static uint32_t percentileUs(const perf_phase_stats_t &stats, float percentile);
+
+  private:
+    PerfMonitor();
+    PerfMonitor(const PerfMonitor &) = delete;
+    PerfMonitor &operator=(const PerfMonitor &) = delete;
+
+    perf_phase_stats_t phases[PERF_PHASE_COUNT];
+    uint32_t           resetAtMs;
+    portMUX_TYPE       statsMutex;
+
+    void clearLocked();
+};
+
+#define perfMonitor PerfMonitor::getInstance()
+
+// Times the enclosing scope into a phase
+class PerfScope
+{
+  public:
+#if PERF_MONITOR_ENABLED
+    explicit PerfScope(PerfPhase phase) : phase(phase), startUs(micros()) {}
+    ~PerfScope() { perfMonitor.record(phase, micros() - startUs); }
+
+  private:
+    PerfPhase phase;
+    uint32_t  startUs;
+#else
+    explicit PerfScope(PerfPhase) {}
+#endif
+};
+
+#endif  // PERF_MONITOR_H
@@ -0,0 +1,283 @@
+#include "PulseCounter.h"
+
+#include <esp_timer.h>
+
+#include "Logger.h"
+
+#if PULSE_COUNTER_USE_PCNT
+#include <esp_idf_version.h>
+#include <soc/soc_caps.h>
+#if !SOC_PCNT_SUPPORTED
+// Chip has no pulse counter peripheral (e.g. ESP32-C3): use the ISR path.
+#undef PULSE_COUNTER_USE_PCNT
+#define PULSE_COUNTER_USE_PCNT 0
+#elif ESP_IDF_VERSION_MAJOR >= 5
+#include <driver/pulse_cnt.h>
+#else
+#include <driver/pcnt.h>
+#endif
+#endif
+
+PulseCounter::Channel PulseCounter::channels[PULSE_COUNTER_MAX_CHANNELS];
+TaskHandle_t volatile PulseCounter::notifyTask = nullptr;
+
+namespace
+{
+// The counter auto-clears when it reaches the high limit; read() extends the
+// 16-bit value to a running total by diffing modulo this limit.
+constexpr int kPcntHighLimit = 32767;
+
+#if PULSE_COUNTER_USE_PCNT && ESP_IDF_VERSION_MAJOR >= 5
+pcnt_unit_handle_t pcntUnits[PULSE_COUNTER_MAX_CHANNELS] = {};
+#endif
+}  // namespace
+
+PulseCounter &PulseCounter::getInstance()
+{
+    static PulseCounter instance;
+    return instance;
+}
+
+void PulseCounter::begin(uint8_t channelIndex, int pin)
+{
+    if (channelIndex >= PULSE_COUNTER_MAX_CHANNELS)
+    {
+        return;
+    }
+    Channel &channel = channels[channelIndex];
+    pinMode(pin, INPUT);
+
+    if (beginHardware(channelIndex, pin))
+    {
+        channel.hardwareActive  = true;
+        channel.lastHardwareRaw = readHardwareRaw(channelIndex);
+        channel.hardwareTotal   = 0;
+        logger.logf("Pulse detection (channel %u) via PCNT on GPIO%d (glitch filter %dns)",
+                    channelIndex, pin, PULSE_COUNTER_GLITCH_NS);
+        return;
+    }
+
+    // Rising edge trigger: counts each time sensor goes LOW->HIGH
+    channel.pulseTimes.clear();
+    attachInterruptArg(digitalPinToInterrupt(pin), PulseCounter::isrHandler, &channel, RISING);
+    logger.logf("Pulse detection (channel %u) via GPIO%d interrupt enabled", channelIndex, pin);
+}
+
+bool PulseCounter::usesHardwareCounter(uint8_t channel) const
+{
+    return channel < PULSE_COUNTER_MAX_CHANNELS && channels[channel].hardwareActive;
+}
+
+unsigned long PulseCounter::read(uint8_t channelIndex)
+{
+    if (channelIndex >= PULSE_COUNTER_MAX_CHANNELS)
+    {
+        return 0;
+    }
+    Channel &channel = channels[channelIndex];
+    if (!channel.hardwareActive)
+    {
+        return channel.isrPulseCounter;
+    }
+
+    int raw = readHardwareRaw(channelIndex);
+    if (raw >= kPcntHighLimit)
+    {
+        raw = 0;  // Limit value is observed only transiently before auto-clear
+    }
+    int delta = raw - channel.lastHardwareRaw;
+    if (delta < 0)
+    {
+        delta += kPcntHighLimit;
+    }
+    channel.lastHardwareRaw = raw;
+    channel.hardwareTotal += static_cast<unsigned long>(delta);
+    return channel.hardwareTotal;
+}
+
+bool PulseCounter::popPulseTime(unsigned long &pulseMs, uint8_t channelIndex)
+{
+    uint32_t pulseUs = 0;
+    if (channelIndex >= PULSE_COUNTER_MAX_CHANNELS || channels[channelIndex].hardwareActive ||
+        !channels[channelIndex].pulseTimes.pop(pulseUs))
+    {
+        return false;
+    }
+
+    // Convert the ISR's microsecond stamp to the millis() timebase used by
+    // FilamentMotionSensor. Unsigned subtraction handles the 32-bit wrap
+    // (~71 minutes), far longer than any pulse stays queued.
+    uint32_t      ageUs = static_cast<uint32_t>(esp_timer_get_time()) - pulseUs;
+    unsigned long now   = millis();
+    unsigned long ageMs = ageUs / 1000UL;
+    pulseMs             = (ageMs < now) ? (now - ageMs) : 0;
+    return true;
+}
+
+void PulseCounter::discardPulseTimes(uint8_t channel)
+{
+    if (channel < PULSE_COUNTER_MAX_CHANNELS)
+    {
+        channels[channel].pulseTimes.clear();
+    }
+}
+
+#if PULSE_COUNTER_USE_PCNT && ESP_IDF_VERSION_MAJOR >= 5
+
+bool PulseCounter::beginHardware(uint8_t channel, int pin)
+{
+    pcnt_unit_handle_t &pcntUnit = pcntUnits[channel];
+    pcnt_unit_config_t unitConfig = {};
+    unitConfig.low_limit          = -1;  // Never reached: we only count up
+    unitConfig.high_limit         = kPcntHighLimit;
+    if (pcnt_new_unit(&unitConfig, &pcntUnit) != ESP_OK)
+    {
+        pcntUnit = nullptr;
+        return false;
+    }
+
+    pcnt_glitch_filter_config_t filterConfig = {};
+    filterConfig.max_glitch_ns               = PULSE_COUNTER_GLITCH_NS;
+    if (pcnt_unit_set_glitch_filter(pcntUnit, &filterConfig) != ESP_OK)
+    {
+        // Still count, but edge noise now reaches the detector unfiltered
+        logger.logf("PCNT glitch filter (%dns) rejected on channel %u; counting unfiltered",
+                    PULSE_COUNTER_GLITCH_NS, channel);
+    }
+
+    pcnt_chan_config_t chanConfig = {};
+    chanConfig.edge_gpio_num      = pin;
+    chanConfig.level_gpio_num     = -1;
+    pcnt_channel_handle_t pcntChannel = nullptr;
+    if (pcnt_new_channel(pcntUnit, &chanConfig, &pcntChannel) != ESP_OK)
+    {
+        pcnt_del_unit(pcntUnit);
+        pcntUnit = nullptr;
+        return false;
+    }
+
+    // On any later failure release the channel and unit so the GPIO is no
+    // longer routed to PCNT before begin() attaches the ISR fallback to it
+    bool enabled = false;
+    if (pcnt_channel_set_edge_action(pcntChannel, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                     PCNT_CHANNEL_EDGE_ACTION_HOLD) == ESP_OK &&
+        pcnt_channel_set_level_action(pcntChannel, PCNT_CHANNEL_LEVEL_ACTION_KEEP,
+                                      PCNT_CHANNEL_LEVEL_ACTION_KEEP) == ESP_OK &&
+        (enabled = (pcnt_unit_enable(pcntUnit) == ESP_OK)) &&
+        pcnt_unit_clear_count(pcntUnit) == ESP_OK && pcnt_unit_start(pcntUnit) == ESP_OK)
+    {
+        return true;
+    }
+
+    if (enabled)
+    {
+        pcnt_unit_disable(pcntUnit);
+    }
+    pcnt_del_channel(pcntChannel);
+    pcnt_del_unit(pcntUnit);
+    pcntUnit = nullptr;
+    return false;
+}
+
+int PulseCounter::readHardwareRaw(uint8_t channel)
+{
+    int value = 0;
+    pcnt_unit_get_count(pcntUnits[channel], &value);
+    return value;
+}
+
+#elif PULSE_COUNTER_USE_PCNT
+
+bool PulseCounter::beginHardware(uint8_t channel, int pin)
+{
+    // One legacy PCNT unit per channel
+    if (channel >= PCNT_UNIT_MAX)
+    {
+        return false;
+    }
+    pcnt_unit_t   unit    = static_cast<pcnt_unit_t>(PCNT_UNIT_0 + channel);
+    pcnt_config_t config  = {};
+    config.pulse_gpio_num = pin;
+    config.ctrl_gpio_num  = PCNT_PIN_NOT_USED;
+    config.lctrl_mode     = PCNT_MODE_KEEP;
+    config.hctrl_mode     = PCNT_MODE_KEEP;
+    config.pos_mode       = PCNT_COUNT_INC;
+    config.neg_mode       = PCNT_COUNT_DIS;
+    config.counter_h_lim  = kPcntHighLimit;
+    config.counter_l_lim  = 0;
+    config.unit           = unit;
+    config.channel        = PCNT_CHANNEL_0;
+    if (pcnt_unit_config(&config) != ESP_OK)
+    {
+        return false;
+    }
+
+    // Filter value is in APB clock cycles (80MHz) and limited to 10 bits
+    uint32_t filterCycles = (uint32_t) PULSE_COUNTER_GLITCH_NS * (APB_CLK_FREQ / 1000000) / 1000;
+    if (filterCycles > 1023)
+    {
+        filterCycles = 1023;
+    }
+    pcnt_set_filter_value(unit, filterCycles);
+    pcnt_filter_enable(unit);
+
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    return pcnt_counter_resume(unit) == ESP_OK;
+}
+
+int PulseCounter::readHardwareRaw(uint8_t channel)
+{
+    int16_t value = 0;
+    pcnt_get_counter_value(static_cast<pcnt_unit_t>(PCNT_UNIT_0 + channel), &value);
+    return value;
+}
+
+#else
+
+bool PulseCounter::beginHardware(uint8_t channel, int pin)
+{
+    (void) channel;
+    (void) pin;
+    return false;
+}
+
+int PulseCounter::readHardwareRaw(uint8_t channel)
+{
+    (void) channel;
+    return 0;
+}
+
+#endif
+
+// ============================================================================
+// Fallback interrupt handler that increments the pulse counter on rising edge.
+// Guarantees no pulses are dropped even during loop stalls, at the cost of an
+// interrupt per edge.
+// Execution time: ~2-3 microseconds (very fast, safe for ISR), plus a task
+// notification when a consumer sleeps on pulses (setNotifyTask).
+// ============================================================================
+void IRAM_ATTR PulseCounter::isrHandler(void *arg)
+{
+    // Timestamp first, count second: the consumer reads the count and then
+    // pops at most that many stamps, so while the ring has room every stamp
+    // belongs to a counted pulse. Once it fills, stamps are dropped but the
+    // count still advances; a later drain may then pop stamps that newer
+    // pulses pushed after the count was read and assign them to older ones.
+    // The misalignment is bounded by the number of dropped stamps, and the
+    // affected pulses are only ever binned later than they happened.
+    Channel *channel = static_cast<Channel *>(arg);
+    channel->pulseTimes.push(static_cast<uint32_t>(esp_timer_get_time()));
+    channel->isrPulseCounter++;
+
+    TaskHandle_t task = notifyTask;
+    if (task != nullptr)
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        if (woken == pdTRUE)
+        {
+            portYIELD_FROM_ISR();
+        }
+    }
+}
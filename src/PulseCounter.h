@@ -0,0 +1,117 @@
+#ifndef PULSE_COUNTER_H
+#define PULSE_COUNTER_H
+
+#include <Arduino.h>
+
+#include "PulseTimestampRing.h"
+
+/**
+ * PulseCounter - movement sensor pulse source
+ *
+ * Two implementations, selected at build time:
+ *   - PCNT (-D PULSE_COUNTER_USE_PCNT=1): the pulse counter peripheral counts
+ *     rising edges in hardware with its glitch filter enabled, so noisy edge
+ *     bursts are rejected before they reach software and no CPU time is spent
+ *     per pulse. Only available on chips with PCNT (ESP32, S2, S3, C6, H2).
+ *   - GPIO ISR (fallback): one interrupt per rising edge increments a counter.
+ *     Used on chips without PCNT (ESP32-C3) or when PCNT setup fails.
+ *
+ * Either way, read() returns a monotonically increasing pulse total that the
+ * caller diffs against its previous reading. read() must be called from a
+ * single consumer (the movement check) at least once per ~32k pulses.
+ *
+ * The ISR path also records each pulse's arrival time in a lock-free ring so
+ * pulses can be binned by when they happened rather than when the loop got
+ * around to draining them. PCNT has no per-pulse timestamps; popPulseTime()
+ * returns false there and the caller estimates arrival times instead.
+ *
+ * Up to PULSE_COUNTER_MAX_CHANNELS sensors (one per filament path) are
+ * counted independently; each channel has its own total, PCNT unit or ISR,
+ * and timestamp ring. The single-channel calls address channel 0.
+ */
+
+#ifndef PULSE_COUNTER_USE_PCNT
+#define PULSE_COUNTER_USE_PCNT 0
+#endif
+
+// Glitch filter width for PCNT: edges shorter than this are ignored.
+// Sensor pulses are milliseconds wide, contact bounce is a few microseconds.
+#ifndef PULSE_COUNTER_GLITCH_NS
+#define PULSE_COUNTER_GLITCH_NS 10000
+#endif
+
+#ifndef PULSE_COUNTER_MAX_CHANNELS
+#define PULSE_COUNTER_MAX_CHANNELS 4
+#endif
+
+class PulseCounter
+{
+  public:
+    static PulseCounter &getInstance();
+
+    /**
+     * Configure the pulse source on the given pin.
+     * Tries PCNT first when enabled at build time, then falls back to the ISR.
+     */
+    void begin(int pin) { begin(0, pin); }
+    void begin(uint8_t channel, int pin);
+
+    /**
+     * Total pulses counted since begin() (wraps at ULONG_MAX like the old ISR counter).
+     */
+    unsigned long read(uint8_t channel = 0);
+
+    /**
+     * True when pulses are being counted by the PCNT peripheral.
+     */
+    bool usesHardwareCounter(uint8_t channel = 0) const;
+
+    /**
+     * Pop the arrival time (millis() domain) of the oldest undrained pulse.
+     * Call after read(), at most once per newly counted pulse.
+     * Returns false when no timestamp is queued (PCNT, or ring overflowed).
+     */
+    bool popPulseTime(unsigned long &pulseMs, uint8_t channel = 0);
+
+    /**
+     * Drop queued timestamps for pulses the caller is discarding.
+     */
+    void discardPulseTimes(uint8_t channel = 0);
+
+    /**
+     * Task the ISR path notifies on every pulse (nullptr = none), so the
+     * consumer can sleep until pulses arrive. PCNT counts silently; its
+     * consumer keeps polling.
+     */
+    void setNotifyTask(TaskHandle_t task) { notifyTask = task; }
+
+  private:
+    PulseCounter() = default;
+    PulseCounter(const PulseCounter &)            = delete;
+    PulseCounter &operator=(const PulseCounter &) = delete;
+
+    // Microsecond timestamps (esp_timer, truncated to 32 bits) of ISR pulses
+    static const size_t PULSE_TIME_RING_SIZE = 128;
+
+    struct Channel
+    {
+        volatile unsigned long                   isrPulseCounter;
+        PulseTimestampRing<PULSE_TIME_RING_SIZE> pulseTimes;
+        bool                                     hardwareActive;
+        int                                      lastHardwareRaw;
+        unsigned long                            hardwareTotal;
+    };
+
+    bool beginHardware(uint8_t channel, int pin);
+    int  readHardwareRaw(uint8_t channel);
+
+    // ISR argument is the channel's entry in `channels`
+    static void IRAM_ATTR isrHandler(void *arg);
+    static Channel channels[PULSE_COUNTER_MAX_CHANNELS];
+    static TaskHandle_t volatile notifyTask;
+};
+
+// Convenience macro for easier access
+#define pulseCounter PulseCounter::getInstance()
+
+#endif  // PULSE_COUNTER_H
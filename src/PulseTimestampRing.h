@@ -0,0 +1,74 @@
+#ifndef PULSE_TIMESTAMP_RING_H
+#define PULSE_TIMESTAMP_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * PulseTimestampRing - lock-free single-producer/single-consumer ring
+ *
+ * The producer (GPIO ISR) pushes one timestamp per pulse, the consumer
+ * (movement check) pops them in arrival order. Each index is written by only
+ * one side and published with release/acquire ordering, so no critical section
+ * is needed on either core. When full, push() drops the new timestamp; the
+ * pulse itself is still counted by the caller and gets an estimated time.
+ *
+ * Capacity must be a power of two. The ring holds Capacity - 1 entries.
+ */
+template <size_t Capacity>
+class PulseTimestampRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+  public:
+    PulseTimestampRing() : head(0), tail(0) {}
+
+    // Producer side (ISR). Returns false when the ring is full.
+    inline bool push(uint32_t timestamp)
+    {
+        uint32_t h    = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        uint32_t next = (h + 1) & kMask;
+        if (next == __atomic_load_n(&tail, __ATOMIC_ACQUIRE))
+        {
+            return false;
+        }
+        slots[h] = timestamp;
+        __atomic_store_n(&head, next, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    inline bool pop(uint32_t &timestamp)
+    {
+        uint32_t t = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+        if (t == __atomic_load_n(&head, __ATOMIC_ACQUIRE))
+        {
+            return false;
+        }
+        timestamp = slots[t];
+        __atomic_store_n(&tail, (t + 1) & kMask, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Consumer side: drop everything currently queued.
+    inline void clear()
+    {
+        __atomic_store_n(&tail, __atomic_load_n(&head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    }
+
+    inline size_t size() const
+    {
+        uint32_t h = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+        uint32_t t = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+        return (h - t) & kMask;
+    }
+
+  private:
+    static const uint32_t kMask = Capacity - 1;
+
+    volatile uint32_t slots[Capacity];
+    uint32_t          head;  // Written by producer only
+    uint32_t          tail;  // Written by consumer only
+};
+
+#endif  // PULSE_TIMESTAMP_RING_H
@@ -1,6 +1,14 @@
 #include "SDCPProtocol.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "ElegooCC.h"
 
+// Filter nodes: ~25 keys, each key stored by pointer (string literals)
+static const size_t MESSAGE_FILTER_CAPACITY = 640;
+
 bool SDCPProtocol::buildCommandMessage(
     JsonDocument& doc,
     int command,
@@ -45,6 +53,87 @@ bool SDCPProtocol::buildCommandMessage(
     return true;
 }
 
+void SDCPProtocol::generateRequestId(char* out) {
+    static const char kHex[] = "0123456789abcdef";
+    for (size_t i = 0; i < REQUEST_ID_LENGTH; i += 8) {
+        uint32_t bits = esp_random();
+        for (size_t j = 0; j < 8; ++j) {
+            out[i + j] = kHex[bits & 0x0F];
+            bits >>= 4;
+        }
+    }
+    out[REQUEST_ID_LENGTH] = '\0';
+}
+
+// IDs are embedded in JSON strings unescaped; reject anything that would
+// need escaping rather than emit a malformed frame.
+static bool isPlainJsonString(const char* value) {
+    for (const char* p = value; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\' || static_cast<unsigned char>(*p) < 0x20) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t SDCPProtocol::encodeCommandMessage(
+    char* buffer,
+    size_t bufferSize,
+    int command,
+    const char* requestId,
+    const char* mainboardId,
+    unsigned long timestamp,
+    int printStatus,
+    uint8_t machineStatusMask
+) {
+    if (buffer == nullptr || bufferSize == 0) {
+        return 0;
+    }
+    if (mainboardId == nullptr) {
+        mainboardId = "";
+    }
+    if (!isPlainJsonString(requestId) || !isPlainJsonString(mainboardId)) {
+        return 0;
+    }
+
+    // CurrentStatus array from the machine status bitmask, e.g. "1,3"
+    char   statusList[16];
+    size_t statusLen = 0;
+    statusList[0] = '\0';
+    for (int s = 0; s <= 4; ++s) {
+        if ((machineStatusMask & (1 << s)) != 0) {
+            if (statusLen > 0) {
+                statusList[statusLen++] = ',';
+            }
+            statusList[statusLen++] = static_cast<char>('0' + s);
+            statusList[statusLen] = '\0';
+        }
+    }
+
+    // Same field order as buildCommandMessage(); Topic only when the
+    // MainboardID is known (matches the Elegoo HA integration)
+    int written = snprintf(
+        buffer, bufferSize,
+        "{\"Id\":\"%s\",\"Data\":{\"Cmd\":%d,\"RequestID\":\"%s\",\"MainboardID\":\"%s\","
+        "\"TimeStamp\":%lu,\"From\":0,\"Data\":{},\"PrintStatus\":%d,\"CurrentStatus\":[%s]}",
+        requestId, command, requestId, mainboardId, timestamp, printStatus, statusList);
+    if (written < 0 || static_cast<size_t>(written) >= bufferSize) {
+        return 0;
+    }
+
+    size_t length = static_cast<size_t>(written);
+    if (mainboardId[0] != '\0') {
+        written = snprintf(buffer + length, bufferSize - length,
+                           ",\"Topic\":\"sdcp/request/%s\"}", mainboardId);
+    } else {
+        written = snprintf(buffer + length, bufferSize - length, "}");
+    }
+    if (written < 0 || static_cast<size_t>(written) >= bufferSize - length) {
+        return 0;
+    }
+    return length + static_cast<size_t>(written);
+}
+
 bool SDCPProtocol::tryReadExtrusionValue(
     JsonObject& printInfo,
     const char* key,
@@ -63,3 +152,60 @@ bool SDCPProtocol::tryReadExtrusionValue(
 
     return false;
 }
+
+const JsonDocument& SDCPProtocol::messageFilter() {
+    static StaticJsonDocument<MESSAGE_FILTER_CAPACITY> filter;
+    static bool built = false;
+    if (built) {
+        return filter;
+    }
+
+    // Command acknowledgment
+    filter["Id"] = true;
+    filter["MainboardID"] = true;
+    JsonObject data = filter.createNestedObject("Data");
+    data["Cmd"] = true;
+    data["RequestID"] = true;
+    data["MainboardID"] = true;
+    data["Data"]["Ack"] = true;
+
+    // Status push
+    JsonObject status = filter.createNestedObject("Status");
+    status["CurrentStatus"] = true;
+    status["CurrenCoord"] = true;
+    JsonObject printInfo = status.createNestedObject("PrintInfo");
+    printInfo["Status"] = true;
+    printInfo["CurrentLayer"] = true;
+    printInfo["TotalLayer"] = true;
+    printInfo["Progress"] = true;
+    printInfo["CurrentTicks"] = true;
+    printInfo["TotalTicks"] = true;
+    printInfo["PrintSpeedPct"] = true;
+    printInfo["TaskId"] = true;
+    printInfo["Filename"] = true;
+    printInfo["TotalExtrusion"] = true;
+    printInfo["CurrentExtrusion"] = true;
+    printInfo[SDCPKeys::TOTAL_EXTRUSION_HEX] = true;
+    printInfo[SDCPKeys::CURRENT_EXTRUSION_HEX] = true;
+
+    built = true;
+    return filter;
+}
+
+bool SDCPProtocol::parseCoordinateZ(const char* coords, float& z) {
+    if (coords == nullptr) {
+        return false;
+    }
+
+    const char* firstComma = strchr(coords, ',');
+    if (firstComma == nullptr) {
+        return false;
+    }
+    const char* secondComma = strchr(firstComma + 1, ',');
+    if (secondComma == nullptr) {
+        return false;
+    }
+
+    z = strtof(secondComma + 1, nullptr);
+    return true;
+}
@@ -18,6 +18,20 @@ namespace SDCPTiming {
     constexpr unsigned int  EXPECTED_FILAMENT_STALE_MS = 1000;
     constexpr unsigned int  SDCP_LOSS_TIMEOUT_MS = 10000;
     constexpr unsigned int  PAUSE_REARM_DELAY_MS = 3000;
+
+    // Transport liveness: WebSocket ping every HEARTBEAT_INTERVAL_MS; once the
+    // printer has answered one, silence past HEARTBEAT_DEADLINE_MS drops the link
+    constexpr unsigned long HEARTBEAT_INTERVAL_MS     = 2000;
+    constexpr unsigned long HEARTBEAT_PONG_TIMEOUT_MS = 1500;
+    constexpr unsigned long HEARTBEAT_DEADLINE_MS     = 5000;
+    // TCP keepalive catches a half-open socket even when nothing is sent
+    constexpr int           TCP_KEEPALIVE_IDLE_S      = 2;
+    constexpr int           TCP_KEEPALIVE_INTERVAL_S  = 1;
+    constexpr int           TCP_KEEPALIVE_COUNT       = 3;
+    // Handshake deadline; the first retry after a drop targets a printer that
+    // was reachable moments ago, so it gives up sooner
+    constexpr unsigned long CONNECT_TIMEOUT_MS        = 10000;
+    constexpr unsigned long FAST_RECONNECT_TIMEOUT_MS = 3000;
 }
 
 // SDCP protocol defaults
@@ -33,6 +47,48 @@ namespace SDCPDefaults {
  */
 class SDCPProtocol {
 public:
+    // Request IDs are 32 lowercase hex characters (a dashless UUID)
+    static constexpr size_t REQUEST_ID_LENGTH = 32;
+    static constexpr size_t REQUEST_ID_BUFFER_SIZE = REQUEST_ID_LENGTH + 1;
+
+    // Large enough for any command frame with a 63-char MainboardID
+    static constexpr size_t COMMAND_BUFFER_SIZE = 512;
+
+    /**
+     * Fill a buffer with a random request ID (hardware RNG, no allocation)
+     *
+     * @param out Buffer of at least REQUEST_ID_BUFFER_SIZE bytes
+     */
+    static void generateRequestId(char* out);
+
+    /**
+     * Encode an SDCP command frame straight into a caller buffer
+     *
+     * Produces the same JSON as buildCommandMessage() + serializeJson()
+     * without a JsonDocument or any String temporaries.
+     *
+     * @param buffer Output buffer (COMMAND_BUFFER_SIZE is always enough)
+     * @param bufferSize Size of buffer in bytes
+     * @param command SDCP command code
+     * @param requestId Request identifier from generateRequestId()
+     * @param mainboardId Printer mainboard ID (empty string if unknown)
+     * @param timestamp Current epoch time
+     * @param printStatus Current print status
+     * @param machineStatusMask Bitmask of active machine statuses
+     * @return Length written (excluding terminator), 0 if the buffer is too
+     *         small or an ID contains characters that would need escaping
+     */
+    static size_t encodeCommandMessage(
+        char* buffer,
+        size_t bufferSize,
+        int command,
+        const char* requestId,
+        const char* mainboardId,
+        unsigned long timestamp,
+        int printStatus,
+        uint8_t machineStatusMask
+    );
+
     /**
      * Build an SDCP command JSON payload
      *
@@ -71,6 +127,26 @@ public:
         const char* hexKey,
         float& output
     );
+
+    /**
+     * Deserialization filter for incoming printer messages
+     *
+     * Keeps only the fields the firmware reads from status pushes
+     * (CurrentStatus, CurrenCoord, PrintInfo incl. hex extrusion keys) and
+     * command acknowledgments (Id, Data.Cmd/RequestID/MainboardID/Data.Ack).
+     * Everything else is skipped by the tokenizer without allocating nodes.
+     * Built once on first use.
+     */
+    static const JsonDocument& messageFilter();
+
+    /**
+     * Parse the Z component of a CurrenCoord string ("x,y,z")
+     *
+     * @param coords Coordinate string (may be nullptr)
+     * @param z Output parameter for the Z value
+     * @return true if the string had three components
+     */
+    static bool parseCoordinateZ(const char* coords, float& z);
 };
 
 #endif  // SDCP_PROTOCOL_H
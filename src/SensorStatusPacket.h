@@ -0,0 +1,88 @@
+#ifndef SENSOR_STATUS_PACKET_H
+#define SENSOR_STATUS_PACKET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * SensorStatusPacket - fixed-layout binary form of /sensor_status
+ *
+ * Served at /api/sensor_status.bin for integrations that poll many boards.
+ * Little-endian, no padding, 72 bytes for version 1. Fields may only be
+ * appended; clients must check magic/version and may ignore bytes beyond
+ * the layout they know (`length` is the size the firmware sent).
+ *
+ * Offset  Type      Field
+ *  0      char[2]   magic "OF"
+ *  2      uint8     version (SENSOR_STATUS_PACKET_VERSION)
+ *  3      uint8     length (sizeof packet)
+ *  4      uint8     flags (SensorStatusFlag bits)
+ *  5      uint8     printStatus (sdcp_print_status_t)
+ *  6      uint8     graceState
+ *  7      uint8     progress (%)
+ *  8      uint8[6]  mac
+ * 14      uint8[2]  reserved
+ * 16      uint16    currentLayer
+ * 18      uint16    totalLayer
+ * 20      uint16    printSpeedPct
+ * 22      uint16    reserved
+ * 24      uint32    uptimeSec
+ * 28      uint32    movementPulses
+ * 32      float32   expectedFilament (mm)
+ * 36      float32   actualFilament (mm)
+ * 40      float32   currentDeficitMm
+ * 44      float32   deficitRatio
+ * 48      float32   passRatio
+ * 52      float32   hardJamPercent
+ * 56      float32   softJamPercent
+ * 60      float32   expectedRateMmPerSec
+ * 64      float32   actualRateMmPerSec
+ * 68      float32   currentZ (mm)
+ */
+
+#define SENSOR_STATUS_PACKET_VERSION 1
+
+enum SensorStatusFlag : uint8_t
+{
+    SENSOR_STATUS_FLAG_STOPPED          = 1 << 0,
+    SENSOR_STATUS_FLAG_RUNOUT           = 1 << 1,
+    SENSOR_STATUS_FLAG_PRINTER_CONNECTED = 1 << 2,
+    SENSOR_STATUS_FLAG_PRINTING         = 1 << 3,
+    SENSOR_STATUS_FLAG_GRACE_ACTIVE     = 1 << 4,
+    SENSOR_STATUS_FLAG_TELEMETRY        = 1 << 5,
+    SENSOR_STATUS_FLAG_RUNOUT_PENDING   = 1 << 6,
+    SENSOR_STATUS_FLAG_RUNOUT_COMMANDED = 1 << 7,
+};
+
+struct __attribute__((packed)) sensor_status_packet_t
+{
+    char     magic[2];
+    uint8_t  version;
+    uint8_t  length;
+    uint8_t  flags;
+    uint8_t  printStatus;
+    uint8_t  graceState;
+    uint8_t  progress;
+    uint8_t  mac[6];
+    uint8_t  reserved0[2];
+    uint16_t currentLayer;
+    uint16_t totalLayer;
+    uint16_t printSpeedPct;
+    uint16_t reserved1;
+    uint32_t uptimeSec;
+    uint32_t movementPulses;
+    float    expectedFilament;
+    float    actualFilament;
+    float    currentDeficitMm;
+    float    deficitRatio;
+    float    passRatio;
+    float    hardJamPercent;
+    float    softJamPercent;
+    float    expectedRateMmPerSec;
+    float    actualRateMmPerSec;
+    float    currentZ;
+};
+
+static_assert(sizeof(sensor_status_packet_t) == 72, "sensor_status_packet_t layout is part of the API");
+
+#endif  // SENSOR_STATUS_PACKET_H
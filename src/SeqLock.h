@@ -0,0 +1,58 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * SeqLock - single-writer snapshot that readers copy without locking
+ *
+ * The writer bumps the sequence to odd, copies the value in, then bumps it to
+ * even. Readers copy the value and retry if the sequence was odd or changed
+ * underneath them, so they never block the writer and never see a torn value.
+ *
+ * Only one writer at a time: callers with several writers must serialize
+ * publish() themselves. T must be trivially copyable. Readers must not run at
+ * a higher priority than a writer on the same core (they would spin while the
+ * writer is preempted mid-copy); in this firmware the writer is always the
+ * higher-priority side.
+ */
+template <typename T>
+class SeqLock
+{
+  public:
+    SeqLock() : sequence(0) { memset(&value, 0, sizeof(value)); }
+
+    void publish(const T &newValue)
+    {
+        uint32_t seq = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+        __atomic_store_n(&sequence, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(&value, &newValue, sizeof(T));
+        __atomic_store_n(&sequence, seq + 2, __ATOMIC_RELEASE);
+    }
+
+    T read() const
+    {
+        T out;
+        uint32_t before;
+        uint32_t after;
+        do
+        {
+            before = __atomic_load_n(&sequence, __ATOMIC_ACQUIRE);
+            memcpy(&out, &value, sizeof(T));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            after = __atomic_load_n(&sequence, __ATOMIC_RELAXED);
+        } while ((before & 1u) != 0 || before != after);
+        return out;
+    }
+
+    // Number of completed publishes; changes whenever the value does.
+    uint32_t generation() const { return __atomic_load_n(&sequence, __ATOMIC_ACQUIRE) >> 1; }
+
+  private:
+    uint32_t sequence;
+    T        value;
+};
+
+#endif  // SEQ_LOCK_H
@@ -3,13 +3,26 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <ctype.h>
 #include <cstddef>
 #include <stdlib.h>
+#include <string.h>
 
 #include "Logger.h"
+#include "SettingsRecord.h"
 
 namespace
 {
+// The binary record is what the firmware reads and writes; the JSON file is
+// only imported when there is no valid record (fresh filesystem image, or
+// an upgrade from a JSON-only release)
+const char* const kSettingsRecordPath     = "/user_settings.bin";
+const char* const kSettingsRecordTempPath = "/user_settings.bin.tmp";
+const char* const kSettingsJsonPath       = "/user_settings.json";
+
+// Stack buffer for the record; the full settings payload is well under this
+constexpr size_t kSettingsRecordMaxSize = 2048;
+
 enum class SettingKind
 {
     Bool,
@@ -82,6 +95,11 @@ static const SettingField kSettingFields[] = {
     makeStringField("ssid", offsetof(user_settings, ssid), "", true),
     makeStringField("passwd", offsetof(user_settings, passwd), "", true, true, true),
     makeStringField("elegooip", offsetof(user_settings, elegooip), "", true),
+    makeStringField("extra_printer_ips", offsetof(user_settings, extra_printer_ips), "", true),
+    makeStringField("static_ip", offsetof(user_settings, static_ip), "", true),
+    makeStringField("static_gateway", offsetof(user_settings, static_gateway), "", true),
+    makeStringField("static_subnet", offsetof(user_settings, static_subnet), "", true),
+    makeStringField("static_dns", offsetof(user_settings, static_dns), "", true),
     makeBoolField("pause_on_runout", offsetof(user_settings, pause_on_runout), true),
     makeBoolField("enabled", offsetof(user_settings, enabled), true),
     makeBoolField("has_connected", offsetof(user_settings, has_connected), false),
@@ -95,7 +113,11 @@ static const SettingField kSettingFields[] = {
     makeIntField("detection_hard_jam_time_ms",
                  offsetof(user_settings, detection_hard_jam_time_ms), 3000),
     makeIntField("detection_mode", offsetof(user_settings, detection_mode), 0),
+    makeIntField("motion_window_profile", offsetof(user_settings, motion_window_profile), 0),
+    makeBoolField("predictive_expected", offsetof(user_settings, predictive_expected), false),
+    makeBoolField("adaptive_soft_jam", offsetof(user_settings, adaptive_soft_jam), false),
     makeIntField("sdcp_loss_behavior", offsetof(user_settings, sdcp_loss_behavior), 2),
+    makeIntField("status_poll_mode", offsetof(user_settings, status_poll_mode), 0),
     makeIntField("flow_telemetry_stale_ms", offsetof(user_settings, flow_telemetry_stale_ms), 1500),
     makeIntField("ui_refresh_interval_ms", offsetof(user_settings, ui_refresh_interval_ms), 1000),
     makeIntField("log_level", offsetof(user_settings, log_level), 0),
@@ -107,9 +129,13 @@ static const SettingField kSettingFields[] = {
     makeBoolField("test_recording_mode", offsetof(user_settings, test_recording_mode), false),
     makeBoolField("show_debug_page", offsetof(user_settings, show_debug_page), false),
     makeIntField("timezone_offset_minutes", offsetof(user_settings, timezone_offset_minutes), 0),
+    makeStringField("mqtt_broker", offsetof(user_settings, mqtt_broker), "", true),
+    makeIntField("mqtt_port", offsetof(user_settings, mqtt_port), 1883),
+    makeStringField("mqtt_user", offsetof(user_settings, mqtt_user), "", true),
+    makeStringField("mqtt_password", offsetof(user_settings, mqtt_password), "", true, true, true),
 };
 
-constexpr size_t SETTINGS_JSON_CAPACITY = 1536;  // Increased from 1152 to prevent truncation
+constexpr size_t SETTINGS_JSON_CAPACITY = 1792;  // Increased from 1536 for the static IP fields
 
 template <typename T>
 T& fieldAt(user_settings& settings, size_t offset)
@@ -217,6 +243,66 @@ void serializeField(const SettingField& field, JsonDocument& doc,
             break;
     }
 }
+
+void addRecordField(const SettingField& field, SettingsRecordWriter& writer,
+                    const user_settings& settings)
+{
+    if (!field.includeInJson)
+    {
+        return;  // Same set of persisted settings as the JSON file
+    }
+
+    switch (field.kind)
+    {
+        case SettingKind::Bool:
+            writer.addBool(field.key, fieldAtConst<bool>(settings, field.offset));
+            break;
+        case SettingKind::Int:
+            writer.addInt(field.key, fieldAtConst<int>(settings, field.offset));
+            break;
+        case SettingKind::Float:
+            writer.addFloat(field.key, fieldAtConst<float>(settings, field.offset));
+            break;
+        case SettingKind::String:
+        {
+            const String& value = fieldAtConst<String>(settings, field.offset);
+            writer.addString(field.key, value.c_str(), value.length());
+            break;
+        }
+    }
+}
+
+void applyRecordEntry(const SettingField& field, const SettingsRecordEntry& entry,
+                      user_settings& settings)
+{
+    switch (field.kind)
+    {
+        case SettingKind::Bool:
+            fieldAt<bool>(settings, field.offset) =
+                entry.asBool(fieldAtConst<bool>(settings, field.offset));
+            break;
+        case SettingKind::Int:
+            fieldAt<int>(settings, field.offset) =
+                entry.asInt(fieldAtConst<int>(settings, field.offset));
+            break;
+        case SettingKind::Float:
+            fieldAt<float>(settings, field.offset) =
+                entry.asFloat(fieldAtConst<float>(settings, field.offset));
+            break;
+        case SettingKind::String:
+        {
+            if (entry.type != SETTINGS_RECORD_STRING)
+            {
+                break;  // Keep the default
+            }
+            String& value = fieldAt<String>(settings, field.offset);
+            value = "";
+            value.reserve(entry.valueLength);
+            value.concat(reinterpret_cast<const char*>(entry.value), entry.valueLength);
+            break;
+        }
+    }
+}
 }  // namespace
 
 SettingsManager &SettingsManager::getInstance()
@@ -230,10 +316,19 @@ SettingsManager::SettingsManager()
     isLoaded                     = false;
     requestWifiReconnect         = false;
     wifiChanged                  = false;
+    writePending                 = false;
+    writeDueMs                   = 0;
+    writtenCrc                   = 0;
+    writtenCrcValid              = false;
     settings.ap_mode             = false;
     settings.ssid                = "";
     settings.passwd              = "";
     settings.elegooip            = "";
+    settings.extra_printer_ips   = "";
+    settings.static_ip           = "";     // DHCP
+    settings.static_gateway      = "";
+    settings.static_subnet       = "";
+    settings.static_dns          = "";
     settings.pause_on_runout     = true;
     settings.enabled             = true;
     settings.has_connected       = false;
@@ -243,7 +338,11 @@ SettingsManager::SettingsManager()
     settings.detection_soft_jam_time_ms = 10000;  // 10 seconds to signal slow clog
     settings.detection_hard_jam_time_ms = 3000;   // 3 seconds of negligible flow
     settings.detection_mode = 0;                  // 0 = both hard + soft detection
+    settings.motion_window_profile      = 0;      // 0 = 250ms buckets, 5s window
+    settings.predictive_expected        = false;  // Expected side moves only on SDCP samples
+    settings.adaptive_soft_jam          = false;  // Fixed soft jam ratio threshold
     settings.sdcp_loss_behavior         = 2;
+    settings.status_poll_mode           = 0;      // Fixed 250ms polling while printing
     settings.flow_telemetry_stale_ms    = 1500;
     settings.ui_refresh_interval_ms     = 1000;
     settings.log_level                  = 0;      // Default to Normal logging
@@ -254,15 +353,94 @@ SettingsManager::SettingsManager()
     settings.test_recording_mode        = false;
     settings.show_debug_page            = false;
     settings.timezone_offset_minutes    = 0;      // Default to UTC
+    settings.mqtt_broker                = "";     // MQTT publishing off until a broker is set
+    settings.mqtt_port                  = 1883;
+    settings.mqtt_user                  = "";
+    settings.mqtt_password              = "";
+    published.nameLock("SettingsManager::published");
+    publishSnapshot();
 }
 
 bool SettingsManager::load()
 {
-    File file = LittleFS.open("/user_settings.json", "r");
-    if (!file)
+    // Defaults first: either format only carries the settings it knows
+    for (const auto& field : kSettingFields)
+    {
+        applyDefault(field, settings);
+    }
+
+    bool loaded = loadRecord();
+    if (!loaded && LittleFS.exists(kSettingsJsonPath))
+    {
+        loaded = loadJson();
+        if (loaded)
+        {
+            // Write the record on the next loop() so later boots skip the parse
+            logger.log("Settings imported from JSON");
+            writePending = true;
+            writeDueMs   = millis();
+        }
+    }
+    else if (!loaded)
     {
         logger.log("Settings file not found, using defaults");
-        isLoaded = true;
+    }
+
+    sanitize();
+
+    // Update logger with loaded log level
+    logger.setLogLevel(static_cast<LogLevel>(settings.log_level));
+
+    isLoaded = true;
+    publishSnapshot();
+    return loaded;
+}
+
+bool SettingsManager::loadRecord()
+{
+    File file = LittleFS.open(kSettingsRecordPath, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    uint8_t buffer[kSettingsRecordMaxSize];
+    size_t  length = file.size();
+    bool    read   = length <= sizeof(buffer) && file.read(buffer, length) == length;
+    file.close();
+
+    SettingsRecordReader reader;
+    if (!read || !reader.open(buffer, length))
+    {
+        logger.log("Settings record invalid, ignoring it");
+        return false;
+    }
+
+    SettingsRecordEntry entry;
+    while (reader.next(entry))
+    {
+        for (const auto& field : kSettingFields)
+        {
+            if (entry.keyEquals(field.key))
+            {
+                applyRecordEntry(field, entry, settings);
+                break;
+            }
+        }
+    }
+
+    // What is on flash is exactly what save() would write for these values
+    writtenCrc      = settingsRecordCrc32(buffer + SETTINGS_RECORD_HEADER_SIZE,
+                                          length - SETTINGS_RECORD_HEADER_SIZE);
+    writtenCrcValid = true;
+    return true;
+}
+
+bool SettingsManager::loadJson()
+{
+    File file = LittleFS.open(kSettingsJsonPath, "r");
+    if (!file)
+    {
         return false;
     }
 
@@ -274,19 +452,16 @@ bool SettingsManager::load()
     if (error)
     {
         logger.log("Settings JSON parsing error, using defaults");
-        isLoaded = true;
         return false;
     }
 
     for (const auto& field : kSettingFields)
     {
         JsonVariantConst value = doc[field.key];
-        if (value.isNull())
+        if (!value.isNull())
         {
-            applyDefault(field, settings);
-            continue;
+            applyVariant(field, value, settings);
         }
-        applyVariant(field, value, settings);
     }
 
     // Migration: handle legacy 0.0-1.0 float format for detection_ratio_threshold
@@ -302,7 +477,11 @@ bool SettingsManager::load()
                         rawValue, settings.detection_ratio_threshold);
         }
     }
+    return true;
+}
 
+void SettingsManager::sanitize()
+{
     // Clamp to valid range (0=Normal, 1=Verbose, 2=Pin Values)
     if (settings.log_level < 0)
     {
@@ -322,39 +501,146 @@ bool SettingsManager::load()
         settings.detection_mode = 2;
     }
 
-    // Update logger with loaded log level
-    logger.setLogLevel(static_cast<LogLevel>(settings.log_level));
+    if (settings.motion_window_profile < 0 || settings.motion_window_profile > 2)
+    {
+        settings.motion_window_profile = 0;
+    }
 
-    isLoaded = true;
-    return true;
+    if (settings.status_poll_mode < 0 || settings.status_poll_mode > 2)
+    {
+        settings.status_poll_mode = 0;
+    }
+
+    if (settings.mqtt_port < 1 || settings.mqtt_port > 65535)
+    {
+        settings.mqtt_port = 1883;
+    }
+}
+
+void SettingsManager::publishSnapshot()
+{
+    settings_snapshot_t snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.enabled                 = settings.enabled;
+    snapshot.pauseOnRunout           = settings.pause_on_runout;
+    snapshot.suppressPauseCommands   = settings.suppress_pause_commands;
+    snapshot.autoCalibrateSensor     = settings.auto_calibrate_sensor;
+    snapshot.predictiveExpected      = settings.predictive_expected;
+    snapshot.adaptiveSoftJam         = settings.adaptive_soft_jam;
+    snapshot.testRecordingMode       = settings.test_recording_mode;
+    snapshot.logLevel                = static_cast<uint8_t>(settings.log_level);
+    snapshot.detectionMode           = static_cast<uint8_t>(settings.detection_mode);
+    snapshot.motionWindowProfile     = static_cast<uint8_t>(settings.motion_window_profile);
+    snapshot.statusPollMode          = static_cast<uint8_t>(settings.status_poll_mode);
+    snapshot.sdcpLossBehavior        = settings.sdcp_loss_behavior;
+    snapshot.detectionGracePeriodMs  = settings.detection_grace_period_ms;
+    snapshot.detectionRatioThreshold = settings.detection_ratio_threshold / 100.0f;
+    snapshot.detectionHardJamMm      = settings.detection_hard_jam_mm;
+    snapshot.detectionSoftJamTimeMs  = settings.detection_soft_jam_time_ms;
+    snapshot.detectionHardJamTimeMs  = settings.detection_hard_jam_time_ms;
+    snapshot.flowTelemetryStaleMs    = settings.flow_telemetry_stale_ms;
+    snapshot.uiRefreshIntervalMs     = settings.ui_refresh_interval_ms;
+    snapshot.movementMmPerPulse      = settings.movement_mm_per_pulse;
+    snapshot.pulseReductionPercent   = settings.pulse_reduction_percent;
+    published.publish(snapshot);
+}
+
+void SettingsManager::commit(bool skipWifiCheck)
+{
+    if (!isLoaded)
+        load();
+    publishSnapshot();
+    writePending = true;
+    writeDueMs   = millis() + SETTINGS_SAVE_DEBOUNCE_MS;
+
+    if (!skipWifiCheck && wifiChanged)
+    {
+        logger.log("WiFi changed, requesting reconnection");
+        requestWifiReconnect = true;
+        wifiChanged          = false;
+    }
 }
 
 bool SettingsManager::save(bool skipWifiCheck)
 {
-    String output = toJson(true);
+    commit(skipWifiCheck);
+    return flush();
+}
+
+bool SettingsManager::flush()
+{
+    if (!writePending)
+    {
+        return true;
+    }
+    if (!writeFile())
+    {
+        // Keep the commit pending and try again after another debounce
+        writeDueMs = millis() + SETTINGS_SAVE_DEBOUNCE_MS;
+        return false;
+    }
+    writePending = false;
+    return true;
+}
 
-    File file = LittleFS.open("/user_settings.json", "w");
+void SettingsManager::loop()
+{
+    if (writePending && (long) (millis() - writeDueMs) >= 0)
+    {
+        flush();
+    }
+}
+
+bool SettingsManager::writeFile()
+{
+    uint8_t              buffer[kSettingsRecordMaxSize];
+    SettingsRecordWriter writer(buffer, sizeof(buffer));
+    for (const auto& field : kSettingFields)
+    {
+        addRecordField(field, writer, settings);
+    }
+    size_t length = writer.finish();
+    if (length == 0)
+    {
+        logger.logf("Settings record too large (%u bytes)", (unsigned) writer.size());
+        return false;
+    }
+
+    uint32_t crc = settingsRecordCrc32(buffer + SETTINGS_RECORD_HEADER_SIZE,
+                                       length - SETTINGS_RECORD_HEADER_SIZE);
+    if (writtenCrcValid && crc == writtenCrc)
+    {
+        return true;  // Same bytes as the file: no flash write
+    }
+
+    File file = LittleFS.open(kSettingsRecordTempPath, "w");
     if (!file)
     {
         logger.log("Failed to open settings file for writing");
         return false;
     }
 
-    if (file.print(output) == 0)
+    if (file.write(buffer, length) != length)
     {
         logger.log("Failed to write settings to file");
         file.close();
+        LittleFS.remove(kSettingsRecordTempPath);
         return false;
     }
-
     file.close();
-    logger.log("Settings saved successfully");
-    if (!skipWifiCheck && wifiChanged)
+
+    // LittleFS renames in one metadata commit: after a reset the file is
+    // either the old settings or the new ones, never a truncated mix
+    if (!LittleFS.rename(kSettingsRecordTempPath, kSettingsRecordPath))
     {
-        logger.log("WiFi changed, requesting reconnection");
-        requestWifiReconnect = true;
-        wifiChanged          = false;
+        logger.log("Failed to replace settings file");
+        LittleFS.remove(kSettingsRecordTempPath);
+        return false;
     }
+
+    writtenCrc      = crc;
+    writtenCrcValid = true;
+    logger.logf("Settings saved successfully (%u bytes)", (unsigned) length);
     return true;
 }
 
@@ -387,6 +673,90 @@ String SettingsManager::getElegooIP()
     return getSettings().elegooip;
 }
 
+String SettingsManager::getExtraPrinterIPs()
+{
+    return getSettings().extra_printer_ips;
+}
+
+String SettingsManager::getPrinterIP(uint8_t index)
+{
+    char ip[64];
+    copyPrinterIP(index, ip, sizeof(ip));
+    return String(ip);
+}
+
+String SettingsManager::getStaticIP()
+{
+    return getSettings().static_ip;
+}
+
+String SettingsManager::getStaticGateway()
+{
+    return getSettings().static_gateway;
+}
+
+String SettingsManager::getStaticSubnet()
+{
+    return getSettings().static_subnet;
+}
+
+String SettingsManager::getStaticDns()
+{
+    return getSettings().static_dns;
+}
+
+size_t SettingsManager::copyPrinterIP(uint8_t index, char *buffer, size_t size)
+{
+    if (size == 0)
+    {
+        return 0;
+    }
+    buffer[0] = '\0';
+
+    const char *start = nullptr;
+    if (index == 0)
+    {
+        start = getSettings().elegooip.c_str();
+    }
+    else
+    {
+        start = getSettings().extra_printer_ips.c_str();
+        for (uint8_t entry = 1; entry < index && start != nullptr; entry++)
+        {
+            start = strchr(start, ',');
+            start = start != nullptr ? start + 1 : nullptr;
+        }
+        if (start == nullptr)
+        {
+            return 0;
+        }
+    }
+
+    // Entry runs to the next comma (end of string for elegooip), trimmed
+    const char *end = index == 0 ? nullptr : strchr(start, ',');
+    if (end == nullptr)
+    {
+        end = start + strlen(start);
+    }
+    while (start < end && isspace(static_cast<unsigned char>(*start)))
+    {
+        start++;
+    }
+    while (end > start && isspace(static_cast<unsigned char>(end[-1])))
+    {
+        end--;
+    }
+
+    size_t length = static_cast<size_t>(end - start);
+    if (length >= size)
+    {
+        length = size - 1;
+    }
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    return length;
+}
+
 bool SettingsManager::getPauseOnRunout()
 {
     return getSettings().pause_on_runout;
@@ -433,11 +803,31 @@ int SettingsManager::getDetectionMode()
     return getSettings().detection_mode;
 }
 
+int SettingsManager::getMotionWindowProfile()
+{
+    return getSettings().motion_window_profile;
+}
+
+bool SettingsManager::getPredictiveExpected()
+{
+    return getSettings().predictive_expected;
+}
+
+bool SettingsManager::getAdaptiveSoftJam()
+{
+    return getSettings().adaptive_soft_jam;
+}
+
 int SettingsManager::getSdcpLossBehavior()
 {
     return getSettings().sdcp_loss_behavior;
 }
 
+int SettingsManager::getStatusPollMode()
+{
+    return getSettings().status_poll_mode;
+}
+
 int SettingsManager::getFlowTelemetryStaleMs()
 {
     return getSettings().flow_telemetry_stale_ms;
@@ -548,6 +938,102 @@ void SettingsManager::setElegooIP(const String &ip)
     settings.elegooip = trimmed;
 }
 
+void SettingsManager::setExtraPrinterIPs(const String &ips)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = ips;
+    trimmed.trim();
+    settings.extra_printer_ips = trimmed;
+}
+
+void SettingsManager::setPrinterIP(uint8_t index, const String &ip)
+{
+    if (index == 0)
+    {
+        setElegooIP(ip);
+        return;
+    }
+    if (!isLoaded)
+        load();
+    String trimmed = ip;
+    trimmed.trim();
+
+    // Rebuild the list with entry index-1 replaced (empty entries pad a short list)
+    uint8_t entries = 0;
+    if (settings.extra_printer_ips.length() > 0)
+    {
+        entries = 1;
+        for (size_t i = 0; i < settings.extra_printer_ips.length(); i++)
+        {
+            entries += settings.extra_printer_ips[i] == ',';
+        }
+    }
+    uint8_t last = entries > index ? entries : index;
+    String  updated;
+    for (uint8_t entry = 1; entry <= last; entry++)
+    {
+        if (entry > 1)
+        {
+            updated += ',';
+        }
+        updated += entry == index ? trimmed : getPrinterIP(entry);
+    }
+    settings.extra_printer_ips = updated;
+}
+
+void SettingsManager::setStaticIP(const String &ip)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = ip;
+    trimmed.trim();
+    if (settings.static_ip != trimmed)
+    {
+        settings.static_ip = trimmed;
+        wifiChanged        = true;
+    }
+}
+
+void SettingsManager::setStaticGateway(const String &gateway)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = gateway;
+    trimmed.trim();
+    if (settings.static_gateway != trimmed)
+    {
+        settings.static_gateway = trimmed;
+        wifiChanged             = true;
+    }
+}
+
+void SettingsManager::setStaticSubnet(const String &subnet)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = subnet;
+    trimmed.trim();
+    if (settings.static_subnet != trimmed)
+    {
+        settings.static_subnet = trimmed;
+        wifiChanged            = true;
+    }
+}
+
+void SettingsManager::setStaticDns(const String &dns)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = dns;
+    trimmed.trim();
+    if (settings.static_dns != trimmed)
+    {
+        settings.static_dns = trimmed;
+        wifiChanged         = true;
+    }
+}
+
 void SettingsManager::setPauseOnRunout(bool pauseOnRunout)
 {
     if (!isLoaded)
@@ -622,6 +1108,31 @@ void SettingsManager::setDetectionMode(int mode)
     settings.detection_mode = mode;
 }
 
+void SettingsManager::setMotionWindowProfile(int profile)
+{
+    if (!isLoaded)
+        load();
+    if (profile < 0 || profile > 2)
+    {
+        profile = 0;
+    }
+    settings.motion_window_profile = profile;
+}
+
+void SettingsManager::setPredictiveExpected(bool predictive)
+{
+    if (!isLoaded)
+        load();
+    settings.predictive_expected = predictive;
+}
+
+void SettingsManager::setAdaptiveSoftJam(bool adaptive)
+{
+    if (!isLoaded)
+        load();
+    settings.adaptive_soft_jam = adaptive;
+}
+
 void SettingsManager::setSdcpLossBehavior(int behavior)
 {
     if (!isLoaded)
@@ -629,6 +1140,17 @@ void SettingsManager::setSdcpLossBehavior(int behavior)
     settings.sdcp_loss_behavior = behavior;
 }
 
+void SettingsManager::setStatusPollMode(int mode)
+{
+    if (!isLoaded)
+        load();
+    if (mode < 0 || mode > 2)
+    {
+        mode = 0;
+    }
+    settings.status_poll_mode = mode;
+}
+
 void SettingsManager::setFlowTelemetryStaleMs(int staleMs)
 {
     if (!isLoaded)
@@ -714,6 +1236,64 @@ void SettingsManager::setTimezoneOffsetMinutes(int offsetMinutes)
     settings.timezone_offset_minutes = offsetMinutes;
 }
 
+String SettingsManager::getMqttBroker()
+{
+    return getSettings().mqtt_broker;
+}
+
+int SettingsManager::getMqttPort()
+{
+    return getSettings().mqtt_port;
+}
+
+String SettingsManager::getMqttUser()
+{
+    return getSettings().mqtt_user;
+}
+
+String SettingsManager::getMqttPassword()
+{
+    return getSettings().mqtt_password;
+}
+
+void SettingsManager::setMqttBroker(const String &broker)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = broker;
+    trimmed.trim();
+    settings.mqtt_broker = trimmed;
+}
+
+void SettingsManager::setMqttPort(int port)
+{
+    if (!isLoaded)
+        load();
+    if (port < 1 || port > 65535)
+    {
+        port = 1883;
+    }
+    settings.mqtt_port = port;
+}
+
+void SettingsManager::setMqttUser(const String &user)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = user;
+    trimmed.trim();
+    settings.mqtt_user = trimmed;
+}
+
+void SettingsManager::setMqttPassword(const String &password)
+{
+    if (!isLoaded)
+        load();
+    String trimmed = password;
+    trimmed.trim();
+    settings.mqtt_password = trimmed;
+}
+
 String SettingsManager::toJson(bool includePassword)
 {
     String output;
@@ -4,12 +4,25 @@
 #ifndef SETTINGS_DATA_H
 #define SETTINGS_DATA_H
 
+#include "VersionedSnapshot.h"
+
+// Quiet time after the last commit() before the settings file is written, so
+// a burst of UI changes costs one flash write
+#ifndef SETTINGS_SAVE_DEBOUNCE_MS
+#define SETTINGS_SAVE_DEBOUNCE_MS 2000
+#endif
+
 struct user_settings
 {
     String ssid;
     String passwd;
     bool   ap_mode;
     String elegooip;
+    String extra_printer_ips;     // Printer sessions 1.. (PRINTER_SESSIONS > 1), comma separated
+    String static_ip;             // Station static IPv4 (empty = DHCP)
+    String static_gateway;
+    String static_subnet;
+    String static_dns;            // Empty = gateway
     bool   pause_on_runout;
     bool   enabled;                // Motion monitoring (jam detection) enabled
     bool   has_connected;
@@ -19,7 +32,11 @@ struct user_settings
       int    detection_soft_jam_time_ms;   // Soft jam: how long ratio must stay bad (ms, e.g., 3000 = 3 sec)
       int    detection_hard_jam_time_ms;   // Hard jam: how long zero movement required (ms, e.g., 2000 = 2 sec)
       int    detection_mode;               // 0=Soft+Hard, 1=Hard only, 2=Soft only
+      int    motion_window_profile;        // 0=Standard (250ms/5s), 1=Fast (100ms/5s), 2=Long (250ms/10s)
+      bool   predictive_expected;          // Extrapolate expected extrusion between SDCP samples
+      bool   adaptive_soft_jam;            // Soft jam threshold relative to the learned flow baseline
       int    sdcp_loss_behavior;
+      int    status_poll_mode;             // 0=Fixed 250ms, 1=Adaptive to flow, 2=Push (poll only when stale)
     int    flow_telemetry_stale_ms;
     int    ui_refresh_interval_ms;
     int    log_level;                 // 0=Normal, 1=Verbose, 2=Pin Values
@@ -30,14 +47,57 @@ struct user_settings
     bool   test_recording_mode;    // Enable CSV test data recording to ./condensed directory
     bool   show_debug_page;        // Show Debug page in web UI (default false)
     int    timezone_offset_minutes; // Offset from UTC in minutes (e.g., -300 for EST)
+    String mqtt_broker;            // MQTT broker host/IP (empty = MQTT publishing off)
+    int    mqtt_port;
+    String mqtt_user;
+    String mqtt_password;
 };
 
+// The settings read on hot paths and by other tasks, published together by
+// SettingsManager::commit(). Strings stay behind the getters (main loop only).
+typedef struct
+{
+    bool     enabled;
+    bool     pauseOnRunout;
+    bool     suppressPauseCommands;
+    bool     autoCalibrateSensor;
+    bool     predictiveExpected;
+    bool     adaptiveSoftJam;
+    bool     testRecordingMode;
+    uint8_t  logLevel;
+    uint8_t  detectionMode;
+    uint8_t  motionWindowProfile;
+    uint8_t  statusPollMode;
+    int      sdcpLossBehavior;
+    int      detectionGracePeriodMs;
+    float    detectionRatioThreshold;  // 0.0-1.0
+    float    detectionHardJamMm;
+    int      detectionSoftJamTimeMs;
+    int      detectionHardJamTimeMs;
+    int      flowTelemetryStaleMs;
+    int      uiRefreshIntervalMs;
+    float    movementMmPerPulse;
+    float    pulseReductionPercent;
+} settings_snapshot_t;
+
 class SettingsManager
 {
    private:
-    user_settings settings;
+    user_settings settings;  // Working copy: setters stage changes here
     bool          isLoaded;
     bool          wifiChanged;
+    bool          writePending;
+    unsigned long writeDueMs;
+    uint32_t      writtenCrc;  // Record on flash, to skip identical rewrites
+    bool          writtenCrcValid;
+
+    VersionedSnapshot<settings_snapshot_t> published;
+
+    bool loadRecord();  // Binary record (SettingsRecord.h): one read, no parse
+    bool loadJson();    // Import from the JSON file when there is no valid record
+    void sanitize();    // Clamp values either format may hold out of range
+    void publishSnapshot();
+    bool writeFile();
 
     SettingsManager();
 
@@ -50,8 +110,29 @@ class SettingsManager
     // Flag to request WiFi reconnection with new credentials
     bool requestWifiReconnect;
 
+    // Reads the binary record (/user_settings.bin); only if it is missing or
+    // damaged is /user_settings.json imported, and then rewritten as a record.
+    // JSON stays the import/export format (web API, uploadfs), never the store.
     bool load();
+    // Apply the staged setter changes: publish a new snapshot at once and
+    // write the file once SETTINGS_SAVE_DEBOUNCE_MS pass without another commit
+    void commit(bool skipWifiCheck = false);
+    // commit() and write the file now (before a restart, or when the caller
+    // needs to know it was persisted)
     bool save(bool skipWifiCheck = false);
+    // Write a pending commit now; true if nothing is left unwritten
+    bool flush();
+    // Writes the file when the debounce expires (call in main loop)
+    void loop();
+
+    // Changes with every published snapshot, so caches of the settings can tell they are stale
+    uint32_t getRevision() const { return published.version(); }
+    // Cheap enough for every pass: copies only when cachedVersion is stale
+    bool refreshSnapshot(settings_snapshot_t &cached, uint32_t &cachedVersion) const
+    {
+        return published.refresh(cached, cachedVersion);
+    }
+    settings_snapshot_t getSnapshot() const { return published.read(); }
 
     //  (loads if not already loaded)
     const user_settings &getSettings();
@@ -60,6 +141,15 @@ class SettingsManager
     String getPassword();
     bool   isAPMode();
     String getElegooIP();
+    String getExtraPrinterIPs();
+    // Printer IP of a session: elegooip for 0, else entry index-1 of extra_printer_ips
+    String getPrinterIP(uint8_t index);
+    // Same, copied into buffer without allocating (truncated to fit); returns the length
+    size_t copyPrinterIP(uint8_t index, char *buffer, size_t size);
+    String getStaticIP();
+    String getStaticGateway();
+    String getStaticSubnet();
+    String getStaticDns();
     bool   getPauseOnRunout();
     bool   getEnabled();                    // Motion monitoring enabled
     bool   getHasConnected();
@@ -69,7 +159,11 @@ class SettingsManager
       int    getDetectionSoftJamTimeMs();     // Soft jam duration threshold
       int    getDetectionHardJamTimeMs();     // Hard jam duration threshold
       int    getDetectionMode();              // Detection mode selector (0=both,1=hard,2=soft)
+      int    getMotionWindowProfile();        // Motion sensor window geometry (0=std,1=fast,2=long)
+      bool   getPredictiveExpected();         // Expected-position extrapolation between samples
+      bool   getAdaptiveSoftJam();            // Soft jam threshold follows the learned baseline
     int    getSdcpLossBehavior();
+    int    getStatusPollMode();                // SDCP status polling strategy (0=fixed,1=adaptive,2=push)
     int    getFlowTelemetryStaleMs();
     int    getUiRefreshIntervalMs();
     int    getLogLevel();                      // Get current log level (0-2)
@@ -87,6 +181,14 @@ class SettingsManager
     void setPassword(const String &password);
     void setAPMode(bool apMode);
     void setElegooIP(const String &ip);
+    void setExtraPrinterIPs(const String &ips);
+    // Printer IP of a session (elegooip or its extra_printer_ips entry)
+    void setPrinterIP(uint8_t index, const String &ip);
+    // Static IP changes reconnect WiFi like credential changes
+    void setStaticIP(const String &ip);
+    void setStaticGateway(const String &gateway);
+    void setStaticSubnet(const String &subnet);
+    void setStaticDns(const String &dns);
     void setPauseOnRunout(bool pauseOnRunout);
     void setEnabled(bool enabled);              // Motion monitoring enabled
     void setHasConnected(bool hasConnected);
@@ -96,7 +198,11 @@ class SettingsManager
       void setDetectionSoftJamTimeMs(int timeMs);        // Soft jam duration setter
       void setDetectionHardJamTimeMs(int timeMs);        // Hard jam duration setter
       void setDetectionMode(int mode);                    // Detection mode selector
+      void setMotionWindowProfile(int profile);           // Window geometry, applied at next print
+      void setPredictiveExpected(bool predictive);        // Extrapolation, applied at next print
+      void setAdaptiveSoftJam(bool adaptive);             // Adaptive soft jam threshold
     void setSdcpLossBehavior(int behavior);
+    void setStatusPollMode(int mode);              // SDCP status polling strategy
     void setFlowTelemetryStaleMs(int staleMs);
     void setUiRefreshIntervalMs(int intervalMs);
     void setLogLevel(int level);                   // Set log level (0-2), updates logger
@@ -108,6 +214,14 @@ class SettingsManager
     void setShowDebugPage(bool show);             // Show/hide debug page in web UI
     int    getTimezoneOffsetMinutes();
     void setTimezoneOffsetMinutes(int offsetMinutes);
+    String getMqttBroker();
+    int    getMqttPort();
+    String getMqttUser();
+    String getMqttPassword();
+    void setMqttBroker(const String &broker);
+    void setMqttPort(int port);
+    void setMqttUser(const String &user);
+    void setMqttPassword(const String &password);
 
     String toJson(bool includePassword = true);
 };
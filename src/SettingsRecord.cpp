@@ -0,0 +1,234 @@
+#include "SettingsRecord.h"
+
+#include <string.h>
+
+namespace
+{
+void putLe16(uint8_t *out, uint16_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLe32(uint8_t *out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint16_t getLe16(const uint8_t *in)
+{
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t getLe32(const uint8_t *in)
+{
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+}  // namespace
+
+uint32_t settingsRecordCrc32(const uint8_t *data, size_t length)
+{
+    // Bitwise: a settings record is well under 2 KB and read once per boot
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+SettingsRecordWriter::SettingsRecordWriter(uint8_t *buffer, size_t capacity)
+    : buffer(buffer), capacity(buffer != nullptr ? capacity : 0),
+      position(SETTINGS_RECORD_HEADER_SIZE), entries(0), invalid(false)
+{
+}
+
+void SettingsRecordWriter::addBool(const char *key, bool value)
+{
+    uint8_t byte = value ? 1 : 0;
+    add(key, SETTINGS_RECORD_BOOL, &byte, 1);
+}
+
+void SettingsRecordWriter::addInt(const char *key, int32_t value)
+{
+    uint8_t bytes[4];
+    putLe32(bytes, static_cast<uint32_t>(value));
+    add(key, SETTINGS_RECORD_INT, bytes, sizeof(bytes));
+}
+
+void SettingsRecordWriter::addFloat(const char *key, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t bytes[4];
+    putLe32(bytes, bits);
+    add(key, SETTINGS_RECORD_FLOAT, bytes, sizeof(bytes));
+}
+
+void SettingsRecordWriter::addString(const char *key, const char *value, size_t length)
+{
+    add(key, SETTINGS_RECORD_STRING, reinterpret_cast<const uint8_t *>(value), length);
+}
+
+void SettingsRecordWriter::add(const char *key, uint8_t type, const uint8_t *value, size_t length)
+{
+    size_t keyLength = strlen(key);
+    if (keyLength == 0 || keyLength > 0xFF || length > 0xFFFF || entries == 0xFFFF)
+    {
+        invalid = true;
+        return;
+    }
+
+    uint8_t lengthBytes[2];
+    putLe16(lengthBytes, static_cast<uint16_t>(length));
+    uint8_t keyLengthByte = static_cast<uint8_t>(keyLength);
+
+    put(&keyLengthByte, 1);
+    put(key, keyLength);
+    put(&type, 1);
+    put(lengthBytes, sizeof(lengthBytes));
+    put(value, length);
+    entries++;
+}
+
+void SettingsRecordWriter::put(const void *bytes, size_t length)
+{
+    if (position + length <= capacity)
+    {
+        memcpy(buffer + position, bytes, length);
+    }
+    position += length;
+}
+
+size_t SettingsRecordWriter::finish()
+{
+    if (invalid || position > capacity)
+    {
+        return 0;
+    }
+    size_t payloadLength = position - SETTINGS_RECORD_HEADER_SIZE;
+    putLe32(buffer, SETTINGS_RECORD_MAGIC);
+    putLe16(buffer + 4, SETTINGS_RECORD_VERSION);
+    putLe16(buffer + 6, entries);
+    putLe32(buffer + 8, static_cast<uint32_t>(payloadLength));
+    putLe32(buffer + 12, settingsRecordCrc32(buffer + SETTINGS_RECORD_HEADER_SIZE, payloadLength));
+    return position;
+}
+
+bool SettingsRecordEntry::keyEquals(const char *name) const
+{
+    return strlen(name) == keyLength && memcmp(name, key, keyLength) == 0;
+}
+
+bool SettingsRecordEntry::asBool(bool fallback) const
+{
+    if (type != SETTINGS_RECORD_BOOL || valueLength != 1)
+    {
+        return fallback;
+    }
+    return value[0] != 0;
+}
+
+int32_t SettingsRecordEntry::asInt(int32_t fallback) const
+{
+    if (type != SETTINGS_RECORD_INT || valueLength != 4)
+    {
+        return fallback;
+    }
+    return static_cast<int32_t>(getLe32(value));
+}
+
+float SettingsRecordEntry::asFloat(float fallback) const
+{
+    if (type != SETTINGS_RECORD_FLOAT || valueLength != 4)
+    {
+        return fallback;
+    }
+    uint32_t bits = getLe32(value);
+    float    result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+SettingsRecordReader::SettingsRecordReader()
+    : payload(nullptr), payloadLength(0), position(0), entries(0)
+{
+}
+
+bool SettingsRecordReader::open(const uint8_t *data, size_t length)
+{
+    payload       = nullptr;
+    payloadLength = 0;
+    position      = 0;
+    entries       = 0;
+
+    if (data == nullptr || length < SETTINGS_RECORD_HEADER_SIZE ||
+        getLe32(data) != SETTINGS_RECORD_MAGIC)
+    {
+        return false;
+    }
+    uint16_t version = getLe16(data + 4);
+    uint16_t count   = getLe16(data + 6);
+    uint32_t size    = getLe32(data + 8);
+    if (version == 0 || version > SETTINGS_RECORD_VERSION ||
+        size != length - SETTINGS_RECORD_HEADER_SIZE ||
+        settingsRecordCrc32(data + SETTINGS_RECORD_HEADER_SIZE, size) != getLe32(data + 12))
+    {
+        return false;
+    }
+
+    // Walk the entries once so next() never reads out of bounds
+    const uint8_t *body = data + SETTINGS_RECORD_HEADER_SIZE;
+    size_t         at   = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (at + 1 > size)
+        {
+            return false;
+        }
+        size_t keyLength = body[at];
+        if (keyLength == 0 || at + 1 + keyLength + 3 > size)
+        {
+            return false;
+        }
+        size_t valueLength = getLe16(body + at + 1 + keyLength + 1);
+        at += 1 + keyLength + 3 + valueLength;
+        if (at > size)
+        {
+            return false;
+        }
+    }
+    if (at != size)
+    {
+        return false;
+    }
+
+    payload       = body;
+    payloadLength = size;
+    entries       = count;
+    return true;
+}
+
+bool SettingsRecordReader::next(SettingsRecordEntry &entry)
+{
+    if (payload == nullptr || position >= payloadLength)
+    {
+        return false;
+    }
+    const uint8_t *at = payload + position;
+    entry.keyLength   = at[0];
+    entry.key         = reinterpret_cast<const char *>(at + 1);
+    entry.type        = at[1 + entry.keyLength];
+    entry.valueLength = getLe16(at + 1 + entry.keyLength + 1);
+    entry.value       = at + 1 + entry.keyLength + 3;
+    position += 1 + entry.keyLength + 3 + entry.valueLength;
+    return true;
+}
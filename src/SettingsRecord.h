@@ -0,0 +1,105 @@
+#ifndef SETTINGS_RECORD_H
+#define SETTINGS_RECORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * SettingsRecord - compact binary form of the user settings
+ *
+ * A 16-byte header (magic, format version, entry count, payload length and
+ * the CRC-32 of the payload) followed by one entry per setting:
+ *
+ *   keyLength:u8  key[keyLength]  type:u8  valueLength:u16  value[valueLength]
+ *
+ * Integers are little-endian; floats are their IEEE-754 bits; strings carry
+ * no terminator. Entries are found by key, so settings can be added or
+ * dropped without a format change: readers skip keys and types they do not
+ * know and default what is missing. SETTINGS_RECORD_VERSION only moves for
+ * an incompatible layout change, and readers refuse records newer than
+ * they understand.
+ *
+ * Loading is one read plus a CRC pass, with no parser and no allocation
+ * beyond the file buffer. No Arduino dependencies, so it is tested on the
+ * host.
+ */
+
+static constexpr uint32_t SETTINGS_RECORD_MAGIC       = 0x5353464Fu;  // "OFSS"
+static constexpr uint16_t SETTINGS_RECORD_VERSION     = 1;
+static constexpr size_t   SETTINGS_RECORD_HEADER_SIZE = 16;
+
+enum SettingsRecordType : uint8_t
+{
+    SETTINGS_RECORD_BOOL   = 0,
+    SETTINGS_RECORD_INT    = 1,  // int32
+    SETTINGS_RECORD_FLOAT  = 2,  // float32
+    SETTINGS_RECORD_STRING = 3
+};
+
+// CRC-32 (IEEE 802.3, reflected, as zlib)
+uint32_t settingsRecordCrc32(const uint8_t *data, size_t length);
+
+/**
+ * Builds a record into a caller buffer. Past the end of the buffer entries
+ * are only counted, so a first pass with a null buffer measures the size.
+ */
+class SettingsRecordWriter
+{
+  public:
+    SettingsRecordWriter(uint8_t *buffer, size_t capacity);
+
+    void addBool(const char *key, bool value);
+    void addInt(const char *key, int32_t value);
+    void addFloat(const char *key, float value);
+    void addString(const char *key, const char *value, size_t length);
+
+    // Bytes the complete record needs
+    size_t size() const { return position; }
+    // Fills in the header; returns the record length, or 0 if it did not fit
+    size_t finish();
+
+  private:
+    void add(const char *key, uint8_t type, const uint8_t *value, size_t length);
+    void put(const void *bytes, size_t length);
+
+    uint8_t *buffer;
+    size_t   capacity;
+    size_t   position;
+    uint16_t entries;
+    bool     invalid;  // A key or value too long for its length field
+};
+
+struct SettingsRecordEntry
+{
+    const char    *key;  // Not terminated
+    uint8_t        keyLength;
+    uint8_t        type;
+    const uint8_t *value;
+    uint16_t       valueLength;
+
+    bool keyEquals(const char *name) const;
+    // Value of the expected type, or fallback when the entry is another type
+    bool    asBool(bool fallback) const;
+    int32_t asInt(int32_t fallback) const;
+    float   asFloat(float fallback) const;
+};
+
+class SettingsRecordReader
+{
+  public:
+    SettingsRecordReader();
+
+    // False unless the header and CRC check out and every entry is in bounds
+    bool open(const uint8_t *data, size_t length);
+    bool next(SettingsRecordEntry &entry);
+
+    uint16_t entryCount() const { return entries; }
+
+  private:
+    const uint8_t *payload;
+    size_t         payloadLength;
+    size_t         position;
+    uint16_t       entries;
+};
+
+#endif  // SETTINGS_RECORD_H
@@ -0,0 +1,150 @@
+#ifndef SHARED_PAYLOAD_H
+#define SHARED_PAYLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * SharedPayload - immutable response bodies shared by concurrent readers
+ *
+ * The writer (main loop) builds a body into a free slot and makes it
+ * current; readers (async web handlers) take a SharedPayloadRef to the
+ * current slot and stream straight out of it for as long as the response
+ * lives. A slot is never rewritten while any reference to it exists, so any
+ * number of clients share one copy and none needs a buffer of its own.
+ *
+ * Memory is fixed at Slots * BufSize. With every spare slot still held by
+ * slow clients publish() fails and readers keep getting the previous body;
+ * the caller retries on its next pass. Single writer; lock-free readers.
+ */
+class SharedPayloadRef
+{
+  public:
+    SharedPayloadRef() : refs(nullptr), bytes(nullptr), length(0) {}
+    SharedPayloadRef(const SharedPayloadRef &other)
+        : refs(other.refs), bytes(other.bytes), length(other.length)
+    {
+        retain();
+    }
+    SharedPayloadRef &operator=(const SharedPayloadRef &other)
+    {
+        if (this != &other)
+        {
+            release();
+            refs   = other.refs;
+            bytes  = other.bytes;
+            length = other.length;
+            retain();
+        }
+        return *this;
+    }
+    ~SharedPayloadRef() { release(); }
+
+    explicit operator bool() const { return bytes != nullptr && length > 0; }
+    const char *data() const { return bytes; }  // NUL-terminated
+    size_t      size() const { return length; }
+
+  private:
+    template <size_t, uint8_t>
+    friend class SharedPayload;
+
+    // Takes over a reference the caller already counted
+    SharedPayloadRef(uint32_t *slotRefs, const char *slotData, size_t slotLength)
+        : refs(slotRefs), bytes(slotData), length(slotLength)
+    {
+    }
+
+    void retain()
+    {
+        if (refs != nullptr)
+        {
+            __atomic_add_fetch(refs, 1, __ATOMIC_ACQ_REL);
+        }
+    }
+    void release()
+    {
+        if (refs != nullptr)
+        {
+            __atomic_sub_fetch(refs, 1, __ATOMIC_ACQ_REL);
+            refs = nullptr;
+        }
+    }
+
+    uint32_t   *refs;
+    const char *bytes;
+    size_t      length;
+};
+
+template <size_t BufSize, uint8_t Slots = 3>
+class SharedPayload
+{
+    static_assert(Slots >= 2, "one current slot plus at least one to build into");
+
+  public:
+    SharedPayload() : current(-1), failures(0)
+    {
+        memset(refs, 0, sizeof(refs));
+        memset(lengths, 0, sizeof(lengths));
+    }
+
+    // Main loop only. Bodies longer than BufSize - 1 are truncated.
+    bool publish(const char *body, size_t bodyLength)
+    {
+        int active = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+        int slot   = -1;
+        for (int i = 0; i < Slots; i++)
+        {
+            if (i != active && __atomic_load_n(&refs[i], __ATOMIC_ACQUIRE) == 0)
+            {
+                slot = i;
+                break;
+            }
+        }
+        if (slot < 0)
+        {
+            failures++;
+            return false;
+        }
+
+        size_t copyLength = bodyLength < BufSize - 1 ? bodyLength : BufSize - 1;
+        memcpy(buffers[slot], body, copyLength);
+        buffers[slot][copyLength] = '\0';
+        lengths[slot]             = copyLength;
+        __atomic_store_n(&current, slot, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // Any task. Empty until the first publish().
+    SharedPayloadRef acquire()
+    {
+        for (;;)
+        {
+            int slot = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+            if (slot < 0)
+            {
+                return SharedPayloadRef();
+            }
+            __atomic_add_fetch(&refs[slot], 1, __ATOMIC_ACQ_REL);
+            // Still current: the writer will not pick it until we let go.
+            // Otherwise it may be rebuilt under us, so back off and retry.
+            if (__atomic_load_n(&current, __ATOMIC_ACQUIRE) == slot)
+            {
+                return SharedPayloadRef(&refs[slot], buffers[slot], lengths[slot]);
+            }
+            __atomic_sub_fetch(&refs[slot], 1, __ATOMIC_ACQ_REL);
+        }
+    }
+
+    // Publishes skipped because readers held every spare slot
+    uint32_t publishFailures() const { return failures; }
+
+  private:
+    char     buffers[Slots][BufSize];
+    size_t   lengths[Slots];
+    uint32_t refs[Slots];
+    int      current;
+    uint32_t failures;
+};
+
+#endif  // SHARED_PAYLOAD_H
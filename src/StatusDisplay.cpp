@@ -44,7 +44,10 @@
 #include <Adafruit_SSD1306.h>
 #include <WiFi.h>
 #include "ElegooCC.h"
+#include "Logger.h"
+#include "SeqLock.h"
 #include "SettingsManager.h"
+#include "TaskWake.h"
 
 // ============================================================================
 // Display Mode Configuration
@@ -98,37 +101,170 @@
 // Update throttle (100ms = 10 FPS max)
 static constexpr unsigned long DISPLAY_UPDATE_INTERVAL_MS = 100;
 
-// Display instance (uses buffer dimensions, -1 = no reset pin)
-static Adafruit_SSD1306 display(BUFFER_WIDTH, BUFFER_HEIGHT, &Wire, -1);
+// Longest the display task sleeps without a new state (it normally wakes on one)
+static constexpr uint32_t DISPLAY_TASK_IDLE_MS = 1000;
 
-// State tracking
-static DisplayStatus currentStatus = DisplayStatus::NORMAL;
-static DisplayStatus lastDrawnStatus = DisplayStatus::NORMAL;
-static unsigned long lastUpdateMs = 0;
-static bool displayInitialized = false;
-static uint8_t lastDisplayedIpOctet = 0;  // Track IP to redraw when WiFi connects
-static bool lastConnectionStatus = false; // Track connection state for mode 4
-static String lastPrinterIp = "";          // Track printer IP for modes 3/4
-static unsigned long lastDisplayedUptime = 0;  // Track uptime for mode 5 refresh
+// SSD1306 memory is organised in pages of 8 pixel rows
+static constexpr uint8_t PAGE_COUNT = BUFFER_HEIGHT / 8;
+
+// Data bytes per I2C transaction: the Wire buffer less the control byte
+#ifdef I2C_BUFFER_LENGTH
+static constexpr size_t I2C_DATA_CHUNK = I2C_BUFFER_LENGTH - 1;
+#else
+static constexpr size_t I2C_DATA_CHUNK = 31;
+#endif
+
+// Display instance (uses buffer dimensions, -1 = no reset pin). Both clocks are
+// the fast one: transfers only ever happen on the display task.
+static Adafruit_SSD1306 display(BUFFER_WIDTH, BUFFER_HEIGHT, &Wire, -1, OLED_I2C_CLOCK_HZ,
+                                OLED_I2C_CLOCK_HZ);
+
+// Everything a frame depends on. Fields that the current status does not draw
+// stay zero, so only visible changes produce a new state.
+typedef struct
+{
+    DisplayStatus status;
+    uint8_t       myIp[4];
+    char          printerIp[16];  // "" if not configured
+    bool          connected;
+    bool          printing;
+    uint32_t      uptimeSec;      // Mode 5 only
+} display_state_t;
+
+// Main loop side
+static DisplayStatus   currentStatus = DisplayStatus::NORMAL;
+static unsigned long   lastUpdateMs = 0;
+static bool            displayInitialized = false;
+static display_state_t lastPublished;
+static bool            hasPublished = false;
+#if OLED_DISPLAY_MODE == 3 || OLED_DISPLAY_MODE == 4
+static uint32_t        settingsRevision = UINT32_MAX;  // Never a real revision
+static char            cachedPrinterIp[16] = "";
+#endif
+
+// Handed to the display task
+static SeqLock<display_state_t> displayState;
+static TaskWake                 displayWake;
+static TaskHandle_t             displayTask = nullptr;
+
+// Display task side: what the panel holds, one byte per column per page
+static uint8_t  sentFrame[PAGE_COUNT * BUFFER_WIDTH];
+static bool     sentFrameValid = false;
+static uint32_t drawnGeneration = 0;
 
 // Forward declarations
-static void drawStatus(DisplayStatus status);
+static void drawStatus(const display_state_t &state);
+static void renderPending();
+
+/**
+ * Send the columns of each page that differ from what the panel already
+ * shows. A changed digit touches one or two pages of a few dozen columns,
+ * against 1 KB for a full display() at every redraw.
+ */
+static void flushDirtyPages()
+{
+    const uint8_t *frame = display.getBuffer();
+
+    for (uint8_t page = 0; page < PAGE_COUNT; page++)
+    {
+        const uint8_t *row  = frame + page * BUFFER_WIDTH;
+        uint8_t       *sent = sentFrame + page * BUFFER_WIDTH;
+
+        int first = 0;
+        int last  = BUFFER_WIDTH - 1;
+        if (sentFrameValid)
+        {
+            while (first < BUFFER_WIDTH && row[first] == sent[first])
+            {
+                first++;
+            }
+            if (first == BUFFER_WIDTH)
+            {
+                continue;  // Page unchanged
+            }
+            while (row[last] == sent[last])
+            {
+                last--;
+            }
+        }
+
+        // Horizontal addressing (set by begin()): a window of one page row
+        display.ssd1306_command(SSD1306_PAGEADDR);
+        display.ssd1306_command(page);
+        display.ssd1306_command(page);
+        display.ssd1306_command(SSD1306_COLUMNADDR);
+        display.ssd1306_command(first);
+        display.ssd1306_command(last);
+
+        for (int column = first; column <= last;)
+        {
+            size_t count = last - column + 1;
+            if (count > I2C_DATA_CHUNK)
+            {
+                count = I2C_DATA_CHUNK;
+            }
+            Wire.beginTransmission(OLED_I2C_ADDRESS);
+            Wire.write((uint8_t) 0x40);  // Co = 0, D/C = 1: data stream
+            Wire.write(row + column, count);
+            Wire.endTransmission();
+            column += count;
+        }
+        memcpy(sent + first, row + first, last - first + 1);
+    }
+    sentFrameValid = true;
+}
+
+// Draw the latest state if it has not been drawn yet
+static void renderPending()
+{
+    uint32_t generation = displayState.generation();
+    if (generation == drawnGeneration)
+    {
+        return;
+    }
+    display_state_t state = displayState.read();
+    drawnGeneration       = generation;
+    drawStatus(state);
+    flushDirtyPages();
+}
+
+static void displayTaskEntry(void *)
+{
+    displayWake.begin();
+    for (;;)
+    {
+        displayWake.sleep(DISPLAY_TASK_IDLE_MS);
+        renderPending();
+    }
+}
 
 void statusDisplayBegin()
 {
     // Initialize I2C with custom pins
-    Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
+    Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN, OLED_I2C_CLOCK_HZ);
     
     // Initialize display
     if (display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDRESS))
     {
         displayInitialized = true;
-        display.clearDisplay();
-        display.display();
-        
-        // Draw initial state
-        drawStatus(DisplayStatus::NORMAL);
-        lastDrawnStatus = DisplayStatus::NORMAL;
+        Wire.setClock(OLED_I2C_CLOCK_HZ);
+
+        // Draw initial state; the first flush sends the whole buffer
+        display_state_t initial;
+        memset(&initial, 0, sizeof(initial));
+        initial.status = DisplayStatus::NORMAL;
+        drawStatus(initial);
+        flushDirtyPages();
+
+        // From here on only the display task touches the panel and the bus
+        const BaseType_t core = 0;
+        if (xTaskCreatePinnedToCore(displayTaskEntry, "display", STATUS_DISPLAY_TASK_STACK_SIZE,
+                                    nullptr, STATUS_DISPLAY_TASK_PRIORITY, &displayTask,
+                                    core) != pdPASS)
+        {
+            displayTask = nullptr;
+            logger.log("Failed to start display task, drawing from the main loop");
+        }
     }
 }
 
@@ -144,14 +280,7 @@ void statusDisplayLoop()
         return;
     }
     
-    unsigned long now = millis();
-    if (now - lastUpdateMs < DISPLAY_UPDATE_INTERVAL_MS)
-    {
-        return;
-    }
-    lastUpdateMs = now;
-    
-    // Query current state from ElegooCC
+    // Query current state from ElegooCC (lock-free snapshot reads)
     DisplayStatus newStatus = DisplayStatus::NORMAL;
     
     if (elegooCC.isFilamentRunout())
@@ -162,39 +291,66 @@ void statusDisplayLoop()
     {
         newStatus = DisplayStatus::JAM;
     }
-    
+
+    // Status changes go out on the pass they are seen; the rest is throttled
+    unsigned long now = millis();
+    if (newStatus == currentStatus && now - lastUpdateMs < DISPLAY_UPDATE_INTERVAL_MS)
+    {
+        return;
+    }
+    lastUpdateMs  = now;
     currentStatus = newStatus;
-    
-    // Check if IP changed (e.g., WiFi just connected)
-    // This forces a redraw when the IP becomes available after boot
-    uint8_t currentIpOctet = WiFi.localIP()[3];
-    bool ipChanged = (currentIpOctet != lastDisplayedIpOctet);
-    
-    // Check if printer IP or connection status changed (for modes 3/4)
-    String currentPrinterIp = settingsManager.getElegooIP();
-    printer_info_t info = elegooCC.getCurrentInformation();
-    bool printerIpChanged = (currentPrinterIp != lastPrinterIp);
-    bool connectionChanged = (info.isWebsocketConnected != lastConnectionStatus);
-
-    // Check if uptime changed (for mode 5 - refresh every second)
-    unsigned long currentUptimeSec = millis() / 1000;
-    bool uptimeChanged = (currentUptimeSec != lastDisplayedUptime);
-
-    // Redraw if any relevant state changed
-    bool needsRedraw = (currentStatus != lastDrawnStatus) ||
-                       (ipChanged && currentStatus == DisplayStatus::NORMAL) ||
-                       (printerIpChanged && currentStatus == DisplayStatus::NORMAL) ||
-                       (connectionChanged && currentStatus == DisplayStatus::NORMAL) ||
-                       (uptimeChanged && currentStatus == DisplayStatus::NORMAL);
-    
-    if (needsRedraw)
+
+    display_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.status = currentStatus;
+
+    if (currentStatus == DisplayStatus::NORMAL)
     {
-        drawStatus(currentStatus);
-        lastDrawnStatus = currentStatus;
-        lastDisplayedIpOctet = currentIpOctet;
-        lastPrinterIp = currentPrinterIp;
-        lastConnectionStatus = info.isWebsocketConnected;
-        lastDisplayedUptime = currentUptimeSec;
+        // IP changes (e.g. WiFi just connected after boot) force a redraw
+        IPAddress ip = WiFi.localIP();
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            state.myIp[i] = ip[i];
+        }
+
+#if OLED_DISPLAY_MODE == 3 || OLED_DISPLAY_MODE == 4
+        // Printer IP only changes with the settings
+        uint32_t revision = settingsManager.getRevision();
+        if (revision != settingsRevision)
+        {
+            strlcpy(cachedPrinterIp, settingsManager.getElegooIP().c_str(), sizeof(cachedPrinterIp));
+            settingsRevision = revision;
+        }
+        memcpy(state.printerIp, cachedPrinterIp, sizeof(state.printerIp));
+#endif
+
+#if OLED_DISPLAY_MODE == 4
+        printer_info_t info = elegooCC.getCurrentInformation();
+        state.connected     = info.isWebsocketConnected;
+        state.printing      = info.isWebsocketConnected && info.isPrinting;
+#endif
+
+#if OLED_DISPLAY_MODE == 5
+        state.uptimeSec = now / 1000;
+#endif
+    }
+
+    if (hasPublished && memcmp(&state, &lastPublished, sizeof(state)) == 0)
+    {
+        return;
+    }
+    lastPublished = state;
+    hasPublished  = true;
+    displayState.publish(state);
+
+    if (displayTask != nullptr)
+    {
+        displayWake.notify();
+    }
+    else
+    {
+        renderPending();
     }
 }
 
@@ -209,11 +365,11 @@ void statusDisplayLoop()
  *   - JAM:     Inverted (white background) with "JAM" text
  *   - RUNOUT:  Striped pattern with "OUT" text
  */
-static void drawStatus(DisplayStatus status)
+static void drawStatus(const display_state_t &state)
 {
     display.clearDisplay();
     
-    switch (status)
+    switch (state.status)
     {
         case DisplayStatus::NORMAL:
         {
@@ -221,8 +377,7 @@ static void drawStatus(DisplayStatus status)
             
 #if OLED_DISPLAY_MODE == 1
             // Mode 1: Show IP last octet only (large, easy to read)
-            IPAddress ip = WiFi.localIP();
-            uint8_t lastOctet = ip[3];
+            uint8_t lastOctet = state.myIp[3];
             
             // "IP:" label - small text at top
             display.setTextSize(1);
@@ -239,7 +394,7 @@ static void drawStatus(DisplayStatus status)
 #elif OLED_DISPLAY_MODE == 2
             // Mode 2: First..Last octet format (fits 72px width)
             {
-                IPAddress ip = WiFi.localIP();
+                const uint8_t *ip = state.myIp;
 
                 display.setTextSize(1);
                 display.setCursor(VIS_X(18), VIS_Y(2));
@@ -257,8 +412,8 @@ static void drawStatus(DisplayStatus status)
 #elif OLED_DISPLAY_MODE == 3
             // Mode 3: Both IPs - first..last format (fits 72px width)
             {
-                IPAddress myIp = WiFi.localIP();
-                String printerIp = settingsManager.getElegooIP();
+                const uint8_t *myIp = state.myIp;
+                String printerIp(state.printerIp);
 
                 display.setTextSize(1);
 
@@ -285,9 +440,8 @@ static void drawStatus(DisplayStatus status)
 #elif OLED_DISPLAY_MODE == 4
             // Mode 4: Both IPs + connection status (abbreviated to fit)
             {
-                IPAddress myIp = WiFi.localIP();
-                String printerIp = settingsManager.getElegooIP();
-                printer_info_t info = elegooCC.getCurrentInformation();
+                const uint8_t *myIp = state.myIp;
+                String printerIp(state.printerIp);
 
                 display.setTextSize(1);
 
@@ -312,7 +466,7 @@ static void drawStatus(DisplayStatus status)
 
                 // Line 3: Connection status
                 display.setCursor(VIS_X(0), VIS_Y(22));
-                if (info.isWebsocketConnected) {
+                if (state.connected) {
                     display.print("*CONNECTED*");
                 } else {
                     display.print("DISCONNECTED");
@@ -320,7 +474,7 @@ static void drawStatus(DisplayStatus status)
 
                 // Line 4: Print status if connected
                 display.setCursor(VIS_X(0), VIS_Y(32));
-                if (info.isWebsocketConnected && info.isPrinting) {
+                if (state.printing) {
                     display.print("PRINTING");
                 }
             }
@@ -334,9 +488,9 @@ static void drawStatus(DisplayStatus status)
                 /*
                 // DEBUG: Add offset to test different uptime values
                 const unsigned long DEBUG_UPTIME_OFFSET_SEC = 621132;
-                unsigned long uptimeSec = millis() / 1000 + DEBUG_UPTIME_OFFSET_SEC;
+                unsigned long uptimeSec = state.uptimeSec + DEBUG_UPTIME_OFFSET_SEC;
                 */
-                unsigned long uptimeSec = millis() / 1000;
+                unsigned long uptimeSec = state.uptimeSec;
 
                 display.setTextSize(1);
 
@@ -416,8 +570,7 @@ static void drawStatus(DisplayStatus status)
             break;
         }
     }
-    
-    display.display();
+    // The caller sends the changed pages
 }
 
 #else // ENABLE_OLED_DISPLAY not defined
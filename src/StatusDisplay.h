@@ -13,8 +13,26 @@
  *   - Green:  Normal operation (no problems)
  *   - Red:    Jam detected
  *   - Purple: Filament runout
+ *
+ * Rendering and the I2C transfer run in a low-priority display task; the
+ * main loop only collects what the screen shows and hands it over, so an
+ * attached panel adds nothing to detection or command latency.
  */
 
+// Display task: priority 1 like the log sink, below detection and async_tcp
+#ifndef STATUS_DISPLAY_TASK_STACK_SIZE
+#define STATUS_DISPLAY_TASK_STACK_SIZE 4096
+#endif
+
+#ifndef STATUS_DISPLAY_TASK_PRIORITY
+#define STATUS_DISPLAY_TASK_PRIORITY 1
+#endif
+
+// SSD1306 supports 400 kHz fast mode; the Wire default is 100 kHz
+#ifndef OLED_I2C_CLOCK_HZ
+#define OLED_I2C_CLOCK_HZ 400000
+#endif
+
 enum class DisplayStatus : uint8_t
 {
     NORMAL = 0,  // Green - all good
@@ -36,8 +54,9 @@ void statusDisplayUpdate(DisplayStatus status);
 
 /**
  * Process display updates (call in main loop).
- * Automatically queries ElegooCC state and updates display.
- * Throttled internally to avoid excessive redraws.
+ * Collects ElegooCC and WiFi state and wakes the display task when what the
+ * screen shows has changed. Never draws or touches I2C itself unless the
+ * display task could not be started.
  */
 void statusDisplayLoop();
 
@@ -1,11 +1,15 @@
 #include "SystemServices.h"
 
 #include <ESPmDNS.h>
+#include <LittleFS.h>
 #include <WiFi.h>
+#include <string.h>
 #include <time.h>
 
+#include "BootStages.h"
 #include "ElegooCC.h"
 #include "Logger.h"
+#include "MemoryMonitor.h"
 #include "SettingsManager.h"
 
 namespace
@@ -14,6 +18,10 @@ constexpr unsigned long WIFI_CHECK_INTERVAL_MS    = 30000;
 constexpr unsigned long WIFI_RECONNECT_TIMEOUT_MS = 10000;
 constexpr unsigned long NTP_SYNC_INTERVAL_MS      = 3600000;
 const char*             NTP_SERVER                = "pool.ntp.org";
+constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS   = 15000;
+constexpr unsigned long WIFI_FAST_CONNECT_TIMEOUT_MS = 5000;  // Cached AP: give up early and scan
+const char*             WIFI_CACHE_PATH           = "/wifi_cache.bin";
+constexpr uint32_t      WIFI_CACHE_MAGIC          = 0x32434657;  // "WFC2" (no lease)
 }  // namespace
 
 SystemServices systemServices;
@@ -21,49 +29,43 @@ SystemServices systemServices;
 void SystemServices::begin()
 {
     wifiSetupAttempted         = false;
-    wifiSetupAttemptedThisLoop = false;
     stationConnected           = false;
     isReconnecting             = false;
     ntpConfigured              = false;
+    timeSynced                 = false;
     lastWifiCheck              = 0;
     wifiReconnectStart         = 0;
     lastNTPSyncAttempt         = 0;
-    lastHeapCheck              = 0;
+    staticIpActive             = false;
+    reconnectPinned            = false;
+    stationConnecting          = false;
 }
 
 void SystemServices::loop()
 {
     unsigned long currentTime = millis();
-    wifiSetupAttemptedThisLoop = false;
 
     if (!wifiSetupAttempted)
     {
-        wifiSetupAttempted         = true;
-        wifiSetupAttemptedThisLoop = true;
-        bool success = wifiSetup();
+        // Non-blocking: the station connect completes in pollWifiStation()
+        // while the rest of the main loop keeps running
+        wifiSetupAttempted = true;
+        wifiSetup();
 
-        if (success)
+        if (settingsManager.isAPMode())
         {
-            logger.log(F("WiFi connected successfully"));
-            logger.logf("IP Address: %s", WiFi.localIP().toString().c_str());
+            logger.log(F("WiFi setup complete - running in AP mode"));
+            logger.logf("AP IP Address: %s", WiFi.softAPIP().toString().c_str());
         }
-        else
-        {
-            if (settingsManager.isAPMode())
-            {
-                logger.log(F("WiFi setup complete - running in AP mode"));
-                logger.logf("AP IP Address: %s", WiFi.softAPIP().toString().c_str());
-            }
-            else
-            {
-                logger.log(F("WiFi setup attempted - will retry connection in background"));
-            }
-        }
-        return;
     }
 
     handleWifiReconnectRequest();
 
+    if (stationConnecting)
+    {
+        pollWifiStation(currentTime);
+    }
+
     stationConnected = (!settingsManager.isAPMode() && WiFi.status() == WL_CONNECTED);
 
     if (stationConnected)
@@ -81,23 +83,36 @@ void SystemServices::loop()
 
         if (!ntpConfigured)
         {
+            // SNTP runs in the background; the clock is checked without blocking below
             configTime(gmtOffset_sec, 0, NTP_SERVER);
-            syncTimeWithNTP(currentTime);
+            lastNTPSyncAttempt = currentTime;
             logger.log("NTP setup complete");
             ntpConfigured = true;
         }
+        else if (!timeSynced)
+        {
+            struct tm timeinfo;
+            if (getLocalTime(&timeinfo, 0))
+            {
+                timeSynced = true;
+                bootStages.mark(BOOT_STAGE_NTP);
+                logger.logf("NTP time synchronization successful, %lums after boot", millis());
+            }
+        }
         else if (currentTime - lastNTPSyncAttempt >= NTP_SYNC_INTERVAL_MS)
         {
             syncTimeWithNTP(currentTime);
         }
     }
-    else if (!settingsManager.isAPMode() && currentTime - lastWifiCheck >= WIFI_CHECK_INTERVAL_MS)
+    else if (!settingsManager.isAPMode() && !stationConnecting &&
+             currentTime - lastWifiCheck >= WIFI_CHECK_INTERVAL_MS)
     {
         lastWifiCheck = currentTime;
         checkWifiConnection();
     }
 
-    monitorHeap(currentTime);
+    // Heap and stack marks, plus the periodic heap summary and warnings
+    memoryMonitor.loop(currentTime);
 }
 
 bool SystemServices::wifiReady() const
@@ -115,11 +130,6 @@ bool SystemServices::hasAttemptedWifiSetup() const
     return wifiSetupAttempted;
 }
 
-bool SystemServices::shouldYieldForSetup() const
-{
-    return wifiSetupAttemptedThisLoop;
-}
-
 unsigned long SystemServices::currentEpoch() const
 {
     time_t now;
@@ -135,7 +145,7 @@ void SystemServices::failWifi()
     {
         settingsManager.setAPMode(true);
         bool saved = settingsManager.save();
-        elegooCC.refreshCaches();
+        ElegooCC::refreshAllCaches();
         if (saved)
         {
             logger.log("Failed to connect to wifi, reverted to AP mode (first connection attempt)");
@@ -177,8 +187,7 @@ void SystemServices::handleSuccessfulWifiConnection()
     if (!settingsManager.getHasConnected())
     {
         settingsManager.setHasConnected(true);
-        settingsManager.save();
-        elegooCC.refreshCaches();
+        settingsManager.commit();
         logger.log("First successful WiFi connection recorded");
     }
 
@@ -191,33 +200,182 @@ void SystemServices::handleSuccessfulWifiConnection()
     }
 }
 
-bool SystemServices::connectToWifiStation(bool isReconnect)
+void SystemServices::loadWifiCache()
+{
+    WifiCache loaded = {};
+    File      file   = LittleFS.open(WIFI_CACHE_PATH, "r");
+    bool      valid  = file && file.read(reinterpret_cast<uint8_t*>(&loaded), sizeof(loaded)) ==
+                             sizeof(loaded);
+    if (file)
+    {
+        file.close();
+    }
+
+    // A cache for other credentials is useless
+    loaded.ssid[sizeof(loaded.ssid) - 1] = '\0';
+    valid = valid && loaded.magic == WIFI_CACHE_MAGIC &&
+            settingsManager.getSSID().equals(loaded.ssid);
+    if (valid)
+    {
+        wifiCache = loaded;
+    }
+    else
+    {
+        wifiCache = WifiCache{};
+    }
+}
+
+void SystemServices::saveWifiCache()
+{
+    File file = LittleFS.open(WIFI_CACHE_PATH, "w");
+    if (!file)
+    {
+        logger.log("Failed to write WiFi cache");
+        return;
+    }
+    file.write(reinterpret_cast<const uint8_t*>(&wifiCache), sizeof(wifiCache));
+    file.close();
+}
+
+void SystemServices::rememberConnection()
+{
+    WifiCache fresh = wifiCache;
+    fresh.magic     = WIFI_CACHE_MAGIC;
+    strlcpy(fresh.ssid, settingsManager.getSSID().c_str(), sizeof(fresh.ssid));
+
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid != nullptr)
+    {
+        memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
+        fresh.channel = WiFi.channel();
+    }
+
+    // Only touch flash when something changed
+    if (memcmp(&fresh, &wifiCache, sizeof(fresh)) != 0)
+    {
+        wifiCache = fresh;
+        saveWifiCache();
+    }
+}
+
+void SystemServices::forgetCachedAp()
+{
+    wifiCache.channel = 0;
+    memset(wifiCache.bssid, 0, sizeof(wifiCache.bssid));
+    saveWifiCache();
+}
+
+bool SystemServices::hasCachedAp() const
+{
+#if WIFI_FAST_CONNECT
+    return wifiCache.magic == WIFI_CACHE_MAGIC && wifiCache.channel > 0;
+#else
+    return false;
+#endif
+}
+
+bool SystemServices::applyStaticIp()
+{
+    String ipText = settingsManager.getStaticIP();
+    if (ipText.length() == 0)
+    {
+        return false;
+    }
+
+    IPAddress ip;
+    IPAddress gateway;
+    IPAddress subnet;
+    IPAddress dns;
+    if (!ip.fromString(ipText) || !gateway.fromString(settingsManager.getStaticGateway()) ||
+        !subnet.fromString(settingsManager.getStaticSubnet()))
+    {
+        logger.log("Static IP settings incomplete or invalid, using DHCP");
+        return false;
+    }
+    if (!dns.fromString(settingsManager.getStaticDns()))
+    {
+        dns = gateway;
+    }
+    if (!WiFi.config(ip, gateway, subnet, dns))
+    {
+        logger.log("Failed to apply static IP, using DHCP");
+        return false;
+    }
+    return true;
+}
+
+void SystemServices::beginStation(bool pinAp)
+{
+    String ssid     = settingsManager.getSSID();
+    String password = settingsManager.getPassword();
+    if (pinAp)
+    {
+        WiFi.begin(ssid.c_str(), password.c_str(), wifiCache.channel, wifiCache.bssid);
+    }
+    else
+    {
+        WiFi.begin(ssid.c_str(), password.c_str());
+    }
+}
+
+void SystemServices::connectToWifiStation(bool isReconnect)
 {
     WiFi.mode(WIFI_STA);
     const char* action = isReconnect ? "Reconnecting to" : "Connecting to";
     logger.logf("%s WiFi: %s", action, settingsManager.getSSID().c_str());
 
-    WiFi.begin(settingsManager.getSSID().c_str(), settingsManager.getPassword().c_str());
-
-    const unsigned long CONNECT_TIMEOUT_MS = 15000;
-    unsigned long       startTime          = millis();
-
-    while (WiFi.status() != WL_CONNECTED && (millis() - startTime) < CONNECT_TIMEOUT_MS)
+    loadWifiCache();
+    staticIpActive = applyStaticIp();
+    if (!staticIpActive && isReconnect)
     {
-        Serial.print('.');
-        vTaskDelay(pdMS_TO_TICKS(500));
-        yield();
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);  // Static IP may have been cleared
     }
 
-    Serial.println();
+    connectPinned      = hasCachedAp();
+    connectIsReconnect = isReconnect;
+    connectStartMs     = millis();
+    attemptStartMs     = connectStartMs;
+    attemptTimeoutMs   = connectPinned ? WIFI_FAST_CONNECT_TIMEOUT_MS : WIFI_CONNECT_TIMEOUT_MS;
+    stationConnecting  = true;
+    beginStation(connectPinned);
+}
 
+void SystemServices::pollWifiStation(unsigned long currentTime)
+{
     if (WiFi.status() == WL_CONNECTED)
     {
+        stationConnecting = false;
+        rememberConnection();
+        bootStages.mark(BOOT_STAGE_WIFI);
+        logger.logf("WiFi ready in %lums (%s, %s), %lums after boot", currentTime - connectStartMs,
+                    connectPinned ? "cached AP" : "scan",
+                    staticIpActive ? "static IP" : "DHCP",
+                    currentTime);
         handleSuccessfulWifiConnection();
-        return true;
+        return;
+    }
+
+    if (currentTime - attemptStartMs < attemptTimeoutMs)
+    {
+        return;
+    }
+
+    if (connectPinned)
+    {
+        // AP replaced or moved channel: scan
+        logger.log("Cached WiFi AP not reachable, scanning");
+        forgetCachedAp();
+        connectPinned = false;
+        WiFi.disconnect();
+        attemptStartMs   = currentTime;
+        attemptTimeoutMs = WIFI_CONNECT_TIMEOUT_MS;
+        beginStation(false);
+        return;
     }
 
-    if (isReconnect)
+    stationConnecting = false;
+    stationConnected  = false;
+    if (connectIsReconnect)
     {
         logger.log("Failed to connect with new WiFi credentials");
     }
@@ -225,9 +383,6 @@ bool SystemServices::connectToWifiStation(bool isReconnect)
     {
         failWifi();
     }
-
-    stationConnected = false;
-    return false;
 }
 
 void SystemServices::cleanupWifiConnections()
@@ -237,31 +392,32 @@ void SystemServices::cleanupWifiConnections()
     delay(1000);
 }
 
-bool SystemServices::wifiSetup()
+void SystemServices::wifiSetup()
 {
     if (settingsManager.isAPMode())
     {
         startAPMode();
-        return false;
+        return;
     }
 
-    return connectToWifiStation(false);
+    connectToWifiStation(false);
 }
 
-bool SystemServices::reconnectWifiWithNewCredentials()
+void SystemServices::reconnectWifiWithNewCredentials()
 {
     logger.log("Applying new WiFi credentials...");
     cleanupWifiConnections();
+    stationConnecting = false;
 
     if (settingsManager.isAPMode())
     {
         logger.log("Switching to AP mode");
         startAPMode();
-        return false;
+        return;
     }
 
     logger.log("Connecting to WiFi station mode with new credentials...");
-    return connectToWifiStation(true);
+    connectToWifiStation(true);
 }
 
 void SystemServices::checkWifiConnection()
@@ -279,12 +435,21 @@ void SystemServices::checkWifiConnection()
         if (!isReconnecting)
         {
             logger.log("WiFi disconnected, attempting to reconnect...");
-            WiFi.begin(settingsManager.getSSID().c_str(), settingsManager.getPassword().c_str());
+            reconnectPinned = hasCachedAp();
+            beginStation(reconnectPinned);
             wifiReconnectStart = millis();
             isReconnecting     = true;
         }
         else if (millis() - wifiReconnectStart >= WIFI_RECONNECT_TIMEOUT_MS)
         {
+            if (reconnectPinned)
+            {
+                // The driver keeps retrying the pinned AP; scan on the next check instead
+                logger.log("Cached WiFi AP not reachable, next reconnect scans");
+                forgetCachedAp();
+                reconnectPinned = false;
+                isReconnecting  = false;
+            }
             failWifi();
         }
     }
@@ -292,12 +457,12 @@ void SystemServices::checkWifiConnection()
     {
         logger.log("WiFi reconnected successfully");
         isReconnecting = false;
+        rememberConnection();
 
         if (!settingsManager.getHasConnected())
         {
             settingsManager.setHasConnected(true);
-            settingsManager.save();
-            elegooCC.refreshCaches();
+            settingsManager.commit();
         }
     }
 }
@@ -306,7 +471,7 @@ void SystemServices::syncTimeWithNTP(unsigned long currentTime)
 {
     struct tm timeinfo;
     lastNTPSyncAttempt = currentTime;
-    if (getLocalTime(&timeinfo))
+    if (getLocalTime(&timeinfo, 0))
     {
         logger.log("NTP time synchronization successful");
     }
@@ -316,35 +481,6 @@ void SystemServices::syncTimeWithNTP(unsigned long currentTime)
     }
 }
 
-void SystemServices::monitorHeap(unsigned long currentTime)
-{
-    if (currentTime - lastHeapCheck <= 300000)
-    {
-        return;
-    }
-
-    lastHeapCheck = currentTime;
-
-    uint32_t freeHeap = ESP.getFreeHeap();
-    uint32_t minHeap  = ESP.getMinFreeHeap();
-    uint32_t maxAlloc = ESP.getMaxAllocHeap();
-
-    float fragmentation = 100.0f * (1.0f - ((float)maxAlloc / (float)freeHeap));
-
-    logger.logf(LOG_VERBOSE, "Heap: free=%lu min=%lu maxAlloc=%lu frag=%.1f%%",
-                freeHeap, minHeap, maxAlloc, fragmentation);
-
-    if (fragmentation > 30.0f)
-    {
-        logger.log(F("WARNING: Heap fragmentation high!"), LOG_NORMAL);
-    }
-
-    if (minHeap < 2000)
-    {
-        logger.logf(LOG_NORMAL, "CRITICAL: Low memory! Min heap: %lu", minHeap);
-    }
-}
-
 void SystemServices::handleWifiReconnectRequest()
 {
     if (!settingsManager.requestWifiReconnect)
@@ -2,6 +2,11 @@
 
 #include <Arduino.h>
 
+// Reconnect straight to the last good AP (BSSID + channel) instead of scanning
+#ifndef WIFI_FAST_CONNECT
+#define WIFI_FAST_CONNECT 1
+#endif
+
 class SystemServices
 {
   public:
@@ -11,32 +16,59 @@ class SystemServices
     bool wifiReady() const;
     bool runningInAPMode() const;
     bool hasAttemptedWifiSetup() const;
-    bool shouldYieldForSetup() const;
 
     unsigned long currentEpoch() const;
 
   private:
+    // Last good association, persisted to skip the scan on the next connect
+    struct WifiCache
+    {
+        uint32_t magic;
+        char     ssid[33];
+        uint8_t  bssid[6];
+        int32_t  channel;  // 0 = no cached AP
+    };
+
+    void loadWifiCache();
+    void saveWifiCache();
+    void rememberConnection();
+    void forgetCachedAp();
+    bool hasCachedAp() const;
+    bool applyStaticIp();
+    void beginStation(bool pinAp);
+    void pollWifiStation(unsigned long currentTime);
+
     void failWifi();
     void startAPMode();
     void handleSuccessfulWifiConnection();
-    bool connectToWifiStation(bool isReconnect);
+    void connectToWifiStation(bool isReconnect);  // Starts the connect; loop() finishes it
     void cleanupWifiConnections();
-    bool wifiSetup();
-    bool reconnectWifiWithNewCredentials();
+    void wifiSetup();
+    void reconnectWifiWithNewCredentials();
     void checkWifiConnection();
     void syncTimeWithNTP(unsigned long currentTime);
-    void monitorHeap(unsigned long currentTime);
     void handleWifiReconnectRequest();
 
     bool          wifiSetupAttempted        = false;
-    bool          wifiSetupAttemptedThisLoop = false;
     bool          stationConnected          = false;
     bool          isReconnecting            = false;
     bool          ntpConfigured             = false;
+    bool          timeSynced                = false;
     unsigned long lastWifiCheck             = 0;
     unsigned long wifiReconnectStart        = 0;
     unsigned long lastNTPSyncAttempt        = 0;
-    unsigned long lastHeapCheck             = 0;
+
+    WifiCache     wifiCache                 = {};
+    bool          staticIpActive            = false;
+    bool          reconnectPinned           = false;  // Background reconnect uses the cached AP
+
+    // Station connect in progress (connectToWifiStation() .. pollWifiStation())
+    bool          stationConnecting         = false;
+    bool          connectIsReconnect        = false;
+    bool          connectPinned             = false;
+    unsigned long connectStartMs            = 0;
+    unsigned long attemptStartMs            = 0;
+    unsigned long attemptTimeoutMs          = 0;
 };
 
 extern SystemServices systemServices;
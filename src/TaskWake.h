@@ -0,0 +1,59 @@
+#ifndef TASK_WAKE_H
+#define TASK_WAKE_H
+
+#include <Arduino.h>
+
+/**
+ * TaskWake - wake a task that sleeps between polls
+ *
+ * The owning task calls begin() once, then sleep(timeoutMs) where it used to
+ * vTaskDelay(): the sleep ends at the timeout or as soon as another task
+ * calls notify(). Notifications coalesce, so a burst of events costs one
+ * wake-up, and a notify() that arrives while the owner is busy makes its
+ * next sleep() return at once. Built on the owner's direct-to-task
+ * notification value; ISRs notify the handle from task() with
+ * vTaskNotifyGiveFromISR().
+ */
+class TaskWake
+{
+  public:
+    // Main loop (Arduino loopTask): web handlers and detection post work here
+    static TaskWake &mainLoop()
+    {
+        static TaskWake instance;
+        return instance;
+    }
+
+    // Call from the owning task
+    void begin() { owner = xTaskGetCurrentTaskHandle(); }
+
+    TaskHandle_t task() const { return owner; }
+
+    // Any task; a no-op before begin()
+    void notify()
+    {
+        TaskHandle_t handle = owner;
+        if (handle != nullptr)
+        {
+            xTaskNotifyGive(handle);
+        }
+    }
+
+    // Owning task only. Returns true when woken by notify().
+    bool sleep(uint32_t timeoutMs)
+    {
+        if (timeoutMs == 0)
+        {
+            taskYIELD();
+            return false;
+        }
+        return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+    }
+
+  private:
+    TaskHandle_t volatile owner = nullptr;
+};
+
+#define mainLoopWake TaskWake::mainLoop()
+
+#endif  // TASK_WAKE_H
@@ -0,0 +1,75 @@
+#ifndef VERSIONED_SNAPSHOT_H
+#define VERSIONED_SNAPSHOT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "LockProfiler.h"
+
+/**
+ * VersionedSnapshot - a value replaced as a whole, with a version readers poll
+ *
+ * publish() swaps in a complete new value and bumps the version; readers keep
+ * their own copy and call refresh() at the top of a pass, which costs one
+ * atomic load while nothing changed and copies the value only after a
+ * publish. The copy is taken under a spinlock rather than a SeqLock retry
+ * loop, so readers may outrank the writer (the detection task reads values
+ * the main loop publishes) without spinning on a preempted write.
+ *
+ * portMUX_TYPE comes from the includer (Arduino.h on the device). T must be
+ * trivially copyable and small: the copy runs with interrupts masked.
+ * nameLock() labels the lock for LockProfiler.
+ */
+template <typename T>
+class VersionedSnapshot
+{
+  public:
+    VersionedSnapshot() : currentVersion(0)
+    {
+        lock = portMUX_INITIALIZER_UNLOCKED;
+        memset(&value, 0, sizeof(value));
+    }
+
+    void publish(const T &newValue)
+    {
+        portENTER_CRITICAL(&lock);
+        memcpy(&value, &newValue, sizeof(T));
+        __atomic_store_n(&currentVersion, currentVersion + 1, __ATOMIC_RELEASE);
+        portEXIT_CRITICAL(&lock);
+    }
+
+    void nameLock(const char *name) { LOCK_PROFILE_NAME(&lock, name); }
+
+    // Number of publishes so far
+    uint32_t version() const { return __atomic_load_n(&currentVersion, __ATOMIC_ACQUIRE); }
+
+    T read() const
+    {
+        T out;
+        portENTER_CRITICAL(&lock);
+        memcpy(&out, &value, sizeof(T));
+        portEXIT_CRITICAL(&lock);
+        return out;
+    }
+
+    // Copies the value into cached when cachedVersion is stale; returns true if it did
+    bool refresh(T &cached, uint32_t &cachedVersion) const
+    {
+        if (version() == cachedVersion)
+        {
+            return false;
+        }
+        portENTER_CRITICAL(&lock);
+        memcpy(&cached, &value, sizeof(T));
+        cachedVersion = currentVersion;
+        portEXIT_CRITICAL(&lock);
+        return true;
+    }
+
+  private:
+    mutable portMUX_TYPE lock;
+    T                    value;
+    uint32_t             currentVersion;
+};
+
+#endif  // VERSIONED_SNAPSHOT_H
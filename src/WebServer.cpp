@@ -5,8 +5,16 @@
 #include <esp_partition.h>
 #include <esp_system.h>
 
+#include "BootStages.h"
 #include "ElegooCC.h"
+#include "FlowProfile.h"
+#include "LockProfiler.h"
+#include "LogSpill.h"
 #include "Logger.h"
+#include "MemoryMonitor.h"
+#include "MqttPublisher.h"
+#include "PerfMonitor.h"
+#include "TaskWake.h"
 
 #define SPIFFS LittleFS
 
@@ -18,20 +26,152 @@ constexpr const char kRouteTestPause[]        = "/test_pause";
 constexpr const char kRouteTestResume[]       = "/test_resume";
 constexpr const char kRouteDiscoverPrinter[]  = "/discover_printer";
 constexpr const char kRouteSensorStatus[]     = "/sensor_status";
+constexpr const char kRouteSensorStatusBin[]  = "/api/sensor_status.bin";
+constexpr const char kRouteFlowHistoryBin[]   = "/api/flow_history.bin";
 constexpr const char kRouteLogsText[]         = "/api/logs_text";
 constexpr const char kRouteLogsLive[]         = "/api/logs_live";
+constexpr const char kRouteLogsHistory[]      = "/api/logs_history";
 constexpr const char kRouteLogsClear[]        = "/api/logs/clear";
 constexpr const char kRouteCoredump[]         = "/api/coredump";
 constexpr const char kRouteCoredumpStatus[]   = "/api/coredump/status";
 constexpr const char kRouteCoredumpClear[]    = "/api/coredump/clear";
 constexpr const char kRoutePanic[]            = "/api/panic";
 constexpr const char kRouteVersion[]          = "/version";
+constexpr const char kRouteDeviceInfo[]       = "/device_info";
 constexpr const char kRouteStatusEvents[]     = "/status_events";
 constexpr const char kRouteLiteRoot[]         = "/lite";
 constexpr const char kRouteFavicon[]          = "/favicon.ico";
 constexpr const char kRouteRoot[]             = "/";
 constexpr const char kLiteIndexPath[]         = "/lite/index.htm";
+constexpr const char kLiteManifestPath[]      = "/lite/manifest.json";
 constexpr const char kRouteReset[]            = "/api/reset";
+constexpr const char kRoutePerf[]             = "/api/perf";
+constexpr const char kRoutePerfReset[]        = "/api/perf/reset";
+constexpr const char kRoutePerfMemory[]       = "/api/perf/memory";
+constexpr const char kRoutePerfMemoryReset[]  = "/api/perf/memory/reset";
+constexpr const char kRoutePerfLocks[]        = "/api/perf/locks";
+constexpr const char kRoutePerfLocksReset[]   = "/api/perf/locks/reset";
+constexpr const char kRouteFlowProfile[]      = "/api/flow_profile";
+constexpr const char kRoutePrinterPrefix[]    = "/printer/";  // + session index + route
+
+constexpr uint32_t kLogsLiveMaxEntries = 100;  // Tail sent to a client without a cursor
+
+// Taken when an OTA upload starts, closed in its end callback
+mem_phase_mark_t otaMemMark = {};
+
+// Per-response state for chunked log downloads. Lines are pulled from the
+// logger ring one at a time, so a response never holds more than one line
+// regardless of how many entries it covers.
+struct LogChunkState
+{
+    uint32_t          cursor;
+    LogRing::ReadHint hint;
+    uint32_t          endSeq;
+    size_t            lineLen;
+    size_t            lineOffset;
+    char              line[Logger::LOG_LINE_BUFFER_SIZE];
+};
+
+// Copy as much of the pending lines as fits; returns 0 once all are sent
+size_t fillLogLines(LogChunkState &state, uint8_t *buffer, size_t maxLen)
+{
+    size_t written = 0;
+    while (written < maxLen)
+    {
+        if (state.lineOffset >= state.lineLen)
+        {
+            if (!logger.formatNextLogLine(state.cursor, state.hint, state.endSeq, state.line,
+                                          sizeof(state.line), state.lineLen))
+            {
+                break;
+            }
+            state.lineOffset = 0;
+        }
+
+        size_t toCopy = state.lineLen - state.lineOffset;
+        if (toCopy > maxLen - written)
+        {
+            toCopy = maxLen - written;
+        }
+        memcpy(buffer + written, state.line + state.lineOffset, toCopy);
+        written += toCopy;
+        state.lineOffset += toCopy;
+    }
+    return written;
+}
+
+void addLogCursorHeaders(AsyncWebServerResponse *response, uint32_t endSeq)
+{
+    // Clients pass this back as ?since= to fetch only newer lines
+    char cursorText[12];
+    snprintf(cursorText, sizeof(cursorText), "%lu", (unsigned long) endSeq);
+    response->addHeader("X-Log-Cursor", cursorText);
+    response->addHeader("Cache-Control", "no-store");
+}
+
+AsyncWebServerResponse *beginLogResponse(AsyncWebServerRequest *request, uint32_t cursor,
+                                         uint32_t endSeq)
+{
+    MemScope      memScope(MEM_LOG_DUMP);
+    LogChunkState state;
+    state.cursor     = cursor;
+    state.endSeq     = endSeq;
+    state.lineLen    = 0;
+    state.lineOffset = 0;
+
+    AsyncWebServerResponse *response = request->beginChunkedResponse(
+        "text/plain",
+        [state](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+            (void) index;
+            MemScope memScope(MEM_LOG_DUMP);
+            return fillLogLines(state, buffer, maxLen);  // Returning 0 ends the response
+        });
+
+    addLogCursorHeaders(response, endSeq);
+    return response;
+}
+
+// Per-response state for /api/logs_history: the spilled segments as they
+// were when the request arrived, then the entries not yet on flash
+struct LogHistoryState
+{
+    LogSpill::Snapshot spill;
+    uint32_t           segment;  // Position in spill.sizes
+    uint32_t           offset;   // Bytes sent from the current segment
+    LogChunkState      tail;
+};
+
+size_t fillSpilledBytes(LogHistoryState &state, uint8_t *buffer, size_t maxLen)
+{
+    while (state.segment < state.spill.count)
+    {
+        uint32_t size = state.spill.sizes[state.segment];
+        if (state.offset < size)
+        {
+            // Reopened per chunk so no file handle outlives a callback
+            char path[32];
+            LogSpill::segmentPath(state.spill.firstIndex + state.segment, path, sizeof(path));
+            File   file  = LittleFS.open(path, "r");
+            size_t count = 0;
+            if (file && file.seek(state.offset))
+            {
+                size_t want = size - state.offset;
+                count       = file.read(buffer, want < maxLen ? want : maxLen);
+            }
+            file.close();
+            if (count > 0)
+            {
+                state.offset += count;
+                return count;
+            }
+        }
+
+        // Done, rotated away or unreadable: continue with the next segment
+        state.segment++;
+        state.offset = 0;
+    }
+    return 0;
+}
 }  // namespace
 
 // External reference to firmware version from main.cpp
@@ -99,19 +239,41 @@ String getBuildVersion() {
     return version.length() > 0 ? version : "0.0.0";
 }
 
-// CRC32 for SSE payload deduplication (replaces full String comparison)
-uint32_t WebServer::crc32(const char *data, size_t length) {
-    uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < length; i++) {
-        crc ^= (uint8_t)data[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+// Copy fields of current that differ from previous into out (recursing into
+// nested objects). Returns true if anything was copied.
+static bool appendChangedFields(JsonObjectConst current, JsonObjectConst previous, JsonObject out) {
+    bool changed = false;
+    for (JsonPairConst kv : current) {
+        const char *key = kv.key().c_str();
+        JsonVariantConst prev = previous[key];
+        if (kv.value().is<JsonObjectConst>()) {
+            JsonObject nested = out.createNestedObject(key);
+            if (appendChangedFields(kv.value().as<JsonObjectConst>(), prev.as<JsonObjectConst>(), nested)) {
+                changed = true;
+            } else {
+                out.remove(key);
+            }
+        } else if (prev.isNull() || kv.value() != prev) {
+            out[key] = kv.value();
+            changed = true;
         }
     }
-    return ~crc;
+    return changed;
 }
 
-WebServer::WebServer(int port) : server(port), statusEvents(kRouteStatusEvents) {}
+WebServer::WebServer(int port) : server(port), statusEvents(kRouteStatusEvents)
+{
+    LOCK_PROFILE_NAME(&pendingMutex, "WebServer::pendingMutex");
+    markStatusJsonDirty();  // Build the initial caches
+}
+
+void WebServer::markStatusJsonDirty()
+{
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        statusJsonDirty[session] = true;
+    }
+}
 
 void WebServer::begin()
 {
@@ -122,19 +284,7 @@ void WebServer::begin()
     // Thread-safe: double-buffered copy, short lock, no heap allocation
     server.on(kRouteGetSettings, HTTP_GET,
               [this](AsyncWebServerRequest *request)
-              {
-                  char jsonBuf[kCacheBufSize];
-                  size_t len = cachedSettings.read(jsonBuf, sizeof(jsonBuf));
-
-                  if (len == 0)
-                  {
-                      request->send(503, "application/json", "{\"error\":\"initializing\"}");
-                  }
-                  else
-                  {
-                      request->send(200, "application/json", jsonBuf);
-                  }
-              });
+              { sendCached(request, cachedSettings.acquire(), "application/json"); });
 
     // --- POST /update_settings ---
     // Thread-safe: copies JSON into pendingSettingsDoc and sets flag;
@@ -161,6 +311,7 @@ void WebServer::begin()
                 pendingSettingsUpdate = true;
             }
             portEXIT_CRITICAL(&pendingMutex);
+            mainLoopWake.notify();
 
             if (alreadyPending)
             {
@@ -177,7 +328,8 @@ void WebServer::begin()
     server.on(kRouteTestPause, HTTP_POST,
               [this](AsyncWebServerRequest *request)
               {
-                  pendingPause = true;
+                  pendingPause[0] = true;
+                  mainLoopWake.notify();
                   request->send(200, "text/plain", "ok");
               });
 
@@ -186,7 +338,8 @@ void WebServer::begin()
     server.on(kRouteTestResume, HTTP_POST,
               [this](AsyncWebServerRequest *request)
               {
-                  pendingResume = true;
+                  pendingResume[0] = true;
+                  mainLoopWake.notify();
                   request->send(200, "text/plain", "ok");
               });
 
@@ -201,39 +354,50 @@ void WebServer::begin()
                       return;
                   }
                   pendingDiscovery = true;
+                  mainLoopWake.notify();
                   request->send(200, "application/json", "{\"started\":true}");
               });
 
     // GET /discover_printer - Poll discovery status and results
-    // Thread-safe: double-buffered copy, short lock, no heap allocation
+    // Thread-safe: streamed from the shared cached body, no copy
     server.on(kRouteDiscoverPrinter, HTTP_GET,
               [this](AsyncWebServerRequest *request)
               {
-                  char jsonBuf[kCacheBufSize];
-                  size_t len = cachedDiscovery.read(jsonBuf, sizeof(jsonBuf));
-
-                  if (len == 0)
+                  SharedPayloadRef body = cachedDiscovery.acquire();
+                  if (!body)
                   {
                       request->send(200, "application/json", "{\"active\":false,\"printers\":[]}");
+                      return;
                   }
-                  else
-                  {
-                      request->send(200, "application/json", jsonBuf);
-                  }
+                  sendCached(request, body, "application/json");
               });
 
-    // Setup ElegantOTA
+    // GET /device_info - MAC, addresses and printer IDs; changes rarely, so
+    // dashboards fetch it once instead of with every status poll
+    server.on(kRouteDeviceInfo, HTTP_GET,
+              [this](AsyncWebServerRequest *request)
+              { sendCached(request, cachedDeviceInfo.acquire(), "application/json"); });
+
+    // Setup ElegantOTA; the upload is accounted as one memory phase
     ElegantOTA.begin(&server);
+    ElegantOTA.onStart([]() { otaMemMark = memoryMonitor.beginPhase(); });
+    ElegantOTA.onEnd([](bool success)
+                     {
+                         (void) success;
+                         memoryMonitor.endPhase(MEM_OTA, otaMemMark);
+                     });
 
     // Reset device endpoint
+    // Thread-safe: loop() writes any debounced settings, then restarts
     server.on(kRouteReset, HTTP_POST,
-              [](AsyncWebServerRequest *request)
+              [this](AsyncWebServerRequest *request)
               {
                   logger.log("Device reset requested via web UI");
                   request->send(200, "text/plain", "Restarting...");
-                  // Delay slightly to allow response to be sent
-                  delay(1000);
-                  ESP.restart();
+                  // Leave time for the response to be sent
+                  unsigned long restartAt = millis() + 1000;
+                  pendingRestartAtMs      = restartAt != 0 ? restartAt : 1;
+                  mainLoopWake.notify();
               });
 
     // SSE client connect handler.
@@ -241,29 +405,67 @@ void WebServer::begin()
     // _client_queue_lock when it calls this callback, so calling count() (which also
     // acquires that mutex) causes a recursive-lock deadlock → Task WDT crash.
     // Excess client cleanup is handled by cleanupSSEClients() in the main loop.
-    statusEvents.onConnect([](AsyncEventSourceClient *client) {
+    statusEvents.onConnect([this](AsyncEventSourceClient *client) {
         client->send("connected", "init", millis(), 1000);
+        sseKeyframePending = true;  // Next broadcast (immediate) is a full snapshot
     });
     server.addHandler(&statusEvents);
 
     // --- GET /sensor_status ---
-    // Thread-safe: double-buffered copy, short lock, no heap allocation
+    // Thread-safe: streamed from the shared cached body, no per-request copy
     server.on(kRouteSensorStatus, HTTP_GET,
-              [this](AsyncWebServerRequest *request)
-              {
-                  char jsonBuf[kCacheBufSize];
-                  size_t len = cachedSensorStatus.read(jsonBuf, sizeof(jsonBuf));
+              [this](AsyncWebServerRequest *request) { sendSensorStatus(request, 0); });
 
-                  if (len == 0)
+    // --- /printer/<n>/sensor_status, /printer/<n>/test_pause, /printer/<n>/test_resume,
+    //     /printer/<n>/api/flow_history.bin ---
+    // The routes above for each printer session (the unprefixed ones are session 0).
+    // Settings, logs and discovery are board-wide and stay unprefixed.
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        char route[48];
+        snprintf(route, sizeof(route), "%s%u%s", kRoutePrinterPrefix, session, kRouteSensorStatus);
+        server.on(route, HTTP_GET,
+                  [this, session](AsyncWebServerRequest *request)
+                  { sendSensorStatus(request, session); });
+
+        snprintf(route, sizeof(route), "%s%u%s", kRoutePrinterPrefix, session, kRouteTestPause);
+        server.on(route, HTTP_POST,
+                  [this, session](AsyncWebServerRequest *request)
                   {
-                      request->send(503, "application/json", "{\"error\":\"initializing\"}");
-                  }
-                  else
+                      pendingPause[session] = true;
+                      mainLoopWake.notify();
+                      request->send(200, "text/plain", "ok");
+                  });
+
+        snprintf(route, sizeof(route), "%s%u%s", kRoutePrinterPrefix, session, kRouteTestResume);
+        server.on(route, HTTP_POST,
+                  [this, session](AsyncWebServerRequest *request)
                   {
-                      request->send(200, "application/json", jsonBuf);
-                  }
+                      pendingResume[session] = true;
+                      mainLoopWake.notify();
+                      request->send(200, "text/plain", "ok");
+                  });
+
+        snprintf(route, sizeof(route), "%s%u%s", kRoutePrinterPrefix, session, kRouteFlowHistoryBin);
+        server.on(route, HTTP_GET,
+                  [this, session](AsyncWebServerRequest *request)
+                  { sendFlowHistory(request, session); });
+    }
+
+    // --- GET /api/sensor_status.bin ---
+    // Same data as /sensor_status as a fixed 72-byte packet (see SensorStatusPacket.h)
+    server.on(kRouteSensorStatusBin, HTTP_GET,
+              [this](AsyncWebServerRequest *request)
+              {
+                  sendCached(request, cachedSensorStatusPacket.acquire(),
+                             "application/octet-stream");
               });
 
+    // --- GET /api/flow_history.bin ---
+    // Per-second and whole-print flow of the current print (see FlowHistory.h)
+    server.on(kRouteFlowHistoryBin, HTTP_GET,
+              [this](AsyncWebServerRequest *request) { sendFlowHistory(request, 0); });
+
     // Logs endpoint (DISABLED - JSON serialization of 1024 entries exceeds 32KB buffer)
     // Use /api/logs_live or /api/logs_text instead
 
@@ -271,12 +473,10 @@ void WebServer::begin()
     server.on(kRouteLogsText, HTTP_GET,
               [](AsyncWebServerRequest *request)
               {
-                  AsyncResponseStream *streamResponse = request->beginResponseStream("text/plain");
-                  streamResponse->addHeader("Content-Disposition", "attachment; filename=\"logs.txt\"");
-
-                  logger.streamLogs(streamResponse);
-
-                  request->send(streamResponse);
+                  AsyncWebServerResponse *response =
+                      beginLogResponse(request, 0, logger.getLatestSequence());
+                  response->addHeader("Content-Disposition", "attachment; filename=\"logs.txt\"");
+                  request->send(response);
               });
 
     // Coredump download endpoint (raw partition bytes)
@@ -368,23 +568,307 @@ void WebServer::begin()
                   request->send(200, "text/plain", "ok");
               });
 
-    // Live logs endpoint (last 100 entries for UI display)
+    // Live logs endpoint (last 100 entries, or only newer ones with ?since=)
     server.on(kRouteLogsLive, HTTP_GET,
               [](AsyncWebServerRequest *request)
               {
-                  String textResponse = logger.getLogsAsText(100);  // Only last 100 entries
-                  request->send(200, "text/plain", textResponse);
+                  // Last 100 entries, or everything after ?since=<counter|uuid>
+                  uint32_t endSeq = logger.getLatestSequence();
+                  uint32_t cursor =
+                      (endSeq > kLogsLiveMaxEntries) ? endSeq - kLogsLiveMaxEntries : 0;
+                  if (request->hasParam("since"))
+                  {
+                      uint32_t since =
+                          Logger::parseCursor(request->getParam("since")->value().c_str());
+                      // A cursor ahead of ours means the device restarted: resend the tail
+                      if (since <= endSeq)
+                      {
+                          cursor = since;
+                      }
+                  }
+                  request->send(beginLogResponse(request, cursor, endSeq));
               });
 
-    // Clear logs endpoint
+    // Persistent log history: LittleFS segments from this and earlier boots,
+    // followed by the entries not yet written to flash
+    server.on(kRouteLogsHistory, HTTP_GET,
+              [](AsyncWebServerRequest *request)
+              {
+                  MemScope        memScope(MEM_LOG_DUMP);
+                  LogHistoryState state;
+                  logSpill.snapshot(state.spill);
+                  state.segment         = 0;
+                  state.offset          = 0;
+                  state.tail.cursor     = state.spill.writtenSeq;
+                  state.tail.endSeq     = logger.getLatestSequence();
+                  state.tail.lineLen    = 0;
+                  state.tail.lineOffset = 0;
+                  uint32_t endSeq       = state.tail.endSeq;
+
+                  AsyncWebServerResponse *response = request->beginChunkedResponse(
+                      "text/plain",
+                      [state](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t {
+                          (void) index;
+                          MemScope memScope(MEM_LOG_DUMP);
+                          size_t   written = fillSpilledBytes(state, buffer, maxLen);
+                          if (written == 0)
+                          {
+                              written = fillLogLines(state.tail, buffer, maxLen);
+                          }
+                          return written;
+                      });
+                  addLogCursorHeaders(response, endSeq);
+                  response->addHeader("Content-Disposition",
+                                      "attachment; filename=\"logs_history.txt\"");
+                  request->send(response);
+              });
+
+    // Clear logs endpoint (RAM ring and the LittleFS history)
     server.on(kRouteLogsClear, HTTP_POST,
               [](AsyncWebServerRequest *request)
               {
                   logger.clearLogs();
+                  logSpill.clear();
                   logger.log("Logs cleared via web UI");
                   request->send(200, "text/plain", "ok");
               });
 
+    // Heap, per-phase low-water marks and per-task stacks (see MemoryMonitor.h).
+    // Registered ahead of /api/perf, whose handler also matches /api/perf/...
+    server.on(kRoutePerfMemory, HTTP_GET,
+              [](AsyncWebServerRequest *request)
+              {
+                  mem_heap_stats_t heap;
+                  memoryMonitor.heapSnapshot(heap);
+                  AsyncResponseStream *response = request->beginResponseStream("application/json");
+                  response->addHeader("Cache-Control", "no-store");
+                  response->printf(
+                      "{\"uptimeMs\":%lu,\"windowMs\":%lu,\"allocCounting\":%s,"
+                      "\"heap\":{\"free\":%lu,\"minFree\":%lu,\"maxAlloc\":%lu,"
+                      "\"minMaxAlloc\":%lu,\"fragmentationPct\":%.1f,"
+                      "\"maxFragmentationPct\":%.1f},\"topRetainer\":\"%s\",\"phases\":{",
+                      (unsigned long) millis(), (unsigned long) memoryMonitor.sinceResetMs(),
+                      MEMORY_COUNT_ALLOCATIONS ? "true" : "false", (unsigned long) heap.freeHeap,
+                      (unsigned long) heap.minFreeHeap, (unsigned long) heap.maxAllocHeap,
+                      (unsigned long) heap.minMaxAllocHeap, heap.fragmentationPct,
+                      heap.maxFragmentationPct,
+                      MemoryMonitor::phaseName(memoryMonitor.topRetainer()));
+                  for (uint8_t i = 0; i < MEM_PHASE_COUNT; i++)
+                  {
+                      MemPhase          phase = static_cast<MemPhase>(i);
+                      mem_phase_stats_t stats;
+                      memoryMonitor.phaseSnapshot(phase, stats);
+                      response->printf(
+                          "%s\"%s\":{\"count\":%lu,\"lowWaterFree\":%lu,\"lowWaterExact\":%lu,"
+                          "\"maxRetained\":%lu,\"netRetained\":%ld,\"allocs\":%lu,"
+                          "\"frees\":%lu,\"allocBytes\":%lu}",
+                          i ? "," : "", MemoryMonitor::phaseName(phase),
+                          (unsigned long) stats.count, (unsigned long) stats.lowWaterFree,
+                          (unsigned long) stats.lowWaterExact, (unsigned long) stats.maxRetained,
+                          (long) stats.netRetained, (unsigned long) stats.allocs,
+                          (unsigned long) stats.frees, (unsigned long) stats.allocBytes);
+                  }
+                  response->print("},\"tasks\":[");
+                  mem_task_stats_t task;
+                  for (uint8_t i = 0; memoryMonitor.taskSnapshot(i, task); i++)
+                  {
+                      response->printf(
+                          "%s{\"name\":\"%s\",\"stackFreeMin\":%lu,\"allocs\":%lu,"
+                          "\"frees\":%lu,\"allocBytes\":%lu}",
+                          i ? "," : "", task.name, (unsigned long) task.stackFreeMin,
+                          (unsigned long) task.allocs, (unsigned long) task.frees,
+                          (unsigned long) task.allocBytes);
+                  }
+                  response->print("]}");
+                  request->send(response);
+              });
+
+    server.on(kRoutePerfMemoryReset, HTTP_POST,
+              [](AsyncWebServerRequest *request)
+              {
+                  memoryMonitor.reset();
+                  request->send(200, "text/plain", "ok");
+              });
+
+    // Critical-section hold/wait times per lock (see LockProfiler.h). Empty
+    // unless built with LOCK_PROFILING; cycles are converted to nanoseconds.
+    server.on(kRoutePerfLocks, HTTP_GET,
+              [](AsyncWebServerRequest *request)
+              {
+                  uint32_t             cyclesPerUs = getCpuFrequencyMhz();
+                  AsyncResponseStream *response =
+                      request->beginResponseStream("application/json");
+                  response->addHeader("Cache-Control", "no-store");
+                  response->printf("{\"enabled\":%s,\"windowMs\":%lu,\"cpuMhz\":%lu,"
+                                   "\"overflowed\":%lu,\"locks\":[",
+                                   LOCK_PROFILING ? "true" : "false",
+                                   (unsigned long) lockProfiler.sinceResetMs(),
+                                   (unsigned long) cyclesPerUs,
+                                   (unsigned long) lockProfiler.overflowed());
+                  lock_stats_t stats;
+                  for (uint8_t i = 0; lockProfiler.snapshot(i, stats); i++)
+                  {
+                      char fallbackName[16];
+                      snprintf(fallbackName, sizeof(fallbackName), "%p", stats.lock);
+                      uint64_t acquisitions = stats.acquisitions ? stats.acquisitions : 1;
+                      response->printf(
+                          "%s{\"name\":\"%s\",\"acquisitions\":%lu,\"contended\":%lu,"
+                          "\"holdAvgNs\":%lu,\"holdP99Ns\":%lu,\"holdMaxNs\":%lu,"
+                          "\"holdTotalUs\":%llu,\"waitAvgNs\":%lu,\"waitMaxNs\":%lu}",
+                          i ? "," : "", stats.name ? stats.name : fallbackName,
+                          (unsigned long) stats.acquisitions, (unsigned long) stats.contended,
+                          (unsigned long) (stats.holdTicks * 1000 / cyclesPerUs / acquisitions),
+                          (unsigned long) ((uint64_t) LockProfiler::holdPercentileTicks(stats, 99.0f) *
+                                           1000 / cyclesPerUs),
+                          (unsigned long) ((uint64_t) stats.maxHoldTicks * 1000 / cyclesPerUs),
+                          (unsigned long long) (stats.holdTicks / cyclesPerUs),
+                          (unsigned long) (stats.waitTicks * 1000 / cyclesPerUs / acquisitions),
+                          (unsigned long) ((uint64_t) stats.maxWaitTicks * 1000 / cyclesPerUs));
+                  }
+                  response->print("]}");
+                  request->send(response);
+              });
+
+    server.on(kRoutePerfLocksReset, HTTP_POST,
+              [](AsyncWebServerRequest *request)
+              {
+                  lockProfiler.reset();
+                  request->send(200, "text/plain", "ok");
+              });
+
+    // Per-phase latency histograms (see PerfMonitor.h). Streamed with printf
+    // so the response needs no JSON document on the async task's stack.
+    server.on(kRoutePerf, HTTP_GET,
+              [](AsyncWebServerRequest *request)
+              {
+                  AsyncResponseStream *response = request->beginResponseStream("application/json");
+                  response->addHeader("Cache-Control", "no-store");
+                  response->printf("{\"uptimeMs\":%lu,\"windowMs\":%lu,\"bucketUnit\":\"us\","
+                                   "\"bucketCount\":%u,\"phases\":{",
+                                   (unsigned long) millis(),
+                                   (unsigned long) perfMonitor.sinceResetMs(),
+                                   (unsigned) PERF_BUCKET_COUNT);
+                  for (uint8_t i = 0; i < PERF_PHASE_COUNT; i++)
+                  {
+                      PerfPhase          phase = static_cast<PerfPhase>(i);
+                      perf_phase_stats_t stats;
+                      perfMonitor.snapshot(phase, stats);
+                      unsigned long avgUs =
+                          stats.count ? (unsigned long) (stats.totalUs / stats.count) : 0;
+                      response->printf(
+                          "%s\"%s\":{\"count\":%lu,\"minUs\":%lu,\"maxUs\":%lu,\"avgUs\":%lu,"
+                          "\"p50Us\":%lu,\"p99Us\":%lu,\"buckets\":[",
+                          i ? "," : "", PerfMonitor::phaseName(phase), (unsigned long) stats.count,
+                          (unsigned long) stats.minUs, (unsigned long) stats.maxUs, avgUs,
+                          (unsigned long) PerfMonitor::percentileUs(stats, 50.0f),
+                          (unsigned long) PerfMonitor::percentileUs(stats, 99.0f));
+                      for (uint8_t b = 0; b < PERF_BUCKET_COUNT; b++)
+                      {
+                          response->printf(b ? ",%lu" : "%lu", (unsigned long) stats.buckets[b]);
+                      }
+                      response->print("]}");
+                  }
+                  response->print("}}");
+                  request->send(response);
+              });
+
+    server.on(kRoutePerfReset, HTTP_POST,
+              [](AsyncWebServerRequest *request)
+              {
+                  perfMonitor.reset();
+                  request->send(200, "text/plain", "ok");
+              });
+
+    // Precomputed flow profile for the next print (see FlowProfile.h).
+    // POST takes the raw file as the request body (application/octet-stream).
+    server.on(kRouteFlowProfile, HTTP_GET,
+              [](AsyncWebServerRequest *request)
+              {
+                  flow_profile_info_t info;
+                  flowProfile.getInfo(info);
+                  StaticJsonDocument<256> jsonDoc;
+                  jsonDoc["loaded"]        = info.loaded;
+                  jsonDoc["entries"]       = info.entryCount;
+                  jsonDoc["msPerTick"]     = info.msPerTick;
+                  jsonDoc["ticksPerEntry"] = info.ticksPerEntry;
+                  jsonDoc["filename"]      = info.filename;
+                  char jsonBuf[256];
+                  serializeJson(jsonDoc, jsonBuf, sizeof(jsonBuf));
+                  request->send(200, "application/json", jsonBuf);
+              });
+
+    server.on(
+        kRouteFlowProfile, HTTP_POST,
+        [this](AsyncWebServerRequest *request)
+        {
+            bool failed             = flowProfileUploadFailed;
+            flowProfileUploadFailed = false;
+            if (flowProfileUpload)
+            {
+                flowProfileUpload.close();  // Body ended early
+                failed = true;
+            }
+            if (pendingFlowProfileInstall)
+            {
+                request->send(429, "application/json",
+                              "{\"error\":\"Flow profile install already pending\"}");
+                return;
+            }
+
+            flow_profile_header_t header;
+            if (failed || !FlowProfile::validateFile(FLOW_PROFILE_UPLOAD_PATH, &header))
+            {
+                LittleFS.remove(FLOW_PROFILE_UPLOAD_PATH);
+                request->send(400, "application/json", "{\"error\":\"Invalid flow profile\"}");
+                return;
+            }
+
+            pendingFlowProfileInstall = true;
+            mainLoopWake.notify();
+            char jsonBuf[64];
+            snprintf(jsonBuf, sizeof(jsonBuf), "{\"status\":\"ok\",\"entries\":%lu}",
+                     (unsigned long) header.entryCount);
+            request->send(200, "application/json", jsonBuf);
+        },
+        nullptr,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index,
+               size_t total)
+        {
+            (void) request;
+            if (index == 0)
+            {
+                flowProfileUploadFailed =
+                    pendingFlowProfileInstall ||
+                    total > sizeof(flow_profile_header_t) +
+                                FLOW_PROFILE_MAX_ENTRIES * sizeof(uint32_t);
+                if (!flowProfileUploadFailed)
+                {
+                    flowProfileUpload = LittleFS.open(FLOW_PROFILE_UPLOAD_PATH, "w");
+                    flowProfileUploadFailed = !flowProfileUpload;
+                }
+            }
+            if (flowProfileUploadFailed || !flowProfileUpload)
+            {
+                return;
+            }
+            if (flowProfileUpload.write(data, len) != len)
+            {
+                flowProfileUploadFailed = true;  // Filesystem full
+            }
+            if (flowProfileUploadFailed || index + len >= total)
+            {
+                flowProfileUpload.close();
+            }
+        });
+
+    server.on(kRouteFlowProfile, HTTP_DELETE,
+              [this](AsyncWebServerRequest *request)
+              {
+                  pendingFlowProfileClear = true;
+                  mainLoopWake.notify();
+                  request->send(200, "text/plain", "ok");
+              });
+
     // Trigger a controlled panic for testing coredumps
 #ifdef ENABLE_CRASH_TESTING
     server.on(kRoutePanic, HTTP_POST,
@@ -419,13 +903,46 @@ void WebServer::begin()
         serializeJson(jsonDoc, cachedVersionJson, sizeof(cachedVersionJson));
     }
 
-    // Version endpoint - serves pre-built JSON (no LittleFS access, thread-safe)
+    // Version endpoint - pre-built JSON (no LittleFS access, thread-safe) plus
+    // live boot stage timings (ms since boot, null until reached)
     server.on(kRouteVersion, HTTP_GET,
               [this](AsyncWebServerRequest *request)
               {
-                  request->send(200, "application/json", cachedVersionJson);
+                  char   stages[192];
+                  char   json[sizeof(cachedVersionJson) + sizeof(stages) + 24];
+                  size_t versionLength = strlen(cachedVersionJson);
+                  if (versionLength < 2 || bootStages.toJson(stages, sizeof(stages)) == 0)
+                  {
+                      request->send(200, "application/json", cachedVersionJson);
+                      return;
+                  }
+                  // Splice before the closing brace of the cached object
+                  snprintf(json, sizeof(json), "%.*s,\"boot_stages\":%s}",
+                           (int) (versionLength - 1), cachedVersionJson, stages);
+                  request->send(200, "application/json", json);
               });
 
+    // Web UI from the build manifest: files go out as stored (gzipped) with an
+    // ETag. Hashed asset names are cached for good; the page and favicon keep
+    // their URLs and are revalidated, which costs a 304 when unchanged.
+    // Registered ahead of the static handlers below, which remain for
+    // filesystems built without a manifest.
+    if (loadUiManifest())
+    {
+        for (size_t i = 0; i < uiAssetCount; i++)
+        {
+            const UiAsset *asset = &uiAssets[i];
+            server.on(asset->url, HTTP_GET,
+                      [this, asset](AsyncWebServerRequest *request) { sendUiAsset(request, *asset); });
+        }
+        // After the assets: this also matches every /lite/... URL
+        if (uiIndexAsset != nullptr)
+        {
+            server.on(kRouteLiteRoot, HTTP_GET,
+                      [this](AsyncWebServerRequest *request) { sendUiAsset(request, *uiIndexAsset); });
+        }
+    }
+
     // Serve lightweight UI from /lite (if available)
     // Keep explicit /lite path for backwards compatibility
     server.serveStatic(kRouteLiteRoot, SPIFFS, "/lite/").setDefaultFile("index.htm");
@@ -438,12 +955,19 @@ void WebServer::begin()
 
     // SPA-style routing: for any unknown GET that isn't an API or asset,
     // serve index.htm so that the frontend router can handle the path.
-    server.onNotFound([](AsyncWebServerRequest *request) {
+    server.onNotFound([this](AsyncWebServerRequest *request) {
         if (request->method() == HTTP_GET &&
             !request->url().startsWith("/api/") &&
             !request->url().startsWith("/assets/"))
         {
-            request->send(SPIFFS, kLiteIndexPath, "text/html");
+            if (uiIndexAsset != nullptr)
+            {
+                sendUiAsset(request, *uiIndexAsset);
+            }
+            else
+            {
+                request->send(SPIFFS, kLiteIndexPath, "text/html");
+            }
         }
         else
         {
@@ -452,20 +976,140 @@ void WebServer::begin()
     });
 }
 
-void WebServer::processPendingCommands()
+bool WebServer::loadUiManifest()
 {
-    // Process pending pause command
-    if (pendingPause)
+    File file = LittleFS.open(kLiteManifestPath, "r");
+    if (!file)
     {
-        pendingPause = false;
-        elegooCC.pausePrint();
+        logger.log("Web UI manifest not found, serving assets without caching");
+        return false;
     }
+    StaticJsonDocument<1536> doc;
+    DeserializationError     error = deserializeJson(doc, file);
+    file.close();
+    if (error)
+    {
+        logger.logf("Web UI manifest unreadable: %s", error.c_str());
+        return false;
+    }
+
+    uiAssetCount = 0;
+    uiIndexAsset = nullptr;
+    for (JsonObject entry : doc["assets"].as<JsonArray>())
+    {
+        const char *url  = entry["url"] | "";
+        const char *path = entry["file"] | "";
+        const char *etag = entry["etag"] | "";
+        const char *type = entry["type"] | "";
+        if (uiAssetCount >= kMaxUiAssets)
+        {
+            break;
+        }
+        UiAsset &asset = uiAssets[uiAssetCount];
+        // Skip entries that do not fit or whose file is missing
+        if (url[0] != '/' || strlen(url) >= sizeof(asset.url) ||
+            strlen(path) >= sizeof(asset.path) || strlen(etag) + 2 >= sizeof(asset.etag) ||
+            strlen(type) >= sizeof(asset.contentType) || !LittleFS.exists(path))
+        {
+            logger.logf("Web UI manifest entry %s skipped", url);
+            continue;
+        }
+        strlcpy(asset.url, url, sizeof(asset.url));
+        strlcpy(asset.path, path, sizeof(asset.path));
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", etag);
+        strlcpy(asset.contentType, type, sizeof(asset.contentType));
+        asset.gzip      = entry["gzip"] | false;
+        asset.immutable = entry["immutable"] | false;
+        if (strcmp(asset.url, kRouteRoot) == 0)
+        {
+            uiIndexAsset = &asset;
+        }
+        uiAssetCount++;
+    }
+    logger.logf("Web UI manifest: %u assets", (unsigned) uiAssetCount);
+    return uiAssetCount > 0;
+}
 
-    // Process pending resume command
-    if (pendingResume)
+void WebServer::sendUiAsset(AsyncWebServerRequest *request, const UiAsset &asset)
+{
+    const char *cacheControl = asset.immutable ? "public, max-age=31536000, immutable" : "no-cache";
+
+    // If-None-Match may list several tags; ours are quoted hashes, so a
+    // substring match cannot hit a different one
+    if (request->hasHeader("If-None-Match") &&
+        strstr(request->header("If-None-Match").c_str(), asset.etag) != nullptr)
     {
-        pendingResume = false;
-        elegooCC.continuePrint();
+        AsyncWebServerResponse *response = request->beginResponse(304);
+        response->addHeader("ETag", asset.etag);
+        response->addHeader("Cache-Control", cacheControl);
+        request->send(response);
+        return;
+    }
+
+    AsyncWebServerResponse *response = request->beginResponse(SPIFFS, asset.path, asset.contentType);
+    if (asset.gzip)
+    {
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", cacheControl);
+    request->send(response);
+}
+
+void WebServer::sendSensorStatus(AsyncWebServerRequest *request, uint8_t session)
+{
+    sendCached(request, cachedSensorStatus[session].acquire(), "application/json");
+}
+
+void WebServer::sendFlowHistory(AsyncWebServerRequest *request, uint8_t session)
+{
+    // Unlike the status it is built per request: a full history is a few KB
+    // and only the charts ask for it
+    AsyncResponseStream *response = request->beginResponseStream("application/octet-stream", 4096);
+    response->addHeader("Cache-Control", "no-store");
+    ElegooCC::getSession(session).writeFlowHistory(*response);
+    request->send(response);
+}
+
+void WebServer::sendCached(AsyncWebServerRequest *request, const SharedPayloadRef &body,
+                           const char *contentType)
+{
+    if (!body)
+    {
+        request->send(503, "application/json", "{\"error\":\"initializing\"}");
+        return;
+    }
+    // The filler holds the reference until the response is freed, so the
+    // slot outlives any number of partial sends on a slow connection
+    AsyncWebServerResponse *response = request->beginResponse(
+        contentType, body.size(),
+        [body](uint8_t *buffer, size_t maxLen, size_t index) -> size_t
+        {
+            size_t remaining = body.size() - index;
+            size_t count     = remaining < maxLen ? remaining : maxLen;
+            memcpy(buffer, body.data() + index, count);
+            return count;
+        });
+    request->send(response);
+}
+
+void WebServer::processPendingCommands()
+{
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        // Process pending pause command
+        if (pendingPause[session])
+        {
+            pendingPause[session] = false;
+            ElegooCC::getSession(session).pausePrint();
+        }
+
+        // Process pending resume command
+        if (pendingResume[session])
+        {
+            pendingResume[session] = false;
+            ElegooCC::getSession(session).continuePrint();
+        }
     }
 
     // Process pending discovery
@@ -478,11 +1122,44 @@ void WebServer::processPendingCommands()
         }
     }
 
-    // Process pending reconnect (triggered by IP change in settings update)
-    if (pendingReconnect)
+    // Process pending flow profile changes
+    if (pendingFlowProfileInstall)
+    {
+        if (flowProfile.install(FLOW_PROFILE_UPLOAD_PATH))
+        {
+            flow_profile_info_t info;
+            flowProfile.getInfo(info);
+            logger.logf("Flow profile installed: %lu entries, %lums/tick, print '%s'",
+                        (unsigned long) info.entryCount, (unsigned long) info.msPerTick,
+                        info.filename);
+        }
+        else
+        {
+            logger.log("Flow profile upload rejected");
+        }
+        pendingFlowProfileInstall = false;
+    }
+    if (pendingFlowProfileClear)
+    {
+        pendingFlowProfileClear = false;
+        flowProfile.clear();
+        logger.log("Flow profile cleared via web UI");
+    }
+
+    if (pendingRestartAtMs != 0 && (long) (millis() - pendingRestartAtMs) >= 0)
     {
-        pendingReconnect = false;
-        elegooCC.reconnect();
+        settingsManager.flush();
+        ESP.restart();
+    }
+
+    // Process pending reconnects (triggered by IP changes in settings update)
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        if (pendingReconnect[session])
+        {
+            pendingReconnect[session] = false;
+            ElegooCC::getSession(session).reconnect();
+        }
     }
 
     // Process pending settings update
@@ -490,24 +1167,33 @@ void WebServer::processPendingCommands()
     {
         portENTER_CRITICAL(&pendingMutex);
         // Copy the doc locally so we can release the mutex quickly
-        StaticJsonDocument<1024> localDoc;
+        StaticJsonDocument<1792> localDoc;
         localDoc.set(pendingSettingsDoc);
         pendingSettingsUpdate = false;
         portEXIT_CRITICAL(&pendingMutex);
 
         JsonObject jsonObj = localDoc.as<JsonObject>();
 
-        // Track if IP address changed to trigger reconnect
-        String oldIp = settingsManager.getElegooIP();
-        bool ipChanged = false;
+        // Track which printer IPs changed to trigger reconnects
+        String oldIps[PRINTER_SESSIONS];
+        for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+        {
+            oldIps[session] = settingsManager.getPrinterIP(session);
+        }
 
         // Only update fields that are present in the request
         if (jsonObj.containsKey("elegooip"))
-        {
-            String newIp = jsonObj["elegooip"].as<String>();
-            ipChanged = (oldIp != newIp) && newIp.length() > 0;
-            settingsManager.setElegooIP(newIp);
-        }
+            settingsManager.setElegooIP(jsonObj["elegooip"].as<String>());
+        if (jsonObj.containsKey("extra_printer_ips"))
+            settingsManager.setExtraPrinterIPs(jsonObj["extra_printer_ips"].as<String>());
+        if (jsonObj.containsKey("static_ip"))
+            settingsManager.setStaticIP(jsonObj["static_ip"].as<String>());
+        if (jsonObj.containsKey("static_gateway"))
+            settingsManager.setStaticGateway(jsonObj["static_gateway"].as<String>());
+        if (jsonObj.containsKey("static_subnet"))
+            settingsManager.setStaticSubnet(jsonObj["static_subnet"].as<String>());
+        if (jsonObj.containsKey("static_dns"))
+            settingsManager.setStaticDns(jsonObj["static_dns"].as<String>());
         if (jsonObj.containsKey("ssid"))
             settingsManager.setSSID(jsonObj["ssid"].as<String>());
         if (jsonObj.containsKey("passwd") && jsonObj["passwd"].as<String>().length() > 0)
@@ -540,8 +1226,16 @@ void WebServer::processPendingCommands()
             settingsManager.setDetectionHardJamTimeMs(jsonObj["detection_hard_jam_time_ms"].as<int>());
         if (jsonObj.containsKey("detection_mode"))
             settingsManager.setDetectionMode(jsonObj["detection_mode"].as<int>());
+        if (jsonObj.containsKey("motion_window_profile"))
+            settingsManager.setMotionWindowProfile(jsonObj["motion_window_profile"].as<int>());
+        if (jsonObj.containsKey("predictive_expected"))
+            settingsManager.setPredictiveExpected(jsonObj["predictive_expected"].as<bool>());
+        if (jsonObj.containsKey("adaptive_soft_jam"))
+            settingsManager.setAdaptiveSoftJam(jsonObj["adaptive_soft_jam"].as<bool>());
         if (jsonObj.containsKey("sdcp_loss_behavior"))
             settingsManager.setSdcpLossBehavior(jsonObj["sdcp_loss_behavior"].as<int>());
+        if (jsonObj.containsKey("status_poll_mode"))
+            settingsManager.setStatusPollMode(jsonObj["status_poll_mode"].as<int>());
         if (jsonObj.containsKey("flow_telemetry_stale_ms"))
             settingsManager.setFlowTelemetryStaleMs(jsonObj["flow_telemetry_stale_ms"].as<int>());
         if (jsonObj.containsKey("ui_refresh_interval_ms"))
@@ -562,65 +1256,136 @@ void WebServer::processPendingCommands()
             settingsManager.setShowDebugPage(jsonObj["show_debug_page"].as<bool>());
         if (jsonObj.containsKey("timezone_offset_minutes"))
             settingsManager.setTimezoneOffsetMinutes(jsonObj["timezone_offset_minutes"].as<int>());
-
-        bool saved = settingsManager.save();
-        if (saved)
+        if (jsonObj.containsKey("mqtt_broker"))
+            settingsManager.setMqttBroker(jsonObj["mqtt_broker"].as<String>());
+        if (jsonObj.containsKey("mqtt_port"))
+            settingsManager.setMqttPort(jsonObj["mqtt_port"].as<int>());
+        if (jsonObj.containsKey("mqtt_user"))
+            settingsManager.setMqttUser(jsonObj["mqtt_user"].as<String>());
+        if (jsonObj.containsKey("mqtt_password") && jsonObj["mqtt_password"].as<String>().length() > 0)
+            settingsManager.setMqttPassword(jsonObj["mqtt_password"].as<String>());
+
+        // One snapshot for the whole update: readers never see half of it.
+        // The file write is debounced, so a burst of changes is one flash write.
+        settingsManager.commit();
+        mqttPublisherRefreshSettings();
+        settingsJsonDirty = true;  // Rebuild cached settings JSON
+        markStatusJsonDirty();     // Status JSON embeds a few settings
+        for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
         {
-            elegooCC.refreshCaches();
-            settingsJsonDirty = true;  // Rebuild cached settings JSON
-            if (ipChanged)
+            String newIp = settingsManager.getPrinterIP(session);
+            if (newIp != oldIps[session] && newIp.length() > 0)
             {
-                pendingReconnect = true;
+                pendingReconnect[session] = true;
             }
         }
-        else
-        {
-            logger.log("Failed to save settings from pending update");
-        }
     }
 }
 
-void WebServer::refreshCachedResponses()
+void WebServer::refreshCachedResponses(bool force)
 {
-    // Rebuild sensor status JSON (called every loop iteration from main task)
-    {
-        printer_info_t elegooStatus = elegooCC.getCurrentInformation();
-        StaticJsonDocument<768> jsonDoc;
-        buildStatusJson(jsonDoc, elegooStatus);
-
-        char jsonBuf[kCacheBufSize];
-        size_t len = serializeJson(jsonDoc, jsonBuf, sizeof(jsonBuf));
+    // Called every loop iteration from main task; each cache is only
+    // rebuilt when its inputs changed
+    PerfScope     perfScope(PERF_REFRESH_CACHE);
+    unsigned long now = millis();
 
-        cachedSensorStatus.publish(jsonBuf, len);
-        cachedPrintStatus = elegooStatus.printStatus;
+    // Rebuild sensor status JSON when a session published new state
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        refreshSessionStatus(session, now, force);
     }
 
-    // Rebuild discovery JSON (only while discovery is active or results exist)
+    // Rebuild discovery JSON when a scan starts or ends and when the printer
+    // cache changes (scan responses, passive sightings, expiry), so GET answers
+    // from the cache at once
+    bool     discoveryActive     = elegooCC.isDiscoveryActive();
+    uint32_t discoveryGeneration = ElegooCC::getDiscoveryGeneration();
+    if (discoveryActive != lastDiscoveryActive || discoveryGeneration != lastDiscoveryGeneration)
     {
+        discoveryJsonDirty = true;
+    }
+    if (force || discoveryJsonDirty)
+    {
+        discoveryJsonDirty      = false;
+        lastDiscoveryActive     = discoveryActive;
+        lastDiscoveryGeneration = discoveryGeneration;
+
         StaticJsonDocument<1024> jsonDoc;
-        jsonDoc["active"] = elegooCC.isDiscoveryActive();
+        jsonDoc["active"] = discoveryActive;
 
+        // Strings are linked, not copied: the cache is only written by this task
         JsonArray printers = jsonDoc.createNestedArray("printers");
-        for (const auto &res : elegooCC.getDiscoveryResults())
+        for (size_t i = 0; i < ElegooCC::getDiscoveryResultCount(); i++)
         {
-            JsonObject p = printers.createNestedObject();
-            p["ip"]      = res.ip;
-            p["payload"] = res.payload;
+            const ElegooCC::DiscoveryResult &res = ElegooCC::getDiscoveryResult(i);
+            JsonObject p     = printers.createNestedObject();
+            p["ip"]          = (const char *) res.ip;
+            p["mainboardID"] = (const char *) res.mainboardID;
+            p["payload"]     = (const char *) res.payload;
+            if (measureJson(jsonDoc) >= kCacheBufSize)
+            {
+                printers.remove(printers.size() - 1);  // Keep the JSON whole
+                break;
+            }
         }
 
         char jsonBuf[kCacheBufSize];
         size_t len = serializeJson(jsonDoc, jsonBuf, sizeof(jsonBuf));
 
-        cachedDiscovery.publish(jsonBuf, len);
+        // Readers still hold both slots: retry on the next pass
+        discoveryJsonDirty = !cachedDiscovery.publish(jsonBuf, len);
     }
 
-    // Rebuild settings JSON only when dirty
+    // Rebuild settings JSON only when dirty (or saved outside the web UI)
+    if (settingsManager.getRevision() != lastSettingsRevision)
+    {
+        settingsJsonDirty = true;
+    }
     if (settingsJsonDirty)
     {
-        settingsJsonDirty = false;
+        settingsJsonDirty    = false;
+        lastSettingsRevision = settingsManager.getRevision();
         String newSettingsJson = settingsManager.toJson(false);
 
-        cachedSettings.publish(newSettingsJson.c_str(), newSettingsJson.length());
+        settingsJsonDirty = !cachedSettings.publish(newSettingsJson.c_str(), newSettingsJson.length());
+    }
+
+    refreshDeviceInfo(now, force);
+}
+
+void WebServer::refreshSessionStatus(uint8_t session, unsigned long now, bool force)
+{
+    ElegooCC     &printer       = ElegooCC::getSession(session);
+    uint32_t      generation    = printer.getInformationGeneration();
+    unsigned long sinceRebuild  = now - lastStatusRebuildMs[session];
+    bool          statusChanged = statusJsonDirty[session] || generation != lastStatusGeneration[session];
+    if (!force && !(statusChanged && sinceRebuild >= kSensorStatusMinRebuildMs) &&
+        sinceRebuild < kSensorStatusMaxAgeMs)
+    {
+        return;
+    }
+    statusJsonDirty[session]      = false;
+    lastStatusGeneration[session] = generation;
+    lastStatusRebuildMs[session]  = now;
+
+    printer_info_t elegooStatus = printer.getCurrentInformation();
+    StatusJsonDocument jsonDoc;
+    buildStatusJson(jsonDoc, elegooStatus);
+
+    char jsonBuf[kCacheBufSize];
+    size_t len = serializeJson(jsonDoc, jsonBuf, sizeof(jsonBuf));
+
+    if (!cachedSensorStatus[session].publish(jsonBuf, len))
+    {
+        statusJsonDirty[session] = true;  // Readers hold every spare slot: retry
+    }
+
+    // The binary packet and SSE stream follow session 0
+    if (session == 0)
+    {
+        sensor_status_packet_t packet;
+        buildStatusPacket(packet, elegooStatus);
+        cachedSensorStatusPacket.publish(reinterpret_cast<const char *>(&packet), sizeof(packet));
     }
 }
 
@@ -640,6 +1405,13 @@ void WebServer::cleanupSSEClients()
                      clientCount, kMaxSSEClients);
         statusEvents.close();
     }
+    else if (clientCount > 1 && ESP.getFreeHeap() < kSseMinFreeHeap)
+    {
+        // Dashboards reconnect on their own; detection must not run out of heap
+        logger.logf("SSE cleanup: heap %u below %u with %d clients, closing connections",
+                     ESP.getFreeHeap(), kSseMinFreeHeap, clientCount);
+        statusEvents.close();
+    }
 }
 
 void WebServer::loop()
@@ -656,7 +1428,7 @@ void WebServer::loop()
     {
         for (int i = 0; i < kStressCacheRefreshes; i++)
         {
-            refreshCachedResponses();
+            refreshCachedResponses(true);
         }
     }
 
@@ -672,7 +1444,8 @@ void WebServer::loop()
                      statusEvents.count(), ESP.getFreeHeap(), ESP.getMinFreeHeap());
     }
 
-    if (statusEvents.count() > 0 && now - lastStatusBroadcastMs >= statusBroadcastIntervalMs)
+    if (statusEvents.count() > 0 &&
+        (sseKeyframePending || now - lastStatusBroadcastMs >= statusBroadcastIntervalMs))
     {
         lastStatusBroadcastMs = now;
         unsigned long t0 = millis();
@@ -685,13 +1458,16 @@ void WebServer::loop()
     }
 }
 
-void WebServer::buildStatusJson(StaticJsonDocument<768> &jsonDoc, const printer_info_t &elegooStatus)
+void WebServer::buildStatusJson(StatusJsonDocument &jsonDoc, const printer_info_t &elegooStatus)
 {
     jsonDoc["stopped"]        = elegooStatus.filamentStopped;
     jsonDoc["filamentRunout"] = elegooStatus.filamentRunout;
 
-    jsonDoc["mac"] = WiFi.macAddress();
-    jsonDoc["ip"]  = WiFi.localIP().toString();
+    // Identity also lives in /device_info; kept here for existing integrations
+    // (SSE deltas skip it, since it does not change)
+    refreshIdentity();
+    jsonDoc["mac"] = (const char *) cachedMac;
+    jsonDoc["ip"]  = (const char *) cachedIp;
     jsonDoc["uptimeSec"] = millis() / 1000;
 
     JsonObject elegoo = jsonDoc["elegoo"].to<JsonObject>();
@@ -710,11 +1486,13 @@ void WebServer::buildStatusJson(StaticJsonDocument<768> &jsonDoc, const printer_
     elegoo["actualFilament"]       = elegooStatus.actualFilamentMM;
     elegoo["expectedDelta"]        = elegooStatus.lastExpectedDeltaMM;
     elegoo["telemetryAvailable"]   = elegooStatus.telemetryAvailable;
+    elegoo["flowProfileActive"]    = elegooStatus.flowProfileActive;
     elegoo["currentDeficitMm"]     = elegooStatus.currentDeficitMm;
     elegoo["deficitThresholdMm"]   = elegooStatus.deficitThresholdMm;
     elegoo["deficitRatio"]         = elegooStatus.deficitRatio;
     elegoo["passRatio"]            = elegooStatus.passRatio;
     elegoo["ratioThreshold"]       = settingsManager.getDetectionRatioThreshold();
+    elegoo["softJamThreshold"]     = elegooStatus.softJamThreshold;
     elegoo["hardJamPercent"]       = elegooStatus.hardJamPercent;
     elegoo["softJamPercent"]       = elegooStatus.softJamPercent;
     elegoo["movementPulses"]       = (uint32_t) elegooStatus.movementPulseCount;
@@ -728,40 +1506,170 @@ void WebServer::buildStatusJson(StaticJsonDocument<768> &jsonDoc, const printer_
     elegoo["runoutPauseRemainingMm"] = elegooStatus.runoutPauseRemainingMm;
     elegoo["runoutPauseDelayMm"]   = elegooStatus.runoutPauseDelayMm;
     elegoo["runoutPauseCommanded"] = elegooStatus.runoutPauseCommanded;
+
+    elegoo["activeChannel"]        = elegooStatus.activeChannel;
+    JsonArray channels = elegoo["channels"].to<JsonArray>();
+    for (uint8_t i = 0; i < MOTION_SENSOR_CHANNELS; i++)
+    {
+        const motion_channel_info_t &info    = elegooStatus.channels[i];
+        JsonObject                   channel = channels.createNestedObject();
+        channel["pulses"]       = (uint32_t) info.pulseCount;
+        channel["windowMm"]     = info.windowMm;
+        channel["rateMmPerSec"] = info.rateMmPerSec;
+    }
+
+    const jam_latency_t &latency    = elegooStatus.jamLatency;
+    JsonObject           jamLatency = jsonDoc["jamLatency"].to<JsonObject>();
+    jamLatency["pauses"]          = latency.pauseCount;
+    jamLatency["acked"]           = latency.ackCount;
+    jamLatency["onsetToDetectMs"] = latency.onsetToDetectMs;
+    jamLatency["detectToSendMs"]  = latency.detectToSendMs;
+    jamLatency["sendToAckMs"]     = latency.sendToAckMs;
+    jamLatency["totalMs"]         = latency.totalMs;
+    jamLatency["maxTotalMs"]      = latency.maxTotalMs;
+    jamLatency["avgTotalMs"]      = latency.ackCount ? latency.sumTotalMs / latency.ackCount : 0;
+
+    const sdcp_link_t &link     = elegooStatus.link;
+    JsonObject         sdcpLink = jsonDoc["sdcpLink"].to<JsonObject>();
+    sdcpLink["drops"]           = link.drops;
+    sdcpLink["reconnects"]      = link.reconnects;
+    sdcpLink["deadLinks"]       = link.deadLinks;
+    sdcpLink["lastOutageMs"]    = link.lastOutageMs;
+    sdcpLink["maxOutageMs"]     = link.maxOutageMs;
+    sdcpLink["totalOutageMs"]   = link.totalOutageMs;
 }
 
-void WebServer::broadcastStatusUpdate()
+void WebServer::refreshIdentity()
 {
-    // Use the pre-built cached sensor status JSON (double-buffered, short-lock copy)
-    char payloadBuf[kCacheBufSize];
-    size_t payloadLen = cachedSensorStatus.read(payloadBuf, sizeof(payloadBuf));
-    sdcp_print_status_t printStatus = cachedPrintStatus;
+    IPAddress localIp = WiFi.localIP();
+    if (cachedMac[0] == '\0' || (uint32_t) localIp != cachedIpRaw)
+    {
+        strlcpy(cachedMac, WiFi.macAddress().c_str(), sizeof(cachedMac));
+        WiFi.macAddress(cachedMacRaw);
+        snprintf(cachedIp, sizeof(cachedIp), "%u.%u.%u.%u", localIp[0], localIp[1], localIp[2],
+                 localIp[3]);
+        cachedIpRaw = (uint32_t) localIp;
+    }
+}
 
-    if (payloadLen == 0)
+void WebServer::refreshDeviceInfo(unsigned long now, bool force)
+{
+    // Cheap to build; checked once a second and published only when it differs
+    if (!force && (now - lastDeviceInfoCheckMs) < kSensorStatusMaxAgeMs)
     {
         return;
     }
+    lastDeviceInfoCheckMs = now;
+    refreshIdentity();
+
+    StaticJsonDocument<128 + 160 * PRINTER_SESSIONS> jsonDoc;
+    jsonDoc["mac"] = (const char *) cachedMac;
+    jsonDoc["ip"]  = (const char *) cachedIp;
+    JsonArray printers = jsonDoc.createNestedArray("printers");
+    char      ips[PRINTER_SESSIONS][16];
+    for (uint8_t session = 0; session < PRINTER_SESSIONS; session++)
+    {
+        printer_info_t info    = ElegooCC::getSession(session).getCurrentInformation();
+        JsonObject     printer = printers.createNestedObject();
+        settingsManager.copyPrinterIP(session, ips[session], sizeof(ips[session]));
+        printer["ip"]          = (const char *) ips[session];
+        printer["mainboardID"] = info.mainboardID;  // Copied: info is a local
+    }
 
-    bool idleState = (printStatus == SDCP_PRINT_STATUS_IDLE ||
-                      printStatus == SDCP_PRINT_STATUS_COMPLETE);
+    char   jsonBuf[kDeviceInfoBufSize];
+    size_t len = serializeJson(jsonDoc, jsonBuf, sizeof(jsonBuf));
 
-    if (idleState)
+    SharedPayloadRef current = cachedDeviceInfo.acquire();
+    if (!current || current.size() != len || memcmp(current.data(), jsonBuf, len) != 0)
     {
-        uint32_t payloadCrc = crc32(payloadBuf, payloadLen);
-        if (hasLastIdlePayload && payloadCrc == lastIdlePayloadCrc)
+        cachedDeviceInfo.publish(jsonBuf, len);
+    }
+}
+
+void WebServer::buildStatusPacket(sensor_status_packet_t &packet, const printer_info_t &elegooStatus)
+{
+    // Called right after buildStatusJson(), which refreshed cachedMacRaw
+    memset(&packet, 0, sizeof(packet));
+    packet.magic[0] = 'O';
+    packet.magic[1] = 'F';
+    packet.version  = SENSOR_STATUS_PACKET_VERSION;
+    packet.length   = sizeof(packet);
+
+    uint8_t flags = 0;
+    if (elegooStatus.filamentStopped)      flags |= SENSOR_STATUS_FLAG_STOPPED;
+    if (elegooStatus.filamentRunout)       flags |= SENSOR_STATUS_FLAG_RUNOUT;
+    if (elegooStatus.isWebsocketConnected) flags |= SENSOR_STATUS_FLAG_PRINTER_CONNECTED;
+    if (elegooStatus.isPrinting)           flags |= SENSOR_STATUS_FLAG_PRINTING;
+    if (elegooStatus.graceActive)          flags |= SENSOR_STATUS_FLAG_GRACE_ACTIVE;
+    if (elegooStatus.telemetryAvailable)   flags |= SENSOR_STATUS_FLAG_TELEMETRY;
+    if (elegooStatus.runoutPausePending)   flags |= SENSOR_STATUS_FLAG_RUNOUT_PENDING;
+    if (elegooStatus.runoutPauseCommanded) flags |= SENSOR_STATUS_FLAG_RUNOUT_COMMANDED;
+    packet.flags = flags;
+
+    packet.printStatus    = (uint8_t) elegooStatus.printStatus;
+    packet.graceState     = elegooStatus.graceState;
+    packet.progress       = (uint8_t) constrain(elegooStatus.progress, 0, 255);
+    memcpy(packet.mac, cachedMacRaw, sizeof(packet.mac));
+    packet.currentLayer   = (uint16_t) constrain(elegooStatus.currentLayer, 0, 65535);
+    packet.totalLayer     = (uint16_t) constrain(elegooStatus.totalLayer, 0, 65535);
+    packet.printSpeedPct  = (uint16_t) constrain(elegooStatus.PrintSpeedPct, 0, 65535);
+    packet.uptimeSec      = millis() / 1000;
+    packet.movementPulses = (uint32_t) elegooStatus.movementPulseCount;
+    packet.expectedFilament     = elegooStatus.expectedFilamentMM;
+    packet.actualFilament       = elegooStatus.actualFilamentMM;
+    packet.currentDeficitMm     = elegooStatus.currentDeficitMm;
+    packet.deficitRatio         = elegooStatus.deficitRatio;
+    packet.passRatio            = elegooStatus.passRatio;
+    packet.hardJamPercent       = elegooStatus.hardJamPercent;
+    packet.softJamPercent       = elegooStatus.softJamPercent;
+    packet.expectedRateMmPerSec = elegooStatus.expectedRateMmPerSec;
+    packet.actualRateMmPerSec   = elegooStatus.actualRateMmPerSec;
+    packet.currentZ             = elegooStatus.currentZ;
+}
+
+void WebServer::broadcastStatusUpdate()
+{
+    PerfScope perfScope(PERF_SSE_BROADCAST);
+    MemScope  memScope(MEM_SSE_BROADCAST);
+    printer_info_t elegooStatus = elegooCC.getCurrentInformation();
+    StatusJsonDocument current;
+    buildStatusJson(current, elegooStatus);
+    sdcp_print_status_t printStatus = elegooStatus.printStatus;
+
+    char   payloadBuf[kCacheBufSize];
+    size_t payloadLen = 0;
+    bool   keyframe   = sseKeyframePending || lastBroadcastDoc.isNull() ||
+                    deltasSinceKeyframe >= kSseKeyframeInterval;
+    if (keyframe)
+    {
+        sseKeyframePending  = false;
+        deltasSinceKeyframe = 0;
+        payloadLen = serializeJson(current, payloadBuf, sizeof(payloadBuf));
+        if (payloadLen == 0)
         {
-            statusBroadcastIntervalMs = kStatusBroadcastIntervalMsDefault;
             return;
         }
-        lastIdlePayloadCrc = payloadCrc;
-        hasLastIdlePayload = true;
+        statusEvents.send(payloadBuf, "status", ++sseSeq);
     }
     else
     {
-        hasLastIdlePayload = false;
+        StatusJsonDocument delta;
+        if (!appendChangedFields(current.as<JsonObjectConst>(), lastBroadcastDoc.as<JsonObjectConst>(),
+                                 delta.to<JsonObject>()))
+        {
+            // Nothing changed since the last broadcast: stay quiet
+            statusBroadcastIntervalMs = kStatusBroadcastIntervalMsDefault;
+            return;
+        }
+        payloadLen = serializeJson(delta, payloadBuf, sizeof(payloadBuf));
+        if (payloadLen == 0)
+        {
+            return;
+        }
+        statusEvents.send(payloadBuf, "delta", ++sseSeq);
+        deltasSinceKeyframe++;
     }
-
-    statusEvents.send(payloadBuf, "status");
+    lastBroadcastDoc = current;
 
     bool isPrinting = (printStatus != SDCP_PRINT_STATUS_IDLE &&
                        printStatus != SDCP_PRINT_STATUS_COMPLETE);
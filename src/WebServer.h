@@ -11,13 +11,18 @@
 
 #include "SettingsManager.h"
 #include "ElegooCC.h"
+#include "SensorStatusPacket.h"
+#include "SharedPayload.h"
 
 // Define SPIFFS as LittleFS
 #define SPIFFS LittleFS
 
-// Maximum SSE clients allowed simultaneously
-// Kept low to reduce memory pressure on page refresh (old connection lingers briefly)
-static constexpr int kMaxSSEClients = 2;
+// Maximum SSE clients allowed simultaneously. AsyncEventSource queues one
+// shared message for all clients, so each extra client costs its TCP state and
+// queue entries rather than a copy of every event; below kSseMinFreeHeap the
+// clients are dropped anyway (a page refresh leaves its old connection briefly).
+static constexpr int kMaxSSEClients = 4;
+static constexpr uint32_t kSseMinFreeHeap = 24 * 1024;
 
 #ifdef STRESS_MODE
 static constexpr unsigned long kStatusBroadcastIntervalMsDefault = 200;
@@ -29,6 +34,19 @@ static constexpr unsigned long kStatusBroadcastIntervalMsPrinting = 1000;
 static constexpr int kStressCacheRefreshes = 0;
 #endif
 
+// Sensor status JSON is rebuilt only when its inputs change (ElegooCC publish
+// generation or settings), and no more often than this. At least once per
+// kSensorStatusMaxAgeMs so uptimeSec stays current.
+#ifndef SENSOR_STATUS_MIN_REBUILD_MS
+#define SENSOR_STATUS_MIN_REBUILD_MS 50
+#endif
+
+// Full SSE status keyframe at least this often (in broadcasts) so clients that
+// missed a delta resync without reconnecting
+static constexpr uint8_t kSseKeyframeInterval = 30;
+static constexpr unsigned long kSensorStatusMinRebuildMs = SENSOR_STATUS_MIN_REBUILD_MS;
+static constexpr unsigned long kSensorStatusMaxAgeMs     = 1000;
+
 class WebServer
 {
    private:
@@ -41,83 +59,110 @@ class WebServer
 
     // Pending settings update: async handler parses JSON into this doc, loop() applies it
     volatile bool pendingSettingsUpdate = false;
-    StaticJsonDocument<1024> pendingSettingsDoc;
+    StaticJsonDocument<1792> pendingSettingsDoc;  // Full settings payload incl. MQTT and static IP strings
     portMUX_TYPE pendingMutex = portMUX_INITIALIZER_UNLOCKED;
 
-    // Pending action commands from web handlers
-    volatile bool pendingPause = false;
-    volatile bool pendingResume = false;
+    // Pending action commands from web handlers, per printer session
+    volatile bool pendingPause[PRINTER_SESSIONS] = {};
+    volatile bool pendingResume[PRINTER_SESSIONS] = {};
     volatile bool pendingDiscovery = false;
-    volatile bool pendingReconnect = false;  // Set when IP changed during settings update
-
-    // --- Pre-built cached responses (double-buffered, short-lock copy) ---
-    // Main loop writes to buf[!activeIdx], then flips activeIdx.
-    // Async handlers snapshot activeIdx/len under a short lock (no heap allocation).
+    volatile bool pendingReconnect[PRINTER_SESSIONS] = {};  // Set when its IP changed in a settings update
+    volatile unsigned long pendingRestartAtMs = 0;  // Restart after the response went out (0 = none)
+
+    // Flow profile upload: the body is streamed to FLOW_PROFILE_UPLOAD_PATH on
+    // the async task; loop() swaps it in (FlowProfile is main-task only)
+    File flowProfileUpload;
+    bool flowProfileUploadFailed = false;
+    volatile bool pendingFlowProfileInstall = false;
+    volatile bool pendingFlowProfileClear = false;
+
+    // --- Pre-built cached responses (shared immutable bodies, see SharedPayload.h) ---
+    // Main loop publishes into a free slot; async handlers stream from the
+    // current one by reference, so concurrent clients share a single copy.
     static constexpr size_t kCacheBufSize = 1536;  // Fits sensor (~600B), settings (~1KB), discovery (~1KB)
-
-    struct CachedResponse {
-        char   buf[2][kCacheBufSize];
-        size_t len[2] = {0, 0};
-        volatile int activeIdx = 0;  // Single-word write is atomic on ESP32
-
-        // Main loop: write to inactive buffer, then flip
-        void publish(const char *json, size_t jsonLen) {
-            int writeIdx = !activeIdx;
-            size_t copyLen = (jsonLen < kCacheBufSize - 1) ? jsonLen : (kCacheBufSize - 1);
-            memcpy(buf[writeIdx], json, copyLen);
-            buf[writeIdx][copyLen] = '\0';
-            len[writeIdx] = copyLen;
-            // Memory barrier + atomic flip
-            portENTER_CRITICAL(&_mutex);
-            activeIdx = writeIdx;
-            portEXIT_CRITICAL(&_mutex);
-        }
-
-        // Async handler: copy active buffer under short lock (no heap alloc)
-        size_t read(char *out, size_t outSize) const {
-            if (outSize == 0) {
-                return 0;
-            }
-            size_t copyLen = 0;
-            portENTER_CRITICAL(&_mutex);
-            int idx = activeIdx;
-            copyLen = len[idx];
-            if (copyLen >= outSize) {
-                copyLen = outSize - 1;
-            }
-            memcpy(out, buf[idx], copyLen);
-            out[copyLen] = '\0';
-            portEXIT_CRITICAL(&_mutex);
-            return copyLen;
-        }
-
-        mutable portMUX_TYPE _mutex = portMUX_INITIALIZER_UNLOCKED;
-    };
-
-    CachedResponse cachedSensorStatus;
-    CachedResponse cachedSettings;
-    CachedResponse cachedDiscovery;
-    sdcp_print_status_t cachedPrintStatus = SDCP_PRINT_STATUS_IDLE;
+    static constexpr size_t kDeviceInfoBufSize = 384;
+
+    // Status JSON document (~45 members incl. the nested elegoo/jamLatency objects)
+    // Fixed fields plus one "channels" entry per motion sensor
+    typedef StaticJsonDocument<1152 + 96 * MOTION_SENSOR_CHANNELS> StatusJsonDocument;
+
+    // /sensor_status is session 0; /printer/<n>/sensor_status serves cachedSensorStatus[n].
+    // Polled by every open dashboard, so one slot more than the rest.
+    SharedPayload<kCacheBufSize, 3> cachedSensorStatus[PRINTER_SESSIONS];
+    SharedPayload<kCacheBufSize, 2> cachedSettings;
+    SharedPayload<kCacheBufSize, 2> cachedDiscovery;
+    SharedPayload<sizeof(sensor_status_packet_t) + 1, 3> cachedSensorStatusPacket;  // Binary /sensor_status
+    // Identity that rarely changes (MAC, addresses, printer IDs) for clients that poll status
+    SharedPayload<kDeviceInfoBufSize, 2> cachedDeviceInfo;
+    unsigned long lastDeviceInfoCheckMs = 0;
     volatile bool settingsJsonDirty = true;  // Start dirty to build initial cache
 
+    // --- Cache dirty tracking ---
+    // Per session: settings shown in the status JSON changed, getInformationGeneration()
+    // at the last build and when it was
+    volatile bool statusJsonDirty[PRINTER_SESSIONS];
+    uint32_t lastStatusGeneration[PRINTER_SESSIONS] = {};
+    unsigned long lastStatusRebuildMs[PRINTER_SESSIONS] = {};
+    bool lastDiscoveryActive = false;
+    uint32_t lastDiscoveryGeneration = 0;
+    bool discoveryJsonDirty = true;
+    uint32_t lastSettingsRevision = 0;  // settingsManager.getRevision() of cachedSettings
+
     // Cached version JSON (built once at startup, never changes)
     char cachedVersionJson[512] = {0};
 
-    // --- SSE deduplication ---
-    // CRC32 of last idle payload for dedup (replaces full String comparison)
-    uint32_t lastIdlePayloadCrc = 0;
-    bool hasLastIdlePayload = false;
+    // --- SSE delta stream ---
+    // Each broadcast carries a sequence number as its SSE id. A full "status"
+    // keyframe goes out when a client connects and every kSseKeyframeInterval
+    // broadcasts; in between, "delta" events carry only fields that changed
+    // since the previous broadcast (nothing is sent if nothing changed).
+    StatusJsonDocument lastBroadcastDoc;
+    uint32_t sseSeq = 0;
+    uint8_t deltasSinceKeyframe = 0;
+    volatile bool sseKeyframePending = true;  // Set by onConnect (async task)
+
+    // Static identity fields, formatted once instead of per status build
+    char cachedMac[18] = {0};
+    uint8_t cachedMacRaw[6] = {0};
+    char cachedIp[16] = {0};
+    uint32_t cachedIpRaw = 0;
 
     // SSE client cleanup tracking
     unsigned long lastSSECleanupMs = 0;
 
-    void buildStatusJson(StaticJsonDocument<768> &jsonDoc, const printer_info_t &elegooStatus);
+    // Web UI assets listed in /lite/manifest.json (webui_lite/build.js).
+    // Filled once in begin(), read-only afterwards (async handlers read it).
+    struct UiAsset
+    {
+        char url[48];
+        char path[48];         // LittleFS file, sent as stored
+        char etag[24];         // Quoted content hash
+        char contentType[32];
+        bool gzip;             // Stored gzipped: sent with Content-Encoding
+        bool immutable;        // Content-hashed URL: cached by browsers for good
+    };
+    static constexpr size_t kMaxUiAssets = 8;
+    UiAsset uiAssets[kMaxUiAssets];
+    size_t uiAssetCount = 0;
+    const UiAsset *uiIndexAsset = nullptr;  // Served for "/", "/lite" and SPA routes
+
+    void buildStatusJson(StatusJsonDocument &jsonDoc, const printer_info_t &elegooStatus);
+    void buildStatusPacket(sensor_status_packet_t &packet, const printer_info_t &elegooStatus);
     void broadcastStatusUpdate();
     void processPendingCommands();
-    void refreshCachedResponses();
+    void refreshCachedResponses(bool force = false);
+    void refreshSessionStatus(uint8_t session, unsigned long now, bool force);
+    void markStatusJsonDirty();
+    void refreshDeviceInfo(unsigned long now, bool force);
+    void refreshIdentity();
+    void sendSensorStatus(AsyncWebServerRequest *request, uint8_t session);
+    void sendFlowHistory(AsyncWebServerRequest *request, uint8_t session);
+    // 200 streaming from the shared body, 503 before the first publish
+    void sendCached(AsyncWebServerRequest *request, const SharedPayloadRef &body,
+                    const char *contentType);
     void cleanupSSEClients();
-
-    static uint32_t crc32(const char *data, size_t length);
+    bool loadUiManifest();
+    void sendUiAsset(AsyncWebServerRequest *request, const UiAsset &asset);
 
    public:
     WebServer(int port = 80);
@@ -2,13 +2,19 @@
 #include <esp_system.h>
 #include <esp_core_dump.h>
 
+#include "BootStages.h"
 #include "ElegooCC.h"
+#include "FlowProfile.h"
 #include "LittleFS.h"
 #include "Logger.h"
 #include "SettingsManager.h"
 #include "SystemServices.h"
 #include "WebServer.h"
 #include "StatusDisplay.h"
+#include "MqttPublisher.h"
+#include "MemoryMonitor.h"
+#include "PerfMonitor.h"
+#include "TaskWake.h"
 
 #define SPIFFS LittleFS
 
@@ -42,17 +48,25 @@ const char* buildTimestamp  = __DATE__ " " __TIME__;
 
 WebServer webServer(80);
 
-// These things get setup in the loop, not setup, so we need to track if they've happened
-bool isElegooSetup    = false;
+// These things get started from the loop once their dependencies are up
+bool isElegooSetup    = false;  // SDCP sessions connecting (needs WiFi)
 bool isWebServerSetup = false;
 
 // Store reset reason for diagnostics
 static esp_reset_reason_t lastResetReason = ESP_RST_UNKNOWN;
 
+// Idle deadline: the WebSocket and MQTT clients cannot wake the loop on RX,
+// so this bounds how long their traffic waits to be polled
+#ifndef MAIN_LOOP_IDLE_SLEEP_MS
+#define MAIN_LOOP_IDLE_SLEEP_MS 20
+#endif
+
 #ifdef STRESS_MODE
-static constexpr uint32_t kMainLoopDelayMs = 0;
+static constexpr uint32_t kMainLoopDelayMs     = 0;
+static constexpr uint32_t kMainLoopIdleSleepMs = 0;
 #else
-static constexpr uint32_t kMainLoopDelayMs = 1;
+static constexpr uint32_t kMainLoopDelayMs     = 1;
+static constexpr uint32_t kMainLoopIdleSleepMs = MAIN_LOOP_IDLE_SLEEP_MS;
 #endif
 
 static const char* getResetReasonString(esp_reset_reason_t reason)
@@ -71,10 +85,21 @@ static const char* getResetReasonString(esp_reset_reason_t reason)
     }
 }
 
+// Stack and allocation tracking for a task started elsewhere (no-op if it is not running)
+static void monitorTaskByName(const char* name)
+{
+    TaskHandle_t handle = xTaskGetHandle(name);
+    if (handle != nullptr)
+    {
+        memoryMonitor.registerTask(name, handle);
+    }
+}
+
 void setup()
 {
     // Initialize serial and log reset reason FIRST for crash diagnostics
     Serial.begin(115200);
+    mainLoopWake.begin();
     lastResetReason = esp_reset_reason();
     Serial.printf("Reset reason: %s (%d)\n", getResetReasonString(lastResetReason), lastResetReason);
 
@@ -115,67 +140,110 @@ void setup()
     String settingsJson = settingsManager.toJson(false);
     logger.logf("Settings snapshot: %s", settingsJson.c_str());
 
+    if (flowProfile.begin())
+    {
+        flow_profile_info_t profileInfo;
+        flowProfile.getInfo(profileInfo);
+        logger.logf("Flow profile loaded: %lu entries for '%s'",
+                    (unsigned long) profileInfo.entryCount, profileInfo.filename);
+    }
+
     systemServices.begin();
 
+    // Protection first: pulse counting, runout pins and the detection task need
+    // no network, so they are armed before WiFi, SDCP, web and NTP
+    ElegooCC::setupSessions();
+    logger.logf("Sensors armed, %lums after boot", millis());
+
     // Initialize optional OLED display (no-op if ENABLE_OLED_DISPLAY not defined)
     statusDisplayBegin();
+
+    // Initialize optional MQTT publisher (no-op if ENABLE_MQTT not defined)
+    mqttPublisherBegin();
+
+    // Boot output above was printed synchronously; from here on a log task
+    // feeds the UART and the LittleFS spill so neither stalls the caller
+    logger.beginSinkTask();
+
+    memoryMonitor.registerTask("loop", xTaskGetCurrentTaskHandle());
+    monitorTaskByName("detect");
+    monitorTaskByName("display");
+    monitorTaskByName("logsink");
 }
 
 /**
  * @brief Main program loop that drives periodic system tasks and conditional subsystem startup.
  *
- * Runs recurring service processing, defers further work while setup is required, starts the web
- * server once a Wi‑Fi setup attempt has occurred, initializes and processes the Elegoo subsystem
- * when Wi‑Fi is ready and an Elegoo IP is configured, and services the web server if started.
+ * Startup is staged by dependency; no stage blocks the loop. Sensors are armed in setup(),
+ * SystemServices connects WiFi in the background, SDCP sessions connect on the pass WiFi is
+ * ready (ahead of everything else), and the web server (with OTA) starts once the network stack
+ * is up. NTP syncs in the background after WiFi. See BootStages and /version for timings.
  *
- * @note The loop yields to the FreeRTOS scheduler with a 1 ms delay to reduce CPU usage while
- *       preserving sensor and polling timing requirements.
+ * @note While a print job, pending ack, connect attempt or discovery is active the loop yields
+ *       for 1 ms per pass. Otherwise it sleeps until a task notification (web command, jam
+ *       edge, pulse without the detection task) or the MAIN_LOOP_IDLE_SLEEP_MS deadline.
  */
 void loop()
 {
-    systemServices.loop();
+    uint32_t loopStartUs = micros();
 
-    if (systemServices.shouldYieldForSetup())
     {
-        return;
-    }
-
-    if (!isWebServerSetup && systemServices.hasAttemptedWifiSetup())
-    {
-        webServer.begin();
-        isWebServerSetup = true;
-        logger.log("Webserver setup complete");
-        return;
+        PerfScope perfScope(PERF_SYSTEM_SERVICES);
+        systemServices.loop();
     }
 
+    // SDCP before the web server: pause commands are what protection needs
     if (systemServices.wifiReady())
     {
         if (!isElegooSetup && settingsManager.getElegooIP().length() > 0)
         {
-            elegooCC.setup();
-            logger.log("Elegoo setup complete");
+            ElegooCC::connectSessions();
+            logger.logf("Elegoo setup complete, %lums after boot", millis());
             isElegooSetup = true;
         }
 
         if (isElegooSetup)
         {
-            elegooCC.loop();
+            PerfScope perfScope(PERF_ELEGOO_LOOP);
+            ElegooCC::loopSessions();
         }
     }
 
+    if (!isWebServerSetup && systemServices.hasAttemptedWifiSetup())
+    {
+        webServer.begin();
+        isWebServerSetup = true;
+        monitorTaskByName("async_tcp");  // Created by the first listening server
+        bootStages.mark(BOOT_STAGE_WEB);
+        logger.logf("Webserver setup complete, %lums after boot", millis());
+    }
+
     if (isWebServerSetup)
     {
         webServer.loop();
     }
 
+    // Write committed settings once they settle (no-op otherwise)
+    settingsManager.loop();
+
     // Update optional OLED display (no-op if ENABLE_OLED_DISPLAY not defined)
-    statusDisplayLoop();
+    {
+        PerfScope perfScope(PERF_DISPLAY_LOOP);
+        statusDisplayLoop();
+    }
+
+    // Push jam/runout transitions and metrics (no-op if ENABLE_MQTT not defined)
+    mqttPublisherLoop();
+
+    // Work done this pass, excluding the yield below
+    perfMonitor.record(PERF_MAIN_LOOP, micros() - loopStartUs);
 
-    // Strategic 1ms delay to reduce CPU usage while maintaining detection accuracy.
-    // This yields to the FreeRTOS scheduler, reducing CPU from 100% spin to ~10-20%.
-    // 1ms is well below all critical timing thresholds:
+    // During a job keep the 1ms cadence, well below all critical timing thresholds:
     // - Motion sensor: ~60ms between pulses at typical speeds
     // - Jam detector: 250ms update interval
     // - Printer polling: 250ms status interval
-    vTaskDelay(pdMS_TO_TICKS(kMainLoopDelayMs));
+    // Idle, there is nothing to do until an event or the next 10s status poll, so
+    // sleep on the task notification; web handlers and detection wake the loop.
+    bool fastLoop = isElegooSetup && ElegooCC::needsFastLoop();
+    mainLoopWake.sleep(fastLoop ? kMainLoopDelayMs : kMainLoopIdleSleepMs);
 }
@@ -0,0 +1,340 @@
+/**
+ * Hot-Path Micro-Benchmarks
+ *
+ * Times the code the firmware runs on every pulse, every detection tick and
+ * every log line, and reports ns/op and heap allocations/op:
+ *
+ *   motion.addSensorPulse      FilamentMotionSensor, one pulse at 10 ms spacing
+ *   motion.updateExpected      FilamentMotionSensor, one SDCP extrusion update
+ *   motion.getWindowedRates    FilamentMotionSensor, rates over a full window
+ *   jam.update                 JamDetector, one tick with steady healthy flow
+ *   jam.update.jamming         JamDetector, one tick while a hard jam builds
+ *   log.logf                   Logger::logf path: vsnprintf + LogRing push
+ *   log.logDeferred            Logger::logDeferred path: DeferredLog::pack + push
+ *
+ * The logging benchmarks run the Logger's own steps against the real LogRing
+ * and DeferredLog (Logger.cpp itself needs FreeRTOS). The SDCP JSON paths and
+ * WebServer::buildStatusJson need the real ArduinoJson, which the host mocks
+ * stub out, so they are not measured here.
+ *
+ * Build and run (optimized, no sanitizer):
+ *   g++ -std=c++17 -O2 -I. -I./mocks -I../src -o bench_hot_paths bench_hot_paths.cpp
+ *   ./bench_hot_paths                              # print results
+ *   ./bench_hot_paths --json bench_baseline.json   # record a baseline
+ *   ./bench_hot_paths --compare bench_baseline.json [--tolerance 25]
+ *
+ * Or: ./build_and_run_all_tests.sh --bench
+ *
+ * Timings are only comparable on the machine that recorded the baseline;
+ * allocation counts are comparable anywhere.
+ */
+
+#include <cmath>
+#include <cstdarg>
+#include <cstring>
+#include <iostream>
+
+#include "bench_support.h"
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+// Pre-define header guards to prevent real headers from being included
+#define LOGGER_H
+#define SETTINGS_DATA_H
+
+enum LogLevel {
+    LOG_NORMAL = 0,
+    LOG_VERBOSE = 1,
+    LOG_PIN_VALUES = 2
+};
+
+// Detection code logs only on state changes; keep those calls free here
+class Logger {
+public:
+    static Logger& getInstance() {
+        static Logger instance;
+        return instance;
+    }
+    void log(const char* msg, LogLevel level = LOG_NORMAL) {}
+    void logf(const char* fmt, ...) {}
+    void logf(LogLevel level, const char* fmt, ...) {}
+    template <typename... Args> void logDeferred(LogLevel level, const char* fmt, Args... args) {}
+};
+
+class SettingsManager {
+public:
+    static SettingsManager& getInstance() {
+        static SettingsManager instance;
+        return instance;
+    }
+    bool getVerboseLogging() const { return false; }
+    int getLogLevel() const { return 0; }
+};
+
+#include "mocks/test_mocks.h"
+#include "mocks/arduino_mocks.h"
+
+MockLogger logger;
+MockSettingsManager settingsManager;
+MockSerial Serial;
+
+#include "../src/FilamentMotionSensor.h"
+#include "../src/FilamentMotionSensor.cpp"
+#include "../src/JamDetector.h"
+#include "../src/JamDetector.cpp"
+#include "../src/DeferredLog.h"
+#include "../src/LogRing.h"
+
+namespace
+{
+const float kMmPerPulse = 2.88f;
+
+JamConfig benchConfig()
+{
+    JamConfig config;
+    config.graceTimeMs    = 5000;
+    config.hardJamMm      = 5.0f;
+    config.softJamTimeMs  = 10000;
+    config.hardJamTimeMs  = 3000;
+    config.ratioThreshold = 0.70f;
+    config.detectionMode  = DetectionMode::BOTH;
+    return config;
+}
+
+// A sensor with a full window of healthy flow (10 mm/s) ending at `now`
+void primeSensor(FilamentMotionSensor &sensor, unsigned long now)
+{
+    sensor.reset();
+    float total = 0.0f;
+    for (unsigned long t = now - 10000; t <= now; t += 250)
+    {
+        setMockTime(t);
+        total += 2.5f;
+        sensor.updateExpectedPosition(total);
+        sensor.addSensorPulse(kMmPerPulse, t);
+    }
+}
+
+// Mirrors Logger::logInternal/logPacked minus the critical section (a no-op
+// on the host) and the sink wakeup
+class BenchLog
+{
+  public:
+    BenchLog() : sequence(0) { ring.begin(storage, sizeof(storage)); }
+
+    void logf(LogLevel level, const char *format, ...)
+    {
+        char    buffer[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        size_t length = strnlen(buffer, 255);
+        ring.push(++sequence, static_cast<uint32_t>(millis()), static_cast<uint8_t>(level),
+                  buffer, length);
+    }
+
+    template <typename... Args> void logDeferred(LogLevel level, const char *format, Args... args)
+    {
+        uint8_t payload[DeferredLog::MAX_PAYLOAD];
+        size_t  length = DeferredLog::pack(payload, sizeof(payload), format, args...);
+        ring.push(++sequence, static_cast<uint32_t>(millis()), static_cast<uint8_t>(level),
+                  reinterpret_cast<const char *>(payload), length, LogRing::FLAG_DEFERRED);
+    }
+
+    size_t count() const { return ring.count(); }
+
+  private:
+    uint8_t  storage[32768];  // LOGGER_RING_BYTES
+    LogRing  ring;
+    uint32_t sequence;
+};
+
+void usage()
+{
+    std::cout << "Usage: bench_hot_paths [--json PATH] [--compare PATH] [--tolerance PCT]\n"
+                 "                       [--filter NAME] [--quick]\n";
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    bench::Options options;
+    const char    *jsonPath    = nullptr;
+    const char    *comparePath = nullptr;
+    double         tolerance   = 25.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--json") == 0 && hasValue)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--compare") == 0 && hasValue)
+        {
+            comparePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue)
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+        {
+            options.filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--quick") == 0)
+        {
+            options.minBatchMs  = 2.0;
+            options.repetitions = 3;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    std::vector<bench::Result> results;
+    std::cout << "Hot-path benchmarks (best of " << options.repetitions << ")\n";
+
+    const unsigned long start = 100000;
+
+    if (bench::selected(options, "motion.addSensorPulse"))
+    {
+        FilamentMotionSensor sensor;
+        primeSensor(sensor, start);
+        results.push_back(bench::run("motion.addSensorPulse", options, [&](unsigned long i) {
+            unsigned long t = start + 10 * i;
+            _mockMillis     = t;
+            sensor.addSensorPulse(kMmPerPulse, t);
+        }));
+        bench::printResult(results.back());
+    }
+
+    if (bench::selected(options, "motion.updateExpected"))
+    {
+        FilamentMotionSensor sensor;
+        primeSensor(sensor, start);
+        float total = 1000.0f;
+        results.push_back(bench::run("motion.updateExpected", options, [&](unsigned long i) {
+            _mockMillis = start + 250 * i;
+            total += 2.5f;
+            sensor.updateExpectedPosition(total);
+        }));
+        bench::printResult(results.back());
+    }
+
+    if (bench::selected(options, "motion.getWindowedRates"))
+    {
+        FilamentMotionSensor sensor;
+        primeSensor(sensor, start);
+        results.push_back(bench::run("motion.getWindowedRates", options, [&](unsigned long) {
+            float expectedRate = 0.0f;
+            float actualRate   = 0.0f;
+            sensor.getWindowedRates(expectedRate, actualRate);
+            bench::doNotOptimize(expectedRate);
+            bench::doNotOptimize(actualRate);
+        }));
+        bench::printResult(results.back());
+    }
+
+    JamConfig config = benchConfig();
+
+    if (bench::selected(options, "jam.update"))
+    {
+        JamDetector detector;
+        detector.reset(0);
+        results.push_back(bench::run("jam.update", options, [&](unsigned long i) {
+            unsigned long now   = start + 50 * i;
+            float         mm    = 0.5f * static_cast<float>(i);
+            JamState      state = detector.update(mm + 20.0f, mm + 19.5f, i, true, true, now, 0,
+                                                  config, 10.0f, 9.8f);
+            bench::doNotOptimize(state.passRatio);
+        }));
+        bench::printResult(results.back());
+    }
+
+    if (bench::selected(options, "jam.update.jamming"))
+    {
+        JamDetector detector;
+        detector.reset(0);
+        results.push_back(bench::run("jam.update.jamming", options, [&](unsigned long i) {
+            // Expected keeps rising, the sensor stalls; restart the episode
+            // every 1000 ticks so the detector does not sit latched
+            unsigned long tick = i % 1000;
+            if (tick == 0)
+            {
+                detector.reset(start + 50 * i);
+            }
+            unsigned long now   = start + 50 * i;
+            float         mm    = 0.5f * static_cast<float>(tick);
+            JamState      state = detector.update(mm + 20.0f, 20.0f, 100, true, true, now, 0,
+                                                  config, 10.0f, 0.0f);
+            bench::doNotOptimize(state.hardJamPercent);
+        }));
+        bench::printResult(results.back());
+    }
+
+    if (bench::selected(options, "log.logf"))
+    {
+        BenchLog log;
+        results.push_back(bench::run("log.logf", options, [&](unsigned long i) {
+            log.logf(LOG_VERBOSE, "Flow: exp=%.2f act=%.2f ratio=%.2f deficit=%.2fmm pulses=%lu",
+                     10.0f, 9.8f, 0.98f, 0.2f, i);
+        }));
+        bench::printResult(results.back());
+    }
+
+    if (bench::selected(options, "log.logDeferred"))
+    {
+        BenchLog log;
+        results.push_back(bench::run("log.logDeferred", options, [&](unsigned long i) {
+            log.logDeferred(LOG_VERBOSE,
+                            "Flow: exp=%.2f act=%.2f ratio=%.2f deficit=%.2fmm pulses=%lu", 10.0f,
+                            9.8f, 0.98f, 0.2f, i);
+        }));
+        bench::printResult(results.back());
+    }
+
+    int exitCode = 0;
+
+    if (jsonPath != nullptr)
+    {
+        if (bench::writeBaseline(jsonPath, results))
+        {
+            std::cout << "Wrote " << jsonPath << "\n";
+        }
+        else
+        {
+            std::cout << "Could not write " << jsonPath << "\n";
+            exitCode = 1;
+        }
+    }
+
+    if (comparePath != nullptr)
+    {
+        std::vector<bench::Result> baseline;
+        if (!bench::readBaseline(comparePath, baseline))
+        {
+            std::cout << "Could not read " << comparePath << "\n";
+            return 1;
+        }
+        std::cout << "Against " << comparePath << " (tolerance " << tolerance << "%)\n";
+        int regressions = bench::compareBaseline(baseline, results, tolerance);
+        if (regressions > 0)
+        {
+            std::cout << regressions << " regression(s)\n";
+            exitCode = 1;
+        }
+        else
+        {
+            std::cout << "No regressions\n";
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,264 @@
+/**
+ * Host micro-benchmark support
+ *
+ * Times a callable in calibrated batches (best of several repetitions, so a
+ * descheduled run does not count), counts heap allocations made through
+ * operator new, and reads/writes the machine-readable baseline:
+ *
+ *   {"format":1,"benchmarks":[
+ *   {"name":"jam.update","nsPerOp":41.2,"allocsPerOp":0.000},
+ *   ...
+ *   ]}
+ *
+ * One benchmark per line so the file diffs cleanly and can be read back
+ * without a JSON library. Include from exactly one translation unit: it
+ * replaces the global operator new/delete, unless BENCH_NO_ALLOC_COUNTING is
+ * defined (sanitizer builds, which bring their own allocator).
+ */
+
+#ifndef BENCH_SUPPORT_H
+#define BENCH_SUPPORT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+namespace bench
+{
+inline std::atomic<unsigned long> &allocationCount()
+{
+    static std::atomic<unsigned long> count(0);
+    return count;
+}
+}  // namespace bench
+
+#ifndef BENCH_NO_ALLOC_COUNTING
+void *operator new(std::size_t size)
+{
+    bench::allocationCount().fetch_add(1, std::memory_order_relaxed);
+    void *p = std::malloc(size ? size : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+#endif  // BENCH_NO_ALLOC_COUNTING
+
+namespace bench
+{
+
+// Keeps the optimizer from discarding a result
+template <typename T> inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result
+{
+    std::string name;
+    unsigned long iterations;  // Per repetition
+    double        nsPerOp;
+    double        allocsPerOp;
+};
+
+struct Options
+{
+    double      minBatchMs  = 10.0;  // Each timed repetition runs at least this long
+    int         repetitions = 15;
+    std::string filter;              // Substring of the benchmark name
+};
+
+inline bool selected(const Options &options, const char *name)
+{
+    return options.filter.empty() || std::strstr(name, options.filter.c_str()) != nullptr;
+}
+
+/**
+ * Time `op` (called with the iteration index). The batch size doubles until
+ * one batch takes minBatchMs, then the fastest of `repetitions` batches is
+ * kept. Allocations are counted over all timed batches.
+ */
+template <typename Op> Result run(const char *name, const Options &options, Op op)
+{
+    typedef std::chrono::steady_clock clock;
+
+    unsigned long batch = 1;
+    unsigned long index = 0;
+    for (;;)
+    {
+        clock::time_point start = clock::now();
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            op(index++);
+        }
+        double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        if (ms >= options.minBatchMs || batch >= (1ul << 30))
+        {
+            break;
+        }
+        batch *= 2;
+    }
+
+    double        bestNs      = 0.0;
+    unsigned long allocsStart = allocationCount().load();
+    for (int r = 0; r < options.repetitions; r++)
+    {
+        clock::time_point start = clock::now();
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            op(index++);
+        }
+        double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        if (r == 0 || ns < bestNs)
+        {
+            bestNs = ns;
+        }
+    }
+    unsigned long allocs = allocationCount().load() - allocsStart;
+
+    Result result;
+    result.name        = name;
+    result.iterations  = batch;
+    result.nsPerOp     = bestNs / static_cast<double>(batch);
+    result.allocsPerOp = static_cast<double>(allocs) /
+                         (static_cast<double>(batch) * static_cast<double>(options.repetitions));
+    return result;
+}
+
+inline void printResult(const Result &result)
+{
+    std::printf("  %-32s %12.1f ns/op %10.3f allocs/op  (%lu iter)\n", result.name.c_str(),
+                result.nsPerOp, result.allocsPerOp, result.iterations);
+}
+
+// ============================================================================
+// Baseline file
+// ============================================================================
+
+inline bool writeBaseline(const char *path, const std::vector<Result> &results)
+{
+    FILE *file = std::fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    std::fprintf(file, "{\"format\":1,\"benchmarks\":[\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        std::fprintf(file, "{\"name\":\"%s\",\"nsPerOp\":%.1f,\"allocsPerOp\":%.3f}%s\n",
+                     results[i].name.c_str(), results[i].nsPerOp, results[i].allocsPerOp,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "]}\n");
+    return std::fclose(file) == 0;
+}
+
+// Reads the lines writeBaseline() produces; other lines are ignored
+inline bool readBaseline(const char *path, std::vector<Result> &out)
+{
+    FILE *file = std::fopen(path, "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    char line[256];
+    while (std::fgets(line, sizeof(line), file) != nullptr)
+    {
+        char   name[96];
+        double ns     = 0.0;
+        double allocs = 0.0;
+        if (std::sscanf(line, "{\"name\":\"%95[^\"]\",\"nsPerOp\":%lf,\"allocsPerOp\":%lf", name,
+                        &ns, &allocs) == 3)
+        {
+            Result result;
+            result.name        = name;
+            result.iterations  = 0;
+            result.nsPerOp     = ns;
+            result.allocsPerOp = allocs;
+            out.push_back(result);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+/**
+ * Compare against a baseline: a benchmark regresses when it is more than
+ * `tolerancePct` slower or allocates at all more per op. Benchmarks with no
+ * baseline entry are reported but do not fail. Returns the regression count.
+ */
+inline int compareBaseline(const std::vector<Result> &baseline, const std::vector<Result> &results,
+                           double tolerancePct)
+{
+    int regressions = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result *base = nullptr;
+        for (size_t j = 0; j < baseline.size(); j++)
+        {
+            if (baseline[j].name == results[i].name)
+            {
+                base = &baseline[j];
+                break;
+            }
+        }
+        if (base == nullptr)
+        {
+            std::printf("  %-32s new (no baseline)\n", results[i].name.c_str());
+            continue;
+        }
+
+        double change = base->nsPerOp > 0.0
+                            ? 100.0 * (results[i].nsPerOp - base->nsPerOp) / base->nsPerOp
+                            : 0.0;
+        bool   slower = change > tolerancePct;
+        bool   allocs = results[i].allocsPerOp > base->allocsPerOp + 0.01;
+        std::printf("  %-32s %+7.1f%% time, %.3f -> %.3f allocs/op%s\n", results[i].name.c_str(),
+                    change, base->allocsPerOp, results[i].allocsPerOp,
+                    slower || allocs ? "  REGRESSION" : "");
+        if (slower || allocs)
+        {
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+}  // namespace bench
+
+#endif  // BENCH_SUPPORT_H
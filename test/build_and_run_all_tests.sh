@@ -15,6 +15,11 @@
 #   --tsan         Compile with ThreadSanitizer (detects data races)
 #   --no-python    Skip Python tests
 #   --no-node      Skip Node/JavaScript tests
+#   --bench        Build the hot-path benchmarks (-O2) and compare them with
+#                  bench_baseline.json instead of running the tests
+#   --soak         Run test_soak in throughput mode instead of the tests: a
+#                  -O2 performance gate against soak_baseline.json, or with
+#                  --sanitize/--tsan a sanitized soak (report only, no gate)
 #   --help         Show this help message
 #
 # =============================================================================
@@ -35,6 +40,8 @@ VERBOSE=false
 SKIP_PYTHON=false
 SKIP_NODE=false
 SANITIZER_FLAGS=""
+BENCH_MODE=false
+SOAK_MODE=false
 
 while [[ $# -gt 0 ]]; do
     case $1 in
@@ -66,8 +73,16 @@ while [[ $# -gt 0 ]]; do
             SKIP_NODE=true
             shift
             ;;
+        --bench)
+            BENCH_MODE=true
+            shift
+            ;;
+        --soak)
+            SOAK_MODE=true
+            shift
+            ;;
         --help)
-            head -27 "$0" | tail -22
+            head -25 "$0" | tail -19
             exit 0
             ;;
         *)
@@ -177,9 +192,9 @@ compile_test() {
     local all_sources=("${source_files[@]}" "${extra_sources[@]}")
 
     if [ "$VERBOSE" = true ]; then
-        g++ -std=c++17 -Wno-redefined-macros $SANITIZER_FLAGS -o "$output_name" "${all_sources[@]}" $INCLUDE_PATHS $extra_flags
+        g++ -std=c++17 -Wno-redefined-macros $SANITIZER_FLAGS $TEST_DEFINES -o "$output_name" "${all_sources[@]}" $INCLUDE_PATHS $extra_flags
     else
-        g++ -std=c++17 -Wno-redefined-macros $SANITIZER_FLAGS -o "$output_name" "${all_sources[@]}" $INCLUDE_PATHS $extra_flags 2>&1 | head -30
+        g++ -std=c++17 -Wno-redefined-macros $SANITIZER_FLAGS $TEST_DEFINES -o "$output_name" "${all_sources[@]}" $INCLUDE_PATHS $extra_flags 2>&1 | head -30
     fi
     
     # Use PIPESTATUS to get the exit code of g++, not head
@@ -208,6 +223,56 @@ if ! command -v g++ &> /dev/null; then
     exit 1
 fi
 
+# Benchmarks: optimized and never sanitized, since they measure speed. The
+# timings in bench_baseline.json are only meaningful on the machine that
+# recorded them; re-record with ./bench_hot_paths --json bench_baseline.json
+if [ "$BENCH_MODE" = true ]; then
+    echo ""
+    echo "========================================"
+    echo "  Hot-Path Benchmarks"
+    echo "========================================"
+    if ! g++ -std=c++17 -O2 -Wno-redefined-macros -I. -I./mocks -I../src -I.. \
+        -o bench_hot_paths bench_hot_paths.cpp; then
+        echo -e "${RED}✗ Benchmark build failed${NC}"
+        exit 1
+    fi
+    if ./bench_hot_paths --compare bench_baseline.json --tolerance "${BENCH_TOLERANCE:-25}"; then
+        echo -e "${GREEN}✓ Benchmarks within baseline${NC}"
+        exit 0
+    fi
+    echo -e "${RED}✗ Benchmarks regressed${NC}"
+    exit 1
+fi
+
+# Soak throughput: the same test_soak binary either as a performance gate
+# (optimized, compared with soak_baseline.json; re-record with
+# ./test_soak --throughput --json soak_baseline.json) or, under a sanitizer,
+# as a long instrumented soak whose timings are reported but not compared
+if [ "$SOAK_MODE" = true ]; then
+    echo ""
+    echo "========================================"
+    echo "  Soak Throughput"
+    echo "========================================"
+    if [ -n "$SANITIZER_FLAGS" ]; then
+        SOAK_BUILD_FLAGS="$SANITIZER_FLAGS"
+        SOAK_ARGS="--throughput --repetitions 1"
+    else
+        SOAK_BUILD_FLAGS="-O2"
+        SOAK_ARGS="--throughput --compare soak_baseline.json --tolerance ${SOAK_TOLERANCE:-20}"
+    fi
+    if ! g++ -std=c++17 -Wno-redefined-macros $SOAK_BUILD_FLAGS -I. -I./mocks -I../src -I.. \
+        -o test_soak test_soak.cpp; then
+        echo -e "${RED}✗ Soak build failed${NC}"
+        exit 1
+    fi
+    if ./test_soak $SOAK_ARGS; then
+        echo -e "${GREEN}✓ Soak throughput passed${NC}"
+        exit 0
+    fi
+    echo -e "${RED}✗ Soak throughput failed${NC}"
+    exit 1
+fi
+
 echo ""
 echo "========================================"
 echo "  C++ Unit Tests"
@@ -223,18 +288,50 @@ declare -a CPP_TESTS=(
     "test_elegoo_cc:ElegooCC Unit Tests"
     "test_settings_manager:SettingsManager Unit Tests"
     "test_logger:Logger Unit Tests"
+    "test_perf_monitor:PerfMonitor Unit Tests"
+    "test_mm_per_pulse_estimator:MmPerPulseEstimator Unit Tests"
+    "test_flow_history:FlowHistory Unit Tests"
+    "test_settings_record:SettingsRecord Unit Tests"
+    "test_memory_monitor:MemoryMonitor Unit Tests"
     "test_integration:Integration Tests"
     "test_thread_safety:Thread Safety Stress Tests"
     "test_soak:Soak Tests"
 )
 
+# Detection pipeline tests rebuilt with integer math (FLOW_FIXED_POINT=1,
+# used by the FPU-less RISC-V targets; see src/FlowMath.h). Decisions must
+# match the float build.
+declare -a FIXED_POINT_TESTS=(
+    "pulse_simulator:Pulse Simulator [fixed-point]"
+    "test_jam_detector:JamDetector Unit Tests [fixed-point]"
+    "test_additional_edge_cases:Additional Edge Cases [fixed-point]"
+    "test_filament_motion_sensor:FilamentMotionSensor Unit Tests [fixed-point]"
+    "test_integration:Integration Tests [fixed-point]"
+)
+
+# Motion sensor rebuilt with several filament-path channels
+# (MOTION_SENSOR_CHANNELS, see src/FilamentMotionSensor.h)
+declare -a MULTI_CHANNEL_TESTS=(
+    "test_filament_motion_sensor:FilamentMotionSensor Unit Tests [3 channels]"
+)
+
 # In quick mode, only run pulse_simulator
 if [ "$QUICK_MODE" = true ]; then
     CPP_TESTS=("pulse_simulator:Pulse Simulator")
+    FIXED_POINT_TESTS=()
+    MULTI_CHANNEL_TESTS=()
 fi
 
-for test_entry in "${CPP_TESTS[@]}"; do
-    IFS=':' read -r test_file test_name <<< "$test_entry"
+ALL_TESTS=("${CPP_TESTS[@]}")
+for test_entry in "${FIXED_POINT_TESTS[@]}"; do
+    ALL_TESTS+=("${test_entry}:fixed")
+done
+for test_entry in "${MULTI_CHANNEL_TESTS[@]}"; do
+    ALL_TESTS+=("${test_entry}:multi")
+done
+
+for test_entry in "${ALL_TESTS[@]}"; do
+    IFS=':' read -r test_file test_name test_variant <<< "$test_entry"
 
     # Check filter
     if [ -n "$FILTER" ]; then
@@ -250,13 +347,23 @@ for test_entry in "${CPP_TESTS[@]}"; do
         continue
     fi
 
+    output_file="$test_file"
+    TEST_DEFINES=""
+    if [ "$test_variant" = "fixed" ]; then
+        output_file="${test_file}_fixed"
+        TEST_DEFINES="-DFLOW_FIXED_POINT=1"
+    elif [ "$test_variant" = "multi" ]; then
+        output_file="${test_file}_multi"
+        TEST_DEFINES="-DMOTION_SENSOR_CHANNELS=3"
+    fi
+
     echo ""
     echo "Building $test_name..."
 
-    if compile_test "$test_file" "$source_file"; then
-        run_test "$test_name" "./$test_file"
+    if compile_test "$output_file" "$source_file"; then
+        run_test "$test_name" "./$output_file"
     else
-        echo -e "${RED}✗ Failed to compile $test_file${NC}"
+        echo -e "${RED}✗ Failed to compile $output_file${NC}"
         TESTS_FAILED=$((TESTS_FAILED + 1))
         TESTS_RUN=$((TESTS_RUN + 1))
         EXIT_CODE=1
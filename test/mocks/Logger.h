@@ -26,6 +26,8 @@ public:
     void log(const class __FlashStringHelper* msg, LogLevel level = LOG_NORMAL) { /* no-op */ }
     void logf(const char* fmt, ...) { /* no-op */ }
     void logf(LogLevel level, const char* fmt, ...) { /* no-op */ }
+    template <typename... Args>
+    void logDeferred(LogLevel level, const char* fmt, Args... args) { /* no-op */ }
     void logVerbose(const char* fmt, ...) { /* no-op */ }
     void logNormal(const char* fmt, ...) { /* no-op */ }
     void logPinValues(const char* fmt, ...) { /* no-op */ }
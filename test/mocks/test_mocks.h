@@ -54,6 +54,8 @@ public:
     void logVerbose(const char* fmt, ...) { /* no-op */ }
     void logNormal(const char* fmt, ...) { /* no-op */ }
     void logPinValues(const char* fmt, ...) { /* no-op */ }
+    template <typename Level, typename... Args>
+    void logDeferred(Level level, const char* fmt, Args... args) { /* no-op */ }
     int getLogLevel() const { return 0; }
     void setLogLevel(int level) { /* no-op */ }
 };
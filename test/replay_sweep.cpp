@@ -0,0 +1,802 @@
+/**
+ * Replay Sweep - detection tuning over recorded print logs
+ *
+ * Parses each verbose print log once into a compact columnar event array,
+ * then replays it through the real FilamentMotionSensor + JamDetector for
+ * every configuration in a parameter grid, spread over all cores. The result
+ * is a detection / false-positive matrix: per configuration and log, how many
+ * of the jams the firmware logged it still catches, how much earlier or later,
+ * and how many detections it makes away from any logged jam.
+ *
+ * What is read from a log (firmware with verbose flow logging):
+ *   "Debug: sdcp_exp=..mm cumul_sns=..mm pulses=N | ..."   one sample
+ *   "Filament tracking reset"                              next sample starts a print
+ *   "Motion sensor reset (resume after pause)"             resume
+ *   "Filament jam detected (hard|soft...)"                 label
+ * Log timestamps have one-second resolution; samples sharing a second are
+ * spread evenly over it. A new print also starts when the SDCP total falls
+ * back towards zero.
+ *
+ * Replay follows ElegooCC: the expected total and the new pulses go into the
+ * motion sensor at each sample and JamDetector::update() runs every 250 ms
+ * while samples keep arriving (the firmware only logs them while printing).
+ * A detection pauses that configuration's print until the next resume or
+ * print start, as the real pause would.
+ *
+ * A detection counts as a hit when it is within --match seconds of a logged
+ * jam, otherwise as a false positive. The labels are the firmware's own
+ * detections, so logs where it tripped falsely should be left out (or kept
+ * to measure which settings avoid them).
+ *
+ * Build and run:
+ *   g++ -std=c++17 -O2 -I. -I./mocks -I../src -pthread -o replay_sweep replay_sweep.cpp
+ *   ./replay_sweep                                   # fixtures/logs_to_replay, default grid
+ *   ./replay_sweep logs/ --ratio 0.3:0.7:0.1 --window standard,fast --csv matrix.csv
+ *
+ * Grid options take "a,b,c" or "first:last:step":
+ *   --ratio, --hard-mm, --soft-ms, --hard-ms, --grace-ms, --window (standard,fast,long)
+ * Other options: --match S (default 30), --threads N, --top N, --csv PATH
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every worker thread replays on its own clock: millis() from the mocks reads
+// _mockMillis, which is mapped onto a thread-local value here
+unsigned long *replayClock()
+{
+    thread_local unsigned long now = 0;
+    return &now;
+}
+#define _mockMillis (*replayClock())
+
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/Arduino.h"
+
+#include "../src/FilamentMotionSensor.h"
+#include "../src/FilamentMotionSensor.cpp"
+#include "../src/JamDetector.h"
+#include "../src/JamDetector.cpp"
+
+namespace
+{
+// ============================================================================
+// Parsed logs
+// ============================================================================
+
+enum ReplayEvent : uint8_t
+{
+    EVENT_SAMPLE = 0,   // expectedMm / pulses valid
+    EVENT_PRINT_START,
+    EVENT_RESUME,
+};
+
+struct ReplayLabel
+{
+    uint32_t timeMs;
+    bool     hard;
+};
+
+// One log as parallel columns (times relative to the first line)
+struct ReplayLog
+{
+    std::string              name;
+    std::vector<uint32_t>    timeMs;
+    std::vector<uint8_t>     event;
+    std::vector<float>       expectedMm;
+    std::vector<uint32_t>    pulses;
+    std::vector<ReplayLabel> labels;
+    float                    mmPerPulse = 2.88f;
+    uint32_t                 printingMs = 0;  // Time covered by samples
+};
+
+// A sample gap longer than this means the printer was not printing
+const uint32_t kMaxSampleGapMs = 3000;
+// ElegooCC::JAM_DETECTOR_UPDATE_INTERVAL_MS
+const uint32_t kDetectorIntervalMs = 250;
+
+bool floatAfter(const std::string &line, const char *key, float &out)
+{
+    size_t pos = line.find(key);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+    const char *start = line.c_str() + pos + strlen(key);
+    char       *end   = nullptr;
+    out               = strtof(start, &end);
+    return end != start;
+}
+
+bool unsignedAfter(const std::string &line, const char *key, uint32_t &out)
+{
+    size_t pos = line.find(key);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+    const char *start = line.c_str() + pos + strlen(key);
+    char       *end   = nullptr;
+    out               = static_cast<uint32_t>(strtoul(start, &end, 10));
+    return end != start;
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+long daysFromCivil(int y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    long     era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+// "MM.DD.YY-hh:mm:ss" (log download) or a leading epoch; false otherwise
+bool lineSeconds(const std::string &line, long &seconds)
+{
+    unsigned mo, d, y, h, mi, s;
+    if (sscanf(line.c_str(), "%2u.%2u.%2u-%2u:%2u:%2u", &mo, &d, &y, &h, &mi, &s) == 6)
+    {
+        seconds = daysFromCivil(2000 + static_cast<int>(y), mo, d) * 86400L + h * 3600L +
+                  mi * 60L + s;
+        return true;
+    }
+    char *end = nullptr;
+    long  raw = strtol(line.c_str(), &end, 10);
+    if (end != line.c_str() && raw > 1000000000L && *end == ' ')
+    {
+        seconds = raw;
+        return true;
+    }
+    return false;
+}
+
+bool loadLog(const std::string &path, ReplayLog &log)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    log.name = std::filesystem::path(path).filename().string();
+
+    // First pass: keep the relevant lines with their second
+    struct Line
+    {
+        long        second;
+        uint8_t     kind;  // 0 sample, 1 tracking reset, 2 resume, 3 jam
+        float       expectedMm;
+        uint32_t    pulses;
+        float       sensorMm;
+        bool        hard;
+    };
+    std::vector<Line> lines;
+    std::string       text;
+    long              lastSecond = 0;
+    bool              haveSecond = false;
+    while (std::getline(in, text))
+    {
+        long second = 0;
+        if (lineSeconds(text, second))
+        {
+            lastSecond = second;
+            haveSecond = true;
+        }
+        if (!haveSecond)
+        {
+            continue;
+        }
+
+        Line line = {lastSecond, 0, 0.0f, 0, 0.0f, false};
+        if (text.find("Debug: sdcp_exp=") != std::string::npos)
+        {
+            if (!floatAfter(text, "sdcp_exp=", line.expectedMm) ||
+                !unsignedAfter(text, "pulses=", line.pulses))
+            {
+                continue;
+            }
+            floatAfter(text, "cumul_sns=", line.sensorMm);
+        }
+        else if (text.find("Filament tracking reset") != std::string::npos)
+        {
+            line.kind = 1;
+        }
+        else if (text.find("Motion sensor reset (resume") != std::string::npos)
+        {
+            line.kind = 2;
+        }
+        else if (text.find("Filament jam detected") != std::string::npos)
+        {
+            line.kind = 3;
+            line.hard = text.find("(hard") != std::string::npos;
+        }
+        else
+        {
+            continue;
+        }
+        lines.push_back(line);
+    }
+    if (lines.empty())
+    {
+        return false;
+    }
+
+    // Second pass: spread each second's lines over it and build the columns
+    const long origin       = lines.front().second;
+    bool       startPending = true;
+    float      lastExpected = 0.0f;
+    uint32_t   lastSampleMs = 0;
+    bool       haveSample   = false;
+    for (size_t i = 0; i < lines.size();)
+    {
+        size_t end = i;
+        while (end < lines.size() && lines[end].second == lines[i].second)
+        {
+            end++;
+        }
+        uint32_t count = static_cast<uint32_t>(end - i);
+        for (size_t j = i; j < end; j++)
+        {
+            const Line &line = lines[j];
+            uint32_t    t    = static_cast<uint32_t>((line.second - origin) * 1000L) +
+                         static_cast<uint32_t>((j - i) * 1000 / count);
+            switch (line.kind)
+            {
+                case 0:
+                    // The SDCP total dips a few mm when the printer retracts
+                    // for a pause; a new print restarts it near zero
+                    if (startPending ||
+                        (line.expectedMm < lastExpected * 0.5f && lastExpected > 10.0f))
+                    {
+                        log.timeMs.push_back(t);
+                        log.event.push_back(EVENT_PRINT_START);
+                        log.expectedMm.push_back(0.0f);
+                        log.pulses.push_back(0);
+                        startPending = false;
+                        haveSample   = false;
+                    }
+                    if (haveSample && t - lastSampleMs <= kMaxSampleGapMs)
+                    {
+                        log.printingMs += t - lastSampleMs;
+                    }
+                    log.timeMs.push_back(t);
+                    log.event.push_back(EVENT_SAMPLE);
+                    log.expectedMm.push_back(line.expectedMm);
+                    log.pulses.push_back(line.pulses);
+                    if (line.pulses > 0 && line.sensorMm > 0.0f)
+                    {
+                        log.mmPerPulse = line.sensorMm / static_cast<float>(line.pulses);
+                    }
+                    lastExpected = line.expectedMm;
+                    lastSampleMs = t;
+                    haveSample   = true;
+                    break;
+                case 1:
+                    startPending = true;
+                    break;
+                case 2:
+                    log.timeMs.push_back(t);
+                    log.event.push_back(EVENT_RESUME);
+                    log.expectedMm.push_back(0.0f);
+                    log.pulses.push_back(0);
+                    haveSample = false;
+                    break;
+                default:
+                    log.labels.push_back({t, line.hard});
+                    break;
+            }
+        }
+        i = end;
+    }
+    return !log.timeMs.empty();
+}
+
+// ============================================================================
+// Configurations and results
+// ============================================================================
+
+struct SweepConfig
+{
+    JamConfig           jam;
+    MotionWindowProfile window;
+};
+
+struct LogOutcome
+{
+    uint16_t detections;
+    uint16_t hits;            // Logged jams matched by a detection
+    uint16_t falsePositives;  // Detections matching no logged jam
+    int32_t  leadMsSum;       // Sum over hits of (label - detection); > 0 is earlier
+};
+
+const char *windowName(MotionWindowProfile window)
+{
+    switch (window)
+    {
+        case MotionWindowProfile::FAST:
+            return "fast";
+        case MotionWindowProfile::LONG:
+            return "long";
+        default:
+            return "standard";
+    }
+}
+
+struct Replayer
+{
+    SelectableMotionSensor sensor;
+    JamDetector            detector;
+
+    LogOutcome run(const ReplayLog &log, const SweepConfig &config, uint32_t matchMs)
+    {
+        LogOutcome outcome = {0, 0, 0, 0};
+        std::vector<bool> matched(log.labels.size(), false);
+
+        bool     printing     = false;  // Samples arriving
+        bool     paused       = false;  // Detected; waiting for resume or a new print
+        uint32_t printStartMs = 0;
+        uint32_t lastSampleMs = 0;
+        uint32_t nextTickMs   = 0;
+        uint32_t pulses       = 0;
+
+        sensor.select(config.window);
+
+        for (size_t i = 0; i < log.timeMs.size(); i++)
+        {
+            uint32_t t = log.timeMs[i];
+
+            // Detector ticks up to this event, while the print is live
+            while (printing && !paused && nextTickMs <= t &&
+                   nextTickMs <= lastSampleMs + kMaxSampleGapMs)
+            {
+                _mockMillis = nextTickMs;
+                MotionWindowTotals totals;
+                sensor->getWindowTotals(totals);
+                JamState state =
+                    detector.update(totals.expectedMm, totals.actualMm[0], pulses, true, true,
+                                    nextTickMs, printStartMs, config.jam, totals.expectedRate,
+                                    totals.actualRate[0]);
+                if (state.jammed)
+                {
+                    record(log, nextTickMs, matchMs, matched, outcome);
+                    detector.setPauseRequested();
+                    paused = true;
+                }
+                nextTickMs += kDetectorIntervalMs;
+            }
+
+            _mockMillis = t;
+            switch (log.event[i])
+            {
+                case EVENT_PRINT_START:
+                    sensor->reset();
+                    detector.reset(t);
+                    printStartMs = t;
+                    pulses       = 0;
+                    printing     = false;
+                    paused       = false;
+                    break;
+                case EVENT_RESUME:
+                    sensor->reset();
+                    detector.onResume(t, pulses, static_cast<float>(pulses) * log.mmPerPulse);
+                    detector.clearPauseRequest();
+                    printing = false;
+                    paused   = false;
+                    break;
+                default:
+                {
+                    sensor->updateExpectedPosition(log.expectedMm[i]);
+                    uint32_t total = log.pulses[i];
+                    if (total > pulses)
+                    {
+                        sensor->addSensorPulses(total - pulses, log.mmPerPulse, t);
+                    }
+                    pulses = total;
+                    if (!printing)
+                    {
+                        nextTickMs = t;
+                    }
+                    printing     = true;
+                    lastSampleMs = t;
+                    break;
+                }
+            }
+        }
+        return outcome;
+    }
+
+    static void record(const ReplayLog &log, uint32_t t, uint32_t matchMs,
+                       std::vector<bool> &matched, LogOutcome &outcome)
+    {
+        outcome.detections++;
+        for (size_t l = 0; l < log.labels.size(); l++)
+        {
+            long lead = static_cast<long>(log.labels[l].timeMs) - static_cast<long>(t);
+            if (!matched[l] && std::labs(lead) <= static_cast<long>(matchMs))
+            {
+                matched[l] = true;
+                outcome.hits++;
+                outcome.leadMsSum += static_cast<int32_t>(lead);
+                return;
+            }
+        }
+        outcome.falsePositives++;
+    }
+};
+
+// ============================================================================
+// Command line
+// ============================================================================
+
+bool parseGrid(const char *text, std::vector<double> &out)
+{
+    out.clear();
+    double first, last, step;
+    if (sscanf(text, "%lf:%lf:%lf", &first, &last, &step) == 3)
+    {
+        if (step <= 0.0 || last < first)
+        {
+            return false;
+        }
+        for (int i = 0; first + i * step <= last + step * 1e-6; i++)
+        {
+            out.push_back(first + i * step);
+        }
+        return true;
+    }
+    std::string list(text);
+    size_t      start = 0;
+    while (start <= list.size())
+    {
+        size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ? std::string::npos
+                                                                         : comma - start);
+        char  *end   = nullptr;
+        double value = strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0')
+        {
+            return false;
+        }
+        out.push_back(value);
+        if (comma == std::string::npos)
+        {
+            break;
+        }
+        start = comma + 1;
+    }
+    return !out.empty();
+}
+
+bool parseWindows(const char *text, std::vector<MotionWindowProfile> &out)
+{
+    out.clear();
+    std::string list(text);
+    size_t      start = 0;
+    for (;;)
+    {
+        size_t      comma = list.find(',', start);
+        std::string item  = list.substr(start, comma == std::string::npos ? std::string::npos
+                                                                          : comma - start);
+        if (item == "standard")
+            out.push_back(MotionWindowProfile::STANDARD);
+        else if (item == "fast")
+            out.push_back(MotionWindowProfile::FAST);
+        else if (item == "long")
+            out.push_back(MotionWindowProfile::LONG);
+        else
+            return false;
+        if (comma == std::string::npos)
+        {
+            return true;
+        }
+        start = comma + 1;
+    }
+}
+
+void usage()
+{
+    std::cout << "Usage: replay_sweep [LOG|DIR ...] [--ratio G] [--hard-mm G] [--soft-ms G]\n"
+                 "                    [--hard-ms G] [--grace-ms G] [--window LIST]\n"
+                 "                    [--match S] [--threads N] [--top N] [--csv PATH]\n"
+                 "G is \"a,b,c\" or \"first:last:step\"\n";
+}
+
+uint16_t clampMs(double value)
+{
+    return static_cast<uint16_t>(std::min(65535.0, std::max(0.0, value)));
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    // Grid centred on the firmware defaults (SettingsManager): ratio 0.40,
+    // hard 12 mm / 3 s, soft 10 s, 18 s grace, standard window
+    std::vector<double>              ratios  = {0.30, 0.35, 0.40, 0.45, 0.50, 0.55, 0.60, 0.65, 0.70};
+    std::vector<double>              hardMms = {4, 6, 8, 10, 12, 14, 16};
+    std::vector<double>              softMs  = {4000, 6000, 8000, 10000, 12000};
+    std::vector<double>              hardMs  = {1000, 2000, 3000, 4000};
+    std::vector<double>              graceMs = {18000};
+    std::vector<MotionWindowProfile> windows = {MotionWindowProfile::STANDARD,
+                                                MotionWindowProfile::FAST,
+                                                MotionWindowProfile::LONG};
+    std::vector<std::string> inputs;
+    double      matchSeconds = 30.0;
+    unsigned    threads      = std::max(1u, std::thread::hardware_concurrency());
+    size_t      top          = 10;
+    const char *csvPath      = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg      = argv[i];
+        const char *value    = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool        ok       = true;
+        bool        consumed = true;
+        if (strcmp(arg, "--ratio") == 0 && value)
+            ok = parseGrid(value, ratios);
+        else if (strcmp(arg, "--hard-mm") == 0 && value)
+            ok = parseGrid(value, hardMms);
+        else if (strcmp(arg, "--soft-ms") == 0 && value)
+            ok = parseGrid(value, softMs);
+        else if (strcmp(arg, "--hard-ms") == 0 && value)
+            ok = parseGrid(value, hardMs);
+        else if (strcmp(arg, "--grace-ms") == 0 && value)
+            ok = parseGrid(value, graceMs);
+        else if (strcmp(arg, "--window") == 0 && value)
+            ok = parseWindows(value, windows);
+        else if (strcmp(arg, "--match") == 0 && value)
+            matchSeconds = atof(value);
+        else if (strcmp(arg, "--threads") == 0 && value)
+            threads = static_cast<unsigned>(std::max(1, atoi(value)));
+        else if (strcmp(arg, "--top") == 0 && value)
+            top = static_cast<size_t>(std::max(0, atoi(value)));
+        else if (strcmp(arg, "--csv") == 0 && value)
+            csvPath = value;
+        else if (arg[0] != '-')
+        {
+            inputs.push_back(arg);
+            consumed = false;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+        if (!ok)
+        {
+            std::cout << "Bad value for " << arg << ": " << value << "\n";
+            return 2;
+        }
+        if (consumed)
+        {
+            i++;
+        }
+    }
+    if (inputs.empty())
+    {
+        inputs.push_back("fixtures/logs_to_replay");
+    }
+
+    typedef std::chrono::steady_clock clock;
+
+    // Parse every log once
+    clock::time_point      parseStart = clock::now();
+    std::vector<ReplayLog> logs;
+    for (const std::string &input : inputs)
+    {
+        std::vector<std::string> paths;
+        if (std::filesystem::is_directory(input))
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(input))
+            {
+                if (entry.is_regular_file())
+                {
+                    paths.push_back(entry.path().string());
+                }
+            }
+            std::sort(paths.begin(), paths.end());
+        }
+        else
+        {
+            paths.push_back(input);
+        }
+        for (const std::string &path : paths)
+        {
+            ReplayLog log;
+            if (loadLog(path, log))
+            {
+                logs.push_back(std::move(log));
+            }
+            else
+            {
+                std::cout << "Skipping " << path << " (no flow samples)\n";
+            }
+        }
+    }
+    double parseMs = std::chrono::duration<double, std::milli>(clock::now() - parseStart).count();
+    if (logs.empty())
+    {
+        std::cout << "No logs to replay\n";
+        return 1;
+    }
+
+    // Configuration grid
+    std::vector<SweepConfig> configs;
+    for (MotionWindowProfile window : windows)
+        for (double grace : graceMs)
+            for (double hardTime : hardMs)
+                for (double softTime : softMs)
+                    for (double hardMm : hardMms)
+                        for (double ratio : ratios)
+                        {
+                            SweepConfig config;
+                            config.window             = window;
+                            config.jam.ratioThreshold = static_cast<float>(ratio);
+                            config.jam.hardJamMm      = static_cast<float>(hardMm);
+                            config.jam.softJamTimeMs  = clampMs(softTime);
+                            config.jam.hardJamTimeMs  = clampMs(hardTime);
+                            config.jam.graceTimeMs    = clampMs(grace);
+                            config.jam.detectionMode  = DetectionMode::BOTH;
+                            configs.push_back(config);
+                        }
+
+    size_t   labelTotal = 0;
+    uint64_t samples    = 0;
+    double   printHours = 0.0;
+    std::cout << "Logs:\n";
+    for (const ReplayLog &log : logs)
+    {
+        labelTotal += log.labels.size();
+        samples += log.timeMs.size();
+        printHours += log.printingMs / 3600000.0;
+        printf("  %-36s %7zu events %3zu jams  %6.1f min printing  %.2f mm/pulse\n",
+               log.name.c_str(), log.timeMs.size(), log.labels.size(), log.printingMs / 60000.0,
+               log.mmPerPulse);
+    }
+
+    // Replay: workers take configurations off a shared counter; each writes
+    // its own rows of the matrix
+    const uint32_t          matchMs = static_cast<uint32_t>(matchSeconds * 1000.0);
+    std::vector<LogOutcome> matrix(configs.size() * logs.size());
+    std::atomic<size_t>     nextConfig(0);
+    threads = static_cast<unsigned>(std::min<size_t>(threads, configs.size()));
+
+    clock::time_point        sweepStart = clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < threads; w++)
+    {
+        workers.emplace_back([&]() {
+            Replayer replayer;
+            for (size_t c = nextConfig.fetch_add(1); c < configs.size();
+                 c = nextConfig.fetch_add(1))
+            {
+                for (size_t l = 0; l < logs.size(); l++)
+                {
+                    matrix[c * logs.size() + l] = replayer.run(logs[l], configs[c], matchMs);
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    double sweepMs = std::chrono::duration<double, std::milli>(clock::now() - sweepStart).count();
+
+    // Rank: most logged jams caught, then fewest false positives, then earliest
+    struct Summary
+    {
+        size_t config;
+        int    hits;
+        int    falsePositives;
+        double meanLeadMs;
+    };
+    std::vector<Summary> summaries(configs.size());
+    for (size_t c = 0; c < configs.size(); c++)
+    {
+        Summary &s = summaries[c];
+        s          = {c, 0, 0, 0.0};
+        long lead  = 0;
+        for (size_t l = 0; l < logs.size(); l++)
+        {
+            const LogOutcome &o = matrix[c * logs.size() + l];
+            s.hits += o.hits;
+            s.falsePositives += o.falsePositives;
+            lead += o.leadMsSum;
+        }
+        s.meanLeadMs = s.hits > 0 ? static_cast<double>(lead) / s.hits : 0.0;
+    }
+    std::vector<Summary> ranked = summaries;
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Summary &a, const Summary &b) {
+        if (a.hits != b.hits)
+            return a.hits > b.hits;
+        if (a.falsePositives != b.falsePositives)
+            return a.falsePositives < b.falsePositives;
+        return a.meanLeadMs > b.meanLeadMs;
+    });
+
+    auto describe = [&](const Summary &s) {
+        const SweepConfig &config = configs[s.config];
+        printf("  %-8s ratio=%.2f hard=%4.1fmm/%4ums soft=%5ums grace=%5ums  "
+               "caught %d/%zu  false %d  lead %+.1fs\n",
+               windowName(config.window), config.jam.ratioThreshold, config.jam.hardJamMm,
+               config.jam.hardJamTimeMs, config.jam.softJamTimeMs, config.jam.graceTimeMs, s.hits,
+               labelTotal, s.falsePositives, s.meanLeadMs / 1000.0);
+    };
+
+    std::cout << "\nBest " << std::min(top, ranked.size()) << " of " << configs.size()
+              << " configurations:\n";
+    for (size_t i = 0; i < std::min(top, ranked.size()); i++)
+    {
+        describe(ranked[i]);
+    }
+
+    // The firmware defaults, if the grid holds them
+    for (const Summary &s : summaries)
+    {
+        const SweepConfig &config = configs[s.config];
+        if (config.window == MotionWindowProfile::STANDARD &&
+            std::fabs(config.jam.ratioThreshold - 0.40f) < 1e-4f &&
+            std::fabs(config.jam.hardJamMm - 12.0f) < 1e-4f && config.jam.hardJamTimeMs == 3000 &&
+            config.jam.softJamTimeMs == 10000 && config.jam.graceTimeMs == 18000)
+        {
+            std::cout << "Firmware defaults:\n";
+            describe(s);
+            break;
+        }
+    }
+
+    double replays = static_cast<double>(configs.size()) * logs.size();
+    printf("\nTiming: parse %.1f ms (%llu events), sweep %.1f ms on %u thread(s)\n", parseMs,
+           static_cast<unsigned long long>(samples), sweepMs, threads);
+    printf("        %.0f log replays/s, %.0f simulated print-hours per second\n",
+           replays / (sweepMs / 1000.0), printHours * configs.size() / (sweepMs / 1000.0));
+
+    if (csvPath != nullptr)
+    {
+        FILE *csv = fopen(csvPath, "w");
+        if (csv == nullptr)
+        {
+            std::cout << "Could not write " << csvPath << "\n";
+            return 1;
+        }
+        fprintf(csv, "window,ratio,hard_mm,hard_ms,soft_ms,grace_ms,caught,jams,false_positives,"
+                     "mean_lead_ms");
+        for (const ReplayLog &log : logs)
+        {
+            fprintf(csv, ",%s:caught,%s:false", log.name.c_str(), log.name.c_str());
+        }
+        fprintf(csv, "\n");
+        for (const Summary &s : summaries)
+        {
+            const SweepConfig &config = configs[s.config];
+            fprintf(csv, "%s,%.3f,%.2f,%u,%u,%u,%d,%zu,%d,%.0f", windowName(config.window),
+                    config.jam.ratioThreshold, config.jam.hardJamMm, config.jam.hardJamTimeMs,
+                    config.jam.softJamTimeMs, config.jam.graceTimeMs, s.hits, labelTotal,
+                    s.falsePositives, s.meanLeadMs);
+            for (size_t l = 0; l < logs.size(); l++)
+            {
+                const LogOutcome &o = matrix[s.config * logs.size() + l];
+                fprintf(csv, ",%u,%u", o.hits, o.falsePositives);
+            }
+            fprintf(csv, "\n");
+        }
+        fclose(csv);
+        std::cout << "Wrote " << csvPath << "\n";
+    }
+    return 0;
+}
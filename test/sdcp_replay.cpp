@@ -0,0 +1,895 @@
+/**
+ * SDCP Replay - accelerated end-to-end load generator for jam detection
+ *
+ * Replays SDCP status traffic and a synthetic pulse stream through the
+ * firmware's task layout, in real time compressed by --speed, and measures
+ * how detection holds up:
+ *
+ *   printer thread    emits status frames at their recorded times into a
+ *                     bounded receive queue (--queue frames, the WebSocket
+ *                     client's buffering; a full queue drops the frame).
+ *                     Pauses when asked, resumes --pause-s later.
+ *   pulse thread      the ISR: counts pulses for the filament that actually
+ *                     moves and pushes their times into a PulseTimestampRing.
+ *                     Injected jams stop it until the printer resumes.
+ *   main thread       ElegooCC::loop(): one frame per pass through the
+ *                     handleStatus() steps (status transitions, resume,
+ *                     TotalExtrusion into the motion sensor), then
+ *                     shouldPausePrint() and pausePrint()
+ *   detection thread  ElegooCC::detectionTaskEntry(): drains pulses every
+ *                     DETECTION_TASK_PERIOD_MS and runs JamDetector::update()
+ *                     at JAM_DETECTOR_UPDATE_INTERVAL_MS, under one mutex
+ *                     with the main thread as on the device
+ *
+ * The motion sensor (SelectableMotionSensor) and JamDetector are the real
+ * ones; every period is divided by --speed, so a run at 100x asks the host
+ * for 100 times the firmware's per-second work. Reported per speed:
+ *   - jam onset to pausePrint() latency (simulated ms) p50/p90/p99/max and
+ *     the jams never paused; detect-to-pause handoff (wall us)
+ *   - frames dropped at the queue, frame emission lag, detector cadence
+ *   - frame decode time on the main thread
+ * followed by the decoder's peak throughput over the whole traffic.
+ *
+ * The device parses with ArduinoJson and SDCPProtocol::messageFilter();
+ * this host build has only the JSON mocks, so frames are decoded by a key
+ * scanner reading the same fields. Its throughput is a host figure, not
+ * the firmware's parse cost (PERF_SDCP_JSON_PARSE in /api/perf is).
+ *
+ * Traffic is synthetic by default (a print with a varying flow rate), or a
+ * recording of one frame per line, "<ms>\t<json>", e.g. from G-code:
+ *   python ../tools/gcode_flow_sim.py ../tools/cubewithironing.gcode --record frames.tsv
+ *
+ * Build and run:
+ *   g++ -std=c++17 -O2 -I. -I./mocks -I../src -pthread -o sdcp_replay sdcp_replay.cpp
+ *   ./sdcp_replay                                    # synthetic, 20x/50x/100x
+ *   ./sdcp_replay --frames frames.tsv --speed 1,10,100 --jam-every 45
+ *
+ * Options: --speed LIST, --frames PATH, --duration S (synthetic, default 180),
+ * --interval-ms N (synthetic frame interval, 500), --pad BYTES (extra bytes
+ * per synthetic frame), --jam-every S (30), --pause-s S (5), --queue N (8),
+ * --slip F (sensor slip fraction, 0.05), --mm-per-pulse F (3.055)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Simulated clock
+// ============================================================================
+
+// millis() from the mocks reads _mockMillis; here it is the wall time since
+// the run started, times the replay speed, read fresh on every call
+namespace
+{
+typedef std::chrono::steady_clock WallClock;
+WallClock::time_point gRunStart = WallClock::now();
+double                gSpeed    = 1.0;
+
+unsigned long simNowMs()
+{
+    double wallMs = std::chrono::duration<double, std::milli>(WallClock::now() - gRunStart).count();
+    return static_cast<unsigned long>(wallMs * gSpeed);
+}
+
+// Sleep for `simMs` of simulated time
+void simSleep(double simMs)
+{
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(simMs / gSpeed));
+}
+
+// Sleep until simulated time `simMs`
+void simSleepUntil(unsigned long simMs)
+{
+    std::this_thread::sleep_until(
+        gRunStart + std::chrono::duration_cast<WallClock::duration>(
+                        std::chrono::duration<double, std::milli>(simMs / gSpeed)));
+}
+
+int64_t wallNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(WallClock::now().time_since_epoch())
+        .count();
+}
+}  // namespace
+
+unsigned long *simClock()
+{
+    thread_local unsigned long now = 0;
+    now                            = simNowMs();
+    return &now;
+}
+#define _mockMillis (*simClock())
+
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/Arduino.h"
+
+#include "../src/FilamentMotionSensor.h"
+#include "../src/FilamentMotionSensor.cpp"
+#include "../src/JamDetector.h"
+#include "../src/JamDetector.cpp"
+#include "../src/PulseTimestampRing.h"
+
+namespace
+{
+// ElegooCC timing (ElegooCC.h, SDCPProtocol.h)
+const unsigned long kDetectionPeriodMs  = 10;
+const unsigned long kJamUpdateMs        = 250;
+const unsigned long kMainLoopMs         = 1;
+const unsigned long kPauseRearmMs       = 3000;
+const unsigned long kJamGiveUpMs        = 60000;  // A jam not paused by then counts as missed
+const unsigned long kGraceMs            = 18000;  // detection_grace_period_ms default
+
+// SDCP codes (ElegooCC.h)
+const int kStatusPaused   = 6;
+const int kStatusPrinting = 13;
+const int kMachinePrinting = 1;
+
+const char kTotalExtrusionHexKey[] = "\"54 6F 74 61 6C 45 78 74 72 75 73 69 6F 6E 00\"";
+
+// ============================================================================
+// Frames
+// ============================================================================
+
+struct Frame
+{
+    unsigned long ms;     // Print time the printer sends it at
+    std::string   text;
+    float         total;  // TotalExtrusion (last known when the frame has none)
+};
+
+struct DecodedFrame
+{
+    bool  hasPrintInfo;
+    int   printStatus;
+    bool  machinePrinting;
+    bool  hasTotal;
+    float total;
+};
+
+// Number after "key": somewhere in [from, end)
+bool numberAfter(const char *from, const char *key, double &out)
+{
+    const char *at = strstr(from, key);
+    if (at == nullptr)
+    {
+        return false;
+    }
+    at += strlen(key);
+    while (*at == ' ' || *at == ':')
+    {
+        at++;
+    }
+    char *end = nullptr;
+    out       = strtod(at, &end);
+    return end != at;
+}
+
+// Reads what handleStatus() takes from a status frame
+bool decodeFrame(const char *text, DecodedFrame &frame)
+{
+    frame = DecodedFrame{false, -1, false, false, 0.0f};
+    const char *status = strstr(text, "\"Status\"");
+    if (status == nullptr)
+    {
+        return false;
+    }
+
+    const char *machine = strstr(status, "\"CurrentStatus\"");
+    if (machine != nullptr)
+    {
+        const char *open  = strchr(machine, '[');
+        const char *close = open ? strchr(open, ']') : nullptr;
+        for (const char *p = open; p != nullptr && p < close; p++)
+        {
+            if (*p >= '0' && *p <= '9')
+            {
+                char *end = nullptr;
+                long  v   = strtol(p, &end, 10);
+                frame.machinePrinting = frame.machinePrinting || v == kMachinePrinting;
+                p = end - 1;
+            }
+        }
+    }
+
+    const char *printInfo = strstr(status, "\"PrintInfo\"");
+    if (printInfo != nullptr)
+    {
+        frame.hasPrintInfo = true;
+        double value;
+        if (numberAfter(printInfo, "\"Status\"", value))
+        {
+            frame.printStatus = static_cast<int>(value);
+        }
+        if (numberAfter(printInfo, "\"TotalExtrusion\"", value) ||
+            numberAfter(printInfo, kTotalExtrusionHexKey, value))
+        {
+            frame.hasTotal = true;
+            frame.total    = static_cast<float>(value);
+        }
+    }
+    return true;
+}
+
+std::string buildFrame(int printStatus, float total, float delta, unsigned long ticks,
+                       size_t pad)
+{
+    char head[1024];
+    snprintf(head, sizeof(head),
+             "{\"Topic\":\"sdcp/status/REPLAY\",\"Status\":{\"CurrentStatus\":[1],"
+             "\"TimeLapseStatus\":0,\"PlatFormType\":0,\"TempOfHotbed\":60.1,"
+             "\"TempOfNozzle\":219.8,\"TempOfBox\":31.0,\"TempTargetHotbed\":60,"
+             "\"TempTargetNozzle\":220,\"TempTargetBox\":0,\"CurrenCoord\":\"112.40,98.75,%.2f\","
+             "\"CurrentFanSpeed\":{\"ModelFan\":100,\"ModeFan\":100,\"AuxiliaryFan\":0,"
+             "\"BoxFan\":0},\"ZOffset\":0.0,\"LightStatus\":{\"SecondLight\":1,"
+             "\"RgbLight\":[0,0,0]},\"PrintInfo\":{\"Status\":%d,\"CurrentLayer\":%lu,"
+             "\"TotalLayer\":400,\"CurrentTicks\":%lu,\"TotalTicks\":7200,"
+             "\"Filename\":\"replay.gcode\",\"ErrorNumber\":0,\"TaskId\":\"replay-0001\","
+             "\"PrintSpeedPct\":100,\"Progress\":0,\"TotalExtrusion\":%.4f,"
+             "\"CurrentExtrusion\":%.4f}",
+             0.2 + ticks / 30000.0, printStatus, ticks / 30000UL, ticks / 1000UL, total, delta);
+    std::string text(head);
+    if (pad > 0)
+    {
+        text += ",\"Padding\":\"";
+        text.append(pad, 'x');
+        text += "\"";
+    }
+    text += "},\"MainboardID\":\"REPLAY0000000000\",\"TimeStamp\":0}";
+    return text;
+}
+
+std::vector<Frame> syntheticTraffic(double durationS, unsigned long intervalMs, size_t pad)
+{
+    std::vector<Frame> frames;
+    float              total = 0.0f;
+    for (unsigned long ms = 0; ms <= static_cast<unsigned long>(durationS * 1000.0); ms += intervalMs)
+    {
+        // 1-8 mm/s, changing over tens of seconds like infill vs perimeters
+        double t     = ms / 1000.0;
+        double rate  = 4.5 + 2.5 * sin(t / 7.0) + 1.0 * sin(t / 2.3);
+        float  delta = static_cast<float>(rate * intervalMs / 1000.0);
+        total += delta;
+        frames.push_back({ms, buildFrame(kStatusPrinting, total, delta, ms, pad), total});
+    }
+    return frames;
+}
+
+bool loadTraffic(const char *path, std::vector<Frame> &frames)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        return false;
+    }
+    std::string line;
+    float       total = 0.0f;
+    while (std::getline(in, line))
+    {
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos)
+        {
+            continue;
+        }
+        Frame frame;
+        frame.ms   = strtoul(line.c_str(), nullptr, 10);
+        frame.text = line.substr(tab + 1);
+        DecodedFrame decoded;
+        if (decodeFrame(frame.text.c_str(), decoded) && decoded.hasTotal)
+        {
+            total = decoded.total;
+        }
+        frame.total = total;
+        frames.push_back(frame);
+    }
+    return !frames.empty();
+}
+
+// TotalExtrusion at print time `ms`, interpolated between frames
+float extrudedAt(const std::vector<Frame> &frames, unsigned long ms)
+{
+    auto after = std::upper_bound(frames.begin(), frames.end(), ms,
+                                  [](unsigned long t, const Frame &f) { return t < f.ms; });
+    if (after == frames.begin())
+    {
+        return 0.0f;
+    }
+    if (after == frames.end())
+    {
+        return frames.back().total;
+    }
+    const Frame &before = *(after - 1);
+    float        span   = static_cast<float>(after->ms - before.ms);
+    float        part   = span > 0 ? (ms - before.ms) / span : 1.0f;
+    return before.total + (after->total - before.total) * part;
+}
+
+// ============================================================================
+// Printer side: queue, pause/resume, pulses
+// ============================================================================
+
+struct FrameQueue
+{
+    std::mutex              lock;
+    std::deque<std::string> frames;
+    size_t                  capacity = 8;
+    unsigned long           dropped  = 0;
+
+    void push(const std::string &frame)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (frames.size() >= capacity)
+        {
+            dropped++;
+            return;
+        }
+        frames.push_back(frame);
+    }
+
+    bool pop(std::string &out)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (frames.empty())
+        {
+            return false;
+        }
+        out = std::move(frames.front());
+        frames.pop_front();
+        return true;
+    }
+};
+
+struct Jam
+{
+    unsigned long onsetMs;  // Simulated
+    unsigned long pausedMs;  // 0 until pausePrint()
+};
+
+// State owned by the simulated printer, read by the pulse and main threads
+struct Printer
+{
+    std::mutex    lock;
+    unsigned long pausedTotalMs = 0;  // Simulated time spent paused
+    unsigned long pausedAtMs    = 0;
+    bool          paused        = false;
+    bool          pauseRequested = false;
+    bool          jamActive     = false;
+    std::vector<Jam> jams;
+
+    // Print time (frozen while paused)
+    unsigned long playMs(unsigned long now)
+    {
+        return (paused ? pausedAtMs : now) - pausedTotalMs;
+    }
+};
+
+// ============================================================================
+// One run
+// ============================================================================
+
+struct Options
+{
+    std::vector<double> speeds     = {20, 50, 100};
+    const char         *framesPath = nullptr;
+    double              durationS  = 180;
+    unsigned long       intervalMs = 500;
+    size_t              pad        = 0;
+    double              jamEveryS  = 30;
+    double              pauseS     = 5;
+    size_t              queue      = 8;
+    float               slip       = 0.05f;
+    float               mmPerPulse = 3.055f;
+};
+
+struct RunResult
+{
+    double                     speed;
+    unsigned long              framesSent;
+    unsigned long              framesDropped;
+    unsigned long              framesDecoded;
+    double                     decodeNsTotal;
+    std::vector<double>        jamToPauseMs;
+    unsigned long              jamsMissed;  // Not paused within kJamGiveUpMs
+    unsigned long              jamsOpen;    // Still unpaused when the traffic ended
+    std::vector<double>        handoffUs;
+    std::vector<double>        emitLagMs;
+    std::vector<double>        cadenceMs;
+    unsigned long              pulses;
+    double                     wallS;
+};
+
+double percentile(std::vector<double> values, double pct)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * values.size()));
+    return values[rank == 0 ? 0 : rank - 1];
+}
+
+RunResult runReplay(const std::vector<Frame> &frames, const Options &options, double speed)
+{
+    gSpeed    = speed;
+    gRunStart = WallClock::now();
+
+    RunResult result = {};
+    result.speed     = speed;
+
+    FrameQueue queue;
+    queue.capacity = options.queue;
+    Printer    printer;
+    std::atomic<bool> done(false);
+
+    // ISR side
+    std::atomic<unsigned long> pulseCount(0);
+    PulseTimestampRing<256>    pulseTimes;
+
+    // Detection state, shared under detectionLock as in ElegooCC
+    std::mutex             detectionLock;
+    SelectableMotionSensor sensor;
+    JamDetector            detector;
+    JamConfig              config;
+    config.ratioThreshold = 0.40f;  // SettingsManager defaults
+    config.hardJamMm      = 12.0f;
+    config.softJamTimeMs  = 10000;
+    config.hardJamTimeMs  = 3000;
+    config.graceTimeMs    = kGraceMs;
+    config.detectionMode  = DetectionMode::BOTH;
+    unsigned long movementPulses  = 0;
+    float         actualMm        = 0.0f;
+    bool          trackingFrozen  = false;
+    bool          filamentStopped = false;
+    bool          telemetry       = false;
+    bool          printing        = false;
+    unsigned long startedAt       = 0;
+    std::atomic<int64_t> detectedWallNs(0);
+
+    sensor.select(MotionWindowProfile::STANDARD);
+    sensor->reset();
+    detector.reset(0);
+
+    // --- printer ---
+    std::thread printerThread([&]() {
+        for (const Frame &frame : frames)
+        {
+            for (;;)
+            {
+                unsigned long now = simNowMs();
+                std::unique_lock<std::mutex> guard(printer.lock);
+                if (printer.pauseRequested && !printer.paused)
+                {
+                    printer.paused     = true;
+                    printer.pausedAtMs = now;
+                    guard.unlock();
+                    queue.push(buildFrame(kStatusPaused, frame.total, 0.0f, frame.ms, 0));
+                    result.framesSent++;
+                    simSleep(options.pauseS * 1000.0);
+
+                    guard.lock();
+                    now = simNowMs();
+                    printer.pausedTotalMs += now - printer.pausedAtMs;
+                    printer.paused         = false;
+                    printer.pauseRequested = false;
+                    printer.jamActive      = false;  // Cleared while paused
+                    guard.unlock();
+                    queue.push(buildFrame(kStatusPrinting, frame.total, 0.0f, frame.ms, 0));
+                    result.framesSent++;
+                    continue;
+                }
+                unsigned long due = frame.ms + printer.pausedTotalMs;
+                guard.unlock();
+                if (now >= due)
+                {
+                    result.emitLagMs.push_back(static_cast<double>(now - due));
+                    break;
+                }
+                // Wake for pause requests while waiting
+                simSleepUntil(std::min(due, now + 50));
+            }
+            queue.push(frame.text);
+            result.framesSent++;
+        }
+        simSleep(1000.0);  // Let the last frames drain
+        done = true;
+    });
+
+    // --- pulses (ISR) ---
+    std::thread pulseThread([&]() {
+        double        movedMm      = 0.0;
+        float         lastExtruded = 0.0f;
+        unsigned long emitted      = 0;
+        size_t        nextJam      = 1;
+        while (!done)
+        {
+            unsigned long now = simNowMs();
+            float         extruded;
+            bool          jammed;
+            {
+                std::lock_guard<std::mutex> guard(printer.lock);
+                unsigned long play = printer.playMs(now);
+                extruded           = extrudedAt(frames, play);
+                if (!printer.jamActive && !printer.paused &&
+                    play >= nextJam * options.jamEveryS * 1000.0 + config.graceTimeMs)
+                {
+                    printer.jamActive = true;
+                    printer.jams.push_back({now, 0});
+                    nextJam++;
+                }
+                if (printer.jamActive && !printer.jams.empty() &&
+                    printer.jams.back().pausedMs == 0 &&
+                    now - printer.jams.back().onsetMs > kJamGiveUpMs)
+                {
+                    printer.jamActive = false;  // Never paused
+                }
+                jammed = printer.jamActive;
+            }
+            if (!jammed && extruded > lastExtruded)
+            {
+                movedMm += (extruded - lastExtruded) * (1.0f - options.slip);
+            }
+            lastExtruded = extruded;
+
+            unsigned long total = static_cast<unsigned long>(movedMm / options.mmPerPulse);
+            for (; emitted < total; emitted++)
+            {
+                pulseTimes.push(static_cast<uint32_t>(now));
+                pulseCount.fetch_add(1, std::memory_order_release);
+            }
+            simSleep(5.0);
+        }
+    });
+
+    // --- detection task ---
+    std::thread detectionThread([&]() {
+        unsigned long lastIsr    = 0;
+        unsigned long lastUpdate = 0;
+        bool          armed      = false;  // Cadence is measured between armed updates
+        while (!done)
+        {
+            unsigned long now     = simNowMs();
+            unsigned long current = pulseCount.load(std::memory_order_acquire);
+            unsigned long fresh   = current - lastIsr;
+            lastIsr               = current;
+
+            std::lock_guard<std::mutex> guard(detectionLock);
+            if (trackingFrozen)
+            {
+                pulseTimes.clear();
+            }
+            else if (fresh > 0)
+            {
+                // Stamped pulses coalesced per bucket, the rest at now (drainChannelPulses)
+                unsigned long bucketMs = sensor->getBucketSizeMs();
+                unsigned long runCount = 0;
+                unsigned long runMs    = 0;
+                unsigned long stamped  = 0;
+                uint32_t      pulseMs;
+                while (stamped < fresh && pulseTimes.pop(pulseMs))
+                {
+                    if (runCount > 0 && pulseMs / bucketMs != runMs / bucketMs)
+                    {
+                        sensor->addSensorPulses(runCount, options.mmPerPulse, runMs);
+                        runCount = 0;
+                    }
+                    runMs = pulseMs;
+                    runCount++;
+                    stamped++;
+                }
+                if (runCount > 0)
+                {
+                    sensor->addSensorPulses(runCount, options.mmPerPulse, runMs);
+                }
+                if (fresh > stamped)
+                {
+                    sensor->addSensorPulses(fresh - stamped, options.mmPerPulse, now);
+                }
+                movementPulses += fresh;
+                actualMm += fresh * options.mmPerPulse;
+                result.pulses += fresh;
+            }
+
+            if (!printing || !telemetry || trackingFrozen)
+            {
+                armed = false;
+            }
+            else if (now - lastUpdate >= kJamUpdateMs)
+            {
+                if (armed)
+                {
+                    result.cadenceMs.push_back(static_cast<double>(now - lastUpdate));
+                }
+                armed      = true;
+                lastUpdate = now;
+                MotionWindowTotals totals;
+                sensor->getWindowTotals(totals);
+                JamState state = detector.update(totals.expectedMm, totals.actualMm[0],
+                                                 movementPulses, true, true, now, startedAt,
+                                                 config, totals.expectedRate,
+                                                 totals.actualRate[0]);
+                if (!detector.isPauseRequested())
+                {
+                    if (state.jammed && !filamentStopped)
+                    {
+                        detectedWallNs = wallNs();
+                    }
+                    filamentStopped = state.jammed;
+                }
+            }
+            simSleep(static_cast<double>(kDetectionPeriodMs));
+        }
+    });
+
+    // --- main loop (this thread) ---
+    int           printStatus   = 0;
+    bool          hasBeenPaused = false;
+    unsigned long lastPauseMs   = 0;
+    std::string   text;
+    while (!done)
+    {
+        if (queue.pop(text))
+        {
+            int64_t      start = wallNs();
+            DecodedFrame frame;
+            bool         ok = decodeFrame(text.c_str(), frame);
+            result.decodeNsTotal += static_cast<double>(wallNs() - start);
+            result.framesDecoded++;
+
+            unsigned long now = simNowMs();
+            if (ok && frame.hasPrintInfo)
+            {
+                if (frame.printStatus != printStatus)
+                {
+                    std::lock_guard<std::mutex> guard(detectionLock);
+                    if (frame.printStatus == kStatusPaused)
+                    {
+                        hasBeenPaused = true;
+                        if (detector.isPauseRequested())
+                        {
+                            trackingFrozen = true;
+                        }
+                    }
+                    else if (frame.printStatus == kStatusPrinting)
+                    {
+                        if (detector.isPauseRequested() || hasBeenPaused)
+                        {
+                            // Resume
+                            trackingFrozen = false;
+                            sensor->reset();
+                            detector.onResume(now, movementPulses, actualMm);
+                            filamentStopped = false;
+                            hasBeenPaused   = false;
+                        }
+                        else if (startedAt == 0)
+                        {
+                            startedAt = now;
+                            sensor->reset();
+                            detector.reset(now);
+                        }
+                    }
+                    printStatus = frame.printStatus;
+                }
+
+                std::lock_guard<std::mutex> guard(detectionLock);
+                printing = printStatus == kStatusPrinting && frame.machinePrinting;
+                if (frame.hasTotal)
+                {
+                    sensor->updateExpectedPosition(frame.total);
+                    telemetry = true;
+                }
+            }
+        }
+
+        // shouldPausePrint() -> pausePrint()
+        unsigned long now = simNowMs();
+        bool          pause;
+        {
+            std::lock_guard<std::mutex> guard(detectionLock);
+            pause = printing && filamentStopped && !detector.isPauseRequested() &&
+                    now - startedAt >= config.graceTimeMs &&
+                    (lastPauseMs == 0 || now - lastPauseMs >= kPauseRearmMs);
+            if (pause)
+            {
+                detector.setPauseRequested();
+            }
+        }
+        if (pause)
+        {
+            int64_t handoff = wallNs() - detectedWallNs.load();
+            lastPauseMs     = now;
+            std::lock_guard<std::mutex> guard(printer.lock);
+            printer.pauseRequested = true;
+            if (printer.jamActive && printer.jams.back().pausedMs == 0)
+            {
+                printer.jams.back().pausedMs = now;
+                result.jamToPauseMs.push_back(
+                    static_cast<double>(now - printer.jams.back().onsetMs));
+                result.handoffUs.push_back(handoff / 1000.0);
+            }
+        }
+        simSleep(static_cast<double>(kMainLoopMs));
+    }
+
+    printerThread.join();
+    pulseThread.join();
+    detectionThread.join();
+
+    result.framesDropped = queue.dropped;
+    unsigned long endMs  = simNowMs();
+    for (const Jam &jam : printer.jams)
+    {
+        if (jam.pausedMs == 0)
+        {
+            (endMs - jam.onsetMs > kJamGiveUpMs ? result.jamsMissed : result.jamsOpen)++;
+        }
+    }
+    result.wallS = std::chrono::duration<double>(WallClock::now() - gRunStart).count();
+    return result;
+}
+
+// ============================================================================
+// Report
+// ============================================================================
+
+void printResult(const RunResult &r)
+{
+    std::vector<double> lat = r.jamToPauseMs;
+    printf("%6.0fx %7lu %5lu %8.0f | %5zu %4lu %4lu %7.0f %7.0f %7.0f %7.0f | %7.0f %7.1f | %6.0f %6.0f\n",
+           r.speed, r.framesSent, r.framesDropped,
+           r.framesDecoded ? r.decodeNsTotal / r.framesDecoded : 0.0,
+           lat.size() + r.jamsMissed + r.jamsOpen, r.jamsMissed, r.jamsOpen, percentile(lat, 50), percentile(lat, 90), percentile(lat, 99),
+           percentile(lat, 100), percentile(r.handoffUs, 50), percentile(r.emitLagMs, 99),
+           percentile(r.cadenceMs, 99), percentile(r.cadenceMs, 100));
+}
+
+void decoderThroughput(const std::vector<Frame> &frames)
+{
+    size_t bytes = 0;
+    for (const Frame &frame : frames)
+    {
+        bytes += frame.text.size();
+    }
+
+    // Whole traffic decoded repeatedly for at least 200 ms, fastest pass kept
+    double bestNs  = 0;
+    double spentMs = 0;
+    int    passes  = 0;
+    while (spentMs < 200.0 || passes < 3)
+    {
+        int64_t start = wallNs();
+        for (const Frame &frame : frames)
+        {
+            DecodedFrame decoded;
+            decodeFrame(frame.text.c_str(), decoded);
+            asm volatile("" : : "r,m"(decoded) : "memory");
+        }
+        double ns = static_cast<double>(wallNs() - start);
+        bestNs    = passes == 0 || ns < bestNs ? ns : bestNs;
+        spentMs += ns / 1e6;
+        passes++;
+    }
+    printf("\nDecoder: %.0f frames/s, %.1f MB/s (%zu frames, %.0f bytes avg)\n",
+           frames.size() / (bestNs / 1e9), bytes / (bestNs / 1e3), frames.size(),
+           static_cast<double>(bytes) / frames.size());
+}
+
+bool parseList(const char *value, std::vector<double> &out)
+{
+    out.clear();
+    std::stringstream stream(value);
+    std::string       item;
+    while (std::getline(stream, item, ','))
+    {
+        char  *end = nullptr;
+        double v   = strtod(item.c_str(), &end);
+        if (end == item.c_str() || v <= 0)
+        {
+            return false;
+        }
+        out.push_back(v);
+    }
+    return !out.empty();
+}
+}  // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg   = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        bool        ok    = value != nullptr;
+        if (ok && strcmp(arg, "--speed") == 0)
+            ok = parseList(value, options.speeds);
+        else if (ok && strcmp(arg, "--frames") == 0)
+            options.framesPath = value;
+        else if (ok && strcmp(arg, "--duration") == 0)
+            options.durationS = atof(value);
+        else if (ok && strcmp(arg, "--interval-ms") == 0)
+            options.intervalMs = strtoul(value, nullptr, 10);
+        else if (ok && strcmp(arg, "--pad") == 0)
+            options.pad = strtoul(value, nullptr, 10);
+        else if (ok && strcmp(arg, "--jam-every") == 0)
+            options.jamEveryS = atof(value);
+        else if (ok && strcmp(arg, "--pause-s") == 0)
+            options.pauseS = atof(value);
+        else if (ok && strcmp(arg, "--queue") == 0)
+            options.queue = strtoul(value, nullptr, 10);
+        else if (ok && strcmp(arg, "--slip") == 0)
+            options.slip = static_cast<float>(atof(value));
+        else if (ok && strcmp(arg, "--mm-per-pulse") == 0)
+            options.mmPerPulse = static_cast<float>(atof(value));
+        else
+            ok = false;
+        if (!ok || options.intervalMs == 0 || options.queue == 0 || options.jamEveryS <= 0 ||
+            options.mmPerPulse <= 0)
+        {
+            fprintf(stderr, "Bad option %s (see the header of sdcp_replay.cpp)\n", arg);
+            return 2;
+        }
+        i++;
+    }
+
+    std::vector<Frame> frames;
+    if (options.framesPath != nullptr)
+    {
+        if (!loadTraffic(options.framesPath, frames))
+        {
+            fprintf(stderr, "No frames in %s\n", options.framesPath);
+            return 1;
+        }
+    }
+    else
+    {
+        frames = syntheticTraffic(options.durationS, options.intervalMs, options.pad);
+    }
+
+    double printS = frames.back().ms / 1000.0;
+    printf("SDCP replay: %zu frames over %.0f s of print, jam every %.0f s after %.0f s grace, "
+           "queue %zu\n\n",
+           frames.size(), printS, options.jamEveryS, kGraceMs / 1000.0, options.queue);
+    printf("  speed  frames  drop decode ns | jams miss open   p50ms   p90ms   p99ms   maxms "
+           "| hand us lag p99 | cad99  cadmax\n");
+
+    // Compared with the slowest speed: misses there are the detector's, not the host's
+    std::vector<double> speeds = options.speeds;
+    std::sort(speeds.begin(), speeds.end());
+    std::vector<RunResult> results;
+    for (double speed : speeds)
+    {
+        results.push_back(runReplay(frames, options, speed));
+        printResult(results.back());
+    }
+    printf("\n(latency: jam onset to pausePrint(), simulated ms; hand: detection to pausePrint(), "
+           "wall us;\n lag: frame emission behind schedule, cad: detector update spacing, "
+           "both simulated ms)\n");
+
+    decoderThroughput(frames);
+    for (const RunResult &result : results)
+    {
+        if (result.jamsMissed > results.front().jamsMissed ||
+            result.framesDropped > results.front().framesDropped)
+        {
+            printf("Degraded at %.0fx: %lu missed jams, %lu dropped frames (%.0fx: %lu, %lu)\n",
+                   result.speed, result.jamsMissed, result.framesDropped, results.front().speed,
+                   results.front().jamsMissed, results.front().framesDropped);
+        }
+    }
+    return 0;
+}
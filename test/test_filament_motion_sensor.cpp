@@ -444,6 +444,322 @@ void testFlowRatioClamping() {
     TEST_PASS("Flow ratio clamping");
 }
 
+// Test: timestamped pulses land in the bucket they arrived in
+void testTimestampedPulses() {
+    TEST_SECTION("Timestamped Pulse Binning");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor sensor;
+    sensor.updateExpectedPosition(0.0f);
+
+    // Simulate a loop stall: pulses from 8.1s ago drained at 13s
+    setMockTime(13000);
+    sensor.addSensorPulse(2.88f, 8100);
+    TEST_ASSERT(floatEquals(sensor.getSensorDistance(), 2.88f),
+                "Pulse inside the window should be counted");
+
+    // Its bucket (8.0s-8.25s) slides out of the window 300ms later
+    advanceTime(300);
+    TEST_ASSERT(floatEquals(sensor.getSensorDistance(), 0.0f),
+                "Pulse should age out with its arrival bucket, not the drain time");
+
+    // Pulses older than the window only affect the monotonic total
+    sensor.addSensorPulse(2.88f, 1000);
+    TEST_ASSERT(floatEquals(sensor.getSensorDistance(), 0.0f),
+                "Pulse older than the window should not enter it");
+
+    // Future timestamps are clamped to now
+    sensor.addSensorPulse(2.88f, 99999);
+    TEST_ASSERT(floatEquals(sensor.getSensorDistance(), 2.88f),
+                "Future timestamp should be binned at now");
+
+    TEST_PASS("Timestamped pulses are binned by arrival time");
+}
+
+// Test: a pulse batch matches the same pulses added one at a time
+void testBatchedPulses() {
+    TEST_SECTION("Batched Pulses");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor single;
+    FilamentMotionSensor batched;
+
+    // Before init only the monotonic total moves; both must agree afterwards
+    single.addSensorPulse(2.88f, 10000);
+    single.addSensorPulse(2.88f, 10000);
+    batched.addSensorPulses(2, 2.88f, 10000);
+    single.updateExpectedPosition(0.0f);
+    batched.updateExpectedPosition(0.0f);
+
+    advanceTime(1000);
+    for (int i = 0; i < 12; i++) {
+        single.addSensorPulse(2.88f, 10600);
+    }
+    batched.addSensorPulses(12, 2.88f, 10600);
+    batched.addSensorPulses(0, 2.88f, 10600);  // Empty batch is a no-op
+    single.updateExpectedPosition(40.0f);
+    batched.updateExpectedPosition(40.0f);
+
+    TEST_ASSERT(floatEquals(batched.getSensorDistance(), single.getSensorDistance()),
+                "Batched sensor distance should match single pulses");
+    TEST_ASSERT(floatEquals(batched.getSensorDistance(), 12 * 2.88f),
+                "Batch should land in the window");
+    TEST_ASSERT(floatEquals(batched.getDeficit(), single.getDeficit()),
+                "Batched deficit should match single pulses");
+
+    // The batch ages out with its arrival bucket (10.5s-10.75s)
+    advanceTime(4800);
+    TEST_ASSERT(floatEquals(batched.getSensorDistance(), 0.0f),
+                "Batch should leave the window with its bucket");
+
+    TEST_PASS("addSensorPulses() matches repeated addSensorPulse()");
+}
+
+// Test: predictive mode extrapolates expected between samples and reconciles
+void testPredictiveExpected() {
+    TEST_SECTION("Predictive Expected Position");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor stepped;
+    FilamentMotionSensor predicted;
+    predicted.setPredictive(true);
+    TEST_ASSERT(!stepped.isPredictive(), "Prediction is off by default");
+    TEST_ASSERT(predicted.isPredictive(), "Prediction can be enabled");
+
+    stepped.updateExpectedPosition(0.0f);
+    predicted.updateExpectedPosition(0.0f);
+    setMockTime(11000);
+    stepped.updateExpectedPosition(10.0f);    // 10 mm/s
+    predicted.updateExpectedPosition(10.0f);
+
+    setMockTime(11500);
+    TEST_ASSERT(floatEquals(stepped.getExpectedDistance(), 10.0f),
+                "Without prediction expected only moves on samples");
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 15.0f),
+                "Prediction advances expected at the last sample rate");
+
+    // Sample matching the prediction adds nothing on top
+    setMockTime(12000);
+    predicted.updateExpectedPosition(20.0f);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 20.0f),
+                "Matching sample reconciles to the real total");
+
+    // Extrapolation stops at the horizon without new samples
+    setMockTime(12000 + MOTION_PREDICT_HORIZON_MS + 500);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 20.0f + MOTION_PREDICT_HORIZON_MS / 100.0f),
+                "Prediction is capped at the horizon");
+
+    // Flow slowed: the over-prediction is taken back
+    predicted.updateExpectedPosition(22.0f);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 22.0f),
+                "Over-prediction is removed when the sample lands");
+
+    // A retraction stops extrapolation
+    advanceTime(250);
+    predicted.updateExpectedPosition(21.0f);
+    advanceTime(250);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 22.0f),
+                "No extrapolation after a retraction");
+
+    TEST_PASS("Predictive mode extrapolates and reconciles expected extrusion");
+}
+
+// Test: a known rate (flow profile) replaces the last-interval rate
+void testPredictedRateOverride() {
+    TEST_SECTION("Predicted Rate Override");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor sensor;
+    sensor.setPredictedRate(5.0f);  // Ignored: not predictive
+    sensor.updateExpectedPosition(0.0f);
+    setMockTime(11000);
+    sensor.updateExpectedPosition(10.0f);
+    sensor.setPredictedRate(5.0f);
+    setMockTime(11500);
+    TEST_ASSERT(floatEquals(sensor.getExpectedDistance(), 10.0f),
+                "Rate override has no effect without prediction");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor predicted;
+    predicted.setPredictive(true);
+    predicted.updateExpectedPosition(0.0f);
+    setMockTime(11000);
+    predicted.updateExpectedPosition(10.0f);  // Last interval: 10 mm/s
+    predicted.setPredictedRate(2.0f);         // Profile: travel ahead, 2 mm/s
+
+    setMockTime(11500);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 11.0f),
+                "Prediction follows the supplied rate");
+
+    // Travel/retraction ahead: nothing is extrapolated
+    setMockTime(12000);
+    predicted.updateExpectedPosition(12.0f);
+    predicted.setPredictedRate(0.0f);
+    setMockTime(12500);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 12.0f),
+                "Zero supplied rate stops extrapolation");
+
+    // The next sample falls back to the last-interval rate
+    setMockTime(13000);
+    predicted.updateExpectedPosition(13.0f);  // 1 mm/s
+    setMockTime(13500);
+    TEST_ASSERT(floatEquals(predicted.getExpectedDistance(), 13.5f),
+                "Override lasts only until the next sample");
+
+    TEST_PASS("Supplied rate drives prediction until the next sample");
+}
+
+// Test: running window totals track a full rescan over long runs and idle gaps
+void testRunningWindowTotals() {
+    TEST_SECTION("Running Window Totals");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor sensor;
+    sensor.updateExpectedPosition(0.0f);
+
+    // 10 minutes of steady 10mm/s expected flow with matching pulses
+    float expectedPos = 0.0f;
+    for (int i = 0; i < 6000; i++) {
+        advanceTime(100);
+        expectedPos += 1.0f;
+        sensor.updateExpectedPosition(expectedPos);
+        sensor.addSensorPulse(1.0f);
+    }
+
+    // Window holds 5s of data (20 or 21 buckets depending on the boundary)
+    float expected = sensor.getExpectedDistance();
+    float actual = sensor.getSensorDistance();
+    TEST_ASSERT(expected >= 47.5f && expected <= 52.5f, "Expected window should hold ~50mm after many laps");
+    TEST_ASSERT(actual >= 47.5f && actual <= 52.5f, "Sensor window should hold ~50mm after many laps");
+
+    float expectedRate, actualRate;
+    sensor.getWindowedRates(expectedRate, actualRate);
+    TEST_ASSERT(expectedRate > 9.5f && expectedRate < 10.5f, "Expected rate should be ~10mm/s");
+
+    // Partial slide: 2.5s idle drops half the window
+    advanceTime(2500);
+    expected = sensor.getExpectedDistance();
+    TEST_ASSERT(expected >= 22.5f && expected <= 27.5f, "Half the window should remain after 2.5s idle");
+
+    // Idle past the window and then a long gap: totals drain to exactly zero
+    advanceTime(60000);
+    TEST_ASSERT(sensor.getExpectedDistance() == 0.0f, "Expected window should be empty after idle");
+    TEST_ASSERT(sensor.getSensorDistance() == 0.0f, "Sensor window should be empty after idle");
+
+    // New data after the gap is counted normally (minus the one pulse that
+    // arrived after the last update and aged out: orphan subtraction)
+    expectedPos += 5.0f;
+    sensor.updateExpectedPosition(expectedPos);
+    TEST_ASSERT(floatEquals(sensor.getExpectedDistance(), 4.0f), "Window should resume after idle gap");
+
+    TEST_PASS("Running window totals stay consistent");
+}
+
+void testWindowProfiles() {
+    TEST_SECTION("Window Profiles");
+
+    // Long profile keeps 10s of history where the standard one keeps 5s
+    resetMockTime();
+    setMockTime(10000);
+    LongFilamentMotionSensor longSensor;
+    FilamentMotionSensor standardSensor;
+    longSensor.updateExpectedPosition(0.0f);
+    standardSensor.updateExpectedPosition(0.0f);
+    float expectedPos = 0.0f;
+    for (int i = 0; i < 300; i++) {
+        advanceTime(100);
+        expectedPos += 1.0f;
+        longSensor.updateExpectedPosition(expectedPos);
+        standardSensor.updateExpectedPosition(expectedPos);
+    }
+    float longExpected = longSensor.getExpectedDistance();
+    float standardExpected = standardSensor.getExpectedDistance();
+    TEST_ASSERT(longExpected >= 97.5f && longExpected <= 102.5f, "Long window should hold ~100mm");
+    TEST_ASSERT(standardExpected >= 47.5f && standardExpected <= 52.5f, "Standard window should hold ~50mm");
+
+    // Fast profile drops an idle bucket's worth after 100ms, not 250ms
+    resetMockTime();
+    setMockTime(10000);
+    FastFilamentMotionSensor fastSensor;
+    fastSensor.updateExpectedPosition(0.0f);
+    advanceTime(100);
+    fastSensor.updateExpectedPosition(10.0f);
+    advanceTime(5000);
+    TEST_ASSERT(floatEquals(fastSensor.getExpectedDistance(), 10.0f), "Bucket still in window at its edge");
+    advanceTime(100);
+    TEST_ASSERT(fastSensor.getExpectedDistance() == 0.0f, "Fast bucket should slide out 100ms later");
+
+    // Runtime selection swaps geometry in place and starts from a clean state
+    SelectableMotionSensor selectable;
+    TEST_ASSERT(selectable.profile() == MotionWindowProfile::STANDARD, "Default profile is standard");
+    TEST_ASSERT(selectable->getBucketSizeMs() == 250, "Standard bucket size is 250ms");
+    TEST_ASSERT(!selectable.select(MotionWindowProfile::STANDARD), "Reselecting the same profile is a no-op");
+    TEST_ASSERT(selectable.select(MotionWindowProfile::FAST), "Switching profile reports a change");
+    TEST_ASSERT(selectable->getBucketSizeMs() == 100, "Fast bucket size is 100ms");
+    TEST_ASSERT(!selectable->isInitialized(), "New profile starts uninitialized");
+    selectable->updateExpectedPosition(0.0f);
+    advanceTime(100);
+    selectable->updateExpectedPosition(5.0f);
+    TEST_ASSERT(floatEquals(selectable->getExpectedDistance(), 5.0f), "Selected profile tracks movement");
+    TEST_ASSERT(selectable.select(MotionWindowProfile::LONG), "Switch to long profile");
+    TEST_ASSERT(selectable->getWindowSizeMs() == 10000, "Long window is 10s");
+
+    TEST_PASS("Window profiles use their own geometry");
+}
+
+// Test: getWindowTotals() agrees with the per-quantity queries
+void testWindowTotals() {
+    TEST_SECTION("Window Totals");
+
+    resetMockTime();
+    setMockTime(10000);
+    FilamentMotionSensor sensor;
+    sensor.updateExpectedPosition(0.0f);
+    advanceTime(1000);
+    sensor.addSensorPulses(3, 2.88f, 10500);
+    sensor.updateExpectedPosition(10.0f);
+
+    MotionWindowTotals totals;
+    sensor.getWindowTotals(totals);
+    float expectedRate, actualRate;
+    sensor.getWindowedRates(expectedRate, actualRate);
+    TEST_ASSERT(floatEquals(totals.expectedMm, sensor.getExpectedDistance()), "Expected distance matches");
+    TEST_ASSERT(floatEquals(totals.actualMm[0], sensor.getSensorDistance()), "Channel 0 distance matches");
+    TEST_ASSERT(floatEquals(totals.expectedRate, expectedRate), "Expected rate matches");
+    TEST_ASSERT(floatEquals(totals.actualRate[0], actualRate), "Channel 0 rate matches");
+
+#if MOTION_SENSOR_CHANNELS > 1
+    // Other paths have their own series against the shared expected side
+    sensor.addChannelPulses(1, 2, flowFromMm(2.88f), 10900);
+    sensor.addChannelPulses(MOTION_SENSOR_CHANNELS, 5, flowFromMm(2.88f), 10900);  // Out of range: ignored
+    sensor.getWindowTotals(totals);
+    TEST_ASSERT(floatEquals(totals.actualMm[0], 3 * 2.88f), "Channel 0 unchanged");
+    TEST_ASSERT(floatEquals(totals.actualMm[1], 2 * 2.88f), "Channel 1 has its own pulses");
+    for (int c = 2; c < MOTION_SENSOR_CHANNELS; c++) {
+        TEST_ASSERT(totals.actualMm[c] == 0.0f, "Idle channel is empty");
+    }
+    TEST_ASSERT(floatEquals(sensor.getSensorDistance(), 5 * 2.88f), "Channel-less queries sum all channels");
+    TEST_ASSERT(sensor.getDeficit() == 0.0f, "Deficit counts all channels (channel 0 alone is short)");
+
+    // One eviction step clears every channel of the bucket
+    advanceTime(4800);
+    sensor.getWindowTotals(totals);
+    TEST_ASSERT(totals.actualMm[0] == 0.0f && totals.actualMm[1] == 0.0f, "Evicted bucket leaves all channels");
+
+    sensor.reset();
+    sensor.getWindowTotals(totals);
+    TEST_ASSERT(totals.actualMm[1] == 0.0f, "Reset clears every channel");
+#endif
+
+    TEST_PASS("getWindowTotals() covers every channel in one window update");
+}
+
 int main() {
     TEST_SUITE_BEGIN("FilamentMotionSensor Unit Test Suite");
 
@@ -461,6 +777,13 @@ int main() {
     testRapidSampleRates();
     testUninitializedState();
     testFlowRatioClamping();
+    testTimestampedPulses();
+    testBatchedPulses();
+    testPredictiveExpected();
+    testPredictedRateOverride();
+    testRunningWindowTotals();
+    testWindowProfiles();
+    testWindowTotals();
 
     TEST_SUITE_END();
 }
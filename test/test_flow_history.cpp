@@ -0,0 +1,317 @@
+/**
+ * Unit Tests for FlowHistory
+ *
+ * Tests per-second aggregation and quantization, gap seconds, the fine
+ * ring, coarse aggregates and their pairwise merge, and a round trip of the
+ * wire format through an independent decoder.
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/test_mocks.h"
+
+#include "../src/FlowHistory.h"
+#include "../src/FlowHistory.cpp"
+
+struct VectorSink
+{
+    std::vector<uint8_t> bytes;
+    size_t write(const uint8_t *data, size_t length)
+    {
+        bytes.insert(bytes.end(), data, data + length);
+        return length;
+    }
+};
+
+// Decoder written from the format description in FlowHistory.h
+struct DecodedHistory
+{
+    bool     valid;
+    uint32_t endSec;
+    uint32_t ageMs;
+    uint16_t fineInterval;
+    uint16_t coarseInterval;
+    std::vector<flow_sample_t> fine;
+    std::vector<flow_sample_t> coarse;
+};
+
+static uint32_t readLe(const std::vector<uint8_t> &b, size_t at, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(b[at + i]) << (8 * i);
+    }
+    return value;
+}
+
+static bool readDelta(const std::vector<uint8_t> &b, size_t &at, int32_t &delta)
+{
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (at >= b.size()) return false;
+        uint8_t byte = b[at++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            delta = static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool readSeries(const std::vector<uint8_t> &b, size_t &at, uint16_t count,
+                       std::vector<flow_sample_t> &out)
+{
+    int32_t values[5] = {0, 0, 0, 0, 0};
+    uint8_t flags = 0;
+    for (uint16_t n = 0; n < count; n++) {
+        if (at >= b.size()) return false;
+        uint8_t mask = b[at++];
+        for (int i = 0; i < 5; i++) {
+            if (mask & (1 << i)) {
+                int32_t delta;
+                if (!readDelta(b, at, delta)) return false;
+                values[i] += delta;
+            }
+        }
+        if (mask & (1 << 5)) {
+            if (at >= b.size()) return false;
+            flags = b[at++];
+        }
+        flow_sample_t sample;
+        sample.expectedRate = static_cast<uint16_t>(values[0]);
+        sample.actualRate   = static_cast<uint16_t>(values[1]);
+        sample.passRatio    = static_cast<uint8_t>(values[2]);
+        sample.hardJam      = static_cast<uint8_t>(values[3]);
+        sample.softJam      = static_cast<uint8_t>(values[4]);
+        sample.flags        = flags;
+        out.push_back(sample);
+    }
+    return true;
+}
+
+static DecodedHistory decode(const std::vector<uint8_t> &b)
+{
+    DecodedHistory history;
+    history.valid = false;
+    if (b.size() < 20 || b[0] != 'F' || b[1] != 'H' || b[2] != FLOW_HISTORY_VERSION) {
+        return history;
+    }
+    size_t at = b[3];
+    history.endSec         = readLe(b, 4, 4);
+    history.ageMs          = readLe(b, 8, 4);
+    history.fineInterval   = static_cast<uint16_t>(readLe(b, 12, 2));
+    history.coarseInterval = static_cast<uint16_t>(readLe(b, 16, 2));
+    uint16_t fineCount     = static_cast<uint16_t>(readLe(b, 14, 2));
+    uint16_t coarseCount   = static_cast<uint16_t>(readLe(b, 18, 2));
+    history.valid = readSeries(b, at, fineCount, history.fine) &&
+                    readSeries(b, at, coarseCount, history.coarse) && at == b.size();
+    return history;
+}
+
+static bool sameSample(const flow_sample_t &a, const flow_sample_t &b)
+{
+    return a.expectedRate == b.expectedRate && a.actualRate == b.actualRate &&
+           a.passRatio == b.passRatio && a.hardJam == b.hardJam && a.softJam == b.softJam &&
+           a.flags == b.flags;
+}
+
+// One detector update per second at the given rates, for seconds [from, to)
+static void steadySeconds(FlowHistory &history, uint32_t from, uint32_t to, float rate)
+{
+    for (uint32_t s = from; s < to; s++) {
+        history.record(s * 1000UL, rate, rate * 0.98f, 0.98f, 0.0f, 0.0f, false, false);
+    }
+}
+
+void testSecondAggregation() {
+    TEST_SECTION("Updates in a second are averaged, jam percentages kept at their peak");
+
+    FlowHistory history;
+    history.record(0, 10.0f, 10.0f, 1.0f, 0.0f, 0.0f, false, false);
+    TEST_ASSERT(history.fineCount() == 0, "Nothing recorded before the first print");
+
+    history.begin(5000);
+    history.record(5000, 10.0f, 9.0f, 0.90f, 10.0f, 0.0f, false, true);
+    history.record(5250, 12.0f, 11.0f, 0.92f, 40.0f, 5.0f, false, false);
+    history.record(5500, 14.0f, 13.0f, 0.94f, 20.0f, 2.5f, true, false);
+    history.record(5750, 16.0f, 15.0f, 0.96f, 0.0f, 0.0f, false, false);
+    TEST_ASSERT(history.fineCount() == 0, "The open second is not a sample yet");
+
+    history.record(6000, 16.0f, 15.0f, 0.96f, 0.0f, 0.0f, false, false);
+    TEST_ASSERT(history.fineCount() == 1, "Next second closes the first");
+    TEST_ASSERT(history.elapsedSec() == 1, "One second elapsed");
+
+    flow_sample_t s = history.fineSample(0);
+    TEST_ASSERT(s.expectedRate == 1300, "Expected rate is the mean in 0.01 mm/s");
+    TEST_ASSERT(s.actualRate == 1200, "Actual rate is the mean in 0.01 mm/s");
+    TEST_ASSERT(s.passRatio == 93, "Pass ratio is the mean in 0.01");
+    TEST_ASSERT(s.hardJam == 80, "Hard jam is the peak in 0.5 %");
+    TEST_ASSERT(s.softJam == 10, "Soft jam is the peak in 0.5 %");
+    TEST_ASSERT(s.flags == (FLOW_SAMPLE_HAS_DATA | FLOW_SAMPLE_JAMMED | FLOW_SAMPLE_GRACE),
+                "Flags raised in the second are kept");
+
+    history.record(7000, 1000.0f, -3.0f, 4.0f, 150.0f, -1.0f, false, false);
+    history.record(8000, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, false, false);
+    s = history.fineSample(2);
+    TEST_ASSERT(s.expectedRate == 65535 && s.actualRate == 0, "Rates clamp to the field");
+    TEST_ASSERT(s.passRatio == 255 && s.hardJam == 200 && s.softJam == 0,
+                "Ratio and percentages clamp to the field");
+
+    TEST_PASS("Updates in a second are averaged, jam percentages kept at their peak");
+}
+
+void testGapsAndRing() {
+    TEST_SECTION("Seconds without updates and the fine ring");
+
+    FlowHistory history;
+    history.begin(0);
+    history.record(0, 20.0f, 20.0f, 1.0f, 0.0f, 0.0f, false, false);
+    history.record(5200, 20.0f, 20.0f, 1.0f, 0.0f, 0.0f, false, false);
+    TEST_ASSERT(history.fineCount() == 5, "Gap seconds are samples");
+    for (uint16_t i = 1; i < 5; i++) {
+        flow_sample_t gap = history.fineSample(i);
+        TEST_ASSERT(gap.flags == 0, "Gap second has no data");
+        TEST_ASSERT(gap.expectedRate == 2000, "Gap repeats the last values");
+    }
+
+    steadySeconds(history, 6, 706, 20.0f);
+    TEST_ASSERT(history.fineCount() == FLOW_HISTORY_FINE_SAMPLES, "Ring holds ten minutes");
+    TEST_ASSERT(history.elapsedSec() == 705, "Every second counted");
+    TEST_ASSERT(history.fineSample(FLOW_HISTORY_FINE_SAMPLES - 1).flags == FLOW_SAMPLE_HAS_DATA,
+                "Newest sample last");
+
+    // A ten hour pause costs one pass over the ring, not one per second
+    history.record(705000UL + 36000000UL, 20.0f, 20.0f, 1.0f, 0.0f, 0.0f, false, false);
+    TEST_ASSERT(history.elapsedSec() == 705 + 36000, "Long gap counted");
+    TEST_ASSERT(history.fineSample(0).flags == 0, "Ring is all gap");
+    uint32_t covered = history.coarseCount() * history.coarseIntervalSec();
+    TEST_ASSERT(covered <= history.elapsedSec() &&
+                history.elapsedSec() - covered < history.coarseIntervalSec(),
+                "Coarse tier still covers the print");
+    TEST_ASSERT(history.coarseCount() <= FLOW_HISTORY_COARSE_SAMPLES, "Coarse tier within bounds");
+
+    history.begin(800000000UL);
+    TEST_ASSERT(history.fineCount() == 0 && history.coarseCount() == 0 &&
+                history.elapsedSec() == 0, "begin() clears");
+    TEST_ASSERT(history.coarseIntervalSec() == FLOW_HISTORY_COARSE_INTERVAL_S,
+                "begin() restores the coarse interval");
+
+    TEST_PASS("Seconds without updates and the fine ring");
+}
+
+void testCoarseMerge() {
+    TEST_SECTION("Coarse aggregates merge pairwise when full");
+
+    const uint32_t interval = FLOW_HISTORY_COARSE_INTERVAL_S;
+    FlowHistory history;
+    history.begin(0);
+
+    // Alternate 10 and 20 mm/s per aggregate; one jam in the second aggregate
+    for (uint32_t s = 0; s <= interval * FLOW_HISTORY_COARSE_SAMPLES; s++) {
+        float rate = (s / interval) % 2 == 0 ? 10.0f : 20.0f;
+        bool  jam  = s == interval + 3;
+        history.record(s * 1000UL, rate, rate, 1.0f, jam ? 90.0f : 0.0f, 0.0f, jam, false);
+    }
+    TEST_ASSERT(history.coarseCount() == FLOW_HISTORY_COARSE_SAMPLES, "Coarse tier full");
+    TEST_ASSERT(history.coarseIntervalSec() == interval, "Not merged yet");
+    TEST_ASSERT(history.coarseSample(0).expectedRate == 1000, "First aggregate at 10 mm/s");
+    TEST_ASSERT(history.coarseSample(1).expectedRate == 2000, "Second aggregate at 20 mm/s");
+    TEST_ASSERT(history.coarseSample(1).hardJam == 180 &&
+                (history.coarseSample(1).flags & FLOW_SAMPLE_JAMMED),
+                "Aggregate keeps its jam");
+
+    uint32_t start = interval * FLOW_HISTORY_COARSE_SAMPLES + 1;
+    steadySeconds(history, start, start + 2 * interval, 10.0f);
+    TEST_ASSERT(history.coarseIntervalSec() == 2 * interval, "Interval doubled");
+    TEST_ASSERT(history.coarseCount() == FLOW_HISTORY_COARSE_SAMPLES / 2 + 1,
+                "Pairs merged, pending aggregate completed at the new interval");
+    TEST_ASSERT(history.coarseSample(0).expectedRate == 1500, "Merged pair is averaged");
+    TEST_ASSERT(history.coarseSample(0).hardJam == 180 &&
+                (history.coarseSample(0).flags & FLOW_SAMPLE_JAMMED),
+                "Merged pair keeps the jam");
+    TEST_ASSERT(history.coarseSample(1).hardJam == 0, "Other pairs stay clear");
+
+    TEST_PASS("Coarse aggregates merge pairwise when full");
+}
+
+void testEncodeRoundTrip() {
+    TEST_SECTION("Wire format round trip");
+
+    FlowHistory empty;
+    VectorSink emptySink;
+    empty.encode(emptySink, 1234);
+    DecodedHistory none = decode(emptySink.bytes);
+    TEST_ASSERT(none.valid && none.fine.empty() && none.coarse.empty(),
+                "Empty history encodes as a header");
+    TEST_ASSERT(emptySink.bytes.size() == FLOW_HISTORY_HEADER_BYTES, "Header size");
+
+    FlowHistory history;
+    history.begin(100000);
+    uint32_t s = 0;
+    for (; s < 900; s++) {
+        float rate = 8.0f + (s % 17) * 0.37f;
+        float hard = (s % 97) < 4 ? 35.0f : 0.0f;
+        if (s >= 400 && s < 420) continue;  // Telemetry lost
+        history.record(100000UL + s * 1000UL + 300, rate, rate * 0.9f, 0.9f, hard, hard / 2,
+                       hard > 30.0f, s < 10);
+    }
+    VectorSink sink;
+    history.encode(sink, 100000UL + 899300UL + 450);
+
+    DecodedHistory decoded = decode(sink.bytes);
+    TEST_ASSERT(decoded.valid, "Decoder consumes the whole body");
+    TEST_ASSERT(decoded.endSec == history.elapsedSec(), "Elapsed seconds");
+    TEST_ASSERT(decoded.ageMs == 750, "Age of the last sample");
+    TEST_ASSERT(decoded.fineInterval == 1, "Fine interval");
+    TEST_ASSERT(decoded.coarseInterval == history.coarseIntervalSec(), "Coarse interval");
+    TEST_ASSERT(decoded.fine.size() == history.fineCount(), "Fine count");
+    TEST_ASSERT(decoded.coarse.size() == history.coarseCount(), "Coarse count");
+
+    bool fineMatch = true;
+    for (uint16_t i = 0; i < history.fineCount(); i++) {
+        fineMatch = fineMatch && sameSample(decoded.fine[i], history.fineSample(i));
+    }
+    bool coarseMatch = true;
+    for (uint16_t i = 0; i < history.coarseCount(); i++) {
+        coarseMatch = coarseMatch && sameSample(decoded.coarse[i], history.coarseSample(i));
+    }
+    TEST_ASSERT(fineMatch, "Fine samples decode unchanged");
+    TEST_ASSERT(coarseMatch, "Coarse samples decode unchanged");
+
+    size_t samples = history.fineCount() + history.coarseCount();
+    std::cout << "  " << samples << " samples in " << sink.bytes.size() << " bytes ("
+              << (sink.bytes.size() - FLOW_HISTORY_HEADER_BYTES) * 1.0 / samples
+              << " B/sample, " << samples * sizeof(flow_sample_t) << " B stored)" << std::endl;
+    TEST_ASSERT(sink.bytes.size() < FLOW_HISTORY_HEADER_BYTES + samples * 5,
+                "Delta coding beats the stored size");
+
+    // Worst case per sample stays within the staging bound
+    flow_sample_t zero = {0, 0, 0, 0, 0, 0};
+    flow_sample_t full = {65535, 65535, 255, 200, 200, 7};
+    uint8_t out[FLOW_HISTORY_MAX_SAMPLE_BYTES + 4];
+    TEST_ASSERT(FlowHistory::encodeSample(zero, full, out) <= FLOW_HISTORY_MAX_SAMPLE_BYTES &&
+                FlowHistory::encodeSample(full, zero, out) <= FLOW_HISTORY_MAX_SAMPLE_BYTES,
+                "Largest change fits FLOW_HISTORY_MAX_SAMPLE_BYTES");
+    TEST_ASSERT(FlowHistory::encodeSample(full, full, out) == 1, "Unchanged sample is one byte");
+
+    TEST_PASS("Wire format round trip");
+}
+
+int main() {
+    TEST_SUITE_BEGIN("FlowHistory Unit Test Suite");
+
+    testSecondAggregation();
+    testGapsAndRing();
+    testCoarseMerge();
+    testEncodeRoundTrip();
+
+    TEST_SUITE_END();
+}
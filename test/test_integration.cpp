@@ -36,6 +36,7 @@ public:
     void log(const char* msg, LogLevel level = LOG_NORMAL) {}
     void logf(const char* fmt, ...) {}
     void logf(LogLevel level, const char* fmt, ...) {}
+    template <typename... Args> void logDeferred(LogLevel level, const char* fmt, Args... args) {}
 };
 
 // Mock SettingsManager singleton for JamDetector
@@ -171,6 +171,84 @@ void testHardJamDetection() {
     testsPassed++;
 }
 
+void testJamLatencyTimestamps() {
+    std::cout << "\n=== Test: Jam Latency Timestamps ===" << std::endl;
+
+    resetMockTime();
+    JamDetector detector;
+    JamConfig config;
+    config.graceTimeMs = 0;
+    config.hardJamMm = 5.0f;
+    config.softJamTimeMs = 10000;
+    config.hardJamTimeMs = 2000;
+    config.ratioThreshold = 0.25f;
+    config.detectionMode = DetectionMode::BOTH;
+
+    unsigned long printStartTime = 1000;
+    _mockMillis = 1000;
+    detector.reset(printStartTime);
+    assert(detector.getTripOnsetMs() == 0);
+    assert(detector.getJamDetectedMs() == 0);
+
+    // Healthy flow: no onset
+    _mockMillis = 2000;
+    detector.update(10.0f, 10.0f, 100, true, true, _mockMillis, printStartTime, config, 10.0f, 10.0f);
+    assert(detector.getTripOnsetMs() == 0);
+
+    // First starved evaluation marks the onset, later ones keep it
+    _mockMillis = 3000;
+    JamState state = detector.update(15.0f, 0.1f, 5, true, true, _mockMillis, printStartTime,
+                                     config, 10.0f, 0.02f);
+    assert(!state.jammed);
+    assert(detector.getTripOnsetMs() == 3000);
+    assert(detector.getJamDetectedMs() == 0);
+
+    _mockMillis = 4000;
+    state = detector.update(20.0f, 0.15f, 7, true, true, _mockMillis, printStartTime, config,
+                            10.0f, 0.02f);
+    assert(state.jammed);
+    assert(detector.getTripOnsetMs() == 3000);
+    assert(detector.getJamDetectedMs() == 4000);
+
+    // Resume clears both stages
+    detector.onResume(_mockMillis, 100, 20.0f);
+    assert(detector.getTripOnsetMs() == 0);
+    assert(detector.getJamDetectedMs() == 0);
+
+    // A jam that recovers without a pause also clears both stages once the
+    // accumulators drain, so a later unrelated pause sees no stale detection
+    float expected = 20.0f;
+    float actual   = 0.15f;
+    int   pulses   = 7;
+    for (int i = 0; i < 3; i++)
+    {
+        _mockMillis += 1000;
+        expected += 2.0f;
+        actual += 0.02f;
+        pulses++;
+        state = detector.update(expected, actual, pulses, true, true, _mockMillis, printStartTime,
+                                config, 10.0f, 0.02f);
+    }
+    assert(state.jammed);
+    assert(detector.getJamDetectedMs() != 0);
+
+    for (int i = 0; i < 30 && (state.jammed || detector.getTripOnsetMs() != 0); i++)
+    {
+        _mockMillis += 1000;
+        expected += 10.0f;
+        actual += 10.0f;
+        pulses += 350;
+        state = detector.update(expected, actual, pulses, true, true, _mockMillis, printStartTime,
+                                config, 10.0f, 10.0f);
+    }
+    assert(!state.jammed);
+    assert(detector.getTripOnsetMs() == 0);
+    assert(detector.getJamDetectedMs() == 0);
+
+    std::cout << COLOR_GREEN << "PASS: Trip onset and detection times recorded" << COLOR_RESET << std::endl;
+    testsPassed++;
+}
+
 void testSoftJamDetection() {
     std::cout << "\n=== Test: Soft Jam Detection ===" << std::endl;
 
@@ -534,6 +612,145 @@ void testNotPrintingState() {
     testsPassed++;
 }
 
+void testAdaptiveSoftJam() {
+    std::cout << "\n=== Test: Adaptive Soft Jam Threshold ===" << std::endl;
+
+    resetMockTime();
+    JamDetector adaptive;
+    JamDetector fixed;
+    JamConfig config;
+    config.graceTimeMs = 0;
+    config.hardJamMm = 5.0f;
+    config.softJamTimeMs = 2000;
+    config.hardJamTimeMs = 3000;
+    config.ratioThreshold = 0.70f;
+    config.detectionMode = DetectionMode::BOTH;
+    JamConfig adaptiveConfig = config;
+    adaptiveConfig.adaptiveSoftJam = true;
+
+    unsigned long printStartTime = 1000;
+    _mockMillis = 1000;
+    adaptive.reset(printStartTime);
+    fixed.reset(printStartTime);
+
+    // Fast print that steadily reads ~75% of expected: learn the baseline
+    JamState state;
+    for (int i = 0; i < 80; i++) {
+        _mockMillis += 500;
+        float ratio = 0.72f + 0.02f * (i % 4);
+        state = adaptive.update(20.0f, 20.0f * ratio, 100 + i, true, true, _mockMillis,
+                                printStartTime, adaptiveConfig, 12.0f, 12.0f * ratio);
+        fixed.update(20.0f, 20.0f * ratio, 100 + i, true, true, _mockMillis,
+                     printStartTime, config, 12.0f, 12.0f * ratio);
+        assert(!state.jammed);
+    }
+
+    FlowBaseline baseline = adaptive.getBaseline(12.0f);
+    assert(baseline.samples >= 60);
+    assert(floatEquals(baseline.passRatioMean, 0.75f, 0.01f));
+    assert(baseline.passRatioStdDev > 0.01f && baseline.passRatioStdDev < 0.05f);
+    assert(floatEquals(baseline.expectedRateMean, 12.0f, 0.01f));
+    assert(adaptive.getBaseline(3.0f).samples == 0);  // Other bands learn separately
+    assert(fixed.getBaseline(12.0f).samples == baseline.samples);  // Learned in either mode
+
+    // Threshold is relative to the learned 0.75, not the fixed 0.70
+    assert(state.softJamThreshold < 0.6f && state.softJamThreshold >= 0.35f);
+
+    // A dip to 62% trips the fixed threshold but not the adaptive one
+    bool fixedJammed = false;
+    for (int i = 0; i < 8; i++) {
+        _mockMillis += 500;
+        state = adaptive.update(20.0f, 12.4f, 200, true, true, _mockMillis,
+                                printStartTime, adaptiveConfig, 12.0f, 7.44f);
+        fixedJammed = fixedJammed ||
+                      fixed.update(20.0f, 12.4f, 200, true, true, _mockMillis,
+                                   printStartTime, config, 12.0f, 7.44f).softJamTriggered;
+        assert(!state.jammed);
+    }
+    assert(fixedJammed);
+
+    // Unlearned band still uses the setting
+    state = adaptive.update(20.0f, 12.4f, 200, true, true, _mockMillis + 500,
+                            printStartTime, adaptiveConfig, 3.0f, 1.86f);
+    assert(floatEquals(state.softJamThreshold, 0.70f, 0.001f));
+
+    // A real drop relative to the baseline still trips
+    for (int i = 0; i < 8 && !state.jammed; i++) {
+        _mockMillis += 1000;
+        state = adaptive.update(20.0f, 6.0f, 200, true, true, _mockMillis,
+                                printStartTime, adaptiveConfig, 12.0f, 3.6f);
+    }
+    assert(state.softJamTriggered);
+
+    // Baselines are per print
+    adaptive.reset(_mockMillis);
+    assert(adaptive.getBaseline(12.0f).samples == 0);
+
+    std::cout << COLOR_GREEN << "PASS: Adaptive soft jam threshold follows the learned baseline" << COLOR_RESET << std::endl;
+    testsPassed++;
+}
+
+void testAdaptiveSoftJamBelowStaticThreshold() {
+    std::cout << "\n=== Test: Adaptive Soft Jam Below Static Threshold ===" << std::endl;
+
+    resetMockTime();
+    JamDetector adaptive;
+    JamDetector fixed;
+    JamConfig config;
+    config.graceTimeMs = 0;
+    config.hardJamMm = 5.0f;
+    config.softJamTimeMs = 10000;  // Shipped default
+    config.hardJamTimeMs = 3000;
+    config.ratioThreshold = 0.40f;  // Shipped default
+    config.detectionMode = DetectionMode::BOTH;
+    JamConfig adaptiveConfig = config;
+    adaptiveConfig.adaptiveSoftJam = true;
+
+    unsigned long printStartTime = 1000;
+    _mockMillis = 1000;
+    adaptive.reset(printStartTime);
+    fixed.reset(printStartTime);
+
+    // High-speed print that steadily reads ~30% of expected from the start:
+    // the fixed threshold trips on it, the adaptive one learns it as normal
+    JamState state;
+    bool fixedJammed = false;
+    for (int i = 0; i < 60; i++) {
+        _mockMillis += 500;
+        float ratio = 0.29f + 0.01f * (i % 3);
+        state = adaptive.update(20.0f, 20.0f * ratio, 100 + i, true, true, _mockMillis,
+                                printStartTime, adaptiveConfig, 12.0f, 12.0f * ratio);
+        fixedJammed = fixedJammed ||
+                      fixed.update(20.0f, 20.0f * ratio, 100 + i, true, true, _mockMillis,
+                                   printStartTime, config, 12.0f, 12.0f * ratio).softJamTriggered;
+        assert(!state.jammed);
+    }
+    assert(fixedJammed);
+
+    // The whole flow was learned, not just the part above the static threshold
+    FlowBaseline baseline = adaptive.getBaseline(12.0f);
+    assert(baseline.samples >= 50);
+    assert(floatEquals(baseline.passRatioMean, 0.30f, 0.01f));
+
+    // Relaxed below the static threshold, but not below the hard-jam ratio
+    assert(state.softJamThreshold < 0.30f && state.softJamThreshold >= 0.25f);
+
+    // A drop well below that baseline (still moving, so not a hard jam) trips
+    for (int i = 0; i < 30 && !state.jammed; i++) {
+        _mockMillis += 500;
+        state = adaptive.update(20.0f, 2.0f, 200, true, true, _mockMillis,
+                                printStartTime, adaptiveConfig, 12.0f, 1.2f);
+    }
+    assert(state.softJamTriggered);
+    assert(!state.hardJamTriggered);
+
+    // ...and was not learned into the baseline
+    assert(adaptive.getBaseline(12.0f).samples == baseline.samples);
+
+    std::cout << COLOR_GREEN << "PASS: Adaptive soft jam learns steady flow below the static threshold" << COLOR_RESET << std::endl;
+    testsPassed++;
+}
+
 int main() {
     std::cout << "\n";
     std::cout << "========================================\n";
@@ -543,6 +760,7 @@ int main() {
     testReset();
     testGracePeriodStartup();
     testHardJamDetection();
+    testJamLatencyTimestamps();
     testSoftJamDetection();
     testJamRecovery();
     testResumeGrace();
@@ -552,6 +770,8 @@ int main() {
     testPauseRequestHandling();
     testEdgeCaseZeroExpected();
     testNotPrintingState();
+    testAdaptiveSoftJam();
+    testAdaptiveSoftJamBelowStaticThreshold();
     
     std::cout << "\n========================================\n";
     std::cout << "Test Results:\n";
@@ -24,6 +24,10 @@ int testsFailed = 0;
 // Mock Serial
 MockSerial Serial;
 
+// Real byte ring used by the firmware Logger
+#include "../src/DeferredLog.h"
+#include "../src/LogRing.h"
+
 // Log levels (from Logger.h)
 enum LogLevel : uint8_t {
     LOG_NORMAL      = 0,
@@ -433,6 +437,203 @@ void testGetLogsWithMaxEntries() {
     TEST_PASS("getLogsAsText(maxEntries) limits output correctly");
 }
 
+// ============================================================================
+// LogRing (firmware storage) tests
+// ============================================================================
+
+static void pushText(LogRing &ring, uint32_t seq, const char *text) {
+    ring.push(seq, 1000 + seq, LOG_NORMAL, text, strlen(text));
+}
+
+void testLogRingStoresVariableLengthRecords() {
+    TEST_SECTION("LogRing stores variable-length records by number");
+
+    static uint8_t storage[256];
+    LogRing ring;
+    TEST_ASSERT(ring.begin(storage, sizeof(storage)), "Power-of-two storage accepted");
+
+    pushText(ring, 1, "a");
+    pushText(ring, 2, "a much longer message than the first one");
+    pushText(ring, 3, "");
+
+    TEST_ASSERT(ring.count() == 3, "Three records stored");
+    TEST_ASSERT(ring.bytesUsed() == 3 * LogRing::HEADER_SIZE + 1 + 40, "Records use header + message bytes only");
+
+    LogRing::Header header;
+    char message[64];
+    TEST_ASSERT(ring.read(2, header, message, sizeof(message)), "Record 2 found");
+    TEST_ASSERT(header.seq == 2 && header.timestamp == 1002, "Header round-trips");
+    TEST_ASSERT(strcmp(message, "a much longer message than the first one") == 0, "Message round-trips");
+    TEST_ASSERT(ring.read(3, header, message, sizeof(message)) && message[0] == '\0', "Empty message round-trips");
+    TEST_ASSERT(!ring.read(4, header, message, sizeof(message)), "Nothing past the newest record");
+
+    char small[5];
+    ring.read(2, header, small, sizeof(small));
+    TEST_ASSERT(strcmp(small, "a mu") == 0, "Message truncated to the caller's buffer");
+
+    TEST_PASS("LogRing stores variable-length records by number");
+}
+
+void testLogRingEvictsOldestAcrossWrap() {
+    TEST_SECTION("LogRing evicts oldest records and wraps");
+
+    static uint8_t storage[128];
+    LogRing ring;
+    ring.begin(storage, sizeof(storage));
+
+    // 12-byte header + 9-byte message = 21 bytes, so the ring wraps many times
+    for (uint32_t seq = 1; seq <= 100; seq++) {
+        char text[16];
+        snprintf(text, sizeof(text), "entry %03u", seq);
+        pushText(ring, seq, text);
+    }
+
+    TEST_ASSERT(ring.count() == 6, "Only as many records as fit are kept");
+    TEST_ASSERT(ring.oldestSeq() == 95, "Oldest surviving record is numbered correctly");
+
+    LogRing::Header header;
+    char message[32];
+    TEST_ASSERT(ring.read(1, header, message, sizeof(message)), "Reading an evicted number returns the oldest");
+    TEST_ASSERT(header.seq == 95 && strcmp(message, "entry 095") == 0, "Oldest record intact after wrap");
+
+    bool allIntact = true;
+    for (uint32_t seq = 95; seq <= 100; seq++) {
+        char expected[16];
+        snprintf(expected, sizeof(expected), "entry %03u", seq);
+        if (!ring.read(seq, header, message, sizeof(message)) || header.seq != seq ||
+            strcmp(message, expected) != 0) {
+            allIntact = false;
+        }
+    }
+    TEST_ASSERT(allIntact, "Records straddling the buffer end read back intact");
+
+    ring.clear();
+    TEST_ASSERT(ring.count() == 0 && !ring.read(0, header, message, sizeof(message)), "clear() empties the ring");
+    pushText(ring, 101, "after clear");
+    TEST_ASSERT(ring.read(0, header, message, sizeof(message)) && header.seq == 101, "Numbering restarts at the next push");
+
+    TEST_PASS("LogRing evicts oldest records and wraps");
+}
+
+void testLogRingReadersKeepOwnHints() {
+    TEST_SECTION("LogRing readers keep their own hints");
+
+    static uint8_t storage[256];
+    LogRing ring;
+    ring.begin(storage, sizeof(storage));
+    for (uint32_t seq = 1; seq <= 8; seq++) {
+        char text[16];
+        snprintf(text, sizeof(text), "entry %03u", seq);
+        pushText(ring, seq, text);
+    }
+
+    // Two readers interleaved, each resuming from its own position
+    LogRing::ReadHint slow;
+    LogRing::ReadHint fast;
+    LogRing::Header   header;
+    char              message[32];
+    bool              inOrder = true;
+    for (uint32_t step = 1; step <= 4; step++) {
+        if (!ring.read(step, header, message, sizeof(message), &slow) || header.seq != step) {
+            inOrder = false;
+        }
+        if (!ring.read(step + 4, header, message, sizeof(message), &fast) || header.seq != step + 4) {
+            inOrder = false;
+        }
+    }
+    TEST_ASSERT(inOrder, "Interleaved readers each read their own records");
+    TEST_ASSERT(slow.seq == 4 && fast.seq == 8, "Each hint tracks its reader's last record");
+
+    // A hint from before clear() is not trusted even when the numbers repeat
+    ring.clear();
+    pushText(ring, 1, "first");
+    pushText(ring, 2, "second");
+    pushText(ring, 3, "third");
+    pushText(ring, 4, "after clear");
+    TEST_ASSERT(ring.read(4, header, message, sizeof(message), &slow) && header.seq == 4 &&
+                strcmp(message, "after clear") == 0, "Stale hint ignored after clear()");
+
+    TEST_PASS("LogRing readers keep their own hints");
+}
+
+void testLogRingTruncatesOversizedMessage() {
+    TEST_SECTION("LogRing truncates messages larger than the ring");
+
+    static uint8_t storage[64];
+    LogRing ring;
+    ring.begin(storage, sizeof(storage));
+
+    char text[200];
+    memset(text, 'z', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    pushText(ring, 1, text);
+
+    LogRing::Header header;
+    char message[sizeof(text)];
+    TEST_ASSERT(ring.read(1, header, message, sizeof(message)), "Oversized record stored");
+    TEST_ASSERT(header.length == ring.maxMessageLength(), "Message clipped to ring capacity");
+    TEST_ASSERT(ring.bytesUsed() == ring.capacity(), "Record fills the ring exactly");
+
+    LogRing rejected;
+    TEST_ASSERT(!rejected.begin(storage, 60), "Non power-of-two capacity rejected");
+
+    TEST_PASS("LogRing truncates messages larger than the ring");
+}
+
+void testDeferredRenderMatchesPrintf() {
+    TEST_SECTION("Deferred records render like snprintf");
+
+    static const char *kFormat = "exp=%.2fmm pulses=%lu jam=%d rate=%6.3f hex=%04x %%";
+    uint8_t payload[DeferredLog::MAX_PAYLOAD];
+    unsigned long pulses = 4000000000UL;
+    size_t length = DeferredLog::pack(payload, sizeof(payload), kFormat, 12.345f, pulses, -3,
+                                      0.5, 0xBEu);
+    TEST_ASSERT(length > 0, "Arguments packed");
+
+    char expected[128];
+    snprintf(expected, sizeof(expected), kFormat, 12.345f, pulses, -3, 0.5, 0xBEu);
+    char rendered[128];
+    size_t renderedLength = DeferredLog::render(payload, length, rendered, sizeof(rendered));
+    TEST_ASSERT(strcmp(rendered, expected) == 0, "Rendered text matches snprintf");
+    TEST_ASSERT(renderedLength == strlen(expected), "Rendered length reported");
+
+    // Stored as a flagged ring record and read back as raw payload bytes
+    static uint8_t storage[256];
+    LogRing ring;
+    ring.begin(storage, sizeof(storage));
+    ring.push(1, 0, 0, reinterpret_cast<const char *>(payload), length, LogRing::FLAG_DEFERRED);
+    LogRing::Header header;
+    char message[DeferredLog::MAX_PAYLOAD + 1];
+    TEST_ASSERT(ring.read(1, header, message, sizeof(message)), "Deferred record stored");
+    TEST_ASSERT(header.flags & LogRing::FLAG_DEFERRED, "Deferred flag kept");
+    DeferredLog::render(reinterpret_cast<const uint8_t *>(message), header.length, rendered,
+                        sizeof(rendered));
+    TEST_ASSERT(strcmp(rendered, expected) == 0, "Ring copy renders the same text");
+
+    TEST_PASS("Deferred records render like snprintf");
+}
+
+void testDeferredRenderHandlesLimits() {
+    TEST_SECTION("Deferred rendering handles missing args, overflow and truncation");
+
+    uint8_t payload[DeferredLog::MAX_PAYLOAD];
+    size_t length = DeferredLog::pack(payload, sizeof(payload), "a=%d b=%d", 7);
+    char rendered[64];
+    DeferredLog::render(payload, length, rendered, sizeof(rendered));
+    TEST_ASSERT(strcmp(rendered, "a=7 b=?") == 0, "Missing argument rendered as ?");
+
+    uint8_t tiny[16];
+    TEST_ASSERT(DeferredLog::pack(tiny, sizeof(tiny), "%f %f", 1.0, 2.0) == 0,
+                "Payload overflow reported as 0");
+
+    length = DeferredLog::pack(payload, sizeof(payload), "value=%d", 123456);
+    char small[8];
+    size_t n = DeferredLog::render(payload, length, small, sizeof(small));
+    TEST_ASSERT(n == 7 && strcmp(small, "value=1") == 0, "Output truncated and terminated");
+
+    TEST_PASS("Deferred rendering handles missing args, overflow and truncation");
+}
+
 int main() {
     TEST_SUITE_BEGIN("Logger Unit Test Suite");
 
@@ -447,6 +648,12 @@ int main() {
     testLogfFormatting();
     testGetLogLevelReturnsCurrentLevel();
     testGetLogsWithMaxEntries();
+    testLogRingStoresVariableLengthRecords();
+    testLogRingEvictsOldestAcrossWrap();
+    testLogRingReadersKeepOwnHints();
+    testLogRingTruncatesOversizedMessage();
+    testDeferredRenderMatchesPrintf();
+    testDeferredRenderHandlesLimits();
 
     TEST_SUITE_END();
 }
@@ -0,0 +1,227 @@
+/**
+ * Unit Tests for MemoryMonitor
+ *
+ * Tests per-phase low-water marks (exact when a phase sets a new boot-wide
+ * minimum), retained bytes and the top retainer, per-task allocation counts
+ * and stack marks, heap sampling with fragmentation, and reset.
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/test_mocks.h"
+
+// FreeRTOS/ESP pieces MemoryMonitor uses
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(x) ((void) (x))
+#define portEXIT_CRITICAL(x) ((void) (x))
+
+typedef void *TaskHandle_t;
+int          mockTaskA = 0;
+int          mockTaskB = 0;
+TaskHandle_t currentTask = &mockTaskA;
+uint32_t     stackHighWater[2] = {0, 0};
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return currentTask; }
+inline uint32_t uxTaskGetStackHighWaterMark(TaskHandle_t handle)
+{
+    return handle == &mockTaskA ? stackHighWater[0] : stackHighWater[1];
+}
+
+struct MockEsp
+{
+    uint32_t freeHeap    = 100000;
+    uint32_t minFreeHeap = 90000;
+    uint32_t maxAlloc    = 80000;
+    uint32_t getFreeHeap() const { return freeHeap; }
+    uint32_t getMinFreeHeap() const { return minFreeHeap; }
+    uint32_t getMaxAllocHeap() const { return maxAlloc; }
+    // Allocate or free through the mock allocator
+    void take(uint32_t bytes)
+    {
+        freeHeap -= bytes;
+        if (freeHeap < minFreeHeap)
+        {
+            minFreeHeap = freeHeap;
+        }
+    }
+    void give(uint32_t bytes) { freeHeap += bytes; }
+} ESP;
+
+#include "../src/MemoryMonitor.h"
+#include "../src/MemoryMonitor.cpp"
+
+void resetHeap() {
+    ESP              = MockEsp();
+    currentTask      = &mockTaskA;
+    memoryMonitor.reset();
+}
+
+void testPhaseLowWater() {
+    TEST_SECTION("Phase low-water marks and retained bytes");
+    resetHeap();
+
+    // Peaks at 15 KB inside the phase (new boot-wide minimum), keeps 1 KB
+    mem_phase_mark_t mark = memoryMonitor.beginPhase();
+    ESP.take(15000);
+    ESP.give(14000);
+    memoryMonitor.endPhase(MEM_SDCP_PARSE, mark);
+
+    mem_phase_stats_t stats;
+    memoryMonitor.phaseSnapshot(MEM_SDCP_PARSE, stats);
+    TEST_ASSERT(stats.count == 1, "Run counted");
+    TEST_ASSERT(stats.lowWaterFree == 85000, "New boot-wide minimum is the exact low-water");
+    TEST_ASSERT(stats.lowWaterExact == 1, "Run flagged as exact");
+    TEST_ASSERT(stats.maxRetained == 1000 && stats.netRetained == 1000, "Kept bytes tracked");
+
+    // Short of the boot minimum: bounded by entry and exit, not exact
+    mark = memoryMonitor.beginPhase();
+    ESP.take(2000);
+    memoryMonitor.endPhase(MEM_SDCP_PARSE, mark);
+    mark = memoryMonitor.beginPhase();
+    ESP.give(3000);
+    memoryMonitor.endPhase(MEM_SDCP_PARSE, mark);
+    memoryMonitor.phaseSnapshot(MEM_SDCP_PARSE, stats);
+    TEST_ASSERT(stats.count == 3, "All runs counted");
+    TEST_ASSERT(stats.lowWaterFree == 85000, "Low-water only falls");
+    TEST_ASSERT(stats.lowWaterExact == 1, "Bounded runs are not exact");
+    TEST_ASSERT(stats.maxRetained == 2000, "Largest single retention");
+    TEST_ASSERT(stats.netRetained == 0, "Freeing phases offset the net");
+
+    mem_phase_stats_t idle;
+    memoryMonitor.phaseSnapshot(MEM_OTA, idle);
+    TEST_ASSERT(idle.count == 0 && idle.lowWaterFree == 0, "Untouched phase reports zeros");
+
+    TEST_PASS("Phase low-water marks and retained bytes");
+}
+
+void testTopRetainer() {
+    TEST_SECTION("Top retainer points at the phase keeping the most");
+    resetHeap();
+
+    TEST_ASSERT(memoryMonitor.topRetainer() == MEM_PHASE_COUNT, "Nothing retained yet");
+    TEST_ASSERT(strcmp(MemoryMonitor::phaseName(MEM_PHASE_COUNT), "none") == 0, "Named none");
+
+    for (int i = 0; i < 10; i++)
+    {
+        MemScope scope(MEM_SSE_BROADCAST);
+        ESP.take(100);  // Small, steady leak
+    }
+    {
+        MemScope scope(MEM_LOG_DUMP);
+        ESP.take(500);
+    }
+    {
+        MemScope scope(MEM_LOG_DUMP);
+        ESP.give(500);
+    }
+    TEST_ASSERT(memoryMonitor.topRetainer() == MEM_SSE_BROADCAST,
+                "Steady leak outranks a large but returned allocation");
+
+    TEST_PASS("Top retainer points at the phase keeping the most");
+}
+
+void testAllocationCounts() {
+    TEST_SECTION("Allocations are counted per task and per phase");
+    resetHeap();
+
+    TEST_ASSERT(memoryMonitor.registerTask("loop", &mockTaskA), "First task registered");
+    TEST_ASSERT(memoryMonitor.registerTask("async_tcp", &mockTaskB), "Second task registered");
+    TEST_ASSERT(memoryMonitor.registerTask("main", &mockTaskA), "Re-registering renames");
+    TEST_ASSERT(memoryMonitor.taskCount() == 2, "No duplicate slot");
+    TEST_ASSERT(!memoryMonitor.registerTask("none", nullptr), "Null handle refused");
+
+    memoryMonitor.countAllocation(64);  // Outside any phase
+    {
+        MemScope scope(MEM_SDCP_PARSE);
+        memoryMonitor.countAllocation(32);
+        memoryMonitor.countAllocation(16);
+        memoryMonitor.countFree();
+    }
+    currentTask = &mockTaskB;
+    {
+        MemScope scope(MEM_LOG_DUMP);
+        memoryMonitor.countAllocation(1024);
+    }
+    int unregistered = 0;
+    currentTask      = &unregistered;
+    memoryMonitor.countAllocation(8);  // Not tracked
+    currentTask = &mockTaskA;
+
+    mem_phase_stats_t parse, dump;
+    memoryMonitor.phaseSnapshot(MEM_SDCP_PARSE, parse);
+    memoryMonitor.phaseSnapshot(MEM_LOG_DUMP, dump);
+    TEST_ASSERT(parse.allocs == 2 && parse.frees == 1 && parse.allocBytes == 48,
+                "Only allocations inside the phase are attributed");
+    TEST_ASSERT(dump.allocs == 1 && dump.allocBytes == 1024, "Attributed on the phase's task");
+
+    mem_task_stats_t task;
+    TEST_ASSERT(memoryMonitor.taskSnapshot(0, task), "First slot readable");
+    TEST_ASSERT(strcmp(task.name, "main") == 0, "Renamed slot");
+    TEST_ASSERT(task.allocs == 3 && task.frees == 1 && task.allocBytes == 112,
+                "Task totals include allocations outside phases");
+    TEST_ASSERT(memoryMonitor.taskSnapshot(1, task) && task.allocs == 1, "Second task counted");
+    TEST_ASSERT(!memoryMonitor.taskSnapshot(2, task), "No third slot");
+
+    memoryMonitor.reset();
+    TEST_ASSERT(memoryMonitor.taskSnapshot(0, task) && task.allocs == 0,
+                "Reset clears counts but keeps the registration");
+
+    TEST_PASS("Allocations are counted per task and per phase");
+}
+
+void testHeapAndStacks() {
+    TEST_SECTION("Heap sampling, fragmentation and stack marks");
+    resetHeap();
+
+    stackHighWater[0] = 1200;
+    stackHighWater[1] = 3000;
+    setMockTime(10000);
+    memoryMonitor.loop(millis());
+
+    mem_heap_stats_t heap;
+    memoryMonitor.heapSnapshot(heap);
+    TEST_ASSERT(heap.samples == 1, "First loop samples at once");
+    TEST_ASSERT(heap.freeHeap == 100000 && heap.maxAllocHeap == 80000, "Current values");
+    TEST_ASSERT(floatEquals(heap.fragmentationPct, 20.0f), "Fragmentation from largest block");
+
+    ESP.maxAlloc      = 50000;
+    stackHighWater[0] = 900;
+    memoryMonitor.loop(millis() + 10);
+    memoryMonitor.heapSnapshot(heap);
+    TEST_ASSERT(heap.samples == 1, "Not sampled again before the interval");
+
+    memoryMonitor.loop(millis() + MEMORY_SAMPLE_INTERVAL_MS);
+    ESP.maxAlloc      = 90000;
+    stackHighWater[0] = 1500;  // High-water marks never rise; a mock that does is ignored
+    memoryMonitor.loop(millis() + 2 * MEMORY_SAMPLE_INTERVAL_MS);
+    memoryMonitor.heapSnapshot(heap);
+    TEST_ASSERT(heap.samples == 3, "Sampled once per interval");
+    TEST_ASSERT(heap.minMaxAllocHeap == 50000, "Lowest largest block kept");
+    TEST_ASSERT(floatEquals(heap.maxFragmentationPct, 50.0f), "Worst fragmentation kept");
+
+    mem_task_stats_t task;
+    TEST_ASSERT(memoryMonitor.taskSnapshot(0, task) && task.stackFreeMin == 900,
+                "Stack mark is the minimum seen");
+    TEST_ASSERT(memoryMonitor.taskSnapshot(1, task) && task.stackFreeMin == 3000,
+                "Each task tracked separately");
+
+    TEST_PASS("Heap sampling, fragmentation and stack marks");
+}
+
+int main() {
+    TEST_SUITE_BEGIN("MemoryMonitor Unit Test Suite");
+
+    testPhaseLowWater();
+    testTopRetainer();
+    testAllocationCounts();
+    testHeapAndStacks();
+
+    TEST_SUITE_END();
+}
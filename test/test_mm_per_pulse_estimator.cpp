@@ -0,0 +1,141 @@
+/**
+ * Unit Tests for MmPerPulseEstimator
+ *
+ * Tests convergence on a drifted sensor, the per-print drift limit,
+ * rejection of unhealthy and outlier segments, and pass-through of seeds
+ * outside the plausible range.
+ */
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/test_mocks.h"
+
+#include "../src/MmPerPulseEstimator.h"
+#include "../src/MmPerPulseEstimator.cpp"
+
+// Telemetry of a print at 1s samples: expected mm per sample varies around
+// rateMm, the sensor lags by about one second and reports whole pulses
+struct SimulatedPrint
+{
+    float         trueMmPerPulse;
+    float         expectedMm;
+    unsigned long pulses;
+
+    explicit SimulatedPrint(float mmPerPulse)
+        : trueMmPerPulse(mmPerPulse), expectedMm(0), pulses(0) {}
+
+    void step(MmPerPulseEstimator &estimator, float rateMm, bool healthy = true)
+    {
+        float delta = rateMm * (0.8f + 0.4f * (rand() % 1000) / 1000.0f);
+        float lagMm = rateMm * (0.5f + (rand() % 1000) / 1000.0f);
+        expectedMm += delta;
+        float sensedMm = expectedMm > lagMm ? expectedMm - lagMm : 0;
+        unsigned long total = static_cast<unsigned long>(sensedMm / trueMmPerPulse);
+        unsigned long newPulses = total > pulses ? total - pulses : 0;
+        pulses += newPulses;
+        estimator.addSample(delta, newPulses, healthy);
+    }
+};
+
+void testConvergesOnDriftedSensor() {
+    TEST_SECTION("Converges on a drifted sensor");
+    srand(1);
+
+    MmPerPulseEstimator estimator;
+    estimator.reset(2.88f);
+    SimulatedPrint print(2.95f);  // Worn wheel: ~2.4% more filament per pulse
+
+    TEST_ASSERT(estimator.estimate() == 2.88f, "Starts from the seed");
+    for (int i = 0; i < 300 && estimator.segmentCount() < MM_PER_PULSE_MIN_SEGMENTS - 1; i++) {
+        print.step(estimator, 5.0f);
+    }
+    TEST_ASSERT(estimator.estimate() == 2.88f, "Seed is kept until enough segments are fitted");
+    TEST_ASSERT(!estimator.isConverged(), "Not converged on few segments");
+
+    for (int i = 0; i < 1500; i++) {
+        print.step(estimator, 5.0f);
+    }
+    float estimate = estimator.estimate();
+    std::cout << "  estimate=" << estimate << " se=" << estimator.standardErrorPercent()
+              << "% segments=" << estimator.segmentCount() << std::endl;
+    TEST_ASSERT(fabsf(estimate - 2.95f) < 0.02f, "Estimate tracks the true value");
+    TEST_ASSERT(estimator.isConverged(), "Converged after a long healthy print");
+
+    TEST_PASS("Converges on a drifted sensor");
+}
+
+void testDriftLimit() {
+    TEST_SECTION("Estimate stays within the drift limit of the seed");
+    srand(2);
+
+    MmPerPulseEstimator estimator;
+    estimator.reset(2.88f);
+    SimulatedPrint print(3.20f);  // 11% off: beyond one print's allowance
+    for (int i = 0; i < 2000; i++) {
+        print.step(estimator, 5.0f);
+    }
+    float limit = 2.88f * (1.0f + MM_PER_PULSE_MAX_DRIFT_PCT / 100.0f);
+    TEST_ASSERT(fabsf(estimator.estimate() - limit) < 1e-4f, "Estimate is capped at the drift limit");
+    TEST_ASSERT(!estimator.isConverged(), "A capped estimate is never persisted");
+
+    TEST_PASS("Estimate stays within the drift limit of the seed");
+}
+
+void testUnhealthyAndOutlierSegments() {
+    TEST_SECTION("Unhealthy flow and outliers are not fitted");
+
+    MmPerPulseEstimator estimator;
+    estimator.reset(2.88f);
+
+    // Unhealthy samples drop the open segment
+    estimator.addSample(40.0f, 14, true);
+    estimator.addSample(20.0f, 0, false);
+    TEST_ASSERT(!estimator.addSample(20.0f, 7, true), "Segment restarted after unhealthy sample");
+    TEST_ASSERT(estimator.segmentCount() == 0, "Nothing fitted across a jam");
+    estimator.addSample(0.0f, 0, false);
+
+    // A partial clog (half the pulses) is far outside the current estimate
+    TEST_ASSERT(!estimator.addSample(60.0f, 10, true), "Partial clog segment is an outlier");
+    TEST_ASSERT(estimator.segmentCount() == 0, "Outlier not fitted");
+
+    // No pulses at all over a full segment is a jam, not a calibration point
+    TEST_ASSERT(!estimator.addSample(60.0f, 0, true), "Zero-pulse segment ignored");
+
+    TEST_ASSERT(estimator.addSample(57.6f, 20, true), "Clean segment is fitted");
+    TEST_ASSERT(estimator.segmentCount() == 1, "One segment fitted");
+
+    TEST_PASS("Unhealthy flow and outliers are not fitted");
+}
+
+void testImplausibleSeed() {
+    TEST_SECTION("Seeds outside the plausible range pass through");
+
+    MmPerPulseEstimator estimator;
+    estimator.reset(1.2f);  // Some other sensor
+    for (int i = 0; i < 100; i++) {
+        estimator.addSample(60.0f, 50, true);
+    }
+    TEST_ASSERT(estimator.segmentCount() == 0, "Nothing fitted");
+    TEST_ASSERT(estimator.estimate() == 1.2f, "Setting is used unchanged");
+    TEST_ASSERT(!estimator.isConverged(), "Never converges");
+
+    TEST_PASS("Seeds outside the plausible range pass through");
+}
+
+int main() {
+    TEST_SUITE_BEGIN("MmPerPulseEstimator Unit Test Suite");
+
+    testConvergesOnDriftedSensor();
+    testDriftLimit();
+    testUnhealthyAndOutlierSegments();
+    testImplausibleSeed();
+
+    TEST_SUITE_END();
+}
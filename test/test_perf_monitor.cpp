@@ -0,0 +1,108 @@
+/**
+ * Unit Tests for PerfMonitor
+ *
+ * Tests histogram bucketing, min/max/avg bookkeeping, percentile
+ * estimation and reset.
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/test_mocks.h"
+
+// FreeRTOS/Arduino pieces PerfMonitor uses
+unsigned long _mockMicros = 0;
+inline unsigned long micros() { return _mockMicros; }
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(x) ((void) (x))
+#define portEXIT_CRITICAL(x) ((void) (x))
+#include "../src/PerfMonitor.h"
+#include "../src/PerfMonitor.cpp"
+
+void testBucketsAndExtremes() {
+    TEST_SECTION("Durations land in power-of-two buckets");
+    perfMonitor.reset();
+
+    perfMonitor.record(PERF_ELEGOO_LOOP, 0);
+    perfMonitor.record(PERF_ELEGOO_LOOP, 1);
+    perfMonitor.record(PERF_ELEGOO_LOOP, 3);
+    perfMonitor.record(PERF_ELEGOO_LOOP, 1000);
+    perfMonitor.record(PERF_ELEGOO_LOOP, 50000000);  // Far beyond the last bucket
+
+    perf_phase_stats_t stats;
+    perfMonitor.snapshot(PERF_ELEGOO_LOOP, stats);
+    TEST_ASSERT(stats.count == 5, "Count tracks every sample");
+    TEST_ASSERT(stats.minUs == 0 && stats.maxUs == 50000000, "Min/max tracked");
+    TEST_ASSERT(stats.buckets[0] == 2, "0 and 1 us share bucket 0");
+    TEST_ASSERT(stats.buckets[1] == 1, "3 us lands in [2,4)");
+    TEST_ASSERT(stats.buckets[9] == 1, "1000 us lands in [512,1024)");
+    TEST_ASSERT(stats.buckets[PERF_BUCKET_COUNT - 1] == 1, "Overflow goes to the last bucket");
+    TEST_ASSERT(stats.totalUs == 50001004ULL, "Total accumulates without overflow");
+
+    perf_phase_stats_t other;
+    perfMonitor.snapshot(PERF_SSE_BROADCAST, other);
+    TEST_ASSERT(other.count == 0 && other.minUs == 0, "Untouched phase reports zeros");
+
+    TEST_PASS("Durations land in power-of-two buckets");
+}
+
+void testPercentiles() {
+    TEST_SECTION("p50/p99 estimated from buckets");
+    perfMonitor.reset();
+
+    // 990 fast samples (~100 us) and 10 slow ones (~20 ms)
+    for (int i = 0; i < 990; i++) perfMonitor.record(PERF_REFRESH_CACHE, 100);
+    for (int i = 0; i < 10; i++) perfMonitor.record(PERF_REFRESH_CACHE, 20000);
+
+    perf_phase_stats_t stats;
+    perfMonitor.snapshot(PERF_REFRESH_CACHE, stats);
+    TEST_ASSERT(PerfMonitor::percentileUs(stats, 50.0f) == 127, "p50 is the fast bucket's bound");
+    TEST_ASSERT(PerfMonitor::percentileUs(stats, 99.0f) == 127, "p99 still within fast samples");
+    TEST_ASSERT(PerfMonitor::percentileUs(stats, 99.9f) == 20000, "p99.9 capped at max");
+
+    perfMonitor.record(PERF_REFRESH_CACHE, 20000);
+    perfMonitor.snapshot(PERF_REFRESH_CACHE, stats);
+    TEST_ASSERT(PerfMonitor::percentileUs(stats, 99.0f) == 20000, "Slow tail moves p99");
+
+    TEST_PASS("p50/p99 estimated from buckets");
+}
+
+void testScopeAndReset() {
+    TEST_SECTION("PerfScope times its scope; reset clears");
+    perfMonitor.reset();
+
+    _mockMicros = 5000;
+    {
+        PerfScope scope(PERF_DISPLAY_LOOP);
+        _mockMicros += 250;
+    }
+    perf_phase_stats_t stats;
+    perfMonitor.snapshot(PERF_DISPLAY_LOOP, stats);
+    TEST_ASSERT(stats.count == 1 && stats.maxUs == 250, "Scope recorded elapsed micros");
+
+    _mockMillis = 1000;
+    perfMonitor.reset();
+    _mockMillis = 4000;
+    perfMonitor.snapshot(PERF_DISPLAY_LOOP, stats);
+    TEST_ASSERT(stats.count == 0, "Reset clears counters");
+    TEST_ASSERT(perfMonitor.sinceResetMs() == 3000, "Window restarts at reset");
+
+    TEST_PASS("PerfScope times its scope; reset clears");
+}
+
+int main() {
+    TEST_SUITE_BEGIN("PerfMonitor Unit Test Suite");
+
+    testBucketsAndExtremes();
+    testPercentiles();
+    testScopeAndReset();
+
+    TEST_SUITE_END();
+}
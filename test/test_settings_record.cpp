@@ -0,0 +1,190 @@
+/**
+ * Unit Tests for SettingsRecord
+ *
+ * Tests the round trip of every value type, sizing and overflow, and that
+ * corrupted, truncated or newer records are refused while unknown keys and
+ * mismatched types fall back instead of failing the load.
+ */
+
+#include <iostream>
+#include <cstring>
+
+// Define mock globals before including mocks
+unsigned long _mockMillis = 0;
+int testsPassed = 0;
+int testsFailed = 0;
+
+#include "mocks/test_mocks.h"
+
+#include "../src/SettingsRecord.h"
+#include "../src/SettingsRecord.cpp"
+
+namespace
+{
+size_t buildSample(uint8_t *buffer, size_t capacity)
+{
+    SettingsRecordWriter writer(buffer, capacity);
+    writer.addBool("enabled", true);
+    writer.addInt("detection_hard_jam_mm", -42);
+    writer.addFloat("movement_mm_per_pulse", 2.88f);
+    writer.addString("ssid", "my network", 10);
+    writer.addString("passwd", "", 0);
+    return writer.finish();
+}
+
+bool findEntry(SettingsRecordReader &reader, const char *key, SettingsRecordEntry &out)
+{
+    SettingsRecordEntry entry;
+    while (reader.next(entry))
+    {
+        if (entry.keyEquals(key))
+        {
+            out = entry;
+            return true;
+        }
+    }
+    return false;
+}
+}  // namespace
+
+void testRoundTrip() {
+    TEST_SECTION("Every value type round-trips");
+
+    uint8_t buffer[256];
+    size_t  length = buildSample(buffer, sizeof(buffer));
+    TEST_ASSERT(length > SETTINGS_RECORD_HEADER_SIZE, "Record built");
+
+    SettingsRecordReader reader;
+    TEST_ASSERT(reader.open(buffer, length), "Record accepted");
+    TEST_ASSERT(reader.entryCount() == 5, "All entries counted");
+
+    SettingsRecordEntry entry;
+    TEST_ASSERT(reader.next(entry) && entry.keyEquals("enabled") && entry.asBool(false),
+                "Bool read back");
+    TEST_ASSERT(reader.next(entry) && entry.keyEquals("detection_hard_jam_mm") &&
+                    entry.asInt(0) == -42,
+                "Negative int read back");
+    TEST_ASSERT(reader.next(entry) && entry.keyEquals("movement_mm_per_pulse") &&
+                    entry.asFloat(0.0f) == 2.88f,
+                "Float read back bit-exact");
+    TEST_ASSERT(reader.next(entry) && entry.keyEquals("ssid") &&
+                    entry.type == SETTINGS_RECORD_STRING && entry.valueLength == 10 &&
+                    memcmp(entry.value, "my network", 10) == 0,
+                "String read back");
+    TEST_ASSERT(reader.next(entry) && entry.keyEquals("passwd") && entry.valueLength == 0,
+                "Empty string read back");
+    TEST_ASSERT(!reader.next(entry), "No entries past the end");
+
+    TEST_PASS("Every value type round-trips");
+}
+
+void testSizing() {
+    TEST_SECTION("Measuring pass and overflow");
+
+    SettingsRecordWriter measure(nullptr, 0);
+    measure.addBool("enabled", true);
+    measure.addString("ssid", "my network", 10);
+    TEST_ASSERT(measure.size() == SETTINGS_RECORD_HEADER_SIZE + (1 + 7 + 3 + 1) + (1 + 4 + 3 + 10),
+                "Null buffer measures the record");
+    TEST_ASSERT(measure.finish() == 0, "Nothing is produced without a buffer");
+
+    uint8_t small[24];
+    TEST_ASSERT(buildSample(small, sizeof(small)) == 0, "Too small a buffer fails");
+
+    uint8_t buffer[64];
+    SettingsRecordWriter tooLongKey(buffer, sizeof(buffer));
+    char key[300];
+    memset(key, 'k', sizeof(key) - 1);
+    key[sizeof(key) - 1] = '\0';
+    tooLongKey.addBool(key, true);
+    TEST_ASSERT(tooLongKey.finish() == 0, "Keys past 255 bytes are refused");
+
+    TEST_PASS("Measuring pass and overflow");
+}
+
+void testRejectsDamagedRecords() {
+    TEST_SECTION("Damaged records are refused");
+
+    uint8_t buffer[256];
+    size_t  length = buildSample(buffer, sizeof(buffer));
+    SettingsRecordReader reader;
+    SettingsRecordEntry  entry;
+
+    uint8_t copy[256];
+    memcpy(copy, buffer, length);
+    copy[length - 3] ^= 0x01;
+    TEST_ASSERT(!reader.open(copy, length), "Flipped payload bit fails the CRC");
+    TEST_ASSERT(!reader.next(entry), "Nothing readable after a failed open");
+
+    TEST_ASSERT(!reader.open(buffer, length - 1), "Truncated record refused");
+    TEST_ASSERT(!reader.open(buffer, SETTINGS_RECORD_HEADER_SIZE - 1), "Short header refused");
+    TEST_ASSERT(!reader.open(nullptr, length), "Null data refused");
+
+    memcpy(copy, buffer, length);
+    copy[0] ^= 0xFF;
+    TEST_ASSERT(!reader.open(copy, length), "Wrong magic refused");
+
+    memcpy(copy, buffer, length);
+    copy[4] = SETTINGS_RECORD_VERSION + 1;
+    TEST_ASSERT(!reader.open(copy, length), "Newer format version refused");
+
+    // Count says one more entry than the payload holds (CRC covers payload only)
+    memcpy(copy, buffer, length);
+    copy[6] = static_cast<uint8_t>(copy[6] + 1);
+    TEST_ASSERT(!reader.open(copy, length), "Entry count past the payload refused");
+
+    TEST_ASSERT(reader.open(buffer, length), "Original still accepted");
+
+    TEST_PASS("Damaged records are refused");
+}
+
+void testUnknownAndMismatched() {
+    TEST_SECTION("Unknown keys and mismatched types fall back");
+
+    uint8_t buffer[128];
+    SettingsRecordWriter writer(buffer, sizeof(buffer));
+    writer.addString("future_setting", "x", 1);
+    writer.addInt("enabled", 1);  // Type changed between firmware versions
+    writer.addFloat("detection_hard_jam_mm", 5.0f);
+    size_t length = writer.finish();
+
+    SettingsRecordReader reader;
+    TEST_ASSERT(reader.open(buffer, length), "Record accepted");
+
+    SettingsRecordEntry entry;
+    TEST_ASSERT(findEntry(reader, "enabled", entry), "Key found after an unknown one");
+    TEST_ASSERT(entry.asBool(false) == false, "Int entry read as bool gives the fallback");
+
+    TEST_ASSERT(reader.open(buffer, length) && findEntry(reader, "detection_hard_jam_mm", entry),
+                "Reopened and found");
+    TEST_ASSERT(entry.asInt(7) == 7, "Float entry read as int gives the fallback");
+    TEST_ASSERT(!entry.keyEquals("detection_hard_jam"), "Prefix of a key does not match");
+
+    TEST_ASSERT(reader.open(buffer, length) && !findEntry(reader, "missing", entry),
+                "Missing key is not found");
+
+    TEST_PASS("Unknown keys and mismatched types fall back");
+}
+
+void testCrcReference() {
+    TEST_SECTION("CRC-32 matches the IEEE check value");
+
+    const char *check = "123456789";
+    TEST_ASSERT(settingsRecordCrc32(reinterpret_cast<const uint8_t *>(check), 9) == 0xCBF43926u,
+                "Check value");
+    TEST_ASSERT(settingsRecordCrc32(nullptr, 0) == 0, "Empty input");
+
+    TEST_PASS("CRC-32 matches the IEEE check value");
+}
+
+int main() {
+    TEST_SUITE_BEGIN("SettingsRecord Unit Test Suite");
+
+    testRoundTrip();
+    testSizing();
+    testRejectsDamagedRecords();
+    testUnknownAndMismatched();
+    testCrcReference();
+
+    TEST_SUITE_END();
+}
@@ -18,6 +18,17 @@
  * With AddressSanitizer:
  *   g++ -std=c++17 -fsanitize=address -fno-omit-frame-pointer -g \
  *       -I. -I./mocks -I../src -o test_soak test_soak.cpp && ./test_soak
+ *
+ * Throughput mode (build with -O2): runs only the full pipeline soak, timed
+ * (fastest of --repetitions runs, default 5), and reports simulated hours per wall second, where the time goes per
+ * component (sampled on every 64th iteration) and peak RSS:
+ *   ./test_soak --throughput [--iterations N] [--repetitions N]
+ *   ./test_soak --throughput --json soak_baseline.json        # record
+ *   ./test_soak --throughput --compare soak_baseline.json [--tolerance 20]
+ * The comparison fails when the pipeline is more than --tolerance percent
+ * slower per iteration than the baseline, or allocates where it did not.
+ *
+ * Or: ./build_and_run_all_tests.sh --soak [--sanitize | --tsan]
  */
 
 #include <iostream>
@@ -27,6 +38,13 @@
 #include <cstring>
 #include <cstdarg>
 #include <climits>
+#include <sys/resource.h>
+
+// Sanitizers bring their own allocator; count allocations only without them
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define BENCH_NO_ALLOC_COUNTING
+#endif
+#include "bench_support.h"
 
 // Define mock globals before including mocks
 unsigned long _mockMillis = 0;
@@ -54,6 +72,7 @@ public:
     void log(const char* msg, LogLevel level = LOG_NORMAL) {}
     void logf(const char* fmt, ...) {}
     void logf(LogLevel level, const char* fmt, ...) {}
+    template <typename... Args> void logDeferred(LogLevel level, const char* fmt, Args... args) {}
 };
 
 // Mock SettingsManager singleton
@@ -82,6 +101,93 @@ MockSerial Serial;
 #include "../src/JamDetector.h"
 #include "../src/JamDetector.cpp"
 
+// ============================================================================
+// Throughput profile
+// ============================================================================
+
+enum SoakComponent {
+    COMP_EXPECTED = 0,  // FilamentMotionSensor::updateExpectedPosition
+    COMP_PULSE,         // FilamentMotionSensor::addSensorPulse
+    COMP_WINDOW,        // Windowed rates and distances
+    COMP_DETECTOR,      // JamDetector::update
+    COMP_COUNT
+};
+
+static const char *const kComponentNames[COMP_COUNT] = {
+    "sensor.updateExpected", "sensor.addPulse", "sensor.window", "detector.update"};
+
+// Every call is counted; only sampled iterations are timed, whole and per
+// component, so the clock reads stay off most iterations and the component
+// shares are taken against the same iterations they were measured in
+struct SoakProfile {
+    typedef std::chrono::steady_clock clock;
+
+    bool          sampling = false;
+    unsigned long calls[COMP_COUNT] = {};
+    unsigned long sampledCalls[COMP_COUNT] = {};
+    double        sampledNs[COMP_COUNT] = {};
+    unsigned long sampledIterations = 0;
+    double        sampledIterationNs = 0.0;
+    double        clockOverheadNs = 0.0;
+
+    clock::time_point iterationStart;
+    unsigned int      iterationScopes = 0;
+
+    void beginIteration(bool sample) {
+        sampling = sample;
+        if (sampling) {
+            iterationScopes = 0;
+            iterationStart  = clock::now();
+        }
+    }
+
+    void endIteration() {
+        if (sampling) {
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - iterationStart).count();
+            // Two clock reads per timed component plus the closing read
+            ns -= clockOverheadNs * (2 * iterationScopes + 1);
+            sampledIterationNs += std::max(0.0, ns);
+            sampledIterations++;
+        }
+    }
+
+    // Cost of a back-to-back pair of clock reads, taken off every sample
+    void calibrate() {
+        const int PAIRS = 100000;
+        clock::time_point start = clock::now();
+        for (int i = 0; i < PAIRS; i++) {
+            bench::doNotOptimize(clock::now());
+        }
+        clockOverheadNs = std::chrono::duration<double, std::nano>(clock::now() - start).count() /
+                          PAIRS;
+    }
+
+    class Scope {
+    public:
+        Scope(SoakProfile *profile, SoakComponent component)
+            : profile(profile), component(component) {
+            if (profile != nullptr) {
+                profile->calls[component]++;
+                if (profile->sampling) {
+                    start = clock::now();
+                }
+            }
+        }
+        ~Scope() {
+            if (profile != nullptr && profile->sampling) {
+                double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+                profile->sampledNs[component] += std::max(0.0, ns - profile->clockOverheadNs);
+                profile->sampledCalls[component]++;
+                profile->iterationScopes++;
+            }
+        }
+    private:
+        SoakProfile      *profile;
+        SoakComponent     component;
+        clock::time_point start;
+    };
+};
+
 // ============================================================================
 // Soak Test Harness (extended from integration test pattern)
 // ============================================================================
@@ -104,11 +210,12 @@ public:
     unsigned long pauseResumeCycles;
     unsigned long jamDetections;
     unsigned long maxPulseCount;
+    SoakProfile  *profile;  // Throughput mode only
 
     SoakHarness() : printStartTime(0), isPrinting(false), pulseCount(0),
                     totalExtrusionMm(0.0f), totalIterations(0), printStarts(0),
                     printStops(0), pauseResumeCycles(0), jamDetections(0),
-                    maxPulseCount(0) {
+                    maxPulseCount(0), profile(nullptr) {
         config.graceTimeMs = 5000;
         config.hardJamMm = 5.0f;
         config.softJamTimeMs = 10000;
@@ -139,33 +246,46 @@ public:
 
     void addExtrusion(float deltaMm) {
         totalExtrusionMm += deltaMm;
+        SoakProfile::Scope scope(profile, COMP_EXPECTED);
         sensor.updateExpectedPosition(totalExtrusionMm);
     }
 
     void addPulse(float mmPerPulse = 2.88f) {
-        sensor.addSensorPulse(mmPerPulse);
+        {
+            SoakProfile::Scope scope(profile, COMP_PULSE);
+            sensor.addSensorPulse(mmPerPulse);
+        }
         pulseCount++;
         if (pulseCount > maxPulseCount) maxPulseCount = pulseCount;
     }
 
     JamState runDetection() {
-        float expectedRate, actualRate;
-        sensor.getWindowedRates(expectedRate, actualRate);
+        float expectedRate, actualRate, expectedDistance, sensorDistance;
+        {
+            SoakProfile::Scope scope(profile, COMP_WINDOW);
+            sensor.getWindowedRates(expectedRate, actualRate);
+            expectedDistance = sensor.getExpectedDistance();
+            sensorDistance   = sensor.getSensorDistance();
+        }
 
         totalIterations++;
 
-        JamState state = detector.update(
-            sensor.getExpectedDistance(),
-            sensor.getSensorDistance(),
-            pulseCount,
-            isPrinting,
-            true,
-            millis(),
-            printStartTime,
-            config,
-            expectedRate,
-            actualRate
-        );
+        JamState state;
+        {
+            SoakProfile::Scope scope(profile, COMP_DETECTOR);
+            state = detector.update(
+                expectedDistance,
+                sensorDistance,
+                pulseCount,
+                isPrinting,
+                true,
+                millis(),
+                printStartTime,
+                config,
+                expectedRate,
+                actualRate
+            );
+        }
 
         if (state.jammed) jamDetections++;
         return state;
@@ -282,10 +402,19 @@ struct CachedResponse {
 // ============================================================================
 
 // Total simulated iterations. 10M iterations @ 250ms = ~694 hours simulated.
-// Reduced to 2M for reasonable test time (~5-10 seconds).
+// Reduced to 2M for reasonable test time (~5-10 seconds); --iterations
+// overrides it.
 static const long SOAK_ITERATIONS = 2000000;
 static const int  TICK_MS = 250;  // Simulated time per iteration
 
+// Filled by testFullPipelineSoak() for the throughput report
+struct SoakThroughput {
+    long          iterations = 0;
+    double        wallMs = 0.0;
+    unsigned long allocations = 0;
+    SoakProfile   profile;
+};
+
 /**
  * Test 1: Full pipeline soak - cycling through print states
  *
@@ -293,11 +422,15 @@ static const int  TICK_MS = 250;  // Simulated time per iteration
  *   idle(10s) -> print(60s, healthy) -> soft jam(5s) -> recovery(10s) ->
  *   pause(3s) -> resume(30s) -> stop -> repeat
  */
-void testFullPipelineSoak() {
-    TEST_SECTION("Full Pipeline Soak (" + std::to_string(SOAK_ITERATIONS) + " iterations)");
+void testFullPipelineSoak(long iterations = SOAK_ITERATIONS, SoakThroughput *throughput = nullptr) {
+    TEST_SECTION("Full Pipeline Soak (" + std::to_string(iterations) + " iterations)");
 
     resetMockTime();
     SoakHarness harness;
+    if (throughput != nullptr) {
+        throughput->profile.calibrate();
+        harness.profile = &throughput->profile;
+    }
 
     // State machine for cycling through conditions
     enum Phase { IDLE, GRACE, HEALTHY, SOFT_JAM, RECOVERY, PAUSED, POST_RESUME };
@@ -316,9 +449,15 @@ void testFullPipelineSoak() {
 
     int phaseIter = 0;
 
-    for (long i = 0; i < SOAK_ITERATIONS; i++) {
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+    unsigned long allocationsStart = bench::allocationCount().load();
+
+    for (long i = 0; i < iterations; i++) {
         advanceTime(TICK_MS);
         phaseIter++;
+        if (throughput != nullptr) {
+            throughput->profile.beginIteration((i & 63) == 0);
+        }
 
         switch (phase) {
         case IDLE:
@@ -406,6 +545,18 @@ void testFullPipelineSoak() {
             }
             break;
         }
+
+        if (throughput != nullptr) {
+            throughput->profile.endIteration();
+        }
+    }
+
+    if (throughput != nullptr) {
+        throughput->iterations  = iterations;
+        throughput->wallMs      = std::chrono::duration<double, std::milli>(
+                                      std::chrono::steady_clock::now() - wallStart).count();
+        throughput->allocations = bench::allocationCount().load() - allocationsStart;
+        throughput->profile.sampling = false;
     }
 
     // Verify state is sane after soak
@@ -445,7 +596,7 @@ void testFullPipelineSoak() {
               << ((_mockMillis % 3600000) / 60000) << "m" << std::endl;
 
     TEST_PASS("Full pipeline soak: " + std::to_string(cycleCount) + " cycles, " +
-              std::to_string(SOAK_ITERATIONS) + " iterations");
+              std::to_string(iterations) + " iterations");
 }
 
 /**
@@ -707,17 +858,131 @@ void testExtrusionAccumulationPrecision() {
 // Main
 // ============================================================================
 
-int main() {
+// Peak resident set size of the process so far (Linux reports KiB)
+long peakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+// Prints the throughput report; returns false if the baseline gate fails
+bool reportThroughput(const SoakThroughput &t, const char *jsonPath, const char *comparePath,
+                      double tolerancePct) {
+    const SoakProfile &p = t.profile;
+    double simulatedHours = t.iterations * (double)TICK_MS / 3600000.0;
+    double nsPerIteration = t.wallMs * 1e6 / t.iterations;
+
     std::cout << "\n========================================" << std::endl;
-    std::cout << "    Soak Test Suite" << std::endl;
+    std::cout << "Throughput:" << std::endl;
+    printf("  %ld iterations, %.1f simulated hours in %.0f ms\n", t.iterations, simulatedHours,
+           t.wallMs);
+    printf("  %.1f simulated hours per wall second, %.1f ns per iteration\n",
+           simulatedHours / (t.wallMs / 1000.0), nsPerIteration);
+#ifdef BENCH_NO_ALLOC_COUNTING
+    printf("  allocations not counted (sanitizer build), peak RSS %ld KiB\n", peakRssKb());
+#else
+    printf("  %.3f allocations per iteration, peak RSS %ld KiB\n",
+           (double)t.allocations / t.iterations, peakRssKb());
+#endif
+
+    printf("Per component (%lu iterations timed, every 64th):\n", p.sampledIterations);
+    double accounted = 0.0;
+    for (int c = 0; c < COMP_COUNT; c++) {
+        double nsPerCall = p.sampledCalls[c] > 0 ? p.sampledNs[c] / p.sampledCalls[c] : 0.0;
+        double share = p.sampledIterationNs > 0.0 ? p.sampledNs[c] / p.sampledIterationNs : 0.0;
+        accounted += share;
+        printf("  %-24s %8.1f ns/call %6.2f calls/iter %5.1f%%\n", kComponentNames[c], nsPerCall,
+               (double)p.calls[c] / t.iterations, 100.0 * share);
+    }
+    printf("  %-24s %8s %18s %5.1f%%\n", "harness (rest)", "", "",
+           100.0 * std::max(0.0, 1.0 - accounted));
+
+    std::vector<bench::Result> results(1);
+    results[0].name        = "soak.pipeline";
+    results[0].iterations  = (unsigned long)t.iterations;
+    results[0].nsPerOp     = nsPerIteration;
+    results[0].allocsPerOp = (double)t.allocations / t.iterations;
+
+    bool ok = true;
+    if (jsonPath != nullptr) {
+        if (bench::writeBaseline(jsonPath, results)) {
+            std::cout << "Wrote " << jsonPath << std::endl;
+        } else {
+            std::cout << "Could not write " << jsonPath << std::endl;
+            ok = false;
+        }
+    }
+    if (comparePath != nullptr) {
+        std::vector<bench::Result> baseline;
+        if (!bench::readBaseline(comparePath, baseline) || baseline.empty()) {
+            std::cout << "Could not read " << comparePath << std::endl;
+            return false;
+        }
+        std::cout << "Against " << comparePath << " (tolerance " << tolerancePct << "%):"
+                  << std::endl;
+        if (bench::compareBaseline(baseline, results, tolerancePct) > 0) {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    bool        throughputMode = false;
+    long        iterations     = SOAK_ITERATIONS;
+    int         repetitions    = 5;
+    const char *jsonPath       = nullptr;
+    const char *comparePath    = nullptr;
+    double      tolerancePct   = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--throughput") == 0) {
+            throughputMode = true;
+        } else if (strcmp(argv[i], "--iterations") == 0 && hasValue) {
+            iterations = std::max(1L, atol(argv[++i]));
+        } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            repetitions = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && hasValue) {
+            comparePath = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            tolerancePct = atof(argv[++i]);
+        } else {
+            std::cout << "Usage: test_soak [--throughput] [--iterations N] [--repetitions N]\n"
+                         "                 [--json PATH] [--compare PATH] [--tolerance PCT]"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "    Soak Test Suite" << (throughputMode ? " (throughput)" : "") << std::endl;
     std::cout << "========================================" << std::endl;
 
-    testFullPipelineSoak();
-    testLoggerCircularBufferSoak();
-    testCachedResponseSoak();
-    testMillisRollover();
-    testRapidStartStopCycling();
-    testExtrusionAccumulationPrecision();
+    bool gateOk = true;
+    if (throughputMode) {
+        // Fastest run wins, so a descheduled run does not fail the gate
+        SoakThroughput best;
+        for (int r = 0; r < repetitions; r++) {
+            SoakThroughput throughput;
+            testFullPipelineSoak(iterations, &throughput);
+            if (r == 0 || throughput.wallMs < best.wallMs) {
+                best = throughput;
+            }
+        }
+        gateOk = reportThroughput(best, jsonPath, comparePath, tolerancePct);
+    } else {
+        testFullPipelineSoak(iterations);
+        testLoggerCircularBufferSoak();
+        testCachedResponseSoak();
+        testMillisRollover();
+        testRapidStartStopCycling();
+        testExtrusionAccumulationPrecision();
+    }
 
     std::cout << "\n========================================" << std::endl;
     std::cout << "Test Results:" << std::endl;
@@ -727,5 +992,5 @@ int main() {
     }
     std::cout << "========================================\n" << std::endl;
 
-    return testsFailed > 0 ? 1 : 0;
+    return (testsFailed > 0 || !gateOk) ? 1 : 0;
 }
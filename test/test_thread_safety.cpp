@@ -14,6 +14,12 @@
  *   g++ -std=c++17 -fsanitize=address -fno-omit-frame-pointer -g -lpthread \
  *       -I. -I./mocks -I../src -o test_thread_safety test_thread_safety.cpp \
  *       && ./test_thread_safety
+ *
+ * The mocked critical sections also feed LockProfiler (src/LockProfiler.h):
+ * after the tests a table lists, per stress workload and lock, how often it
+ * was taken and contended and how long it was held and waited for, in ns.
+ * Hold times stand for interrupts masked on the device; build with -O2 and
+ * without sanitizers for numbers worth comparing between locks.
  */
 
 #include <iostream>
@@ -25,6 +31,11 @@
 #include <thread>
 #include <vector>
 #include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <string>
+
+#include "SharedPayload.h"
 
 // ============================================================================
 // Mock ESP32 primitives using POSIX mutexes
@@ -45,14 +56,33 @@ struct portMUX_TYPE {
 
 #define portMUX_INITIALIZER_UNLOCKED portMUX_TYPE()
 
+// Profile every critical section: ticks are steady_clock nanoseconds
+#define LOCK_PROFILE_NAME(lock, name) lockProfiler.setName(lock, name)
+#include "LockProfiler.h"
+#include "LockProfiler.cpp"
+
+inline uint32_t profileTicks() {
+    return (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 inline void portENTER_CRITICAL(portMUX_TYPE *mux) {
-    mux->mtx->lock();
+    uint32_t start = profileTicks();
+    bool contended = !mux->mtx->try_lock();
+    if (contended) {
+        mux->mtx->lock();
+    }
+    uint32_t now = profileTicks();
+    lockProfiler.acquired(mux, now - start, contended, now);
 }
 
 inline void portEXIT_CRITICAL(portMUX_TYPE *mux) {
+    lockProfiler.released(mux, profileTicks());
     mux->mtx->unlock();
 }
 
+#include "VersionedSnapshot.h"
+
 // Mock millis / time
 static std::atomic<unsigned long> _mockMillis{0};
 unsigned long millis() { return _mockMillis.load(std::memory_order_relaxed); }
@@ -181,6 +211,7 @@ public:
         : logCapacity(MAX_LOG_ENTRIES), currentIndex(0), totalEntries(0),
           uuidCounter(0), currentLogLevel(LOG_PIN_VALUES) {
         _logMutex = portMUX_INITIALIZER_UNLOCKED;
+        LOCK_PROFILE_NAME(&_logMutex, "Logger::_logMutex");
         memset(logBuffer, 0, sizeof(logBuffer));
     }
 
@@ -291,6 +322,8 @@ struct CachedResponse {
     volatile int activeIdx = 0;
     mutable portMUX_TYPE _mutex = portMUX_INITIALIZER_UNLOCKED;
 
+    CachedResponse() { LOCK_PROFILE_NAME(&_mutex, "CachedResponse::_mutex"); }
+
     void publish(const char *json, size_t jsonLen) {
         int writeIdx = !activeIdx;
         size_t copyLen = (jsonLen < kCacheBufSize - 1) ? jsonLen : (kCacheBufSize - 1);
@@ -671,6 +704,242 @@ void testCachePublishLargePayload() {
               " publishes, " + std::to_string(readCount.load()) + " reads");
 }
 
+/**
+ * Test 7: SharedPayload held references stay intact
+ * Thread A: publishes numbered payloads
+ * Threads B-D: hold a reference across many checks, like a slow response
+ * Verifies a referenced body is never rewritten and publishes that find no
+ * free slot fail instead of overwriting one.
+ */
+void testSharedPayloadHeldRefs() {
+    TEST_SECTION("SharedPayload held references under publish");
+
+    static SharedPayload<kCacheBufSize, 3> payload;
+    std::atomic<bool> running{true};
+    std::atomic<int> readCount{0};
+    std::atomic<int> corrupted{0};
+    std::atomic<int> failedPublishes{0};
+
+    std::thread writer([&]() {
+        char body[kCacheBufSize];
+        for (int i = 0; i < STRESS_ITERATIONS; i++) {
+            // Every byte derived from i, so a rewrite under a reader shows
+            int len = snprintf(body, sizeof(body), "{\"n\":%08d,\"pad\":\"", i);
+            memset(body + len, 'a' + (i % 26), 600);
+            len += 600;
+            len += snprintf(body + len, sizeof(body) - len, "\"}");
+            if (!payload.publish(body, len)) {
+                failedPublishes.fetch_add(1);
+            }
+        }
+        running.store(false);
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&]() {
+            while (running.load()) {
+                SharedPayloadRef ref = payload.acquire();
+                if (!ref) {
+                    continue;
+                }
+                SharedPayloadRef copy = ref;  // Responses copy their filler
+                char first[16];
+                memcpy(first, ref.data(), sizeof(first));
+                char fill = ref.data()[21];
+                for (int check = 0; check < 20; check++) {
+                    if (memcmp(first, copy.data(), sizeof(first)) != 0 ||
+                        copy.data()[ref.size() - 3] != fill ||
+                        copy.data()[ref.size()] != '\0') {
+                        corrupted.fetch_add(1);
+                        break;
+                    }
+                }
+                readCount.fetch_add(1);
+            }
+        });
+    }
+
+    writer.join();
+    for (auto &th : readers) th.join();
+
+    TEST_ASSERT(readCount.load() > 0, "Readers completed reads");
+    TEST_ASSERT(corrupted.load() == 0,
+                "No held body rewritten (got " + std::to_string(corrupted.load()) + ")");
+    TEST_PASS("SharedPayload: " + std::to_string(readCount.load()) + " held reads, " +
+              std::to_string(failedPublishes.load()) + " publishes deferred");
+}
+
+/**
+ * Test 8: SharedPayload slot accounting (single thread)
+ * The writer never takes the current slot or one still referenced, and the
+ * slots come back when the references go away.
+ */
+void testSharedPayloadSlotAccounting() {
+    TEST_SECTION("SharedPayload slot accounting");
+
+    SharedPayload<64, 2> payload;
+    TEST_ASSERT(!payload.acquire(), "Empty before the first publish");
+
+    TEST_ASSERT(payload.publish("first", 5), "First publish");
+    {
+        SharedPayloadRef held = payload.acquire();
+        TEST_ASSERT(held && strcmp(held.data(), "first") == 0, "Reads the first body");
+        TEST_ASSERT(payload.publish("second", 6), "Spare slot is free");
+        // "first" is held and "second" is current: no slot left
+        TEST_ASSERT(!payload.publish("third", 5), "Publish fails while both slots are in use");
+        TEST_ASSERT(strcmp(held.data(), "first") == 0, "Held body unchanged");
+        TEST_ASSERT(strcmp(payload.acquire().data(), "second") == 0, "Readers get the current body");
+    }
+    TEST_ASSERT(payload.publish("third", 5), "Slot reusable once released");
+    TEST_ASSERT(strcmp(payload.acquire().data(), "third") == 0, "Third body is current");
+    TEST_ASSERT(payload.publishFailures() == 1, "One deferred publish counted");
+
+    TEST_PASS("SharedPayload slots are reused only when unreferenced");
+}
+
+/**
+ * Test 9: VersionedSnapshot under concurrent publish
+ * Readers polling refresh() only ever see whole values, and the version they
+ * record never goes backwards.
+ */
+struct SnapshotValue {
+    uint32_t sequence;
+    float    scaled;
+    int      words[8];
+};
+
+void testVersionedSnapshot() {
+    TEST_SECTION("VersionedSnapshot concurrent publish/refresh");
+
+    static VersionedSnapshot<SnapshotValue> snapshot;
+    snapshot.nameLock("VersionedSnapshot::lock");
+    std::atomic<bool> running{true};
+    std::atomic<int> refreshes{0};
+    std::atomic<int> torn{0};
+    std::atomic<int> regressions{0};
+
+    std::thread writer([&]() {
+        SnapshotValue value;
+        for (int i = 1; i <= STRESS_ITERATIONS; i++) {
+            value.sequence = i;
+            value.scaled   = i * 0.5f;
+            for (int w = 0; w < 8; w++) {
+                value.words[w] = i + w;
+            }
+            snapshot.publish(value);
+            if (i % 16 == 0) {
+                std::this_thread::yield();  // Let readers interleave
+            }
+        }
+        running.store(false);
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; t++) {
+        readers.emplace_back([&]() {
+            SnapshotValue cached;
+            memset(&cached, 0, sizeof(cached));
+            uint32_t version = 0;
+            while (running.load()) {
+                uint32_t before = version;
+                if (!snapshot.refresh(cached, version)) {
+                    continue;
+                }
+                refreshes.fetch_add(1);
+                if (version < before) {
+                    regressions.fetch_add(1);
+                }
+                bool whole = cached.sequence == version && cached.scaled == cached.sequence * 0.5f;
+                for (int w = 0; w < 8 && whole; w++) {
+                    whole = cached.words[w] == (int) cached.sequence + w;
+                }
+                if (!whole) {
+                    torn.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    writer.join();
+    for (auto &th : readers) th.join();
+
+    SnapshotValue last;
+    uint32_t lastVersion = 0;
+    TEST_ASSERT(snapshot.refresh(last, lastVersion), "Fresh reader copies the value");
+    TEST_ASSERT(!snapshot.refresh(last, lastVersion), "No copy while the version is unchanged");
+    TEST_ASSERT(last.sequence == (uint32_t) STRESS_ITERATIONS &&
+                    snapshot.version() == (uint32_t) STRESS_ITERATIONS,
+                "Last publish is current");
+    TEST_ASSERT(torn.load() == 0, "No torn snapshot (got " + std::to_string(torn.load()) + ")");
+    TEST_ASSERT(regressions.load() == 0, "Versions never go backwards");
+    TEST_PASS("VersionedSnapshot: " + std::to_string(refreshes.load()) + " refreshes, all whole");
+}
+
+// ============================================================================
+// Lock contention report
+// ============================================================================
+
+struct LockRow {
+    std::string  workload;
+    lock_stats_t stats;
+};
+
+static std::vector<LockRow> lockRows;
+
+// Runs one stress test with fresh lock counters and keeps its locks' rows.
+// Locks live on the test's stack, so a slot may be reused by the next test's
+// lock at the same address; every lock names itself when constructed.
+void runProfiled(const char *workload, void (*test)()) {
+    lockProfiler.reset();
+    test();
+    lock_stats_t stats;
+    for (uint8_t i = 0; lockProfiler.snapshot(i, stats); i++) {
+        if (stats.acquisitions > 0) {
+            lockRows.push_back(LockRow{workload, stats});
+        }
+    }
+}
+
+void printLockReport() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Lock contention (ns):" << std::endl;
+    printf("  %-16s %-26s %9s %9s %8s %8s %9s %8s %9s\n", "workload", "lock", "acquired",
+           "contended", "holdAvg", "holdP99", "holdMax", "waitAvg", "waitMax");
+    for (const LockRow &row : lockRows) {
+        const lock_stats_t &s = row.stats;
+        printf("  %-16s %-26s %9lu %9lu %8.0f %8lu %9lu %8.0f %9lu\n", row.workload.c_str(),
+               s.name ? s.name : "(unnamed)", (unsigned long) s.acquisitions,
+               (unsigned long) s.contended, (double) s.holdTicks / s.acquisitions,
+               (unsigned long) LockProfiler::holdPercentileTicks(s, 99.0f),
+               (unsigned long) s.maxHoldTicks, (double) s.waitTicks / s.acquisitions,
+               (unsigned long) s.maxWaitTicks);
+    }
+    if (lockProfiler.overflowed() > 0) {
+        printf("  %lu lock(s) beyond %u slots not recorded\n",
+               (unsigned long) lockProfiler.overflowed(), (unsigned) LOCK_PROFILE_SLOTS);
+    }
+    if (lockRows.empty()) {
+        return;
+    }
+
+    // The longest single hold bounds ISR latency; p99 shows the typical worst
+    auto worst = [](uint32_t (*key)(const lock_stats_t &)) {
+        return *std::max_element(lockRows.begin(), lockRows.end(),
+                                 [key](const LockRow &a, const LockRow &b) {
+                                     return key(a.stats) < key(b.stats);
+                                 });
+    };
+    LockRow byMax = worst([](const lock_stats_t &s) { return s.maxHoldTicks; });
+    LockRow byP99 = worst(
+        [](const lock_stats_t &s) { return LockProfiler::holdPercentileTicks(s, 99.0f); });
+    printf("  Longest hold: %s (%s), %lu ns\n", byMax.stats.name ? byMax.stats.name : "(unnamed)",
+           byMax.workload.c_str(), (unsigned long) byMax.stats.maxHoldTicks);
+    printf("  Highest p99 hold: %s (%s), %lu ns\n",
+           byP99.stats.name ? byP99.stats.name : "(unnamed)", byP99.workload.c_str(),
+           (unsigned long) LockProfiler::holdPercentileTicks(byP99.stats, 99.0f));
+}
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -680,12 +949,16 @@ int main() {
     std::cout << "    Thread Safety Stress Test Suite" << std::endl;
     std::cout << "========================================" << std::endl;
 
-    testConcurrentLogAndRead();
-    testConcurrentLogAndClear();
-    testTripleContention();
-    testCachedResponseDoubleBuffer();
-    testUuidUniquenessUnderContention();
-    testCachePublishLargePayload();
+    runProfiled("logRead", testConcurrentLogAndRead);
+    runProfiled("logClear", testConcurrentLogAndClear);
+    runProfiled("logReadClear", testTripleContention);
+    runProfiled("cacheDouble", testCachedResponseDoubleBuffer);
+    runProfiled("uuid", testUuidUniquenessUnderContention);
+    runProfiled("cacheLarge", testCachePublishLargePayload);
+    runProfiled("payloadRefs", testSharedPayloadHeldRefs);
+    runProfiled("payloadSlots", testSharedPayloadSlotAccounting);
+    runProfiled("snapshot", testVersionedSnapshot);
+    printLockReport();
 
     std::cout << "\n========================================" << std::endl;
     std::cout << "Test Results:" << std::endl;
@@ -5,6 +5,7 @@ import argparse
 import asyncio
 import json
 import re
+import struct
 from pathlib import Path
 from typing import Generator, Iterable, List, Tuple
 
@@ -110,6 +111,49 @@ def format_json(samples: Iterable[Tuple[int, float, float]]) -> str:
     )
 
 
+# Must match src/FlowProfile.h
+PROFILE_MAGIC = b"FPRF"
+PROFILE_VERSION = 1
+PROFILE_HEADER = struct.Struct("<4sHHIII64s")
+PROFILE_MAX_ENTRIES = 65536
+
+
+def build_flow_profile(
+    samples: List[Tuple[int, float, float]], interval_ms: int, name: str
+) -> bytes:
+    """Pack samples into a FlowProfile file for POST /api/flow_profile.
+
+    One entry per interval (one CurrentTicks step in --serve): the cumulative
+    expected extrusion in micrometres at that tick. Ticks without a sample
+    repeat the previous total.
+    """
+    if not samples:
+        raise ValueError("no samples")
+    tick_count = samples[-1][0] // interval_ms + 1
+    if tick_count < 2 or tick_count > PROFILE_MAX_ENTRIES:
+        raise ValueError(f"profile needs 2..{PROFILE_MAX_ENTRIES} ticks, got {tick_count}")
+
+    entries = [0] * tick_count
+    index = 0
+    total_um = 0
+    for tick in range(tick_count):
+        while index < len(samples) and samples[index][0] // interval_ms <= tick:
+            total_um = max(0, int(round(samples[index][2] * 1000)))
+            index += 1
+        entries[tick] = total_um
+
+    header = PROFILE_HEADER.pack(
+        PROFILE_MAGIC,
+        PROFILE_VERSION,
+        PROFILE_HEADER.size,
+        interval_ms,
+        1,
+        tick_count,
+        name.encode("utf-8")[:63],
+    )
+    return header + struct.pack(f"<{tick_count}I", *entries)
+
+
 def build_arg_parser() -> argparse.ArgumentParser:
     parser = argparse.ArgumentParser(
         description="Convert a G-code file into synthetic extrusion samples "
@@ -136,6 +180,24 @@ def build_arg_parser() -> argparse.ArgumentParser:
         default="table",
         help="Output format (default: table)",
     )
+    parser.add_argument(
+        "--profile-out",
+        type=Path,
+        help="Also write a flow profile for the device; upload it with "
+        "curl --data-binary @FILE -H 'Content-Type: application/octet-stream' "
+        "http://DEVICE/api/flow_profile",
+    )
+    parser.add_argument(
+        "--profile-name",
+        help="Print filename the profile applies to (default: the G-code file name; "
+        "empty string = any print)",
+    )
+    parser.add_argument(
+        "--record",
+        type=Path,
+        help="Also write the frames --serve would send, one '<ms>\\t<json>' line each, "
+        "for test/sdcp_replay --frames",
+    )
     parser.add_argument(
         "--serve",
         action="store_true",
@@ -166,22 +228,23 @@ def build_arg_parser() -> argparse.ArgumentParser:
     return parser
 
 
-def build_status_payload(delta: float, total: float, index: int, count: int) -> str:
+def build_status_payload(
+    delta: float, total: float, index: int, count: int, ticks: int, total_ticks: int, filename: str
+) -> str:
     """Build a websocket payload that mimics the Elegoo printer.
 
     We include the fields that the firmware expects for proper gating:
     - PrintInfo.Status = 13 (printing)
     - Status.CurrentStatus = [1] (SDCP_MACHINE_STATUS_PRINTING)
-    - Basic progress/ticks so the UI looks sane during simulation.
+    - Basic progress so the UI looks sane during simulation.
+    - CurrentTicks in sampling intervals since the start, the index of
+      a --profile-out flow profile, and the Filename it is matched by.
     """
     if count <= 0:
         progress = 0
-        current_ticks = 0
-        total_ticks = 0
     else:
         progress = int(min(100, max(0, (index * 100) // count)))
-        total_ticks = count
-        current_ticks = min(index, count)
+    current_ticks = min(ticks, total_ticks)
 
     status = {
         "Topic": "status/simulator",
@@ -199,6 +262,7 @@ def build_status_payload(delta: float, total: float, index: int, count: int) ->
                 "PrintSpeedPct": 100,
                 "CurrentExtrusion": round(delta, 6),
                 "TotalExtrusion": round(total, 6),
+                "Filename": filename,
             },
         },
         "MainboardID": "SIMULATOR",
@@ -206,19 +270,40 @@ def build_status_payload(delta: float, total: float, index: int, count: int) ->
     return json.dumps(status)
 
 
+def record_samples(
+    path: Path, samples: List[Tuple[int, float, float]], interval_ms: int, filename: str
+) -> None:
+    """Write the status frames stream_samples() sends, with their send times."""
+    count = len(samples)
+    total_ticks = samples[-1][0] // interval_ms if samples else 0
+    with path.open("w", encoding="utf-8") as handle:
+        for index, (timestamp, delta, total) in enumerate(samples):
+            payload = build_status_payload(
+                delta, total, index, count, timestamp // interval_ms, total_ticks, filename
+            )
+            handle.write(f"{timestamp}\t{payload}\n")
+
+
 async def stream_samples(
     ws: web.WebSocketResponse,
     samples: List[Tuple[int, float, float]],
     repeat: bool,
     speed: float,
+    interval_ms: int,
+    filename: str,
 ) -> None:
     if not samples:
         return
 
     count = len(samples)
+    total_ticks = samples[-1][0] // interval_ms
     while True:
-        for index, (_, delta, total) in enumerate(samples):
-            await ws.send_str(build_status_payload(delta, total, index, count))
+        for index, (timestamp, delta, total) in enumerate(samples):
+            await ws.send_str(
+                build_status_payload(
+                    delta, total, index, count, timestamp // interval_ms, total_ticks, filename
+                )
+            )
             if index + 1 < count:
                 delay_ms = samples[index + 1][0] - samples[index][0]
             else:
@@ -234,6 +319,8 @@ async def serve_samples(
     port: int,
     repeat: bool,
     speed: float,
+    interval_ms: int,
+    filename: str,
 ) -> None:
     app = web.Application()
 
@@ -242,7 +329,7 @@ async def serve_samples(
         await ws.prepare(request)
         print("Simulator: client connected", flush=True)
         try:
-            await stream_samples(ws, samples, repeat, speed)
+            await stream_samples(ws, samples, repeat, speed, interval_ms, filename)
         finally:
             await ws.close()
             print("Simulator: client disconnected", flush=True)
@@ -278,10 +365,33 @@ def main() -> None:
         )
     )
 
+    profile_name = args.gcode.name if args.profile_name is None else args.profile_name
+    if args.profile_out:
+        try:
+            profile = build_flow_profile(samples, args.interval_ms, profile_name)
+        except ValueError as exc:
+            raise SystemExit(f"Cannot build flow profile: {exc}")
+        args.profile_out.write_bytes(profile)
+        print(f"Wrote flow profile ({len(profile)} bytes) to {args.profile_out}", flush=True)
+
+    if args.record:
+        record_samples(args.record, samples, args.interval_ms, profile_name)
+        print(f"Recorded {len(samples)} frames to {args.record}", flush=True)
+
     if args.serve:
         if not samples:
             raise SystemExit("No extrusion moves found in the provided G-code.")
-        asyncio.run(serve_samples(samples, args.host, args.port, args.repeat, args.speed))
+        asyncio.run(
+            serve_samples(
+                samples,
+                args.host,
+                args.port,
+                args.repeat,
+                args.speed,
+                args.interval_ms,
+                profile_name,
+            )
+        )
     else:
         formatter = format_table if args.output == "table" else format_json
         print(formatter(samples))
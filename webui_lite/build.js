@@ -3,23 +3,38 @@
 /**
  * Build script for lightweight WebUI.
  * Copies artifacts into data_lite/ (staging) and mirrors them to data/lite/
- * so LittleFS always has the latest assets.
+ * so LittleFS always has the latest assets. Assets are stored gzipped under
+ * content-hashed names where the URL allows it, and manifest.json tells the
+ * firmware which file, ETag and caching policy serve each URL.
  */
 
 const fs = require('fs');
 const path = require('path');
 const zlib = require('zlib');
+const crypto = require('crypto');
 
 const SOURCE_DIR = __dirname;
 const STAGING_DIR = path.join(__dirname, '..', 'data_lite');
 const FINAL_DIR = path.join(__dirname, '..', 'data', 'lite');
 
+// url: what the browser requests. hashed: served under a content-hashed name
+// (index.html references are rewritten) and cached by browsers for good.
+// Fixed URLs (page, favicon) are revalidated with their ETag instead.
 const files = [
-    { src: 'index.html', dest: 'index.htm' },
-    { src: 'lite_ota.js', dest: 'lite_ota.js' },
-    { src: 'favicon.ico', dest: 'favicon.ico', skipGzip: true },
+    { src: 'lite_ota.js', dest: 'lite_ota.js', url: '/lite/lite_ota.js', type: 'application/javascript', hashed: true },
+    { src: 'favicon.ico', dest: 'favicon.ico', url: '/favicon.ico', type: 'image/x-icon', skipGzip: true, optional: true },
+    // Last: its content depends on the hashed names above
+    { src: 'index.html', dest: 'index.htm', url: '/', type: 'text/html' },
 ];
 
+// Read by WebServer::loadUiManifest(); keep in sync with UiAsset field sizes
+const MANIFEST_NAME = 'manifest.json';
+const HASH_LENGTH = 10;
+
+function contentHash(content) {
+    return crypto.createHash('sha256').update(content).digest('hex').slice(0, HASH_LENGTH);
+}
+
 function ensureDir(dir) {
     if (!fs.existsSync(dir)) {
         fs.mkdirSync(dir, { recursive: true });
@@ -44,10 +59,13 @@ console.log('\n=== Building lightweight WebUI ===\n');
 fs.rmSync(STAGING_DIR, { recursive: true, force: true });
 ensureDir(STAGING_DIR);
 
+const manifest = { version: 1, assets: [] };
+const renamed = [];  // [original URL, hashed URL] for index.html
+
 files.forEach(file => {
     const srcPath = path.join(SOURCE_DIR, file.src);
     if (!fs.existsSync(srcPath)) {
-        if (file.skipGzip) {
+        if (file.optional) {
             console.log(`Skipping ${file.src} (not found)`);
             return;
         }
@@ -55,21 +73,52 @@ files.forEach(file => {
         process.exit(1);
     }
 
-    const destPath = path.join(STAGING_DIR, file.dest);
-    const content = fs.readFileSync(srcPath);
+    let content = fs.readFileSync(srcPath);
+    if (file.src === 'index.html') {
+        let html = content.toString('utf8');
+        for (const [from, to] of renamed) {
+            html = html.split(`"${from}"`).join(`"${to}"`);
+        }
+        content = Buffer.from(html, 'utf8');
+    }
+
+    const hash = contentHash(content);
+    let dest = file.dest;
+    let url = file.url;
+    if (file.hashed) {
+        const ext = path.extname(file.dest);
+        dest = `${path.basename(file.dest, ext)}.${hash}${ext}`;
+        url = `${path.posix.dirname(file.url)}/${dest}`;
+        renamed.push([file.url, url]);
+    }
 
+    const destPath = path.join(STAGING_DIR, dest);
+    let stored = dest;
     if (!file.skipGzip) {
         // For gzipped files, only create the .gz version to save space
         const gzipped = zlib.gzipSync(content, { level: 9 });
+        stored = dest + '.gz';
         fs.writeFileSync(destPath + '.gz', gzipped);
-        console.log(`Gzipped ${file.src} -> ${file.dest}.gz (${gzipped.length} bytes)`);
+        console.log(`Gzipped ${file.src} -> ${stored} (${gzipped.length} bytes)`);
     } else {
         // For non-gzipped files (e.g., favicon), copy as-is
         fs.writeFileSync(destPath, content);
-        console.log(`Copied ${file.src} -> ${file.dest}`);
+        console.log(`Copied ${file.src} -> ${stored}`);
     }
+
+    manifest.assets.push({
+        url,
+        file: `/lite/${stored}`,
+        etag: hash,
+        type: file.type,
+        gzip: !file.skipGzip,
+        immutable: !!file.hashed,
+    });
 });
 
+fs.writeFileSync(path.join(STAGING_DIR, MANIFEST_NAME), JSON.stringify(manifest));
+console.log(`Wrote ${MANIFEST_NAME} (${manifest.assets.length} assets)`);
+
 // Mirror staging directory into data/lite
 console.log('\nSyncing artifacts to data/lite ...');
 fs.rmSync(FINAL_DIR, { recursive: true, force: true });
@@ -211,11 +211,27 @@ function buildStatusData() {
             softJamPercent: simState.softJamPercent,
             passRatio: passRatio,
             ratioThreshold: 0.25,
+            softJamThreshold: 0.25,
             runoutPausePending: false,
             runoutPauseRemainingMm: 0,
             runoutPauseCommanded: false,
+            flowProfileActive: false,
+            activeChannel: 0,
+            channels: [
+                { pulses: simState.movementPulses, windowMm: simState.actualFilament, rateMmPerSec: 0 }
+            ],
             uiRefreshIntervalMs: 1000
         },
+        jamLatency: {
+            pauses: 0,
+            acked: 0,
+            onsetToDetectMs: 0,
+            detectToSendMs: 0,
+            sendToAckMs: 0,
+            totalMs: 0,
+            maxTotalMs: 0,
+            avgTotalMs: 0
+        },
         mac: '24:0A:C4:XX:XX:XX',
         ip: '192.168.1.100',
         uptimeSec: Math.floor(process.uptime())
@@ -229,9 +245,36 @@ app.get('/status_events', (req, res) => {
     res.setHeader('Connection', 'keep-alive');
     res.flushHeaders();
 
+    // Mirror the firmware: full "status" keyframe first (and every 30 events),
+    // then "delta" events with only changed fields, sequenced via the SSE id
+    let seq = 0;
+    let last = null;
+    const changedFields = (current, previous) => {
+        const out = {};
+        Object.keys(current).forEach(key => {
+            const value = current[key];
+            const prev = previous ? previous[key] : undefined;
+            if (value && typeof value === 'object' && !Array.isArray(value)) {
+                const nested = changedFields(value, prev);
+                if (Object.keys(nested).length > 0) out[key] = nested;
+            } else if (value !== prev) {
+                out[key] = value;
+            }
+        });
+        return out;
+    };
     const sendEvent = () => {
         const data = buildStatusData();
-        res.write(`event: status\ndata: ${JSON.stringify(data)}\n\n`);
+        if (!last || seq % 30 === 0) {
+            seq++;
+            res.write(`event: status\nid: ${seq}\ndata: ${JSON.stringify(data)}\n\n`);
+        } else {
+            const delta = changedFields(data, last);
+            if (Object.keys(delta).length === 0) return;
+            seq++;
+            res.write(`event: delta\nid: ${seq}\ndata: ${JSON.stringify(delta)}\n\n`);
+        }
+        last = JSON.parse(JSON.stringify(data));
     };
 
     sendEvent();
@@ -290,19 +333,47 @@ const mockLogs = [
     '[INFO] Total distance: 152.3 mm'
 ];
 
+// Mirrors the firmware: entries are numbered from 1, X-Log-Cursor carries the
+// newest number and ?since=<n> returns only entries after it
 app.get('/api/logs_live', (req, res) => {
-    res.json({ logs: mockLogs });
+    const latest = mockLogs.length;
+    const since = parseInt(req.query.since, 10);
+    const start = (!isNaN(since) && since <= latest) ? since : Math.max(0, latest - 100);
+    res.set('X-Log-Cursor', String(latest));
+    res.type('text/plain').send(mockLogs.slice(start).map(line => line + '\n').join(''));
 });
 
 app.get('/api/logs_text', (req, res) => {
     res.type('text/plain').send(mockLogs.join('\n'));
 });
 
+// Firmware serves LittleFS segments from earlier boots first, then the live ring
+app.get('/api/logs_history', (req, res) => {
+    res.set('X-Log-Cursor', String(mockLogs.length));
+    res.type('text/plain').send(['[INFO] (previous boot) System started']
+        .concat(mockLogs).map(line => line + '\n').join(''));
+});
+
 app.post('/api/logs_clear', (req, res) => {
     console.log('\n🗑️  Logs cleared');
     res.json({ success: true });
 });
 
+// Flow profile: the firmware takes the raw .bin as the request body
+app.get('/api/flow_profile', (req, res) => {
+    res.json({ loaded: false, entries: 0, msPerTick: 0, ticksPerEntry: 0, filename: '' });
+});
+
+app.post('/api/flow_profile', (req, res) => {
+    console.log('\n📈 Flow profile uploaded');
+    res.json({ status: 'ok', entries: 0 });
+});
+
+app.delete('/api/flow_profile', (req, res) => {
+    console.log('\n🗑️  Flow profile cleared');
+    res.type('text/plain').send('ok');
+});
+
 // Mock version info
 app.get('/version', (req, res) => {
     const now = new Date();
@@ -347,6 +418,7 @@ app.listen(PORT, () => {
     console.log(`   GET  /discover_printer`);
     console.log(`   GET  /api/logs_live`);
     console.log(`   GET  /api/logs_text`);
+    console.log(`   GET  /api/logs_history`);
     console.log(`   GET  /version`);
     console.log(`\n🎮 Keyboard Controls:`);
     console.log(`   [1] Normal print simulation`);